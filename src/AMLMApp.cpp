@@ -32,11 +32,16 @@
 
 // Ours
 #include <utils/TheSimplestThings.h>
+#include <AMLMSettings.h>
+#include <concurrency/AMLMExecutor.h>
+#include <logic/CollectionStore.h>
 #include <logic/SupportedMimeTypes.h>
 #include <gui/Theme.h>
 //#include <logic/dbmodels/CollectionDatabaseModel.h>
 #include <logic/PerfectDeleter.h>
 #include <utils/RegisterQtMetatypes.h>
+#include <utils/StartupProfiler.h>
+#include <utils/Trace.h>
 #include <gui/MainWindow.h>
 
 
@@ -70,7 +75,13 @@ void AMLMApp::Init(bool gtest_only)
 	PerfectDeleter::instance(this);
 
 	// Register our types with Qt.
-	RegisterQtMetatypes();
+	{
+		StartupProfiler::Phase phase("RegisterQtMetatypes");
+		RegisterQtMetatypes();
+	}
+
+	// The one store of the collection's files, which the models are views onto.
+	CollectionStore::instance(this);
 
 	/// @todo This is ugly, refactor this.
 	if(gtest_only)
@@ -82,6 +93,10 @@ void AMLMApp::Init(bool gtest_only)
 //    QNetworkAccessManager* nam = new QNetworkAccessManager(this);
 //    qIn() << "QNetworkAccessManager Supported Schemes:" << nam->supportedSchemes();
 
+	// Size the thread pools the async work runs on.
+	AMLMExecutor::configure(AMLMSettings::executorIoThreads(), AMLMSettings::executorCpuThreads(),
+							AMLMSettings::executorInteractiveThreads());
+
 	// Create the singletons we'll need for any app invocation.
 	m_the_supported_mime_types = &SupportedMimeTypes::instance(this);
 
@@ -178,6 +193,9 @@ void AMLMApp::SLOT_onAboutToQuit()
 
 	qDbo() << "#### App shutdown complete.";
 
+	// For tuning the executors' sizes.
+	AMLMExecutor::logStats();
+
 	if(!AMLMApp::IPerfectDeleter().empty())
 	{
 		qWro() << "PerfectDeleter still has undeleted objects:";
@@ -206,8 +224,19 @@ void AMLMApp::perform_controlled_shutdown()
 
 		m_the_supported_mime_types->deleteLater();
 
-		// Cancel all asynchronous activities and wait for them to complete.
-		AMLMApp::IPerfectDeleter().cancel_and_wait_for_all();
+		// Cancel all asynchronous activities and wait, for at most PerfectDeleter::c_default_shutdown_budget, for them to complete.
+		if(!AMLMApp::IPerfectDeleter().cancel_and_wait_for_all())
+		{
+			// Whatever's still running would be deleted out from under its worker, or waited on forever, by the
+			// rest of the teardown.  Leave it be.
+			AMLMApp::IPerfectDeleter().abandon_still_running();
+		}
+
+		// Everything's stopped, so the trace is complete.
+		if(const QString trace_path = Trace::exitTracePath(); !trace_path.isEmpty())
+		{
+			Trace::writeChromeTrace(trace_path);
+		}
     }
 	else
 	{
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file AMLMExecutor.cpp
+ * Implementation of AMLMExecutor.
+ */
+
+#include "AMLMExecutor.h"
+
+// Std C++
+#include <algorithm>
+
+// Qt
+#include <QThread>
+
+// Ours
+#include <utils/DebugHelpers.h>
+
+
+namespace
+{
+	/// Enough outstanding requests to keep a few disks or a network share busy.
+	constexpr int c_io_threads_per_core = 2;
+	constexpr int c_io_threads_min = 4;
+
+	/// Cover art etc. is small, a couple of threads keep the latency down without competing with the scans.
+	constexpr int c_interactive_threads = 2;
+
+	std::int64_t to_us(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	}
+}
+
+// The executors are never destroyed.  A QThreadPool's destructor waits for its tasks, and at exit those are either
+// long done, or ones the shutdown gave up waiting for, see PerfectDeleter::abandon_still_running().
+
+AMLMExecutor& AMLMExecutor::io()
+{
+	static AMLMExecutor* the_io_executor = new AMLMExecutor("AMLMIO",
+										std::max(c_io_threads_min, c_io_threads_per_core * QThread::idealThreadCount()),
+										QThread::InheritPriority);
+	return *the_io_executor;
+}
+
+AMLMExecutor& AMLMExecutor::cpu()
+{
+	static AMLMExecutor* the_cpu_executor = new AMLMExecutor("AMLMCPU", QThread::idealThreadCount(), QThread::InheritPriority);
+	return *the_cpu_executor;
+}
+
+AMLMExecutor& AMLMExecutor::interactive()
+{
+	static AMLMExecutor* the_interactive_executor = new AMLMExecutor("AMLMInteractive", c_interactive_threads, QThread::HighPriority);
+	return *the_interactive_executor;
+}
+
+void AMLMExecutor::configure(int io_threads, int cpu_threads, int interactive_threads)
+{
+	auto configure_one = [](AMLMExecutor& executor, int threads){
+		if(threads > 0)
+		{
+			executor.m_pool.setMaxThreadCount(threads);
+		}
+		qIn() << "Executor" << executor.name() << "threads:" << executor.m_pool.maxThreadCount();
+	};
+
+	configure_one(io(), io_threads);
+	configure_one(cpu(), cpu_threads);
+	configure_one(interactive(), interactive_threads);
+}
+
+void AMLMExecutor::logStats()
+{
+	for(AMLMExecutor* executor : {&io(), &cpu(), &interactive()})
+	{
+		qIn() << executor->stats();
+	}
+}
+
+void AMLMExecutor::start(std::function<void()> task, int priority)
+{
+	const auto queued_at = taskQueued();
+	m_pool.start([this, queued_at, task = std::move(task)](){
+		TaskScope scope(*this, queued_at);
+		task();
+	}, priority);
+}
+
+AMLMExecutor::Stats AMLMExecutor::stats() const
+{
+	Stats retval;
+	retval.m_name = name();
+	retval.m_max_threads = m_pool.maxThreadCount();
+	retval.m_queue_depth = m_queue_depth;
+	retval.m_running = m_running;
+	retval.m_completed = m_completed;
+
+	const std::int64_t started = m_started;
+	const std::int64_t completed = retval.m_completed;
+	if(started > 0)
+	{
+		retval.m_mean_queue_latency = std::chrono::microseconds(m_total_queue_latency_us / started);
+	}
+	retval.m_max_queue_latency = std::chrono::microseconds(m_max_queue_latency_us.load());
+	if(completed > 0)
+	{
+		retval.m_mean_run_time = std::chrono::microseconds(m_total_run_time_us / completed);
+	}
+	return retval;
+}
+
+AMLMExecutor::AMLMExecutor(const QString& name, int max_threads, QThread::Priority thread_priority)
+{
+	m_pool.setObjectName(name);
+	m_pool.setMaxThreadCount(max_threads);
+	m_pool.setThreadPriority(thread_priority);
+}
+
+AMLMExecutor::clock::time_point AMLMExecutor::taskQueued()
+{
+	++m_queue_depth;
+	return clock::now();
+}
+
+AMLMExecutor::TaskScope::TaskScope(AMLMExecutor& executor, clock::time_point queued_at)
+	: m_executor(executor), m_started_at(clock::now())
+{
+	--m_executor.m_queue_depth;
+	++m_executor.m_running;
+	++m_executor.m_started;
+
+	const std::int64_t latency_us = to_us(m_started_at - queued_at);
+	m_executor.m_total_queue_latency_us += latency_us;
+	std::int64_t max_us = m_executor.m_max_queue_latency_us;
+	while(latency_us > max_us && !m_executor.m_max_queue_latency_us.compare_exchange_weak(max_us, latency_us))
+	{
+	}
+}
+
+AMLMExecutor::TaskScope::~TaskScope()
+{
+	m_executor.m_total_run_time_us += to_us(clock::now() - m_started_at);
+	--m_executor.m_running;
+	++m_executor.m_completed;
+}
+
+QDebug operator<<(QDebug dbg, const AMLMExecutor::Stats& stats)
+{
+	QDebugStateSaver saver(dbg);
+	dbg.nospace() << "Executor(" << stats.m_name << ", threads: " << stats.m_max_threads
+		<< ", queued: " << stats.m_queue_depth << ", running: " << stats.m_running
+		<< ", completed: " << stats.m_completed
+		<< ", queue latency mean/max: " << stats.m_mean_queue_latency.count() << "/"
+		<< stats.m_max_queue_latency.count() << " us"
+		<< ", run time mean: " << stats.m_mean_run_time.count() << " us)";
+	return dbg;
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_CONCURRENCY_AMLMEXECUTOR_H_
+#define SRC_CONCURRENCY_AMLMEXECUTOR_H_
+
+/**
+ * @file AMLMExecutor.h
+ * Interface of AMLMExecutor, the named thread pools each kind of async work runs on.
+ */
+
+// Std C++
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Qt
+#include <QDebug>
+#include <QPromise>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+// Ours
+#include <future/guideline_helpers.h>
+
+
+namespace AMLMExecutor_detail
+{
+	/// Whether F is a function taking a QPromise<T>& first, the kind QtConcurrent::run() passes a promise to.
+	template <class F>
+	struct promise_function_traits
+	{
+		static constexpr bool value = false;
+	};
+	template <class T, class... Args>
+	struct promise_function_traits<void (*)(QPromise<T>&, Args...)>
+	{
+		static constexpr bool value = true;
+		using result_type = T;
+	};
+	/// Lambdas, by their operator().
+	template <class C, class T, class... Args>
+	struct promise_function_traits<void (C::*)(QPromise<T>&, Args...)>
+		: promise_function_traits<void (*)(QPromise<T>&, Args...)> {};
+	template <class C, class T, class... Args>
+	struct promise_function_traits<void (C::*)(QPromise<T>&, Args...) const>
+		: promise_function_traits<void (*)(QPromise<T>&, Args...)> {};
+	template <class F>
+		requires requires { &F::operator(); }
+	struct promise_function_traits<F> : promise_function_traits<decltype(&F::operator())> {};
+}
+
+/**
+ * A named QThreadPool for one kind of work, with counters for tuning its size.
+ *
+ * Everything async used to land on QThreadPool::globalInstance(), so a long dir scan blocked on disk I/O would hold
+ * every thread and the cover art for the track the user just clicked would wait behind it.  Now each job picks one:
+ *
+ * - io()           Blocking file and network I/O: dir scans, tag reads, database load/save.  More threads than cores,
+ *                  since they're mostly waiting.
+ * - cpu()          Compute, and the short continuation hops of streaming_then() etc.  One thread per core.
+ * - interactive()  Small things the user is waiting on right now, e.g. cover art.  Few threads, high priority, and
+ *                  never behind a scan.
+ *
+ * All members are threadsafe.
+ */
+class AMLMExecutor
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(AMLMExecutor)
+
+	/// Counters for tuning, see stats().
+	struct Stats
+	{
+		QString m_name;
+		int m_max_threads {0};
+		/// Submitted but not started yet.
+		std::int64_t m_queue_depth {0};
+		std::int64_t m_running {0};
+		std::int64_t m_completed {0};
+		/// From submission to start.
+		std::chrono::microseconds m_mean_queue_latency {0};
+		std::chrono::microseconds m_max_queue_latency {0};
+		/// From start to finish.
+		std::chrono::microseconds m_mean_run_time {0};
+	};
+
+	/// @name The executors.
+	/// @{
+	static AMLMExecutor& io();
+	static AMLMExecutor& cpu();
+	static AMLMExecutor& interactive();
+	/// @}
+
+	/**
+	 * Set the executors' thread counts, e.g. from the settings.  0 leaves that one at its default.
+	 */
+	static void configure(int io_threads, int cpu_threads, int interactive_threads);
+
+	/// Log all the executors' stats().
+	static void logStats();
+
+	/// The underlying pool, for APIs which want one.  Work started on it directly isn't counted in stats().
+	QThreadPool* pool() { return &m_pool; }
+
+	/// Run @a task.  Higher @a priority tasks are started first.
+	void start(std::function<void()> task, int priority = 0);
+
+	/**
+	 * Like QtConcurrent::run(), but on this executor.  If @a function takes a QPromise<T>& first it's passed one, and
+	 * the future is a QFuture<T>.  Otherwise the future is of whatever @a function returns.
+	 */
+	template <class Function, class... Args>
+	auto run(Function&& function, Args&&... args)
+	{
+		using FunctionType = std::decay_t<Function>;
+		using traits = AMLMExecutor_detail::promise_function_traits<FunctionType>;
+
+		const auto queued_at = taskQueued();
+		if constexpr(traits::value)
+		{
+			using T = typename traits::result_type;
+			return QtConcurrent::run(&m_pool,
+					[this, queued_at, function = FunctionType(function), ...args = std::forward<Args>(args)]
+					(QPromise<T>& promise) mutable {
+						TaskScope scope(*this, queued_at);
+						std::invoke(function, promise, std::move(args)...);
+					});
+		}
+		else
+		{
+			return QtConcurrent::run(&m_pool,
+					[this, queued_at, function = FunctionType(std::forward<Function>(function)),
+					 ...args = std::forward<Args>(args)]() mutable {
+						TaskScope scope(*this, queued_at);
+						return std::invoke(function, std::move(args)...);
+					});
+		}
+	}
+
+	/// A snapshot of the counters.
+	Stats stats() const;
+
+	QString name() const { return m_pool.objectName(); }
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	AMLMExecutor(const QString& name, int max_threads, QThread::Priority thread_priority);
+	~AMLMExecutor() = default;
+
+	/// Counts a task in, returns when it was queued.
+	clock::time_point taskQueued();
+
+	/// Counts a task from started to finished.
+	class TaskScope
+	{
+	public:
+		TaskScope(AMLMExecutor& executor, clock::time_point queued_at);
+		~TaskScope();
+	private:
+		AMLMExecutor& m_executor;
+		clock::time_point m_started_at;
+	};
+
+	QThreadPool m_pool;
+
+	std::atomic<std::int64_t> m_queue_depth {0};
+	std::atomic<std::int64_t> m_running {0};
+	std::atomic<std::int64_t> m_started {0};
+	std::atomic<std::int64_t> m_completed {0};
+	std::atomic<std::int64_t> m_total_queue_latency_us {0};
+	std::atomic<std::int64_t> m_max_queue_latency_us {0};
+	std::atomic<std::int64_t> m_total_run_time_us {0};
+};
+
+QDebug operator<<(QDebug dbg, const AMLMExecutor::Stats& stats);
+
+#endif /* SRC_CONCURRENCY_AMLMEXECUTOR_H_ */
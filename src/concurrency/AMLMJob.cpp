@@ -301,6 +301,42 @@ void AMLMJob::setTotalAmountAndSize(/*KJob::Unit*/int unit, qulonglong amount)
 	setTotalAmount(KJob::Unit(unit), amount);
 }
 
+void AMLMJob::setProgressCounter(std::shared_ptr<ProgressCounter> counter)
+{
+	m_progress_counter = std::move(counter);
+	m_last_progress_sample = ProgressCounter::Sample();
+}
+
+void AMLMJob::sampleProgressCounter()
+{
+	if(!m_progress_counter)
+	{
+		return;
+	}
+
+	ProgressCounter::Sample sample = m_progress_counter->sample();
+
+	if(sample.m_total != m_last_progress_sample.m_total)
+	{
+		setTotalAmountAndSize(progressUnit(), sample.m_total);
+	}
+	if(sample.m_processed != m_last_progress_sample.m_processed)
+	{
+		setProcessedAmountAndSize(progressUnit(), sample.m_processed);
+	}
+	if(!sample.m_current_item.isEmpty() && sample.m_current_item != m_last_progress_sample.m_current_item)
+	{
+		Q_EMIT infoMessage(this, sample.m_current_item);
+	}
+	else
+	{
+		// Nothing new, keep the one that's showing.
+		sample.m_current_item = m_last_progress_sample.m_current_item;
+	}
+
+	m_last_progress_sample = std::move(sample);
+}
+
 void AMLMJob::setProgressUnit(int prog_unit)
 {
 #ifdef THIS_IS_EVER_NOT_BROKEN
@@ -24,6 +24,7 @@
 
 // Std C++
 #include <deque>
+#include <memory>
 
 // Qt
 #include <QObject>
@@ -44,6 +45,7 @@
 #include <future/guideline_helpers.h>
 #include <utils/UniqueIDMixin.h>
 #include "utils/ConnectHelpers.h"
+#include "ProgressCounter.h"
 
 
 
@@ -312,8 +314,22 @@ public:
 	void setProcessedAmountAndSize(int unit, qulonglong amount) /*override*/;
 	void setTotalAmountAndSize(int unit, qulonglong amount) /*override*/;
 
+	/**
+	 * Report progress through @a counter instead of the wrapped future's progress.  The worker updates the counter,
+	 * and the tracker calls sampleProgressCounter() at display refresh rate.  The future's progress range/value
+	 * signals are then ignored.
+	 */
+	void setProgressCounter(std::shared_ptr<ProgressCounter> counter);
+	bool hasProgressCounter() const { return static_cast<bool>(m_progress_counter); }
+
     /// @}
 
+	/**
+	 * Pick up whatever's changed in the ProgressCounter since the last call, and emit the KJob progress signals for it.
+	 * Called from the GUI thread by ActivityProgressStatusBarTracker.  Does nothing if there's no counter.
+	 */
+	void sampleProgressCounter();
+
 	/// Returns the currently set progress unit for this AMLMJob.
 	KJob::Unit progressUnit() const;
 
@@ -469,6 +485,10 @@ private:
 
     /// Wishful thinking at the moment, but maybe I'll figure out how to separate "Size" from KJob::Bytes.
     KJob::Unit m_progress_unit { KJob::Unit::Bytes };
+
+	std::shared_ptr<ProgressCounter> m_progress_counter;
+	/// What was last passed on from m_progress_counter, so unchanged samples don't emit anything.
+	ProgressCounter::Sample m_last_progress_sample;
 };
 
 
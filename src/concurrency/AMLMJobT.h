@@ -36,6 +36,7 @@
 #include "AMLMJob.h"
 #include "ExtFutureProgressInfo.h"
 #include "ExtFuture.h"
+#include "CoTask.h"
 
 /**
  * Class template for wrapping ExtAsync jobs returning an ExtFuture<T>.
@@ -212,6 +213,11 @@ protected: //Q_SLOTS:
 
     virtual void SLOT_extfuture_progressRangeChanged(int min, int max)
     {
+		if(this->hasProgressCounter())
+		{
+			// sampleProgressCounter() reports it.
+			return;
+		}
         this->setTotalAmountAndSize(this->progressUnit(), max-min);
     }
 
@@ -278,6 +284,10 @@ protected: //Q_SLOTS:
 
     virtual void SLOT_extfuture_progressValueChanged(int progress_value)
     {
+		if(this->hasProgressCounter())
+		{
+			return;
+		}
         this->setProcessedAmountAndSize(this->progressUnit(), progress_value);
 //        this->emitSpeed(progress_value);
     }
@@ -652,5 +662,16 @@ make_async_AMLMJobT(ExtFutureT ef, const char* jobname = nullptr, QObject* paren
 	return new AMLMJobT<ExtFutureT>(ef, parent, jobname, KJob::Unit::Files);
 }
 
+/**
+ * Create a new AMLMJobT wrapped around a coroutine's CoTask<T>.  Killing the job cancels the coroutine at its next
+ * co_await.
+ */
+template<class T>
+AMLMJobT<ExtFuture<T>>*
+make_async_AMLMJobT(CoTask<T> task, const char* jobname = nullptr, QObject* parent = nullptr)
+{
+	return make_async_AMLMJobT(task.future(), jobname, parent);
+}
+
 
 #endif //AWESOMEMEDIALIBRARYMANAGER_AMLMJOBT_H
@@ -0,0 +1,407 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_CONCURRENCY_BOUNDEDCHANNEL_H_
+#define SRC_CONCURRENCY_BOUNDEDCHANNEL_H_
+
+/**
+ * @file BoundedChannel.h
+ * BoundedChannel, a fixed-capacity multi-producer/multi-consumer queue for connecting pipeline stages,
+ * and streaming_consume() to drain one without parking a thread.
+ */
+
+// Std C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+// Qt
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QPromise>
+
+// Ours
+#include <future/cpp14_concepts.hpp>
+#include <future/guideline_helpers.h>
+#include <utils/ConnectHelpers.h>
+#include "ContinuationExecutor.h"
+
+
+/**
+ * Fixed-capacity multi-producer/multi-consumer channel.
+ *
+ * Unlike a QFuture's result store, items are freed as soon as they're popped, so the memory a pipeline stage holds
+ * is bounded by the capacity, not the number of items that have gone through it.
+ *
+ * - Producers push(), which blocks while the channel is full, then close() when they're done.
+ * - Consumers pop until the channel isDrained(): closed and empty.
+ * - cancel() drops whatever's queued and wakes everyone.  Pushes after that fail, which is how a producer finds out.
+ *
+ * Always held by std::shared_ptr, it's shared between the stages.  All members are threadsafe.
+ */
+template <class T>
+class BoundedChannel
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(BoundedChannel)
+
+	/// How often a push() blocked on a full channel checks if its producer has been canceled.
+	static constexpr std::chrono::milliseconds c_cancel_poll_interval {50};
+
+	explicit BoundedChannel(std::size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {}
+	~BoundedChannel() = default;
+
+	/// @name Producer side
+	/// @{
+
+	/**
+	 * Push @a item, blocking while the channel is full.
+	 * @returns false if the channel was canceled or closed, and @a item wasn't pushed.
+	 */
+	bool push(T item)
+	{
+		return push_impl(std::move(item), [](){ return false; });
+	}
+
+	/**
+	 * Push @a item, blocking while the channel is full or until @a cancel_source, e.g. the producer's QPromise,
+	 * is canceled.  Canceling the producer cancels the channel.
+	 * @returns false if the channel or @a cancel_source was canceled, or the channel was closed.
+	 */
+	template <class CancelSource>
+	bool push(T item, const CancelSource& cancel_source)
+	{
+		return push_impl(std::move(item), [&](){ return cancel_source.isCanceled(); });
+	}
+
+	/**
+	 * Push all of @a items, blocking as needed.  Only takes the lock once per run of free space.
+	 * @returns false if the channel was canceled or closed before all of @a items were pushed.
+	 */
+	bool push_batch(std::vector<T> items)
+	{
+		std::size_t next = 0;
+		while(next < items.size())
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_not_full.wait(lock, [this](){ return m_closed || m_queue.size() < m_capacity; });
+				if(m_closed)
+				{
+					return false;
+				}
+				while(next < items.size() && m_queue.size() < m_capacity)
+				{
+					m_queue.push_back(std::move(items[next]));
+					++next;
+					++m_total_pushed;
+				}
+			}
+			m_not_empty.notify_all();
+			notify_ready();
+		}
+		return true;
+	}
+
+	/// No more items are coming.  Consumers get what's left, then see isDrained().
+	void close()
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_closed = true;
+		}
+		m_not_full.notify_all();
+		m_not_empty.notify_all();
+		notify_ready();
+	}
+
+	/// @}
+
+	/// @name Consumer side
+	/// @{
+
+	/// Pop one item, blocking until there is one.  Returns nullopt once the channel isDrained().
+	std::optional<T> pop()
+	{
+		std::optional<T> retval;
+		{
+			std::unique_lock lock(m_mutex);
+			m_not_empty.wait(lock, [this](){ return m_closed || !m_queue.empty(); });
+			if(m_queue.empty())
+			{
+				return retval;
+			}
+			retval.emplace(std::move(m_queue.front()));
+			m_queue.pop_front();
+			++m_total_popped;
+		}
+		m_not_full.notify_one();
+		return retval;
+	}
+
+	/// Pop up to @a max_items, blocking until there's at least one.  Returns an empty vector once the channel isDrained().
+	std::vector<T> pop_batch(std::size_t max_items)
+	{
+		std::unique_lock lock(m_mutex);
+		m_not_empty.wait(lock, [this](){ return m_closed || !m_queue.empty(); });
+		return take_locked(lock, max_items);
+	}
+
+	/// Pop up to @a max_items without blocking.
+	std::vector<T> try_pop_batch(std::size_t max_items)
+	{
+		std::unique_lock lock(m_mutex);
+		return take_locked(lock, max_items);
+	}
+
+	/**
+	 * Set the function called whenever items are pushed or the channel is closed or canceled, for consumers which
+	 * don't want to block in pop().  Called without the lock held, from whichever thread did the push.
+	 * Keep it short, e.g. post a drain to an executor.
+	 */
+	void setReadyCallback(std::function<void()> ready_callback)
+	{
+		std::scoped_lock lock(m_callback_mutex);
+		m_ready_callback = std::move(ready_callback);
+	}
+
+	/// @}
+
+	/// Drop everything queued, and fail all pushes from now on.
+	void cancel()
+	{
+		std::deque<T> dropped;
+		{
+			std::scoped_lock lock(m_mutex);
+			m_canceled = true;
+			m_closed = true;
+			dropped.swap(m_queue);
+		}
+		m_not_full.notify_all();
+		m_not_empty.notify_all();
+		notify_ready();
+		// dropped is freed here, outside the lock.
+	}
+
+	bool isCanceled() const { std::scoped_lock lock(m_mutex); return m_canceled; }
+	/// Closed and empty, nothing more will ever come out.
+	bool isDrained() const { std::scoped_lock lock(m_mutex); return m_closed && m_queue.empty(); }
+
+	std::size_t capacity() const { return m_capacity; }
+	std::size_t size() const { std::scoped_lock lock(m_mutex); return m_queue.size(); }
+
+	/// @name Counts, for progress reporting.
+	/// @{
+	std::size_t totalPushed() const { std::scoped_lock lock(m_mutex); return m_total_pushed; }
+	std::size_t totalPopped() const { std::scoped_lock lock(m_mutex); return m_total_popped; }
+	/// @}
+
+private:
+
+	template <class IsCanceledFunc>
+	bool push_impl(T&& item, IsCanceledFunc is_canceled)
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			while(!m_closed && m_queue.size() >= m_capacity)
+			{
+				if(is_canceled())
+				{
+					lock.unlock();
+					cancel();
+					return false;
+				}
+				m_not_full.wait_for(lock, c_cancel_poll_interval);
+			}
+			if(m_closed)
+			{
+				return false;
+			}
+			m_queue.push_back(std::move(item));
+			++m_total_pushed;
+		}
+		m_not_empty.notify_one();
+		notify_ready();
+		return true;
+	}
+
+	std::vector<T> take_locked(std::unique_lock<std::mutex>& lock, std::size_t max_items)
+	{
+		std::vector<T> retval;
+		const std::size_t num_items = std::min(max_items, m_queue.size());
+		retval.reserve(num_items);
+		for(std::size_t i = 0; i < num_items; ++i)
+		{
+			retval.push_back(std::move(m_queue.front()));
+			m_queue.pop_front();
+		}
+		m_total_popped += num_items;
+		lock.unlock();
+		if(num_items > 0)
+		{
+			m_not_full.notify_all();
+		}
+		return retval;
+	}
+
+	void notify_ready()
+	{
+		std::function<void()> ready_callback;
+		{
+			std::scoped_lock lock(m_callback_mutex);
+			ready_callback = m_ready_callback;
+		}
+		if(ready_callback)
+		{
+			ready_callback();
+		}
+	}
+
+	const std::size_t m_capacity;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_not_full;
+	std::condition_variable m_not_empty;
+	std::deque<T> m_queue;
+	bool m_closed {false};
+	bool m_canceled {false};
+	std::size_t m_total_pushed {0};
+	std::size_t m_total_popped {0};
+
+	std::mutex m_callback_mutex;
+	std::function<void()> m_ready_callback;
+};
+
+/**
+ * Calls @a function with batches of up to @a max_batch items from @a channel as they're pushed, until the channel
+ * isDrained().  The streaming_then() of channels: nothing waits on the channel, a SerialExecutor on @a executor drains
+ * it whenever there's something to drain, so @a function is called one batch at a time, in order.
+ *
+ * - If @a function throws, the channel is canceled and the returned future finishes with the exception.
+ * - If the channel is canceled, the returned future is canceled.
+ * - Canceling the returned future cancels the channel, which is how its producers find out.
+ *
+ * The returned future's progress is the number of items consumed out of the number pushed so far.
+ *
+ * @param function  Called as function(std::vector<T> batch).
+ */
+template <class T, class Function,
+	REQUIRES(std::is_invocable_v<Function, std::vector<T>>)>
+QFuture<void> streaming_consume(std::shared_ptr<BoundedChannel<T>> channel, Function function,
+								std::size_t max_batch = 64, AMLMExecutor& executor = AMLMExecutor::cpu())
+{
+	struct State
+	{
+		explicit State(Function&& f) : m_function(std::move(f)) {}
+
+		Function m_function;
+		QPromise<void> m_promise;
+		std::atomic_bool m_drain_posted {false};
+		/// Only touched from the SerialExecutor.
+		bool m_done {false};
+	};
+	auto state = std::make_shared<State>(std::move(function));
+	auto serial_executor = std::make_shared<SerialExecutor>(executor);
+
+	QFuture<void> ret_future = state->m_promise.future();
+	state->m_promise.start();
+
+	// Only ever run on serial_executor.
+	auto drain = [=]() mutable {
+		state->m_drain_posted = false;
+		if(state->m_done)
+		{
+			return;
+		}
+
+		auto finish = [&](){
+			state->m_done = true;
+			// Break the channel -> callback -> channel cycle.
+			channel->setReadyCallback({});
+			state->m_promise.finish();
+		};
+
+		try
+		{
+			while(true)
+			{
+				if(ret_future.isCanceled())
+				{
+					channel->cancel();
+				}
+				std::vector<T> batch = channel->try_pop_batch(max_batch);
+				if(batch.empty())
+				{
+					break;
+				}
+				state->m_function(std::move(batch));
+				state->m_promise.setProgressRange(0, int(channel->totalPushed()));
+				state->m_promise.setProgressValue(int(channel->totalPopped()));
+			}
+		}
+		catch(...)
+		{
+			state->m_promise.setException(std::current_exception());
+			channel->cancel();
+			finish();
+			return;
+		}
+
+		if(channel->isDrained())
+		{
+			if(channel->isCanceled())
+			{
+				ret_future.cancel();
+			}
+			finish();
+		}
+	};
+
+	channel->setReadyCallback([=](){
+		if(!state->m_drain_posted.exchange(true))
+		{
+			serial_executor->post(drain);
+		}
+	});
+
+	// Cancellation flows back to the channel.
+	ContinuationExecutor::runInDispatchThread([=](){
+		auto* down_watcher = new QFutureWatcher<void>(ContinuationExecutor::dispatchContext());
+		connect_or_die(down_watcher, &QFutureWatcher<void>::canceled, down_watcher, [=](){ channel->cancel(); });
+		connect_or_die(down_watcher, &QFutureWatcher<void>::finished, down_watcher, &QObject::deleteLater);
+		down_watcher->setFuture(ret_future);
+	});
+
+	// Pick up anything pushed before the callback was set.
+	serial_executor->post(drain);
+
+	return ret_future;
+}
+
+#endif /* SRC_CONCURRENCY_BOUNDEDCHANNEL_H_ */
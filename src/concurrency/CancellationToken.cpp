@@ -0,0 +1,172 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file CancellationToken.cpp
+ * Implementation of CancellationSource and CancellationToken.
+ */
+
+#include "CancellationToken.h"
+
+// Std C++
+#include <algorithm>
+
+// Qt
+#include <QMutexLocker>
+
+// Ours
+#include <utils/DebugHelpers.h>
+
+
+namespace
+{
+	std::int64_t now_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/// For CancellationSource::latencyStats().
+	std::atomic<std::int64_t> s_num_latencies_measured {0};
+	std::atomic<std::int64_t> s_total_latency_ns {0};
+	std::atomic<std::int64_t> s_max_latency_ns {0};
+}
+
+namespace Cancellation_detail
+{
+
+void Node::cancel()
+{
+	std::vector<std::function<void()>> callbacks;
+	std::vector<std::weak_ptr<Node>> children;
+
+	{
+		QMutexLocker locker(&m_mutex);
+
+		if(m_canceled.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		m_canceled_at_ns.store(now_ns(), std::memory_order_relaxed);
+		m_canceled.store(true, std::memory_order_release);
+
+		// Nothing's added after this, onCancel() and addChild() see m_canceled and act immediately.
+		callbacks.swap(m_callbacks);
+		children.swap(m_children);
+	}
+
+	// Outside the lock, the callbacks can do anything, including cancel other scopes.
+	for(auto& callback : callbacks)
+	{
+		callback();
+	}
+	for(const auto& weak_child : children)
+	{
+		if(auto child = weak_child.lock())
+		{
+			child->cancel();
+		}
+	}
+}
+
+void Node::onCancel(std::function<void()> callback)
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		if(!m_canceled.load(std::memory_order_relaxed))
+		{
+			m_callbacks.push_back(std::move(callback));
+			return;
+		}
+	}
+	callback();
+}
+
+void Node::addChild(const std::shared_ptr<Node>& child)
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		if(!m_canceled.load(std::memory_order_relaxed))
+		{
+			// Drop the ones which are gone while we're here, so a long-lived parent doesn't accumulate them.
+			std::erase_if(m_children, [](const std::weak_ptr<Node>& weak_child){ return weak_child.expired(); });
+			m_children.push_back(child);
+			return;
+		}
+	}
+	child->cancel();
+}
+
+void Node::recordLatency()
+{
+	if(m_latency_recorded.exchange(true, std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	const std::int64_t latency_ns = now_ns() - m_canceled_at_ns.load(std::memory_order_relaxed);
+	s_num_latencies_measured.fetch_add(1, std::memory_order_relaxed);
+	s_total_latency_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+	std::int64_t max_ns = s_max_latency_ns.load(std::memory_order_relaxed);
+	while(latency_ns > max_ns && !s_max_latency_ns.compare_exchange_weak(max_ns, latency_ns, std::memory_order_relaxed))
+	{
+	}
+}
+
+} // namespace Cancellation_detail
+
+CancellationSource::CancellationSource() : m_node(std::make_shared<Cancellation_detail::Node>())
+{
+}
+
+CancellationSource::CancellationSource(const CancellationToken& parent) : CancellationSource()
+{
+	if(parent.m_node)
+	{
+		parent.m_node->addChild(m_node);
+	}
+}
+
+CancellationSource& CancellationSource::appRoot()
+{
+	static CancellationSource the_app_root;
+	return the_app_root;
+}
+
+CancellationSource::LatencyStats CancellationSource::latencyStats()
+{
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+	using std::chrono::nanoseconds;
+
+	LatencyStats retval;
+	retval.m_num_measured = s_num_latencies_measured.load(std::memory_order_relaxed);
+	if(retval.m_num_measured > 0)
+	{
+		retval.m_mean = duration_cast<microseconds>(nanoseconds(s_total_latency_ns.load(std::memory_order_relaxed) / retval.m_num_measured));
+	}
+	retval.m_max = duration_cast<microseconds>(nanoseconds(s_max_latency_ns.load(std::memory_order_relaxed)));
+	return retval;
+}
+
+void CancellationSource::logLatencyStats()
+{
+	const LatencyStats stats = latencyStats();
+	qIn() << "Cancellation latency, cancel() to checkpoint(): measured:" << stats.m_num_measured
+		  << "mean/max:" << stats.m_mean.count() << "/" << stats.m_max.count() << "us";
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_CONCURRENCY_CANCELLATIONTOKEN_H_
+#define SRC_CONCURRENCY_CANCELLATIONTOKEN_H_
+
+/**
+ * @file CancellationToken.h
+ * CancellationSource and CancellationToken, a tree of cancellation scopes from the app down to single tasks.
+ */
+
+// Std C++
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Qt
+#include <QFuture>
+#include <QMutex>
+
+// Ours
+#include "ExtAsyncExceptions.h"
+
+
+namespace Cancellation_detail
+{
+
+/**
+ * One scope in the tree.  Shared by its CancellationSource, its tokens, and weakly by its parent.
+ */
+class Node
+{
+public:
+	Node() = default;
+
+	bool isCanceled() const { return m_canceled.load(std::memory_order_acquire); }
+
+	/// Cancel this and everything under it, and run the callbacks.  Only the first call does anything.
+	void cancel();
+
+	/// Runs @a callback on cancel(), or right now if it's already been canceled.
+	void onCancel(std::function<void()> callback);
+
+	/// Makes @a child a child of this.  Canceled right now if this already has been.
+	void addChild(const std::shared_ptr<Node>& child);
+
+	/// The first time it's called after the cancel, records how long it took to get here.
+	void recordLatency();
+
+private:
+	std::atomic_bool m_canceled {false};
+	std::atomic_bool m_latency_recorded {false};
+	std::atomic<std::int64_t> m_canceled_at_ns {0};
+
+	QMutex m_mutex;
+	std::vector<std::function<void()>> m_callbacks;
+	std::vector<std::weak_ptr<Node>> m_children;
+};
+
+} // namespace Cancellation_detail
+
+/**
+ * The read side of a cancellation scope, passed down to whatever should stop when it's canceled.  Cheap to copy,
+ * threadsafe.  A default-constructed token is never canceled.
+ */
+class CancellationToken
+{
+public:
+	CancellationToken() = default;
+
+	/// One atomic load.
+	bool isCanceled() const { return m_node && m_node->isCanceled(); }
+
+	/**
+	 * A cooperative check point: isCanceled(), but the first check point to see the cancellation records the time
+	 * since it was requested in CancellationSource::latencyStats().  Put them in the loops, between units of work
+	 * which take a bounded time, e.g. one file's TagLib read.
+	 */
+	bool checkpoint() const
+	{
+		if(!isCanceled())
+		{
+			return false;
+		}
+		m_node->recordLatency();
+		return true;
+	}
+
+	/// checkpoint(), throwing ExtAsyncCancelException if canceled.
+	void throwIfCanceled() const
+	{
+		if(checkpoint())
+		{
+			throw ExtAsyncCancelException();
+		}
+	}
+
+	/**
+	 * Runs @a callback, on the canceling thread, when this is canceled.  Right now if it already has been.
+	 * It's kept until the scope is destroyed, so it shouldn't hold anything it shouldn't keep alive that long.
+	 */
+	void onCancel(std::function<void()> callback) const
+	{
+		if(m_node)
+		{
+			m_node->onCancel(std::move(callback));
+		}
+	}
+
+	/// Cancel @a future when this is canceled, e.g. to stop a worker which checks its QPromise.
+	template <class T>
+	void bind(QFuture<T> future) const
+	{
+		onCancel([future]() mutable { future.cancel(); });
+	}
+
+private:
+	friend class CancellationSource;
+
+	explicit CancellationToken(std::shared_ptr<Cancellation_detail::Node> node) : m_node(std::move(node)) {}
+
+	std::shared_ptr<Cancellation_detail::Node> m_node;
+};
+
+/**
+ * The owning side of a cancellation scope.
+ *
+ * Scopes form a tree: a source made from a parent's token is canceled when the parent is, so canceling the root
+ * stops everything, canceling a LibraryRescanner's stops its scan, canceling a scan's stops its tasks.  The tree
+ * only holds its children weakly, a scope goes away with its last source or token.  Copies share the scope.
+ *
+ * CancellationSource::appRoot() is canceled first thing at shutdown.
+ */
+class CancellationSource
+{
+public:
+	/// A new top-level scope.
+	CancellationSource();
+	/// A new scope under @a parent.
+	explicit CancellationSource(const CancellationToken& parent);
+
+	void cancel() { m_node->cancel(); }
+	bool isCanceled() const { return m_node->isCanceled(); }
+
+	CancellationToken token() const { return CancellationToken(m_node); }
+
+	/// The root of all the app's scopes.
+	static CancellationSource& appRoot();
+
+	/// How long it's taken the checkpoint()s to notice the cancellations so far.
+	struct LatencyStats
+	{
+		std::int64_t m_num_measured {0};
+		std::chrono::microseconds m_mean {0};
+		std::chrono::microseconds m_max {0};
+	};
+	static LatencyStats latencyStats();
+
+	/// Log latencyStats().
+	static void logLatencyStats();
+
+private:
+	std::shared_ptr<Cancellation_detail::Node> m_node;
+};
+
+#endif /* SRC_CONCURRENCY_CANCELLATIONTOKEN_H_ */
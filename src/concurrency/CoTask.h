@@ -0,0 +1,298 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_CONCURRENCY_COTASK_H_
+#define SRC_CONCURRENCY_COTASK_H_
+
+/**
+ * @file CoTask.h
+ * CoTask<T>, a coroutine which can co_await ExtFutures, and whose result is an ExtFuture<T>.
+ */
+
+// Std C++
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Qt
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QPromise>
+
+// Ours
+#include <utils/ConnectHelpers.h>
+#include "ContinuationExecutor.h"
+#include "ExtAsyncExceptions.h"
+
+template <class T>
+class CoTask;
+
+namespace CoTask_detail
+{
+
+/**
+ * What a co_await of a QFuture<T> in a CoTask turns into.
+ *
+ * Nothing waits on the future.  A watcher in the ContinuationExecutor's dispatch thread resumes the coroutine on
+ * its CoExecutor when the future finishes, or when the awaiting task is canceled.
+ */
+template <class T>
+class FutureAwaiter
+{
+public:
+	FutureAwaiter(QFuture<T> future, QFuture<void> awaiting, CoExecutor executor)
+		: m_future(std::move(future)), m_awaiting(std::move(awaiting)), m_executor(std::move(executor)) {}
+
+	bool await_ready() const
+	{
+		return m_future.isFinished() || m_awaiting.isCanceled();
+	}
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		// The up and down watchers can both fire, only the first one gets to resume.
+		auto resumed = std::make_shared<std::atomic_bool>(false);
+		auto resume_once = [=, executor = m_executor](){
+			if(!resumed->exchange(true))
+			{
+				executor.post([handle](){ handle.resume(); });
+			}
+		};
+
+		ContinuationExecutor::runInDispatchThread([=, future = m_future, awaiting = m_awaiting]() mutable {
+			QObject* context = ContinuationExecutor::dispatchContext();
+			auto* up_watcher = new QFutureWatcher<T>(context);
+			auto* down_watcher = new QFutureWatcher<void>(context);
+			auto done = [=](){
+				up_watcher->deleteLater();
+				down_watcher->deleteLater();
+				resume_once();
+			};
+
+			connect_or_die(up_watcher, &QFutureWatcher<T>::finished, context, done);
+			// Canceling the awaiting task cancels what it's waiting on, and wakes it up to find out.
+			connect_or_die(down_watcher, &QFutureWatcher<void>::canceled, context, [=]() mutable {
+				future.cancel();
+				done();
+			});
+
+			down_watcher->setFuture(awaiting);
+			up_watcher->setFuture(future);
+		});
+	}
+
+	/// The first result of the future.  Throws ExtAsyncCancelException if either side was canceled.
+	T await_resume()
+	{
+		if(m_awaiting.isCanceled())
+		{
+			throw ExtAsyncCancelException();
+		}
+		// It's finished, so this doesn't wait, it just rethrows any exception it finished with.
+		m_future.waitForFinished();
+		if(m_future.isCanceled())
+		{
+			throw ExtAsyncCancelException();
+		}
+		if constexpr(!std::is_void_v<T>)
+		{
+			if(m_future.resultCount() == 0)
+			{
+				// Finished without a result, i.e. a broken promise.
+				throw ExtAsyncCancelException();
+			}
+			return m_future.result();
+		}
+	}
+
+private:
+	QFuture<T> m_future;
+	QFuture<void> m_awaiting;
+	CoExecutor m_executor;
+};
+
+/**
+ * What a co_await of a CoExecutor in a CoTask turns into: continue on that executor.
+ */
+class ExecutorAwaiter
+{
+public:
+	ExecutorAwaiter(CoExecutor executor, QFuture<void> awaiting)
+		: m_executor(std::move(executor)), m_awaiting(std::move(awaiting)) {}
+
+	bool await_ready() const { return false; }
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		m_executor.post([handle](){ handle.resume(); });
+	}
+
+	void await_resume() const
+	{
+		if(m_awaiting.isCanceled())
+		{
+			throw ExtAsyncCancelException();
+		}
+	}
+
+private:
+	CoExecutor m_executor;
+	QFuture<void> m_awaiting;
+};
+
+template <class T>
+class CoTaskPromiseBase
+{
+public:
+	CoTaskPromiseBase()
+	{
+		m_promise.start();
+	}
+
+	CoTask<T> get_return_object()
+	{
+		return CoTask<T>(m_promise.future());
+	}
+
+	/// Runs on the caller's thread up to the first co_await.
+	std::suspend_never initial_suspend() noexcept { return {}; }
+	/// The frame is destroyed as soon as the body finishes, the future is what's left.
+	std::suspend_never final_suspend() noexcept { return {}; }
+
+	void unhandled_exception()
+	{
+		try
+		{
+			throw;
+		}
+		catch(const ExtAsyncCancelException&)
+		{
+			m_promise.future().cancel();
+		}
+		catch(...)
+		{
+			m_promise.setException(std::current_exception());
+		}
+		m_promise.finish();
+	}
+
+	template <class U>
+	FutureAwaiter<U> await_transform(QFuture<U> future)
+	{
+		return FutureAwaiter<U>(std::move(future), awaiting(), m_executor);
+	}
+
+	template <class U>
+	FutureAwaiter<U> await_transform(CoTask<U> task)
+	{
+		return await_transform(task.future());
+	}
+
+	ExecutorAwaiter await_transform(CoExecutor executor)
+	{
+		m_executor = executor;
+		return ExecutorAwaiter(std::move(executor), awaiting());
+	}
+
+protected:
+	/// This task's future, as seen by what it's awaiting.
+	QFuture<void> awaiting()
+	{
+		return QFuture<void>(m_promise.future());
+	}
+
+	QPromise<T> m_promise;
+
+	/// Where the coroutine resumes after awaiting a future.  Changed by co_await'ing a CoExecutor.
+	CoExecutor m_executor;
+};
+
+template <class T>
+class CoTaskPromise : public CoTaskPromiseBase<T>
+{
+public:
+	void return_value(T value)
+	{
+		this->m_promise.addResult(std::move(value));
+		this->m_promise.finish();
+	}
+};
+
+template <>
+class CoTaskPromise<void> : public CoTaskPromiseBase<void>
+{
+public:
+	void return_void()
+	{
+		m_promise.finish();
+	}
+};
+
+} // namespace CoTask_detail
+
+/**
+ * The return type of a coroutine which co_awaits ExtFutures, so a multi-stage async flow can be written as one
+ * function instead of a chain of .then()s.
+ *
+ * - The coroutine starts running immediately, on the caller's thread.
+ * - co_await'ing a QFuture<U> (or another CoTask<U>) suspends without holding a thread, and evaluates to the future's
+ *   first result.  An exception the future finished with is rethrown.
+ * - co_await'ing a CoExecutor, e.g. CoExecutor::guiThread(), moves the coroutine over to it.  Awaited futures then
+ *   resume it there too.  It starts out on AMLMExecutor::cpu().
+ * - If the task's future is canceled, the future it's waiting on is canceled and ExtAsyncCancelException is thrown at
+ *   the suspension point.  The same if what it's waiting on is canceled.  Let it propagate, and the task's future
+ *   finishes canceled.  Any other exception finishes the future with that exception.
+ *
+ * A CoTask<T> is just a handle to the coroutine's future, copying or dropping it doesn't affect the coroutine.
+ * Use CoTask<Unit> for anything an AMLMJobT will wrap.
+ *
+ * @code
+ *     CoTask<int> count_files(QUrl dir)
+ *     {
+ *         co_await CoExecutor::io();
+ *         QVector<QUrl> files = co_await list_dir_future(dir);
+ *         co_await CoExecutor::guiThread();
+ *         update_the_model(files);
+ *         co_return files.size();
+ *     }
+ * @endcode
+ */
+template <class T>
+class CoTask
+{
+public:
+	using promise_type = CoTask_detail::CoTaskPromise<T>;
+
+	explicit CoTask(QFuture<T> future) : m_future(std::move(future)) {}
+
+	/// The future which finishes when the coroutine does.
+	QFuture<T> future() const { return m_future; }
+	operator QFuture<T>() const { return m_future; }
+
+	/// Cancel the coroutine at its next suspension point.
+	void cancel() { m_future.cancel(); }
+
+private:
+	QFuture<T> m_future;
+};
+
+#endif /* SRC_CONCURRENCY_COTASK_H_ */
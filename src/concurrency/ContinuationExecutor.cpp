@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ContinuationExecutor.cpp
+ * Implementation of ContinuationExecutor, SerialExecutor and CoExecutor.
+ */
+
+#include "ContinuationExecutor.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QThread>
+
+// Ours
+#include <utils/DebugHelpers.h>
+
+
+namespace
+{
+	struct DispatchThread
+	{
+		DispatchThread()
+		{
+			m_thread.setObjectName("ExtFutureDispatch");
+			m_context = new QObject();
+			m_context->moveToThread(&m_thread);
+			m_thread.start();
+		}
+
+		~DispatchThread()
+		{
+			m_thread.quit();
+			m_thread.wait();
+			// The thread's gone, so nothing else can be touching it.
+			delete m_context;
+		}
+
+		QThread m_thread;
+		QObject* m_context {nullptr};
+	};
+
+	DispatchThread& dispatch_thread()
+	{
+		static DispatchThread the_dispatch_thread;
+		return the_dispatch_thread;
+	}
+}
+
+QObject* ContinuationExecutor::dispatchContext()
+{
+	return dispatch_thread().m_context;
+}
+
+void ContinuationExecutor::runInDispatchThread(std::function<void()> func)
+{
+	QMetaObject::invokeMethod(dispatchContext(), std::move(func), Qt::QueuedConnection);
+}
+
+/////
+
+SerialExecutor::SerialExecutor(AMLMExecutor& executor) : m_executor(executor)
+{
+}
+
+void SerialExecutor::post(std::function<void()> task)
+{
+	bool start_draining = false;
+	{
+		std::scoped_lock lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+		if(!m_draining)
+		{
+			m_draining = true;
+			start_draining = true;
+		}
+	}
+
+	if(start_draining)
+	{
+		m_executor.start([self = shared_from_this()](){ self->drain(); });
+	}
+}
+
+void SerialExecutor::drain()
+{
+	while(true)
+	{
+		std::function<void()> task;
+		{
+			std::scoped_lock lock(m_mutex);
+			if(m_tasks.empty())
+			{
+				// Give the thread back, the next post() will start another drain.
+				m_draining = false;
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
+
+/////
+
+CoExecutor CoExecutor::on(AMLMExecutor& executor)
+{
+	CoExecutor retval;
+	retval.m_executor = &executor;
+	return retval;
+}
+
+CoExecutor CoExecutor::guiThread()
+{
+	return context(QCoreApplication::instance());
+}
+
+CoExecutor CoExecutor::context(QObject* context)
+{
+	Q_CHECK_PTR(context);
+	CoExecutor retval;
+	retval.m_executor = nullptr;
+	retval.m_context = context;
+	return retval;
+}
+
+void CoExecutor::post(std::function<void()> task) const
+{
+	if(m_executor != nullptr)
+	{
+		m_executor->start(std::move(task));
+		return;
+	}
+
+	QObject* context = m_context.data();
+	if(context == nullptr)
+	{
+		qWr() << "CoExecutor's context is gone, dropping task";
+		return;
+	}
+	QMetaObject::invokeMethod(context, std::move(task), Qt::QueuedConnection);
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_CONCURRENCY_CONTINUATIONEXECUTOR_H_
+#define SRC_CONCURRENCY_CONTINUATIONEXECUTOR_H_
+
+/**
+ * @file ContinuationExecutor.h
+ * Interface of ContinuationExecutor, SerialExecutor and CoExecutor, which run ExtFuture continuations and coroutines
+ * when their upstream futures become ready instead of having a thread wait on them.
+ */
+
+// Std C++
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// Qt
+#include <QObject>
+#include <QPointer>
+
+// Ours
+#include <future/guideline_helpers.h>
+#include "AMLMExecutor.h"
+
+
+/**
+ * The one thread which watches the futures continuations are waiting on.
+ *
+ * The QFutureWatchers behind streaming_then() etc. live here, so their signals arrive as events on this thread's
+ * event loop.  It doesn't run the continuations themselves, it hands them off to an executor, so it's never blocked
+ * and one thread covers every pipeline no matter how many stages deep.
+ *
+ * All static, threadsafe.
+ */
+class ContinuationExecutor
+{
+public:
+	/// The QObject in the dispatch thread to parent watchers to and use as the context of their connections.
+	static QObject* dispatchContext();
+
+	/// Run @a func in the dispatch thread, from its event loop.  Keep it short, no waiting.
+	static void runInDispatchThread(std::function<void()> func);
+};
+
+/**
+ * Runs tasks one at a time, in the order they're posted, on an AMLMExecutor.
+ *
+ * Only takes a pool thread while there's something queued, so a continuation waiting on its upstream costs nothing.
+ * Always held by std::shared_ptr.  post() is threadsafe.
+ */
+class SerialExecutor : public std::enable_shared_from_this<SerialExecutor>
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(SerialExecutor)
+
+	explicit SerialExecutor(AMLMExecutor& executor = AMLMExecutor::cpu());
+	~SerialExecutor() = default;
+
+	/// Queue @a task to run after everything posted before it.  @a task shouldn't throw.
+	void post(std::function<void()> task);
+
+private:
+	void drain();
+
+	AMLMExecutor& m_executor;
+
+	std::mutex m_mutex;
+	std::deque<std::function<void()>> m_tasks;
+	/// True while a pool thread is draining m_tasks.
+	bool m_draining {false};
+};
+
+/**
+ * Where a coroutine resumes after a co_await: an AMLMExecutor, or the thread of a QObject, e.g. the GUI thread.
+ * Cheap to copy, post() is threadsafe.
+ */
+class CoExecutor
+{
+public:
+	/// AMLMExecutor::cpu().
+	CoExecutor() = default;
+
+	/// Resume on @a executor.
+	static CoExecutor on(AMLMExecutor& executor);
+	/// @name Shorthands for on() the AMLMExecutors.
+	/// @{
+	static CoExecutor io() { return on(AMLMExecutor::io()); }
+	static CoExecutor cpu() { return on(AMLMExecutor::cpu()); }
+	static CoExecutor interactive() { return on(AMLMExecutor::interactive()); }
+	/// @}
+	/// Resume in the GUI thread, from its event loop.
+	static CoExecutor guiThread();
+	/// Resume in @a context's thread, from its event loop.  If @a context is destroyed first, the task is dropped.
+	static CoExecutor context(QObject* context);
+
+	/// Run @a task on this executor.
+	void post(std::function<void()> task) const;
+
+private:
+	AMLMExecutor* m_executor {&AMLMExecutor::cpu()};
+	/// Only used if m_executor is null.
+	QPointer<QObject> m_context;
+};
+
+#endif /* SRC_CONCURRENCY_CONTINUATIONEXECUTOR_H_ */
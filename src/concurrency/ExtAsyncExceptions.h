@@ -0,0 +1,42 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_CONCURRENCY_EXTASYNCEXCEPTIONS_H_
+#define SRC_CONCURRENCY_EXTASYNCEXCEPTIONS_H_
+
+/**
+ * @file ExtAsyncExceptions.h
+ * Exceptions thrown by the async machinery itself.
+ */
+
+// Qt
+#include <QException>
+
+/**
+ * Thrown at a coroutine's suspension point when it or what it was waiting on was canceled.
+ * Let it propagate, the coroutine's future then finishes canceled.
+ */
+class ExtAsyncCancelException : public QException
+{
+public:
+	void raise() const override { throw *this; }
+	ExtAsyncCancelException *clone() const override { return new ExtAsyncCancelException(*this); }
+};
+
+#endif /* SRC_CONCURRENCY_EXTASYNCEXCEPTIONS_H_ */
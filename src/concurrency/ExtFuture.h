@@ -29,6 +29,7 @@
 // Std C++
 #include <memory>
 #include <atomic>
+#include <exception>
 #include <type_traits>
 #include <functional>
 
@@ -42,7 +43,9 @@
 #include <QtConcurrentRun>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QPromise>
 #include <QThread>
+#include <QThreadPool>
 #include <QPair>
 #include <QStringList> // For template shenanigans.
 
@@ -55,6 +58,7 @@
 #include <utils/StringHelpers.h>
 #include <utils/DebugHelpers.h>
 #include <utils/UniqueIDMixin.h>
+#include "ContinuationExecutor.h"
 
 #if 0 // if !QT6
 
@@ -1576,45 +1580,99 @@ QString state_str(const ExtFuture<T>& future)
 }
 
 /**
- * Works much like .then(), but uses a QFutureWatcher to call @a function when resultsReadyAt() fires.
+ * Works much like .then(), but calls @a function with each batch of results as they become ready.
+ *
+ * Nothing waits on @a future.  A QFutureWatcher in the ContinuationExecutor's dispatch thread picks up its
+ * resultsReadyAt() and finished() signals, and hands the calls to @a function to a SerialExecutor on @a executor, so they
+ * run one at a time, in order, and only take a pool thread while there's something to do.
+ *
+ * - If @a function throws, @a future is canceled and the returned future finishes with the exception.
+ * - An exception or cancellation of @a future is passed on to the returned future.
+ * - Canceling the returned future cancels @a future.
  *
  * @tparam T
  * @tparam Function
  * @param future
- * @param function    The function to be called when QFutureWatcher fires a resultsReadyAt() signal.
- * @return  A copy of the passed-in @a future.
+ * @param function    Called as function(future, begin, end) for each range [begin, end) of ready results.
+ * @param executor    Where @a function is run.
+ * @return  A future which finishes after the last call to @a function.
  */
 template <typename T, typename Function,
 	REQUIRES(std::is_invocable_r_v<void, Function, QFuture<T>, int, int>)>
-auto streaming_then(QFuture<T> future, Function function)
+QFuture<void> streaming_then(QFuture<T> future, Function function, AMLMExecutor& executor = AMLMExecutor::cpu())
 {
-    auto ret_future = QtConcurrent::run(QThreadPool::globalInstance(), [function](QFuture<T> future)
+	struct State
 	{
-		qDebug() << "HERE 1, future: " << future;
-
-		QFutureWatcher<T>* watcher = new QFutureWatcher<T>();
-    	QEventLoop loop;
-		connect_or_die(watcher, &QFutureWatcher<T>::resultsReadyAt, watcher,
-						[future, function](int begin, int end)
-						{
-							qDebug() << "IN LAMBDA, future: " << future;
-							function(future, begin, end);
-						}, Qt::DirectConnection);
-		connect_or_die(watcher, &QFutureWatcher<T>::finished, watcher, [watcher, &loop]()
-		{
-            qDebug() << "WATCHER FINISHED, DELETELATER";
-			watcher->deleteLater();
-			loop.quit();
+		QPromise<void> m_promise;
+		/// Only touched from the SerialExecutor.
+		std::exception_ptr m_exception;
+	};
+	auto state = std::make_shared<State>();
+	auto serial_executor = std::make_shared<SerialExecutor>(executor);
+
+	QFuture<void> ret_future = state->m_promise.future();
+	state->m_promise.start();
+
+	ContinuationExecutor::runInDispatchThread([=]() mutable {
+		QObject* context = ContinuationExecutor::dispatchContext();
+		auto* up_watcher = new QFutureWatcher<T>(context);
+		auto* down_watcher = new QFutureWatcher<void>(context);
+
+		connect_or_die(up_watcher, &QFutureWatcher<T>::resultsReadyAt, context, [=](int begin, int end){
+			serial_executor->post([=]() mutable {
+				if(state->m_exception || ret_future.isCanceled())
+				{
+					return;
+				}
+				try
+				{
+					function(future, begin, end);
+				}
+				catch(...)
+				{
+					state->m_exception = std::current_exception();
+					future.cancel();
+				}
+			});
+		});
+		connect_or_die(up_watcher, &QFutureWatcher<T>::finished, context, [=]() mutable {
+			// finished() comes after the last resultsReadyAt(), so this runs after the last call to function.
+			serial_executor->post([=]() mutable {
+				if(!state->m_exception)
+				{
+					try
+					{
+						// Already finished, this just rethrows any exception it finished with.
+						future.waitForFinished();
+					}
+					catch(...)
+					{
+						state->m_exception = std::current_exception();
+					}
+				}
+
+				if(state->m_exception)
+				{
+					state->m_promise.setException(state->m_exception);
+				}
+				else if(future.isCanceled())
+				{
+					ret_future.cancel();
+				}
+				state->m_promise.finish();
+			});
+			up_watcher->deleteLater();
+			down_watcher->deleteLater();
+		});
+		// Cancellation flows back upstream.
+		connect_or_die(down_watcher, &QFutureWatcher<void>::canceled, context, [=]() mutable {
+			future.cancel();
 		});
 
-		watcher->setFuture(future);
-        // qDb() << "AFTER SETFUTURE, future: " << future;
-    	loop.exec();
-		future.waitForFinished();
-        // qDb() << "WAIT FOR FINISHED COMPLETE" << future;
-	}, future);
+		down_watcher->setFuture(ret_future);
+		up_watcher->setFuture(future);
+	});
 
-    // qDebug() << "RETURNING FUTURE" << ret_future;
 	return ret_future;
 }
 
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ProgressCounter.cpp
+ * Implementation of ProgressCounter.
+ */
+
+#include "ProgressCounter.h"
+
+
+ProgressCounter::ProgressCounter(QString item_format) : m_item_format(std::move(item_format))
+{
+}
+
+void ProgressCounter::setCurrentItem(QString item)
+{
+	m_current_item.store(std::make_shared<const QString>(std::move(item)), std::memory_order_release);
+	m_item_wanted.store(false, std::memory_order_relaxed);
+}
+
+ProgressCounter::Sample ProgressCounter::sample()
+{
+	Sample retval;
+	retval.m_processed = m_processed.load(std::memory_order_relaxed);
+	retval.m_total = m_total.load(std::memory_order_relaxed);
+
+	std::shared_ptr<const QString> item = m_current_item.exchange(nullptr, std::memory_order_acquire);
+	if(item)
+	{
+		retval.m_current_item = m_item_format.arg(*item);
+	}
+
+	m_item_wanted.store(true, std::memory_order_relaxed);
+	return retval;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_CONCURRENCY_PROGRESSCOUNTER_H_
+#define SRC_CONCURRENCY_PROGRESSCOUNTER_H_
+
+/**
+ * @file ProgressCounter.h
+ * Interface of ProgressCounter, lock-free progress reporting from a worker, sampled by the GUI.
+ */
+
+// Std C++
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Qt
+#include <QString>
+
+// Ours
+#include <future/guideline_helpers.h>
+
+
+/**
+ * A job's progress, written by its worker and read by whoever's displaying it.
+ *
+ * QPromise::setProgressValueAndText() etc. take the future's mutex and post an event every time they're called, and
+ * a dir scan calls them for every file.  This is just atomics: the worker bumps the counts as it goes, and the GUI
+ * sample()s them on a timer at display refresh rate, however fast the worker is.
+ *
+ * The "current item", e.g. the file being scanned, is only handed over when the sampler's asked for one since the
+ * last time, so the worker formats and copies at most one per sample:
+ * @code
+ *     progress->addProcessed();
+ *     progress->updateCurrentItem([&](){ return file_path; });
+ * @endcode
+ *
+ * Always held by std::shared_ptr, it's shared between the worker and the job.  All members are threadsafe.
+ */
+class ProgressCounter
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(ProgressCounter)
+
+	/**
+	 * @param item_format  What the current item is shown as, with %1 for the item, e.g. tr("File: %1").
+	 */
+	explicit ProgressCounter(QString item_format = QStringLiteral("%1"));
+	~ProgressCounter() = default;
+
+	/// @name Worker side.
+	/// @{
+
+	void setTotal(std::int64_t total) { m_total.store(total, std::memory_order_relaxed); }
+	void addTotal(std::int64_t amount = 1) { m_total.fetch_add(amount, std::memory_order_relaxed); }
+	void setProcessed(std::int64_t processed) { m_processed.store(processed, std::memory_order_relaxed); }
+	void addProcessed(std::int64_t amount = 1) { m_processed.fetch_add(amount, std::memory_order_relaxed); }
+	std::int64_t processed() const { return m_processed.load(std::memory_order_relaxed); }
+
+	/// True if the sampler wants a new current item.  One relaxed load.
+	bool currentItemWanted() const { return m_item_wanted.load(std::memory_order_relaxed); }
+
+	/// Hand over a new current item, unformatted.
+	void setCurrentItem(QString item);
+
+	/// Calls @a make_item and hands its result over only if currentItemWanted().
+	template <class MakeItemFunc>
+	void updateCurrentItem(MakeItemFunc make_item)
+	{
+		if(currentItemWanted())
+		{
+			setCurrentItem(make_item());
+		}
+	}
+
+	/// @}
+
+	/// What sample() returns.
+	struct Sample
+	{
+		std::int64_t m_processed {0};
+		std::int64_t m_total {0};
+		/// Formatted, empty if there hasn't been a new item since the last sample().
+		QString m_current_item;
+	};
+
+	/// @name Display side.
+	/// @{
+
+	/// Read the counts, take the current item, and ask the worker for the next one.
+	Sample sample();
+
+	/// @}
+
+private:
+	const QString m_item_format;
+
+	std::atomic<std::int64_t> m_processed {0};
+	std::atomic<std::int64_t> m_total {0};
+
+	/// Set by sample(), cleared by setCurrentItem().  Starts out set so the first item comes through.
+	std::atomic_bool m_item_wanted {true};
+	std::atomic<std::shared_ptr<const QString>> m_current_item;
+};
+
+#endif /* SRC_CONCURRENCY_PROGRESSCOUNTER_H_ */
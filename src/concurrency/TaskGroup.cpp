@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file TaskGroup.cpp
+ * Implementation of TaskGroup.
+ */
+
+#include "TaskGroup.h"
+
+// Qt
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QPointer>
+
+// Ours
+#include <AMLMApp.h>
+#include <gui/MainWindow.h>
+#include <gui/activityprogressmanager/ActivityProgressStatusBarTracker.h>
+#include <utils/DebugHelpers.h>
+#include "AMLMJobT.h"
+
+
+namespace TaskGroup_detail
+{
+
+State::State(QByteArray name) : m_name(std::move(name)), m_progress(std::make_shared<ProgressCounter>())
+{
+}
+
+TaskToken State::taskSubmitted()
+{
+	// Counted in before it's added to the total, so the batch it's added to has been started.
+	if(m_num_outstanding.fetch_add(1, std::memory_order_acq_rel) == 0)
+	{
+		startBatch();
+	}
+	m_progress->addTotal();
+
+	return TaskToken(shared_from_this(), cancelGeneration());
+}
+
+void State::taskFinished()
+{
+	m_progress->addProcessed();
+	if(m_num_outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		finishBatch();
+	}
+}
+
+void State::startBatch()
+{
+	QMutexLocker locker(&m_batch_mutex);
+
+	if(m_batch)
+	{
+		// The last batch's last task hasn't gotten to finishBatch() yet, and when it does it'll see this task and
+		// leave the batch open.
+		return;
+	}
+
+	// Take the last batch's tasks out of the counts.  They've all finished, but tasks of this batch which were
+	// submitted after us may already have been counted in, so subtract rather than zero, which keeps the number
+	// still to go right.
+	const std::int64_t last_batch_processed = m_progress->processed();
+	m_progress->addProcessed(-last_batch_processed);
+	m_progress->addTotal(-last_batch_processed);
+
+	m_batch.emplace();
+	m_batch->start();
+	startBatchJob(m_batch->future());
+}
+
+void State::finishBatch()
+{
+	QMutexLocker locker(&m_batch_mutex);
+
+	if(!m_batch || m_num_outstanding.load(std::memory_order_acquire) != 0)
+	{
+		// Another task was submitted in the meantime, it's still the same batch.
+		return;
+	}
+
+	m_batch->finish();
+	m_batch.reset();
+}
+
+void State::startBatchJob(QFuture<Unit> batch_future)
+{
+	std::weak_ptr<State> weak_this = weak_from_this();
+
+	QMetaObject::invokeMethod(AMLMApp::instance(), [weak_this, batch_future](){
+		auto self = weak_this.lock();
+		if(!self || batch_future.isFinished() || MainWindow::instance().isNull())
+		{
+			// Gone, all done before we got here, or there's no GUI to show it in, e.g. in the benchmarks.
+			return;
+		}
+
+		QPointer<AMLMJobT<ExtFuture<Unit>>> job = make_async_AMLMJobT(batch_future, self->m_name.constData(), AMLMApp::instance());
+		job->setProgressCounter(self->m_progress);
+
+		// Killing the job cancels the tasks in it.
+		connect_or_die(job, &KJob::finished, AMLMApp::instance(), [weak_this](KJob* kjob){
+			if(kjob->error() == KJob::KilledJobError)
+			{
+				if(auto state = weak_this.lock())
+				{
+					state->cancel();
+				}
+			}
+		});
+
+		MainWindow::master_tracker_instance()->registerJob(job);
+	}, Qt::QueuedConnection);
+}
+
+} // namespace TaskGroup_detail
+
+TaskGroup::TaskGroup(const char* name, AMLMExecutor& executor)
+	: m_state(std::make_shared<TaskGroup_detail::State>(QByteArray(name))), m_executor(executor)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+	m_state->cancel();
+}
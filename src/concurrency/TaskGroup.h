@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_CONCURRENCY_TASKGROUP_H_
+#define SRC_CONCURRENCY_TASKGROUP_H_
+
+/**
+ * @file TaskGroup.h
+ * Interface of TaskGroup, lightweight tasks shown in the UI as one aggregate AMLMJob.
+ */
+
+// Std C++
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Qt
+#include <QByteArray>
+#include <QMutex>
+#include <QPromise>
+
+// Ours
+#include <future/guideline_helpers.h>
+#include "AMLMExecutor.h"
+#include "ExtFuture.h"
+#include "ProgressCounter.h"
+
+class TaskToken;
+
+namespace TaskGroup_detail
+{
+
+/**
+ * What a TaskGroup's tasks share with it, and outlive it by.
+ */
+class State : public std::enable_shared_from_this<State>
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(State)
+
+	explicit State(QByteArray name);
+	~State() = default;
+
+	/// Counts a task in.  Starts a new batch, and with it a new aggregate job, if there wasn't one outstanding.
+	TaskToken taskSubmitted();
+	/// Counts a task out.  Finishes the batch if it was the last one.
+	void taskFinished();
+
+	/// Cancels every task submitted so far.
+	void cancel() { m_cancel_generation.fetch_add(1, std::memory_order_relaxed); }
+
+	std::uint64_t cancelGeneration() const { return m_cancel_generation.load(std::memory_order_relaxed); }
+
+	const std::shared_ptr<ProgressCounter>& progress() const { return m_progress; }
+
+private:
+	void startBatch();
+	void finishBatch();
+
+	/// Registers an aggregate job for @a batch_future with the tracker, in the GUI thread.
+	void startBatchJob(QFuture<Unit> batch_future);
+
+	const QByteArray m_name;
+	const std::shared_ptr<ProgressCounter> m_progress;
+
+	std::atomic<std::uint64_t> m_cancel_generation {0};
+	std::atomic<std::int64_t> m_num_outstanding {0};
+
+	/// Only taken when the number outstanding goes from or to zero.
+	QMutex m_batch_mutex;
+	std::optional<QPromise<Unit>> m_batch;
+};
+
+} // namespace TaskGroup_detail
+
+/**
+ * What a TaskGroup task checks to see if it's been canceled.  Copyable, threadsafe.
+ */
+class TaskToken
+{
+public:
+	TaskToken() = default;
+
+	/// True if the group, or its aggregate job, has been canceled since the task was submitted.
+	bool isCanceled() const
+	{
+		return m_state && m_state->cancelGeneration() != m_cancel_generation;
+	}
+
+private:
+	friend class TaskGroup_detail::State;
+	friend class TaskGroup;
+
+	TaskToken(std::shared_ptr<TaskGroup_detail::State> state, std::uint64_t cancel_generation)
+		: m_state(std::move(state)), m_cancel_generation(cancel_generation) {}
+
+	std::shared_ptr<TaskGroup_detail::State> m_state;
+	std::uint64_t m_cancel_generation {0};
+};
+
+/**
+ * Runs many small tasks of the same kind, e.g. loading the cover art or metadata for one row, without an AMLMJob each.
+ *
+ * A make_async_AMLMJobT() per item is a QObject, a watcher, a speed timer and a tracker registration, i.e. a few
+ * allocations and a stream of queued signals for a task which may only take a few hundred microseconds.  A task run
+ * here is just the executor's QRunnable and the future: the group's bookkeeping is a few atomics per task.
+ *
+ * For the UI, the tasks are batched: when the first one's submitted, one aggregate AMLMJob is registered with the
+ * tracker, reporting "n of m" through a ProgressCounter, and it finishes when the last outstanding one does.  Killing
+ * it cancels the group.
+ *
+ * Canceling the group cancels everything submitted before it.  Tasks which haven't started yet are skipped, and
+ * their futures finish canceled.  A running task can pass its token() along and check it.  Tasks submitted after
+ * the cancel run normally.
+ *
+ * All members are threadsafe.
+ */
+class TaskGroup
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(TaskGroup)
+
+	/**
+	 * @param name  The aggregate job's name.
+	 * @param executor  What the tasks run on.
+	 */
+	explicit TaskGroup(const char* name, AMLMExecutor& executor);
+	/// Cancels the tasks, but doesn't wait for them.
+	~TaskGroup();
+
+	/**
+	 * Like AMLMExecutor::run(), but counted in this group.  @a function must take a QPromise<T>& first.
+	 * @returns The QFuture<T> of @a function's promise.
+	 */
+	template <class Function, class... Args>
+	auto run(Function&& function, Args&&... args)
+	{
+		using FunctionType = std::decay_t<Function>;
+		using traits = AMLMExecutor_detail::promise_function_traits<FunctionType>;
+		static_assert(traits::value, "TaskGroup tasks take a QPromise<T>& as their first parameter");
+		using T = typename traits::result_type;
+
+		return m_executor.run(
+				[token = m_state->taskSubmitted(), function = FunctionType(std::forward<Function>(function)),
+				 ...args = std::forward<Args>(args)](QPromise<T>& promise) mutable {
+					FinishedScope finished(*token.m_state);
+					if(token.isCanceled())
+					{
+						promise.future().cancel();
+						return;
+					}
+					std::invoke(function, promise, std::move(args)...);
+				});
+	}
+
+	/// Cancel every task submitted so far.
+	void cancel() { m_state->cancel(); }
+
+	/// A token canceled by the next cancel(), for a running task to check.
+	TaskToken token() const { return TaskToken(m_state, m_state->cancelGeneration()); }
+
+private:
+	/// Counts a task out however it ends.
+	struct FinishedScope
+	{
+		explicit FinishedScope(TaskGroup_detail::State& state) : m_state(state) {}
+		~FinishedScope() { m_state.taskFinished(); }
+		TaskGroup_detail::State& m_state;
+	};
+
+	std::shared_ptr<TaskGroup_detail::State> m_state;
+	AMLMExecutor& m_executor;
+};
+
+#endif /* SRC_CONCURRENCY_TASKGROUP_H_ */
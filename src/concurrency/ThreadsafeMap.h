@@ -1,5 +1,5 @@
 /*
- * Copyright 2018 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ * Copyright 2018, 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
  *
  * This file is part of AwesomeMediaLibraryManager.
  *
@@ -20,86 +20,188 @@
 #ifndef SRC_CONCURRENCY_THREADSAFEMAP_H_
 #define SRC_CONCURRENCY_THREADSAFEMAP_H_
 
+// Std C++
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+// Qt
+#include <QList>
 #include <QMap>
-#include <QMutex>
-#include <QMutexLocker>
+#include <QPointer>
+#include <QReadWriteLock>
+#include <QSharedPointer>
 
 
-/*
+namespace ThreadsafeMap_detail
+{
+	/**
+	 * Keys which go null on their own when what they point to is destroyed.  They'd hash to a different shard and sort
+	 * differently afterwards, so the entry could never be found, or removed, again.
+	 */
+	template <typename Key> struct is_self_nulling : std::false_type {};
+	template <typename T> struct is_self_nulling<QPointer<T>> : std::true_type {};
+	template <typename T> struct is_self_nulling<QWeakPointer<T>> : std::true_type {};
+	template <typename T> struct is_self_nulling<std::weak_ptr<T>> : std::true_type {};
+
+	/// Which shard @a key goes in.  Keys with a std::hash<> use it, QSharedPointer<>s etc. hash what they point to.
+	template <typename Key>
+	std::size_t shard_hash(const Key& key)
+	{
+		std::uint64_t h;
+		if constexpr(requires { std::hash<Key>{}(key); })
+		{
+			h = std::hash<Key>{}(key);
+		}
+		else if constexpr(requires { key.data(); })
+		{
+			h = std::hash<const void*>{}(static_cast<const void*>(key.data()));
+		}
+		else
+		{
+			h = qHash(key);
+		}
+		// Pointers and sequential IDs have all their entropy in the wrong bits, mix it down.
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		return static_cast<std::size_t>(h);
+	}
+}
+
+/**
+ * A map which can be used from any number of threads at once.
  *
+ * The entries are spread over NumShards QMaps by a hash of the key, each with its own QReadWriteLock, so threads
+ * working on different keys mostly don't contend, and lookups of the same shard don't block each other.
+ *
+ * Iteration is over a snapshot: each shard's QMap is copied under its lock, which is just a reference count since
+ * QMap is implicitly shared, and then iterated with no locks held.  Writers aren't blocked by it, and only pay for a
+ * deep copy of a shard if they write to it while the snapshot is still alive.  The upshot is that the lambda passed
+ * to for_each_key_value_pair() can call back into the map.
+ *
+ * Unlike QMap, keys() etc. aren't in key order across shards.
  */
-template <typename Key, typename Value>
+template <typename Key, typename Value, int NumShards = 16>
 class ThreadsafeMap
 {
     using T = Value;
-    using ActiveActivitiesMap = QMap<Key, T>;
+    using ShardMap = QMap<Key, T>;
+
+	static_assert(!ThreadsafeMap_detail::is_self_nulling<Key>::value,
+				  "A key's hash mustn't change while it's in the map, key by the raw pointer instead.");
 
 public:
-    ThreadsafeMap() : m_map_mutex() {}
+    ThreadsafeMap() = default;
 
     const T value(const Key &key, const T &defaultValue = T()) const
     {
-        QMutexLocker locker(&m_map_mutex);
-        return m_kjob_to_widget_map.value(key, defaultValue);
+		const Shard& shard = shard_for(key);
+		QReadLocker locker(&shard.m_lock);
+		return shard.m_map.value(key, defaultValue);
     }
 
     void insert(const Key &key, const T &value)
     {
-        QMutexLocker locker(&m_map_mutex);
-        m_kjob_to_widget_map.insert(key, value);
+		Shard& shard = shard_for(key);
+		QWriteLocker locker(&shard.m_lock);
+		const auto size_before = shard.m_map.size();
+		shard.m_map.insert(key, value);
+		m_size.fetch_add(shard.m_map.size() - size_before, std::memory_order_relaxed);
     }
 
     /// Remove key from the map.
     int remove(const Key &key)
     {
-        QMutexLocker locker(&m_map_mutex);
-        return m_kjob_to_widget_map.remove(key);
+		Shard& shard = shard_for(key);
+		QWriteLocker locker(&shard.m_lock);
+		const int num_removed = shard.m_map.remove(key);
+		m_size.fetch_sub(num_removed, std::memory_order_relaxed);
+		return num_removed;
     }
 
     QList<Key> keys() const
     {
         QList<Key> retval;
+		retval.reserve(size());
 
-        QMutexLocker locker(&m_map_mutex);
-
-        retval = m_kjob_to_widget_map.keys();
+		for(const ShardMap& shard_map : snapshot())
+		{
+			retval.append(shard_map.keys());
+		}
 
         return retval;
     }
 
     int size() const
     {
-        QMutexLocker locker(&m_map_mutex);
-        return m_kjob_to_widget_map.size();
+		return m_size.load(std::memory_order_relaxed);
     }
 
-
 	bool contains(const Key& key) const
 	{
-		QMutexLocker locker(&m_map_mutex);
-		return m_kjob_to_widget_map.contains(key);
+		const Shard& shard = shard_for(key);
+		QReadLocker locker(&shard.m_lock);
+		return shard.m_map.contains(key);
 	}
 
+	/**
+	 * Call @a the_lambda with each key and value in a snapshot of the map.  Entries inserted or removed by other
+	 * threads during the iteration may or may not be seen.
+	 */
     template<typename Lambda>
     void for_each_key_value_pair(Lambda the_lambda) const
     {
-        QMutexLocker locker(&m_map_mutex);
-        for(typename ActiveActivitiesMap::const_iterator i = m_kjob_to_widget_map.cbegin();
-            i != m_kjob_to_widget_map.cend(); ++i)
-        {
-            the_lambda(i.key(), i.value());
-        }
+		for(const ShardMap& shard_map : snapshot())
+		{
+			for(auto i = shard_map.cbegin(); i != shard_map.cend(); ++i)
+			{
+				the_lambda(i.key(), i.value());
+			}
+		}
     }
 
-    /// Public types
-    using const_iterator = typename ActiveActivitiesMap::const_iterator;
+	/// What snapshot() returns, the shards' QMaps.
+	using Snapshot = std::array<ShardMap, NumShards>;
+
+	/// A copy of the map, O(NumShards).
+	Snapshot snapshot() const
+	{
+		Snapshot retval;
+		for(int i = 0; i < NumShards; ++i)
+		{
+			QReadLocker locker(&m_shards[i].m_lock);
+			retval[i] = m_shards[i].m_map;
+		}
+		return retval;
+	}
 
 private:
 
-    /// Mutex for protecting the map.
-    mutable QMutex m_map_mutex;
+	/// One per cache line, so the locks of different shards don't false-share.
+	struct alignas(64) Shard
+	{
+		mutable QReadWriteLock m_lock;
+		ShardMap m_map;
+	};
+
+	Shard& shard_for(const Key& key)
+	{
+		return m_shards[ThreadsafeMap_detail::shard_hash(key) % NumShards];
+	}
+	const Shard& shard_for(const Key& key) const
+	{
+		return m_shards[ThreadsafeMap_detail::shard_hash(key) % NumShards];
+	}
+
+	std::array<Shard, NumShards> m_shards;
 
-    ActiveActivitiesMap m_kjob_to_widget_map;
+	/// Kept separately so size() doesn't have to lock every shard.
+	std::atomic<int> m_size {0};
 };
 
 #endif /* SRC_CONCURRENCY_THREADSAFEMAP_H_ */
@@ -0,0 +1,861 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file AsyncRuntimeBenchmarks.cpp
+ * Benchmarks of the async runtime: continuations, streaming_then(), AMLMJobT, cancellation, pipelines and
+ * ThreadsafeMap, and of the tree models the scans build and the serialization they're saved with.
+ *
+ * QTest benchmarks, so the results come out in any of QTest's formats, e.g. for comparing before and after a change
+ * to the concurrency layer:
+ * @code
+ * bench_asyncruntime -o bench_asyncruntime.csv,csv -o -,txt
+ * @endcode
+ * Latencies are reported as the median in WalltimeNanoseconds, with the p99 and max logged.  Thread counts are
+ * reported as Events.
+ */
+
+// Std C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Qt
+#include <QFile>
+#include <QFuture>
+#include <QPromise>
+#include <QSignalSpy>
+#include <QThread>
+#include <QTimeZone>
+#include <QtTest>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+// Ours
+#include <AMLMApp.h>
+#include <utils/RegisterQtMetatypes.h>
+#include "../AMLMExecutor.h"
+#include "../AMLMJobT.h"
+#include "../BoundedChannel.h"
+#include "../CancellationToken.h"
+#include "../ExtFuture.h"
+#include "../TaskGroup.h"
+#include "../ThreadsafeMap.h"
+#include <logic/models/ScanResultsTreeModel.h>
+#include <logic/models/ScanResultsTreeModelItem.h>
+#include <logic/models/SRTMItemLibEntry.h>
+#include <logic/ExtUrl.h>
+#include <logic/serialization/XmlSerializer.h>
+#include <logic/serialization/XmlStreamReadVisitor.h>
+#include <logic/serialization/XmlStreamVisitor.h>
+
+
+namespace
+{
+	/// Samples per latency measurement.
+	constexpr int c_num_latency_samples = 1000;
+	/// Results per streaming_then() throughput iteration.
+	constexpr int c_num_streamed_results = 64 * 1024;
+	/// Items through each deep pipeline.  The channels hold them all, so no stage ever blocks on a full one.
+	constexpr int c_num_pipeline_items = 16 * 1024;
+	constexpr int c_timeout_ms = 10000;
+	/// Nodes in the benchmark tree, a file item and its tracks at a time.
+	constexpr int c_num_tree_nodes = 400'000;
+	constexpr int c_num_tracks_per_file = 9;
+	/// Builds per tree measurement.
+	constexpr int c_num_tree_samples = 5;
+	/// ExtUrls per serialization read.
+	constexpr int c_num_serialized_exturls = 20'000;
+	/// Tasks per per-task overhead iteration.
+	constexpr int c_num_overhead_tasks = 1000;
+	/// ThreadsafeMap operations per thread, over the thread's own range of keys.
+	constexpr int c_num_map_ops_per_thread = 200'000;
+	constexpr int c_num_map_keys_per_thread = 1024;
+
+	qint64 now_ns()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/// Wait for @a predicate without running the event loop.
+	template <class Predicate>
+	bool spin_until(Predicate predicate)
+	{
+		const qint64 deadline_ns = now_ns() + qint64(c_timeout_ms) * 1'000'000;
+		while(!predicate())
+		{
+			if(now_ns() > deadline_ns)
+			{
+				return false;
+			}
+			std::this_thread::yield();
+		}
+		return true;
+	}
+
+	qint64 percentile(std::vector<qint64> samples, double p)
+	{
+		if(samples.empty())
+		{
+			return 0;
+		}
+		auto nth = samples.begin() + static_cast<std::ptrdiff_t>(p * (samples.size() - 1));
+		std::nth_element(samples.begin(), nth, samples.end());
+		return *nth;
+	}
+
+	/// Report the median of @a samples_ns as the result, and log the rest.
+	void report_latency(const char* what, const std::vector<qint64>& samples_ns)
+	{
+		const qint64 p50 = percentile(samples_ns, 0.5);
+		qInfo() << what << "latency ns: p50:" << p50 << "p99:" << percentile(samples_ns, 0.99)
+				<< "max:" << percentile(samples_ns, 1.0) << "samples:" << samples_ns.size();
+		QTest::setBenchmarkResult(p50, QTest::WalltimeNanoseconds);
+	}
+
+	/// The value of @a key in /proc/self/status, or -1 if we can't tell on this platform.
+	qint64 proc_status_value(const QByteArray& key)
+	{
+#if defined(Q_OS_LINUX)
+		QFile status("/proc/self/status");
+		if(status.open(QIODevice::ReadOnly | QIODevice::Text))
+		{
+			while(!status.atEnd())
+			{
+				const QByteArray line = status.readLine();
+				if(line.startsWith(key))
+				{
+					// E.g. "VmRSS:	  123456 kB".
+					return line.mid(key.size()).trimmed().split(' ').front().toLongLong();
+				}
+			}
+		}
+#endif
+		return -1;
+	}
+
+	/// The number of threads in the process, or -1 if we can't tell on this platform.
+	int process_thread_count()
+	{
+		return static_cast<int>(proc_status_value("Threads:"));
+	}
+
+	/// The resident set size in bytes, or -1 if we can't tell on this platform.
+	qint64 process_rss_bytes()
+	{
+#if defined(__GLIBC__)
+		// Give back what earlier measurements freed, so it isn't reused and hidden from this one.
+		malloc_trim(0);
+#endif
+		const qint64 rss_kb = proc_status_value("VmRSS:");
+		return rss_kb < 0 ? -1 : rss_kb * 1024;
+	}
+
+	/// One build and close of a c_num_tree_nodes scan results tree.
+	struct TreeSample
+	{
+		qint64 m_build_ns {0};
+		qint64 m_rss_bytes {0};
+		qint64 m_close_ns {0};
+	};
+
+	TreeSample build_and_close_tree(bool use_arena)
+	{
+		TreeSample retval;
+
+		const qint64 rss_before = process_rss_bytes();
+		auto model = ScanResultsTreeModel::create({});
+		if(!use_arena)
+		{
+			model->disableNodeArena();
+		}
+
+		// The same shape applyCollectionStoreChanges() builds: a file item, then its tracks in one go.
+		const qint64 build_start_ns = now_ns();
+		auto root = model->getRootItem();
+		for(int file = 0; file < c_num_tree_nodes / (1 + c_num_tracks_per_file); ++file)
+		{
+			auto file_item = ScanResultsTreeModelItem::create_shared(model);
+			root->appendChild(file_item);
+
+			std::vector<std::shared_ptr<AbstractTreeModelItem>> track_items;
+			track_items.reserve(c_num_tracks_per_file);
+			for(int track = 0; track < c_num_tracks_per_file; ++track)
+			{
+				track_items.push_back(SRTMItem_LibEntry::create_shared(model));
+			}
+			file_item->appendChildren(std::move(track_items));
+		}
+		retval.m_build_ns = now_ns() - build_start_ns;
+		retval.m_rss_bytes = process_rss_bytes() - rss_before;
+
+		// Close: clear the model, then drop it and what's left of its arena.
+		const qint64 close_start_ns = now_ns();
+		root.reset();
+		model->clear(false);
+		model.reset();
+		retval.m_close_ns = now_ns() - close_start_ns;
+
+		return retval;
+	}
+
+	void add_arena_rows()
+	{
+		QTest::addColumn<bool>("use_arena");
+
+		QTest::newRow("arena") << true;
+		QTest::newRow("heap") << false;
+	}
+
+	/// The median of c_num_tree_samples builds, of whichever member @a field is.
+	qint64 median_tree_sample(bool use_arena, qint64 TreeSample::* field)
+	{
+		std::vector<qint64> samples;
+		for(int i = 0; i < c_num_tree_samples; ++i)
+		{
+			samples.push_back(build_and_close_tree(use_arena).*field);
+		}
+		return percentile(samples, 0.5);
+	}
+
+	int executor_active_thread_count()
+	{
+		return AMLMExecutor::io().pool()->activeThreadCount()
+			+ AMLMExecutor::cpu().pool()->activeThreadCount()
+			+ AMLMExecutor::interactive().pool()->activeThreadCount();
+	}
+}
+
+
+class tst_AsyncRuntimeBenchmarks : public QObject
+{
+	Q_OBJECT
+
+private Q_SLOTS:
+
+	void initTestCase();
+
+	/// From a promise's finish() to its .then() continuation starting on a pool thread.
+	void continuationDispatchLatency();
+
+	/// Build and run a .then() chain of the given depth.
+	void thenChainThroughput_data();
+	void thenChainThroughput();
+
+	/// From addResults() to streaming_then()'s function being called with them, one batch in flight at a time.
+	void streamingThenLatency_data();
+	void streamingThenLatency();
+
+	/// c_num_streamed_results through streaming_then(), in batches of the given size.
+	void streamingThenThroughput_data();
+	void streamingThenThroughput();
+
+	/// make_async_AMLMJobT() to the job's autodelete, for an already-running future which then finishes.
+	void amlmJobTCreateAndTeardown();
+
+	/// c_num_overhead_tasks trivial tasks on interactive(), e.g. per-row loads, run bare, in a TaskGroup, or each with
+	/// its own AMLMJobT.
+	void perTaskOverhead_data();
+	void perTaskOverhead();
+
+	/// From a CancellationSource::cancel() to the last of the given number of tasks seeing it at a checkpoint().
+	void cancellationTokenLatency_data();
+	void cancellationTokenLatency();
+
+	/// From canceling a streaming_then()'s future to its upstream worker seeing the cancel.
+	void futureCancelPropagationLatency();
+
+	/// Peak threads while items go through a pipeline of streaming_consume() stages of the given depth.
+	void deepPipelineThreadCount_data();
+	void deepPipelineThreadCount();
+
+	/// Wall time per ThreadsafeMap operation, mostly lookups, with the given number of threads hammering it.
+	/// The inverse of the throughput, so it should go down with more threads, not up.
+	void threadsafeMapContention_data();
+	void threadsafeMapContention();
+
+	/// @name A c_num_tree_nodes scan results tree, with its items from the model's TreeNodeArena or the heap.
+	/// @{
+	/// Building it.
+	void treeModelBuild_data();
+	void treeModelBuild();
+	/// The memory it takes, in bytes per node.
+	void treeModelMemory_data();
+	void treeModelMemory();
+	/// Clearing it and dropping the model.
+	void treeModelClose_data();
+	void treeModelClose();
+	/// @}
+
+	/// Reading c_num_serialized_exturls ExtUrls from XML, through a QVariant or reflected.
+	void extUrlXmlRead_data();
+	void extUrlXmlRead();
+};
+
+
+void tst_AsyncRuntimeBenchmarks::initTestCase()
+{
+	AMLMExecutor::logStats();
+	qInfo() << "Process threads at start:" << process_thread_count();
+}
+
+void tst_AsyncRuntimeBenchmarks::continuationDispatchLatency()
+{
+	std::vector<qint64> latencies;
+	latencies.reserve(c_num_latency_samples);
+
+	for(int i = 0; i < c_num_latency_samples; ++i)
+	{
+		QPromise<int> promise;
+		QFuture<int> future = promise.future();
+		promise.start();
+
+		std::atomic<qint64> ran_at_ns {0};
+		QFuture<void> continuation = future.then(AMLMExecutor::cpu().pool(), [&ran_at_ns](int){
+			ran_at_ns = now_ns();
+		});
+
+		const qint64 finished_at_ns = now_ns();
+		promise.addResult(i);
+		promise.finish();
+		continuation.waitForFinished();
+
+		latencies.push_back(ran_at_ns - finished_at_ns);
+	}
+
+	report_latency("Continuation dispatch", latencies);
+}
+
+void tst_AsyncRuntimeBenchmarks::thenChainThroughput_data()
+{
+	QTest::addColumn<int>("depth");
+
+	QTest::newRow("depth 1") << 1;
+	QTest::newRow("depth 16") << 16;
+	QTest::newRow("depth 256") << 256;
+}
+
+void tst_AsyncRuntimeBenchmarks::thenChainThroughput()
+{
+	QFETCH(int, depth);
+
+	QBENCHMARK
+	{
+		QPromise<int> promise;
+		QFuture<int> future = promise.future();
+		promise.start();
+
+		for(int i = 0; i < depth; ++i)
+		{
+			future = future.then(AMLMExecutor::cpu().pool(), [](int value){ return value + 1; });
+		}
+
+		promise.addResult(0);
+		promise.finish();
+		QCOMPARE(future.result(), depth);
+	}
+}
+
+void tst_AsyncRuntimeBenchmarks::streamingThenLatency_data()
+{
+	QTest::addColumn<int>("batch_size");
+
+	QTest::newRow("batch 1") << 1;
+	QTest::newRow("batch 16") << 16;
+	QTest::newRow("batch 256") << 256;
+}
+
+void tst_AsyncRuntimeBenchmarks::streamingThenLatency()
+{
+	QFETCH(int, batch_size);
+
+	std::vector<qint64> pushed_at_ns(c_num_latency_samples);
+	std::vector<qint64> latencies(c_num_latency_samples);
+	std::atomic_int num_delivered {0};
+
+	QPromise<int> promise;
+	QFuture<int> future = promise.future();
+	promise.start();
+
+	QFuture<void> streamed = streaming_then(future, [&](QFuture<int>, int begin, int end){
+		const qint64 delivered_at_ns = now_ns();
+		// One batch in flight at a time, so the range is exactly one batch.
+		const int batch_index = begin / batch_size;
+		Q_ASSERT(end - begin == batch_size);
+		latencies[batch_index] = delivered_at_ns - pushed_at_ns[batch_index];
+		num_delivered++;
+	});
+
+	const QList<int> batch(batch_size, 0);
+	for(int i = 0; i < c_num_latency_samples; ++i)
+	{
+		pushed_at_ns[i] = now_ns();
+		promise.addResults(batch);
+		QVERIFY(spin_until([&](){ return num_delivered > i; }));
+	}
+	promise.finish();
+	streamed.waitForFinished();
+
+	report_latency("streaming_then() delivery", latencies);
+}
+
+void tst_AsyncRuntimeBenchmarks::streamingThenThroughput_data()
+{
+	streamingThenLatency_data();
+}
+
+void tst_AsyncRuntimeBenchmarks::streamingThenThroughput()
+{
+	QFETCH(int, batch_size);
+
+	const QList<int> batch(batch_size, 1);
+
+	QBENCHMARK
+	{
+		std::atomic_int num_received {0};
+
+		QPromise<int> promise;
+		QFuture<int> future = promise.future();
+		promise.start();
+
+		QFuture<void> streamed = streaming_then(future, [&](QFuture<int>, int begin, int end){
+			num_received += end - begin;
+		});
+
+		for(int i = 0; i < c_num_streamed_results; i += batch_size)
+		{
+			promise.addResults(batch);
+		}
+		promise.finish();
+		streamed.waitForFinished();
+
+		QCOMPARE(num_received.load(), c_num_streamed_results);
+	}
+}
+
+void tst_AsyncRuntimeBenchmarks::amlmJobTCreateAndTeardown()
+{
+	QBENCHMARK
+	{
+		QPromise<Unit> promise;
+		promise.start();
+
+		AMLMJobT<ExtFuture<Unit>>* job = make_async_AMLMJobT(ExtFuture<Unit>(promise.future()), "BenchmarkJob");
+		QSignalSpy destroyed_spy(job, &QObject::destroyed);
+
+		promise.finish();
+
+		// Autodelete, so this is the whole life of the job.
+		QVERIFY(destroyed_spy.wait(c_timeout_ms));
+	}
+}
+
+void tst_AsyncRuntimeBenchmarks::perTaskOverhead_data()
+{
+	QTest::addColumn<QString>("via");
+
+	QTest::newRow("executor") << QStringLiteral("executor");
+	QTest::newRow("task group") << QStringLiteral("task group");
+	QTest::newRow("AMLMJobT each") << QStringLiteral("AMLMJobT each");
+}
+
+void tst_AsyncRuntimeBenchmarks::perTaskOverhead()
+{
+	QFETCH(QString, via);
+
+	auto task = [](QPromise<int>& promise){ promise.addResult(1); };
+	TaskGroup group("BenchmarkTasks", AMLMExecutor::interactive());
+
+	QBENCHMARK
+	{
+		std::vector<QFuture<int>> futures;
+		futures.reserve(c_num_overhead_tasks);
+		int num_jobs_destroyed = 0;
+
+		for(int i = 0; i < c_num_overhead_tasks; ++i)
+		{
+			if(via == QLatin1String("task group"))
+			{
+				futures.push_back(group.run(task));
+			}
+			else
+			{
+				futures.push_back(AMLMExecutor::interactive().run(task));
+			}
+			if(via == QLatin1String("AMLMJobT each"))
+			{
+				AMLMJobT<ExtFuture<int>>* job = make_async_AMLMJobT(ExtFuture<int>(futures.back()), "BenchmarkJob");
+				connect_or_die(job, &QObject::destroyed, job, [&](){ num_jobs_destroyed++; });
+			}
+		}
+		for(QFuture<int>& future : futures)
+		{
+			future.waitForFinished();
+		}
+		if(via == QLatin1String("AMLMJobT each"))
+		{
+			QTRY_COMPARE_WITH_TIMEOUT(num_jobs_destroyed, c_num_overhead_tasks, c_timeout_ms);
+		}
+	}
+}
+
+void tst_AsyncRuntimeBenchmarks::cancellationTokenLatency_data()
+{
+	QTest::addColumn<int>("num_tasks");
+
+	QTest::newRow("1 task") << 1;
+	QTest::newRow("4 tasks") << 4;
+	QTest::newRow("16 tasks") << 16;
+}
+
+void tst_AsyncRuntimeBenchmarks::cancellationTokenLatency()
+{
+	QFETCH(int, num_tasks);
+
+	if(num_tasks > AMLMExecutor::io().pool()->maxThreadCount())
+	{
+		QSKIP("Not enough io() threads to have all the tasks running at once");
+	}
+
+	std::vector<qint64> latencies;
+	latencies.reserve(c_num_latency_samples / num_tasks);
+
+	for(int sample = 0; sample < c_num_latency_samples / num_tasks; ++sample)
+	{
+		CancellationSource source;
+		const CancellationToken token = source.token();
+		std::atomic_int num_running {0};
+		std::vector<std::atomic<qint64>> seen_at_ns(num_tasks);
+		std::vector<QFuture<void>> tasks;
+
+		for(int i = 0; i < num_tasks; ++i)
+		{
+			tasks.push_back(AMLMExecutor::io().run([&, i, token](){
+				num_running++;
+				while(!token.checkpoint())
+				{
+					std::this_thread::yield();
+				}
+				seen_at_ns[i] = now_ns();
+			}));
+		}
+		QVERIFY(spin_until([&](){ return num_running == num_tasks; }));
+
+		const qint64 canceled_at_ns = now_ns();
+		source.cancel();
+		for(QFuture<void>& task : tasks)
+		{
+			task.waitForFinished();
+		}
+
+		qint64 last_seen_at_ns = 0;
+		for(const auto& seen : seen_at_ns)
+		{
+			last_seen_at_ns = std::max(last_seen_at_ns, seen.load());
+		}
+		latencies.push_back(last_seen_at_ns - canceled_at_ns);
+	}
+
+	report_latency("CancellationToken, cancel() to last checkpoint()", latencies);
+}
+
+void tst_AsyncRuntimeBenchmarks::futureCancelPropagationLatency()
+{
+	constexpr int c_num_samples = c_num_latency_samples / 10;
+
+	std::vector<qint64> latencies;
+	latencies.reserve(c_num_samples);
+
+	for(int sample = 0; sample < c_num_samples; ++sample)
+	{
+		std::atomic_bool upstream_running {false};
+		std::atomic<qint64> seen_at_ns {0};
+
+		QFuture<int> upstream = AMLMExecutor::io().run([&](QPromise<int>& promise){
+			upstream_running = true;
+			while(!promise.isCanceled())
+			{
+				std::this_thread::yield();
+			}
+			seen_at_ns = now_ns();
+		});
+		QFuture<void> downstream = streaming_then(upstream, [](QFuture<int>, int, int){});
+		QVERIFY(spin_until([&](){ return upstream_running.load(); }));
+
+		const qint64 canceled_at_ns = now_ns();
+		downstream.cancel();
+		upstream.waitForFinished();
+
+		latencies.push_back(seen_at_ns - canceled_at_ns);
+	}
+
+	report_latency("streaming_then() cancel to upstream", latencies);
+}
+
+void tst_AsyncRuntimeBenchmarks::deepPipelineThreadCount_data()
+{
+	QTest::addColumn<int>("depth");
+
+	QTest::newRow("depth 4") << 4;
+	QTest::newRow("depth 16") << 16;
+	QTest::newRow("depth 64") << 64;
+}
+
+void tst_AsyncRuntimeBenchmarks::deepPipelineThreadCount()
+{
+	QFETCH(int, depth);
+
+	std::vector<std::shared_ptr<BoundedChannel<int>>> channels;
+	for(int i = 0; i <= depth; ++i)
+	{
+		channels.push_back(std::make_shared<BoundedChannel<int>>(c_num_pipeline_items));
+	}
+
+	// Each stage passes its batches on to the next, and closes it when it's done.
+	for(int i = 0; i < depth; ++i)
+	{
+		auto next = channels[i + 1];
+		streaming_consume(channels[i], [next](std::vector<int> batch){
+			next->push_batch(std::move(batch));
+		})
+		.then(AMLMExecutor::cpu().pool(), [next](){ next->close(); });
+	}
+	std::atomic_int num_received {0};
+	QFuture<void> sink = streaming_consume(channels[depth], [&](std::vector<int> batch){
+		num_received += batch.size();
+	});
+
+	// Sample the thread counts while the items go through.
+	const int threads_before = process_thread_count();
+	std::atomic_bool sampling {true};
+	std::atomic_int peak_process_threads {threads_before};
+	std::atomic_int peak_executor_threads {0};
+	std::thread sampler([&](){
+		while(sampling)
+		{
+			peak_process_threads = std::max(peak_process_threads.load(), process_thread_count());
+			peak_executor_threads = std::max(peak_executor_threads.load(), executor_active_thread_count());
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+
+	std::vector<int> batch(64, 1);
+	for(int i = 0; i < c_num_pipeline_items; i += batch.size())
+	{
+		QVERIFY(channels[0]->push_batch(batch));
+	}
+	channels[0]->close();
+	sink.waitForFinished();
+
+	sampling = false;
+	sampler.join();
+
+	QCOMPARE(num_received.load(), c_num_pipeline_items);
+
+	// Less one for the sampler.
+	const int peak_added_threads = (threads_before < 0) ? -1 : (peak_process_threads - 1 - threads_before);
+	qInfo() << "Pipeline depth" << depth << ": process threads before:" << threads_before
+			<< "peak added:" << peak_added_threads << "peak active executor threads:" << peak_executor_threads.load();
+	QTest::setBenchmarkResult(peak_executor_threads.load(), QTest::Events);
+}
+
+void tst_AsyncRuntimeBenchmarks::threadsafeMapContention_data()
+{
+	QTest::addColumn<int>("num_threads");
+
+	for(int num_threads = 1; num_threads <= 2 * QThread::idealThreadCount(); num_threads *= 2)
+	{
+		QTest::addRow("%d threads", num_threads) << num_threads;
+	}
+}
+
+void tst_AsyncRuntimeBenchmarks::threadsafeMapContention()
+{
+	QFETCH(int, num_threads);
+
+	ThreadsafeMap<int, int> map;
+	std::atomic_int num_lookups_found {0};
+
+	auto worker = [&](int thread_index){
+		const int first_key = thread_index * c_num_map_keys_per_thread;
+		for(int i = 0; i < c_num_map_ops_per_thread; ++i)
+		{
+			const int key = first_key + (i % c_num_map_keys_per_thread);
+			// Mostly reads, like the tracker.
+			switch(i % 8)
+			{
+			case 0:
+				map.insert(key, i);
+				break;
+			case 1:
+				map.remove(key);
+				break;
+			default:
+				if(map.contains(key))
+				{
+					num_lookups_found.fetch_add(1, std::memory_order_relaxed);
+				}
+				break;
+			}
+		}
+	};
+
+	const qint64 start_ns = now_ns();
+	std::vector<std::thread> threads;
+	for(int t = 0; t < num_threads; ++t)
+	{
+		threads.emplace_back(worker, t);
+	}
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+	const qint64 elapsed_ns = now_ns() - start_ns;
+
+	const qint64 num_ops = qint64(num_threads) * c_num_map_ops_per_thread;
+	qInfo() << "ThreadsafeMap threads:" << num_threads << "Mops/s:" << (double(num_ops) * 1000.0 / std::max<qint64>(elapsed_ns, 1))
+			<< "lookups found:" << num_lookups_found.load();
+	QTest::setBenchmarkResult(double(elapsed_ns) / num_ops, QTest::WalltimeNanoseconds);
+}
+
+void tst_AsyncRuntimeBenchmarks::treeModelBuild_data()
+{
+	add_arena_rows();
+}
+
+void tst_AsyncRuntimeBenchmarks::treeModelBuild()
+{
+	QFETCH(bool, use_arena);
+
+	QTest::setBenchmarkResult(median_tree_sample(use_arena, &TreeSample::m_build_ns), QTest::WalltimeNanoseconds);
+}
+
+void tst_AsyncRuntimeBenchmarks::treeModelMemory_data()
+{
+	add_arena_rows();
+}
+
+void tst_AsyncRuntimeBenchmarks::treeModelMemory()
+{
+	QFETCH(bool, use_arena);
+
+	if(process_rss_bytes() < 0)
+	{
+		QSKIP("Can't measure the RSS on this platform");
+	}
+	const qint64 rss_bytes = median_tree_sample(use_arena, &TreeSample::m_rss_bytes);
+	qInfo() << "Tree of" << c_num_tree_nodes << "nodes, RSS added:" << rss_bytes;
+	QTest::setBenchmarkResult(rss_bytes / c_num_tree_nodes, QTest::BytesAllocated);
+}
+
+void tst_AsyncRuntimeBenchmarks::treeModelClose_data()
+{
+	add_arena_rows();
+}
+
+void tst_AsyncRuntimeBenchmarks::treeModelClose()
+{
+	QFETCH(bool, use_arena);
+
+	QTest::setBenchmarkResult(median_tree_sample(use_arena, &TreeSample::m_close_ns), QTest::WalltimeNanoseconds);
+}
+
+void tst_AsyncRuntimeBenchmarks::extUrlXmlRead_data()
+{
+	QTest::addColumn<bool>("reflected");
+
+	QTest::newRow("qvariant") << false;
+	QTest::newRow("reflected") << true;
+}
+
+void tst_AsyncRuntimeBenchmarks::extUrlXmlRead()
+{
+	QFETCH(bool, reflected);
+
+	std::vector<ExtUrl> before(c_num_serialized_exturls);
+	for(int i = 0; i < c_num_serialized_exturls; ++i)
+	{
+		before[i].m_url = QUrl(QString("file:///music/artist/album/track%1.flac").arg(i));
+		before[i].m_file_size_bytes = i * 1000;
+		before[i].m_last_modified_timestamp = QDateTime::fromMSecsSinceEpoch(1600000000000 + i, QTimeZone::UTC);
+	}
+
+	XmlSerializer xmlser;
+	QByteArray bytes;
+	{
+		QXmlStreamWriter writer(&bytes);
+		XmlStreamVisitor visitor(xmlser, writer);
+		visitor.beginList("list");
+		for(const auto& obj : before)
+		{
+			obj.toXmlStream(visitor, "exturl");
+		}
+		visitor.endElement();
+	}
+
+	std::vector<ExtUrl> after(before.size());
+	QBENCHMARK
+	{
+		QXmlStreamReader reader(bytes);
+		reader.readNextStartElement();
+		XmlStreamReadVisitor read_visitor(xmlser, reader);
+		std::size_t num_read = 0;
+		while(reader.readNextStartElement())
+		{
+			if(num_read == after.size())
+			{
+				QFAIL("Read more ExtUrls than were written");
+			}
+			if(reflected)
+			{
+				after[num_read].fromXmlStream(read_visitor);
+			}
+			else
+			{
+				after[num_read].fromVariant(read_visitor.readVariant());
+			}
+			++num_read;
+		}
+		QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+		QCOMPARE(num_read, after.size());
+	}
+	QCOMPARE(after.back().m_url, before.back().m_url);
+}
+
+
+int main(int argc, char *argv[])
+{
+	QThread::currentThread()->setObjectName("MAIN");
+
+	// AMLMJobs need the app.
+	AMLMApp app(argc, argv);
+	app.Init(true);
+	RegisterQtMetatypes();
+
+	tst_AsyncRuntimeBenchmarks benchmarks;
+	return QTest::qExec(&benchmarks, argc, argv);
+}
+
+#include "AsyncRuntimeBenchmarks.moc"
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#include "BoundedChannelTests.h"
+
+// Std C++
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Qt
+#include <QException>
+#include <QFuture>
+#include <QPromise>
+#include <QTest>
+
+// Google Test
+#include <gtest/gtest.h>
+
+// Ours
+#include <tests/TestHelpers.h>
+#include "ExtAsyncTestCommon.h"
+#include "../BoundedChannel.h"
+
+namespace
+{
+	/// Long enough for a thread which is going to get somewhere to get there.
+	constexpr int c_settle_ms = 200;
+	constexpr int c_timeout_ms = 5000;
+}
+
+/// A push into a full channel blocks until a consumer makes room.
+TEST_F(BoundedChannelTests, PushBlocksWhileFull)
+{
+	TC_ENTER();
+
+	BoundedChannel<int> channel(2);
+	AMLMTEST_EXPECT_TRUE(channel.push(1));
+	AMLMTEST_EXPECT_TRUE(channel.push(2));
+
+	std::atomic_bool pushed {false};
+	std::thread producer([&](){
+		EXPECT_TRUE(channel.push(3));
+		pushed = true;
+	});
+
+	QTest::qWait(c_settle_ms);
+	AMLMTEST_EXPECT_FALSE(pushed);
+	AMLMTEST_EXPECT_EQ(channel.size(), 2u);
+	AMLMTEST_EXPECT_EQ(channel.totalPushed(), 2u);
+
+	AMLMTEST_EXPECT_EQ(channel.pop(), std::optional<int>(1));
+	producer.join();
+	AMLMTEST_EXPECT_TRUE(pushed);
+	AMLMTEST_EXPECT_EQ(channel.size(), 2u);
+	AMLMTEST_EXPECT_EQ(channel.totalPushed(), 3u);
+	AMLMTEST_EXPECT_EQ(channel.totalPopped(), 1u);
+
+	TC_EXIT();
+}
+
+/// push_batch() into a smaller channel pushes as room is made, and everything comes out in order.
+TEST_F(BoundedChannelTests, PushBatchLargerThanCapacity)
+{
+	TC_ENTER();
+
+	constexpr int c_num_items = 1000;
+	BoundedChannel<int> channel(7);
+
+	std::thread producer([&](){
+		std::vector<int> items;
+		for(int i = 0; i < c_num_items; ++i)
+		{
+			items.push_back(i);
+		}
+		EXPECT_TRUE(channel.push_batch(std::move(items)));
+		channel.close();
+	});
+
+	std::vector<int> popped;
+	while(true)
+	{
+		std::vector<int> batch = channel.pop_batch(5);
+		if(batch.empty())
+		{
+			break;
+		}
+		AMLMTEST_EXPECT_LE(channel.size(), channel.capacity());
+		popped.insert(popped.end(), batch.begin(), batch.end());
+	}
+	producer.join();
+
+	AMLMTEST_EXPECT_EQ(popped.size(), std::size_t(c_num_items));
+	for(int i = 0; i < c_num_items; ++i)
+	{
+		AMLMTEST_EXPECT_EQ(popped[i], i);
+	}
+	AMLMTEST_EXPECT_TRUE(channel.isDrained());
+	AMLMTEST_EXPECT_FALSE(channel.isCanceled());
+
+	TC_EXIT();
+}
+
+/// Consumers get what's queued after a close(), then nullopt.  Pushes after a close() fail.
+TEST_F(BoundedChannelTests, CloseDrainsThenEnds)
+{
+	TC_ENTER();
+
+	BoundedChannel<int> channel(4);
+	AMLMTEST_EXPECT_TRUE(channel.push(1));
+	AMLMTEST_EXPECT_TRUE(channel.push(2));
+	channel.close();
+
+	AMLMTEST_EXPECT_FALSE(channel.push(3));
+	AMLMTEST_EXPECT_FALSE(channel.push_batch({4, 5}));
+	AMLMTEST_EXPECT_FALSE(channel.isDrained());
+
+	AMLMTEST_EXPECT_EQ(channel.pop(), std::optional<int>(1));
+	AMLMTEST_EXPECT_EQ(channel.pop(), std::optional<int>(2));
+	AMLMTEST_EXPECT_EQ(channel.pop(), std::optional<int>());
+	AMLMTEST_EXPECT_TRUE(channel.pop_batch(10).empty());
+	AMLMTEST_EXPECT_TRUE(channel.isDrained());
+	AMLMTEST_EXPECT_FALSE(channel.isCanceled());
+	AMLMTEST_EXPECT_EQ(channel.totalPushed(), 2u);
+
+	TC_EXIT();
+}
+
+/// close() wakes a consumer blocked on an empty channel, and a producer blocked on a full one.
+TEST_F(BoundedChannelTests, CloseWakesBlockedThreads)
+{
+	TC_ENTER();
+
+	BoundedChannel<int> empty_channel(1);
+	std::atomic_bool consumer_done {false};
+	std::thread consumer([&](){
+		EXPECT_EQ(empty_channel.pop(), std::optional<int>());
+		consumer_done = true;
+	});
+
+	BoundedChannel<int> full_channel(1);
+	AMLMTEST_EXPECT_TRUE(full_channel.push(1));
+	std::atomic_bool producer_done {false};
+	std::thread producer([&](){
+		EXPECT_FALSE(full_channel.push(2));
+		producer_done = true;
+	});
+
+	QTest::qWait(c_settle_ms);
+	AMLMTEST_EXPECT_FALSE(consumer_done);
+	AMLMTEST_EXPECT_FALSE(producer_done);
+
+	empty_channel.close();
+	full_channel.close();
+	consumer.join();
+	producer.join();
+
+	// The item which was already in there is still there.
+	AMLMTEST_EXPECT_EQ(full_channel.pop(), std::optional<int>(1));
+	AMLMTEST_EXPECT_TRUE(full_channel.isDrained());
+
+	TC_EXIT();
+}
+
+/// cancel() drops what's queued, wakes everyone, and fails pushes from then on.
+TEST_F(BoundedChannelTests, CancelDropsQueuedItems)
+{
+	TC_ENTER();
+
+	auto item = std::make_shared<int>(1);
+	std::weak_ptr<int> weak_item = item;
+
+	BoundedChannel<std::shared_ptr<int>> channel(2);
+	AMLMTEST_EXPECT_TRUE(channel.push(std::move(item)));
+	AMLMTEST_EXPECT_TRUE(channel.push(std::make_shared<int>(2)));
+
+	std::atomic_bool producer_done {false};
+	std::thread producer([&](){
+		EXPECT_FALSE(channel.push(std::make_shared<int>(3)));
+		producer_done = true;
+	});
+	QTest::qWait(c_settle_ms);
+	AMLMTEST_EXPECT_FALSE(producer_done);
+
+	channel.cancel();
+	producer.join();
+
+	AMLMTEST_EXPECT_TRUE(channel.isCanceled());
+	AMLMTEST_EXPECT_TRUE(channel.isDrained());
+	AMLMTEST_EXPECT_EQ(channel.size(), 0u);
+	// Freed, not just unreachable.
+	AMLMTEST_EXPECT_TRUE(weak_item.expired());
+	AMLMTEST_EXPECT_EQ(channel.pop(), std::optional<int>());
+	AMLMTEST_EXPECT_FALSE(channel.push(std::make_shared<int>(4)));
+
+	TC_EXIT();
+}
+
+/// A producer blocked on a full channel sees its promise being canceled, and cancels the channel.
+TEST_F(BoundedChannelTests, CanceledProducerCancelsChannel)
+{
+	TC_ENTER();
+
+	BoundedChannel<int> channel(1);
+	AMLMTEST_EXPECT_TRUE(channel.push(1));
+
+	QPromise<void> promise;
+	QFuture<void> future = promise.future();
+	promise.start();
+
+	std::atomic_bool producer_done {false};
+	std::thread producer([&](){
+		EXPECT_FALSE(channel.push(2, promise));
+		producer_done = true;
+	});
+	QTest::qWait(c_settle_ms);
+	AMLMTEST_EXPECT_FALSE(producer_done);
+
+	future.cancel();
+	AMLMTEST_EXPECT_TRUE(QTest::qWaitFor([&](){ return producer_done.load(); }, c_timeout_ms));
+	producer.join();
+	AMLMTEST_EXPECT_TRUE(channel.isCanceled());
+
+	promise.finish();
+
+	TC_EXIT();
+}
+
+/// streaming_consume() sees every item in order, and finishes when the channel is closed.
+TEST_F(BoundedChannelTests, StreamingConsumeDeliversInOrder)
+{
+	TC_ENTER();
+
+	constexpr int c_num_items = 500;
+	auto channel = std::make_shared<BoundedChannel<int>>(16);
+
+	std::mutex seen_mutex;
+	std::vector<int> seen;
+	QFuture<void> consumer = streaming_consume(channel, [&](std::vector<int> batch){
+		std::scoped_lock lock(seen_mutex);
+		seen.insert(seen.end(), batch.begin(), batch.end());
+	}, 8);
+
+	std::thread producer([&](){
+		for(int i = 0; i < c_num_items; ++i)
+		{
+			EXPECT_TRUE(channel->push(i));
+		}
+		channel->close();
+	});
+	producer.join();
+
+	consumer.waitForFinished();
+	AMLMTEST_EXPECT_FALSE(consumer.isCanceled());
+	std::scoped_lock lock(seen_mutex);
+	AMLMTEST_EXPECT_EQ(seen.size(), std::size_t(c_num_items));
+	for(int i = 0; i < c_num_items; ++i)
+	{
+		AMLMTEST_EXPECT_EQ(seen[i], i);
+	}
+
+	TC_EXIT();
+}
+
+/// Canceling the streaming_consume() future cancels the channel, which fails the producer's pushes.
+TEST_F(BoundedChannelTests, StreamingConsumeCancelCancelsChannel)
+{
+	TC_ENTER();
+
+	auto channel = std::make_shared<BoundedChannel<int>>(4);
+	QFuture<void> consumer = streaming_consume(channel, [](std::vector<int>){});
+
+	consumer.cancel();
+	AMLMTEST_EXPECT_TRUE(QTest::qWaitFor([&](){ return channel->isCanceled(); }, c_timeout_ms));
+	AMLMTEST_EXPECT_FALSE(channel->push(1));
+
+	consumer.waitForFinished();
+	AMLMTEST_EXPECT_TRUE(consumer.isCanceled());
+
+	TC_EXIT();
+}
+
+/// An exception from the streaming_consume() function cancels the channel and comes out of the future.
+TEST_F(BoundedChannelTests, StreamingConsumeThrowCancelsChannel)
+{
+	TC_ENTER();
+
+	auto channel = std::make_shared<BoundedChannel<int>>(4);
+	QFuture<void> consumer = streaming_consume(channel, [](std::vector<int>){
+		throw QException();
+	});
+
+	AMLMTEST_EXPECT_TRUE(channel->push(1));
+	AMLMTEST_EXPECT_TRUE(QTest::qWaitFor([&](){ return channel->isCanceled(); }, c_timeout_ms));
+	AMLMTEST_EXPECT_FALSE(channel->push(2));
+
+	EXPECT_THROW(consumer.waitForFinished(), QException);
+
+	TC_EXIT();
+}
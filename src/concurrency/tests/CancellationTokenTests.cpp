@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#include "CancellationTokenTests.h"
+
+// Std C++
+#include <atomic>
+#include <thread>
+
+// Google Test
+#include <gtest/gtest.h>
+
+// Ours
+#include <tests/TestHelpers.h>
+#include "ExtAsyncTestCommon.h"
+#include "../CancellationToken.h"
+
+/// Canceling a scope cancels everything under it, including scopes made after the cancel, and the worker's
+/// checkpoint() records the latency.
+TEST_F(CancellationTokenTests, TreePropagates)
+{
+	TC_ENTER();
+
+	// Not the appRoot(), that would cancel everything else in the process.
+	CancellationSource root;
+	CancellationSource scan(root.token());
+	CancellationSource task(scan.token());
+
+	std::atomic_int num_callbacks {0};
+	task.token().onCancel([&](){ num_callbacks++; });
+
+	const auto num_measured_before = CancellationSource::latencyStats().m_num_measured;
+
+	std::atomic_bool worker_running {false};
+	std::thread worker([&, token = task.token()](){
+		worker_running = true;
+		while(!token.checkpoint())
+		{
+			std::this_thread::yield();
+		}
+	});
+	while(!worker_running)
+	{
+		std::this_thread::yield();
+	}
+
+	AMLMTEST_EXPECT_FALSE(task.isCanceled());
+	root.cancel();
+	worker.join();
+
+	AMLMTEST_EXPECT_TRUE(scan.isCanceled());
+	AMLMTEST_EXPECT_TRUE(task.isCanceled());
+	AMLMTEST_EXPECT_EQ(num_callbacks, 1);
+	AMLMTEST_EXPECT_EQ(CancellationSource::latencyStats().m_num_measured, num_measured_before + 1);
+
+	// Too late to run normally, so right away.
+	CancellationSource late(scan.token());
+	AMLMTEST_EXPECT_TRUE(late.isCanceled());
+	late.token().onCancel([&](){ num_callbacks++; });
+	AMLMTEST_EXPECT_EQ(num_callbacks, 2);
+
+	// A default token is never canceled.
+	AMLMTEST_EXPECT_FALSE(CancellationToken().checkpoint());
+
+	TC_EXIT();
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#include "CoTaskTests.h"
+
+// Std C++
+#include <atomic>
+#include <memory>
+
+// Qt
+#include <QFuture>
+#include <QPromise>
+#include <QTest>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+// Google Test
+#include <gtest/gtest.h>
+
+// Ours
+#include <tests/TestHelpers.h>
+#include "ExtAsyncTestCommon.h"
+#include "../CoTask.h"
+
+namespace
+{
+	CoTask<int> add_one_after(QFuture<int> upstream)
+	{
+		int value = co_await upstream;
+		co_return value + 1;
+	}
+
+	CoTask<int> add_one_then_times_ten(QFuture<int> upstream)
+	{
+		int first = co_await add_one_after(upstream);
+		int second = co_await QtConcurrent::run([first](){ return first * 10; });
+		co_return second;
+	}
+
+	CoTask<void> wait_for(QFuture<int> upstream, std::shared_ptr<std::atomic_bool> got_cancel_exception)
+	{
+		try
+		{
+			co_await upstream;
+		}
+		catch(const ExtAsyncCancelException&)
+		{
+			*got_cancel_exception = true;
+			throw;
+		}
+	}
+}
+
+/// A multi-stage coroutine doesn't hold any threads while it's waiting.
+TEST_F(CoTaskTests, AwaitParksNoThreads)
+{
+	TC_ENTER();
+
+	QThreadPool* tp = QThreadPool::globalInstance();
+	// Let anything left over from other tests finish.
+	tp->waitForDone();
+	const int threads_before = tp->activeThreadCount();
+
+	QPromise<int> promise;
+	promise.start();
+
+	CoTask<int> task = add_one_then_times_ten(promise.future());
+
+	QTest::qWait(200);
+	AMLMTEST_EXPECT_EQ(tp->activeThreadCount(), threads_before);
+	AMLMTEST_EXPECT_FALSE(task.future().isFinished());
+
+	promise.addResult(4);
+	promise.finish();
+
+	QFuture<int> result = task.future();
+	result.waitForFinished();
+	AMLMTEST_EXPECT_FALSE(result.isCanceled());
+	AMLMTEST_EXPECT_EQ(result.result(), 50);
+
+	TC_EXIT();
+}
+
+/// Canceling a coroutine cancels what it's waiting on, and throws ExtAsyncCancelException at the co_await.
+TEST_F(CoTaskTests, CancelThrowsAtSuspensionPoint)
+{
+	TC_ENTER();
+
+	QPromise<int> promise;
+	QFuture<int> upstream = promise.future();
+	promise.start();
+
+	auto got_cancel_exception = std::make_shared<std::atomic_bool>(false);
+	CoTask<void> task = wait_for(upstream, got_cancel_exception);
+
+	task.cancel();
+	AMLMTEST_EXPECT_TRUE(QTest::qWaitFor([&](){ return upstream.isCanceled(); }, 5000));
+	AMLMTEST_EXPECT_TRUE(QTest::qWaitFor([&](){ return got_cancel_exception->load(); }, 5000));
+
+	QFuture<void> result = task.future();
+	result.waitForFinished();
+	AMLMTEST_EXPECT_TRUE(result.isCanceled());
+
+	promise.finish();
+
+	TC_EXIT();
+}
@@ -22,18 +22,26 @@
 
 // Std C++
 #include <type_traits>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 // Future Std C++
 #include <future/future_type_traits.hpp>
 #include <future/function_traits.hpp>
 
 // Qt
+#include <QPromise>
 #include <QString>
 #include <QTest>
+#include <QThread>
+#include <QThreadPool>
 #include <QFutureInterfaceBase> // shhh, we're not supposed to use this.  For calling .reportFinished() on QFuture<>s inside a run().
 #define QFUTURE_TEST
 #include <QtCore/qfutureinterface.h>  // For test purposes only.
@@ -46,6 +54,7 @@
 #include <tests/TestHelpers.h>
 #include "ExtAsyncTestCommon.h"
 #include <tests/IResultsSequenceMock.h>
+#include "../AMLMExecutor.h"
 
 /// Types for gtest's "Typed Test" support.
 using FutureIntTypes = ::testing::Types<QFuture<int>, ExtFuture<int>>;
@@ -1534,6 +1543,102 @@ TEST_F(ExtFutureTest, ParallelThens)  // NOLINT
 	TC_EXIT();
 }
 
+/// A streaming_then() pipeline which is waiting on its upstream shouldn't be holding any threads.
+TEST_F(ExtFutureTest, StreamingThenParksNoThreads)
+{
+	TC_ENTER();
+
+	// The pool streaming_then()'s hops run on.
+	QThreadPool* tp = AMLMExecutor::cpu().pool();
+	// Let anything left over from other tests finish.
+	tp->waitForDone();
+	const int threads_before = tp->activeThreadCount();
+	AMLMTEST_ASSERT_EQ(threads_before, 0);
+
+	QPromise<int> promise;
+	QFuture<int> upstream = promise.future();
+	promise.start();
+
+	std::mutex seen_mutex;
+	std::vector<int> seen;
+
+	QFuture<void> stage1 = streaming_then(upstream, [&](QFuture<int> f, int begin, int end){
+		std::scoped_lock lock(seen_mutex);
+		for(int i = begin; i < end; ++i)
+		{
+			seen.push_back(f.resultAt(i));
+		}
+	});
+	QFuture<void> stage2 = streaming_then(stage1, [](QFuture<void>, int, int){});
+	QFuture<void> stage3 = streaming_then(stage2, [](QFuture<void>, int, int){});
+
+	// Nothing's ready, so nothing should be running.
+	QTest::qWait(200);
+	AMLMTEST_EXPECT_EQ(tp->activeThreadCount(), threads_before);
+	AMLMTEST_EXPECT_FALSE(stage3.isFinished());
+
+	promise.addResult(1);
+	promise.addResult(2);
+	promise.addResult(3);
+	promise.finish();
+
+	stage3.waitForFinished();
+	AMLMTEST_EXPECT_FALSE(stage3.isCanceled());
+	{
+		std::scoped_lock lock(seen_mutex);
+		AMLMTEST_EXPECT_EQ(seen, (std::vector<int>{1, 2, 3}));
+	}
+
+	TC_EXIT();
+}
+
+/// An exception thrown by a streaming_then() callback cancels the upstream and comes out of the downstream.
+TEST_F(ExtFutureTest, StreamingThenThrowPropagates)
+{
+	TC_ENTER();
+
+	QPromise<int> promise;
+	QFuture<int> upstream = promise.future();
+	promise.start();
+
+	QFuture<void> downstream = streaming_then(upstream, [](QFuture<int>, int, int){
+		throw QException();
+	});
+
+	promise.addResult(1);
+	AMLMTEST_EXPECT_TRUE(QTest::qWaitFor([&](){ return upstream.isCanceled(); }, 5000));
+	promise.finish();
+
+	EXPECT_THROW(downstream.waitForFinished(), QException);
+
+	TC_EXIT();
+}
+
+/// Canceling a streaming_then()'s future cancels its upstream.
+TEST_F(ExtFutureTest, StreamingThenCancelPropagatesUpstream)
+{
+	TC_ENTER();
+
+	QPromise<int> promise;
+	QFuture<int> upstream = promise.future();
+	promise.start();
+
+	std::atomic_bool ran_callback {false};
+	QFuture<void> downstream = streaming_then(upstream, [&](QFuture<int>, int, int){
+		ran_callback = true;
+	});
+
+	downstream.cancel();
+	AMLMTEST_EXPECT_TRUE(QTest::qWaitFor([&](){ return upstream.isCanceled(); }, 5000));
+	promise.finish();
+
+	downstream.waitForFinished();
+	AMLMTEST_EXPECT_TRUE(downstream.isCanceled());
+	AMLMTEST_EXPECT_FALSE(ran_callback);
+
+	TC_EXIT();
+}
+
 #if 0
 TEST_F(ExtFutureTest, ExtFutureThenCancel)
 {
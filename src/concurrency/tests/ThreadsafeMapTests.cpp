@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Throughput under contention is measured by bench_asyncruntime's threadsafeMapContention.
+
+#include "ThreadsafeMapTests.h"
+
+// Std C++
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Qt
+#include <QObject>
+#include <QPointer>
+
+// Google Test
+#include <gtest/gtest.h>
+
+// Ours
+#include <tests/TestHelpers.h>
+#include "ExtAsyncTestCommon.h"
+#include "../ThreadsafeMap.h"
+
+/// Writers on their own ranges of keys, spread over the shards, don't lose or corrupt each other's entries.
+TEST_F(ThreadsafeMapTests, ConcurrentWritersEndUpConsistent)
+{
+	TC_ENTER();
+
+	constexpr int c_num_threads = 8;
+	constexpr int c_ops_per_thread = 20'000;
+	constexpr int c_keys_per_thread = 1024;
+
+	ThreadsafeMap<int, int> map;
+
+	auto worker = [&](int thread_index){
+		const int first_key = thread_index * c_keys_per_thread;
+		for(int i = 0; i < c_ops_per_thread; ++i)
+		{
+			const int key = first_key + (i % c_keys_per_thread);
+			// c_keys_per_thread is a multiple of 4, so each key only ever gets one kind of operation.
+			switch(i % 4)
+			{
+			case 0:
+				map.insert(key, i);
+				EXPECT_EQ(map.value(key, -1), i);
+				break;
+			case 1:
+				map.remove(key);
+				EXPECT_FALSE(map.contains(key));
+				break;
+			default:
+				// Never inserted.
+				EXPECT_FALSE(map.contains(key));
+				break;
+			}
+		}
+		// Leave every key of this thread in the map.
+		for(int key = first_key; key < first_key + c_keys_per_thread; ++key)
+		{
+			map.insert(key, key);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(int t = 0; t < c_num_threads; ++t)
+	{
+		threads.emplace_back(worker, t);
+	}
+	for(auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	AMLMTEST_EXPECT_EQ(map.size(), c_num_threads * c_keys_per_thread);
+	AMLMTEST_EXPECT_EQ(map.keys().size(), c_num_threads * c_keys_per_thread);
+	for(int key = 0; key < c_num_threads * c_keys_per_thread; ++key)
+	{
+		AMLMTEST_EXPECT_EQ(map.value(key, -1), key);
+	}
+
+	TC_EXIT();
+}
+
+/// Iteration is over a snapshot, so it doesn't block writers, and can write to the map itself.
+TEST_F(ThreadsafeMapTests, SnapshotIterationDoesNotBlockWriters)
+{
+	TC_ENTER();
+
+	ThreadsafeMap<int, int> map;
+	for(int i = 0; i < 100; ++i)
+	{
+		map.insert(i, i);
+	}
+
+	int num_visited = 0;
+	map.for_each_key_value_pair([&](int key, int value){
+		AMLMTEST_EXPECT_EQ(key, value);
+		// With the old single-mutex map this deadlocked.
+		map.insert(key + 100, value);
+		// And another thread can too.
+		std::thread([&](){ map.remove(key); }).join();
+		num_visited++;
+	});
+
+	AMLMTEST_EXPECT_EQ(num_visited, 100);
+	AMLMTEST_EXPECT_EQ(map.size(), 100);
+	AMLMTEST_EXPECT_FALSE(map.contains(0));
+	AMLMTEST_EXPECT_TRUE(map.contains(100));
+
+	TC_EXIT();
+}
+
+/// Like ActivityProgressStatusBarTracker: the entry's removed from the object's destroyed() signal, when a QPointer to
+/// it would already be null.  That's why QPointer keys aren't allowed.
+TEST_F(ThreadsafeMapTests, EntriesCanBeRemovedWhenTheirKeyIsDestroyed)
+{
+	TC_ENTER();
+
+	static_assert(ThreadsafeMap_detail::is_self_nulling<QPointer<QObject>>::value);
+
+	ThreadsafeMap<QObject*, QPointer<QObject>> map;
+	std::vector<std::unique_ptr<QObject>> objects;
+	// Enough that they're spread over all the shards.
+	for(int i = 0; i < 64; ++i)
+	{
+		auto object = std::make_unique<QObject>();
+		map.insert(object.get(), QPointer<QObject>(object.get()));
+		QObject::connect(object.get(), &QObject::destroyed, [&map](QObject* destroyed){
+			AMLMTEST_EXPECT_EQ(map.remove(destroyed), 1);
+		});
+		objects.push_back(std::move(object));
+	}
+	AMLMTEST_EXPECT_EQ(map.size(), 64);
+
+	objects.clear();
+
+	AMLMTEST_EXPECT_EQ(map.size(), 0);
+	AMLMTEST_EXPECT_TRUE(map.keys().isEmpty());
+
+	TC_EXIT();
+}
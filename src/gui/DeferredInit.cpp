@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file DeferredInit.cpp
+ * Implementation of DeferredInit.
+ */
+
+#include "DeferredInit.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+
+// Ours
+#include <utils/DebugHelpers.h>
+#include <utils/StartupProfiler.h>
+
+
+/// How long to wait for the first paint before giving up on it.
+static constexpr int f_first_paint_timeout_ms = 3000;
+
+DeferredInit* DeferredInit::instance()
+{
+	// Parented to the app, so it goes away with it.
+	static DeferredInit* the_instance = new DeferredInit(QCoreApplication::instance());
+	return the_instance;
+}
+
+DeferredInit::DeferredInit(QObject* parent) : QObject(parent)
+{
+	setObjectName("DeferredInit");
+}
+
+void DeferredInit::add(std::string name, std::function<void()> task)
+{
+	m_tasks.push_back({std::move(name), std::move(task)});
+
+	if(m_started && !m_run_scheduled)
+	{
+		m_run_scheduled = true;
+		QTimer::singleShot(0, this, &DeferredInit::runNext);
+	}
+}
+
+void DeferredInit::runAfterFirstPaint(QWidget* main_window)
+{
+	Q_CHECK_PTR(main_window);
+	Q_ASSERT(m_main_window.isNull());
+
+	m_main_window = main_window;
+	m_main_window->installEventFilter(this);
+
+	QTimer::singleShot(f_first_paint_timeout_ms, this, [this](){
+		if(!m_started)
+		{
+			qWr() << "No first paint after" << f_first_paint_timeout_ms << "ms, running deferred initialization anyway";
+			onFirstPaint();
+		}
+	});
+}
+
+bool DeferredInit::eventFilter(QObject* watched, QEvent* event)
+{
+	if(watched == m_main_window && event->type() == QEvent::Paint && !m_started)
+	{
+		// Let the paint finish and get on screen first.
+		QTimer::singleShot(0, this, &DeferredInit::onFirstPaint);
+	}
+	return QObject::eventFilter(watched, event);
+}
+
+void DeferredInit::onFirstPaint()
+{
+	if(m_started)
+	{
+		return;
+	}
+	m_started = true;
+
+	if(m_main_window)
+	{
+		m_main_window->removeEventFilter(this);
+	}
+
+	StartupProfiler::interactive();
+
+	m_run_scheduled = true;
+	QTimer::singleShot(0, this, &DeferredInit::runNext);
+}
+
+void DeferredInit::runNext()
+{
+	m_run_scheduled = false;
+	if(m_tasks.empty())
+	{
+		return;
+	}
+
+	Task task = std::move(m_tasks.front());
+	m_tasks.pop_front();
+	{
+		StartupProfiler::Phase phase("Deferred: " + task.m_name);
+		task.m_task();
+	}
+
+	if(!m_tasks.empty())
+	{
+		// One per event loop iteration.
+		m_run_scheduled = true;
+		QTimer::singleShot(0, this, &DeferredInit::runNext);
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file DeferredInit.h
+ * Interface of DeferredInit, for initialization which can wait until the main window is up.
+ */
+#ifndef SRC_GUI_DEFERREDINIT_H_
+#define SRC_GUI_DEFERREDINIT_H_
+
+// Std C++
+#include <deque>
+#include <functional>
+#include <string>
+
+// Qt
+#include <QObject>
+#include <QPointer>
+class QWidget;
+
+// Ours
+#include <future/guideline_helpers.h>
+
+
+/**
+ * Queue of non-critical initialization work, run in the GUI thread after the main window has been painted for the
+ * first time.  The tasks are run one per event loop iteration so the window stays responsive while they run.
+ *
+ * Once the queue has been run, tasks added later are just run on the next event loop iteration.
+ */
+class DeferredInit : public QObject
+{
+	Q_OBJECT
+
+public:
+	M_GH_POLYMORPHIC_SUPPRESS_COPYING_C67(DeferredInit)
+
+	static DeferredInit* instance();
+
+	/// Queue @a task.  @a name is what it's called in the StartupProfiler timeline.
+	void add(std::string name, std::function<void()> task);
+
+	/**
+	 * Start running the queued tasks after @a main_window's first paint.  Call once, before showing it.
+	 * If the paint doesn't come soon enough, e.g. the window starts minimized, they're run anyway.
+	 */
+	void runAfterFirstPaint(QWidget* main_window);
+
+protected:
+	bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+	explicit DeferredInit(QObject* parent = nullptr);
+	~DeferredInit() override = default;
+
+	/// The main window is up, mark it and start running the queue.
+	void onFirstPaint();
+	void runNext();
+
+	struct Task
+	{
+		std::string m_name;
+		std::function<void()> m_task;
+	};
+	std::deque<Task> m_tasks;
+
+	QPointer<QWidget> m_main_window;
+	bool m_started {false};
+	bool m_run_scheduled {false};
+};
+
+#endif /* SRC_GUI_DEFERREDINIT_H_ */
@@ -59,6 +59,7 @@ MDILibraryView::MDILibraryView(QWidget* parent) : MDITreeViewBase(parent)
 	m_act_window->setIcon(QIcon::fromTheme("folder"));
 
 	m_underlying_model = nullptr;
+	m_sortfilter_model = nullptr;
 
 	// Delegates.
 	m_length_delegate = new ItemDelegateLength(this);
@@ -77,6 +78,11 @@ MDILibraryView::MDILibraryView(QWidget* parent) : MDITreeViewBase(parent)
 	setAcceptDrops(false);
 	setDragDropMode(QAbstractItemView::DragOnly);
 	setDropIndicatorShown(true);
+
+	// Load what's on screen once it's settled down a bit, not on every repaint while scrolling.
+	m_load_visible_rows_timer.setSingleShot(true);
+	m_load_visible_rows_timer.setInterval(50);
+	connect_or_die(&m_load_visible_rows_timer, &QTimer::timeout, this, &MDILibraryView::loadVisibleRows);
 }
 
 QString MDILibraryView::getDisplayName() const
@@ -313,6 +319,43 @@ bool MDILibraryView::onBlankAreaToolTip(QHelpEvent* event)
 	return true;
 }
 
+bool MDILibraryView::viewportEvent(QEvent* event)
+{
+	if(event->type() == QEvent::Paint && !m_load_visible_rows_timer.isActive())
+	{
+		m_load_visible_rows_timer.start();
+	}
+	return BASE_CLASS::viewportEvent(event);
+}
+
+void MDILibraryView::loadVisibleRows()
+{
+	if(m_underlying_model.isNull() || m_sortfilter_model == nullptr)
+	{
+		return;
+	}
+
+	const QModelIndex first = indexAt(viewport()->rect().topLeft());
+	if(!first.isValid())
+	{
+		// Nothing on screen.
+		return;
+	}
+	// Invalid if the last row's above the bottom of the viewport, in which case it's everything to the end.
+	const QModelIndex last = indexAt(viewport()->rect().bottomLeft());
+
+	std::vector<int> rows;
+	for(QModelIndex index = first; index.isValid(); index = indexBelow(index))
+	{
+		rows.push_back(to_underlying_qmodelindex(index).row());
+		if(last.isValid() && index.row() == last.row())
+		{
+			break;
+		}
+	}
+	m_underlying_model->requestEntryLoads(rows);
+}
+
 QModelIndex MDILibraryView::to_underlying_qmodelindex(const QModelIndex &proxy_index)
 {
 	auto underlying_model_index = qobject_cast<LibrarySortFilterProxyModel*>(model())->mapToSource(proxy_index);
@@ -25,6 +25,7 @@
 #include <functional>
 
 // Qt
+#include <QTimer>
 #include <QUrl>
 
 // Ours
@@ -126,6 +127,9 @@ protected:
 
 	bool onBlankAreaToolTip(QHelpEvent* event) override;
 
+	/// Any repaint of the viewport may be showing new rows, so it schedules loadVisibleRows().
+	bool viewportEvent(QEvent* event) override;
+
 	/// Helper function to convert from incoming proxy QModelIndexes to actual underlying model indexes.
 	QModelIndex to_underlying_qmodelindex(const QModelIndex &proxy_index) override;
 	/// Helper function to convert from underlying model indexes to proxy QModelIndexes.
@@ -156,6 +160,15 @@ private:
 	std::vector<MDIPlaylistView*> getAllMdiPlaylistViews();
 	void addSendToMenuActions(QMenu* menu);
 
+	/**
+	 * Start loading the metadata of the unpopulated rows which are on screen, so they don't wait for the rescan.
+	 * Only these rows, not every row the sort/filter proxy asks data() about.
+	 */
+	void loadVisibleRows();
+
+	/// Coalesces viewport repaints into one loadVisibleRows().
+	QTimer m_load_visible_rows_timer;
+
 	virtual LibrarySortFilterProxyModel* getTypedModel();
 };
 
@@ -32,6 +32,7 @@
 #include <QMimeData>
 #include <QMimeType>
 #include <QMimeDatabase>
+#include <QFileInfo>
 #include <QClipboard>
 #include <QPoint>
 #include <QKeyEvent>
@@ -190,7 +191,7 @@ QString MDIPlaylistView::getNewFilenameTemplate() const
 
 QString MDIPlaylistView::defaultNameFilter()
 {
-    return "M3U8 (*.m3u8);;M3U (*.m3u);;PLS (*.pls);;Windows media player playlist (*.wpl);;XSPF (*.xspf)";
+    return "M3U8 (*.m3u8);;M3U (*.m3u);;PLS (*.pls);;Windows media player playlist (*.wpl);;XSPF (*.xspf);;Compressed XSPF (*.xspfz)";
 }
 
 void MDIPlaylistView::setEmptyModel()
@@ -220,6 +221,13 @@ void MDIPlaylistView::serializeDocument(QFileDevice& file)
         QMessageBox::critical(nullptr/*this*/, "Save Error", QString("Unable to determine what format to save playlist as: Filename was empty"));
 	}
 
+	// Our compressed XSPF, which the mime database doesn't know about.
+	if(QFileInfo(fn).suffix().compare(QLatin1StringView("xspfz"), Qt::CaseInsensitive) == 0)
+	{
+		underlyingModel()->serializeToFileAsXSPF(file, true);
+		return;
+	}
+
 	// Filename to mimetype.
 	QMimeType mt = QMimeDatabase().mimeTypeForFile(fn, QMimeDatabase::MatchExtension);
 	if(!mt.isValid())
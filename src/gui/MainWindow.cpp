@@ -25,6 +25,10 @@
 // Std C++
 #include <functional>
 #include <algorithm>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <utility>
 #include <vector>
 
 // Qt
@@ -56,7 +60,8 @@
 #include <QWhatsThis>
 #include <QMimeData>
 #include <QTableView>
-#include <QProgressDialog>
+#include <QProgressBar>
+#include <QFileDialog>
 
 // KF
 #include <KMainWindow>
@@ -94,10 +99,12 @@
 #include <gui/widgets/CollectionStatsWidget.h>
 #include <gui/widgets/CollectionView.h>
 
+#include <concurrency/AMLMExecutor.h>
 #include <logic/models/LibraryModel.h>
 #include <logic/models/PlaylistModel.h>
 #include <proxymodels/ShuffleProxyModel.h>
 
+#include "gui/DeferredInit.h"
 #include "gui/MDIArea.h"
 #include "MetadataDockWidget.h"
 #include "CollectionDockWidget.h"
@@ -107,6 +114,7 @@
 
 #include "utils/ConnectHelpers.h"
 #include "utils/DebugHelpers.h"
+#include <utils/Trace.h>
 
 #include <logic/MP2.h>
 #include "Theme.h"
@@ -122,7 +130,11 @@
 #include <gui/activityprogressmanager/ActivityProgressStatusBarTracker.h>
 #include <logic/proxymodels/LibrarySortFilterProxyModel.h>
 #include <logic/serialization/XmlSerializer.h>
+#include <logic/serialization/XmlStreamVisitor.h>
+#include <logic/LibraryJournal.h>
+#include <logic/CollectionStore.h>
 
+#include <utils/StartupProfiler.h>
 #include <utils/Stopwatch.h>
 
 /// @note EXPERIMENTAL
@@ -273,7 +285,11 @@ void MainWindow::init()
 	setToolButtonStyle(Qt::ToolButtonFollowStyle);
 
 	// Set up our Theme/Style management and actions.
-	Theme::initialize();
+	{
+		StartupProfiler::Phase phase("Theme::initialize");
+		Theme::initialize();
+	}
+	DeferredInit::instance()->add("Theme diagnostics", [](){ Theme::LogStartupDiagnostics(); });
     m_actgroup_styles = Theme::getWidgetStylesActionGroup(this);
 	m_act_styles_kaction_menu = qobject_cast<KActionMenu*>(m_actgroup_styles->parent());
 	Q_CHECK_PTR(m_act_styles_kaction_menu);
@@ -308,12 +324,15 @@ void MainWindow::init()
 	// the subwindow activation changes.
     connect_or_die(m_mdi_area, &QMdiArea::subWindowActivated, this, &MainWindow::onSubWindowActivated);
 
-	createActions();
-	createToolBars();
-	createStatusBar();
-	createDockWidgets();
-	/// @note Temporary move, should really be before createToolBars().
-	createMenus();
+	{
+		StartupProfiler::Phase phase("Create actions, bars, docks and menus");
+		createActions();
+		createToolBars();
+		createStatusBar();
+		createDockWidgets();
+		/// @note Temporary move, should really be before createToolBars().
+		createMenus();
+	}
 
 	updateActionEnableStates();
 
@@ -365,6 +384,8 @@ void MainWindow::applyMainWindowSettings(const KConfigGroup& config)
  */
 void MainWindow::onStartup()
 {
+	StartupProfiler::Phase phase("MainWindow::onStartup");
+
     initRootModels();
 
     // Create the "Now Playing" playlist model and view.
@@ -377,7 +398,13 @@ void MainWindow::onStartup()
 
     // Load any files which were opened at the time the last session was closed.
     qInfo() << "Loading libraries open at end of last session...";
-    readLibSettings();
+	/// @todo Get this path from settings.
+	m_lib_journal = new LibraryJournal(QDir::homePath() + "/AMLMDatabaseSerDes.journal", this);
+	connect_or_die(m_lib_journal, &LibraryJournal::SIGNAL_compactionDue, this, &MainWindow::writeLibSettings);
+	{
+		StartupProfiler::Phase phase("readLibSettings");
+		readLibSettings();
+	}
 
     // Open the windows the user had open at the end of last session.
     openWindows();
@@ -753,6 +780,18 @@ void MainWindow::createActionsTools(KActionCollection *ac)
 	m_scanLibraryAction = make_action(QIcon::fromTheme("tools-check-spelling"), "Scan library", this,
 							   QKeySequence(), "Scan library for problems");
     addAction("scan_lib", m_scanLibraryAction);
+
+	m_act_record_trace = make_action(Theme::iconFromTheme("media-record"), tr("Record Trace"), this,
+									QKeySequence(), tr("Record a timeline of what runs on which thread"));
+	m_act_record_trace->setCheckable(true);
+	m_act_record_trace->setChecked(Trace::isEnabled());
+	connect_or_die(m_act_record_trace, &QAction::toggled, this, &MainWindow::onRecordTrace);
+	addAction("record_trace", m_act_record_trace);
+
+	m_act_save_trace = make_action(Theme::iconFromTheme("document-save-as"), tr("Save Trace..."), this,
+									QKeySequence(), tr("Save the recorded timeline for chrome://tracing or ui.perfetto.dev"));
+	connect_trig(m_act_save_trace, this, &MainWindow::onSaveTrace);
+	addAction("save_trace", m_act_save_trace);
 }
 
 void MainWindow::createActionsSettings(KActionCollection *ac)
@@ -917,6 +956,9 @@ void MainWindow::createMenus()
 		 m_menu_tools->addSection("Rescans"),
 		 m_rescanLibraryAct,
 		 m_cancelRescanAct,
+		 m_menu_tools->addSection("Diagnostics"),
+		 m_act_record_trace,
+		 m_act_save_trace,
                 });
 
 	// Settings menu.
@@ -1534,6 +1576,35 @@ void MainWindow::readPreGUISettings()
 	/// @todo Add any readEntry()'s here.
 }
 
+namespace
+{
+	/// What readLibSettings() shares between the loading threads and the GUI thread.
+	struct LibraryLoadState
+	{
+		/// The LibraryEntries of each split run.  Each slot is written by one loading thread, and only read by the
+		/// GUI thread once it's been told the chunk it's in is done.
+		std::vector<std::vector<std::shared_ptr<LibraryEntry>>> m_runs;
+
+		/// @name GUI thread only.
+		/// @{
+		/// The model for each split run.
+		std::vector<QPointer<LibraryModel>> m_run_models;
+		/// How many of each run's entries have been appended to its model.
+		std::vector<std::size_t> m_run_num_appended;
+		/// Chunks which are done but can't be appended yet, since an earlier one in the same run isn't done.
+		/// Per run, first index -> count.
+		std::vector<std::map<std::size_t, std::size_t>> m_run_pending_chunks;
+		/// True for the runs whose libraries have journal records to replay.  Those are appended all at once,
+		/// after the replay.
+		std::vector<bool> m_run_needs_replay;
+		int m_num_replayed {0};
+		std::size_t m_num_entries {0};
+		std::size_t m_num_entries_loaded {0};
+		QPointer<QProgressBar> m_progress_bar;
+		/// @}
+	};
+}
+
 void MainWindow::readLibSettings()
 {
 	int num_libs;
@@ -1541,34 +1612,20 @@ void MainWindow::readLibSettings()
 
 	qIn() << "START readLibSettings";
 
-	// Throw up a progress dialog indicating that we're loading the database.
-	auto* prog = new QProgressDialog(tr("Opening database..."), tr("Abort open"), 0, 0, this);
-
-//	prog.setWindowModality(Qt::WindowModal);
-	prog->setValue(1);
-	prog->setValue(2);
-	prog->show();
-
-	// The primary database file.
-	/// @todo Get this from settings.
-	QString database_filename = QDir::homePath() + "/AMLMDatabase.xml";
-
-	qIn() << "Loading" << database_filename;
-
-	// Try to Load it asynchronously into a new model.
-	/// AMLM::Core::self()->getDefaultColumnSpecs()
-	auto exp_db_model = AMLM::Core::self()->getScanResultsTreeModel();
-    bool success = exp_db_model->LoadDatabase(database_filename);
-    if(success)
-    {
-		// qDb() << "Load succeeded";
-	}
-	else
-	{
-		qWr() << "Database load failed:" << database_filename;
-//				auto default_columnspecs = AMLM::Core::self()->getDefaultColumnSpecs();
-//				AMLM::Core::self()->getScanResultsTreeModel()->setColumnSpecs(default_columnspecs);
-	}
+	// Show the loading progress in the status bar, the library views open as soon as we know what they are and fill
+	// in as the entries are read.
+	auto state = std::make_shared<LibraryLoadState>();
+	state->m_progress_bar = new QProgressBar(statusBar());
+	state->m_progress_bar->setRange(0, 0);
+	state->m_progress_bar->setMaximumWidth(200);
+	statusBar()->addPermanentWidget(state->m_progress_bar);
+	statusBar()->showMessage(tr("Opening database..."));
+
+	// The collection tree is a view onto the CollectionStore, which the library models fill as they load and rescan.
+	// Update the files the store says have changed, the store coalesces those so this isn't per-entry.
+	connect_or_die(&CollectionStore::instance(), &CollectionStore::SIGNAL_changed, this, [](const QStringList& file_keys){
+		AMLM::Core::self()->getScanResultsTreeModel()->applyCollectionStoreChanges(CollectionStore::instance(), file_keys);
+	});
 
 	/// @todo The playlist
 	/// @todo Get this path from settings.
@@ -1576,65 +1633,154 @@ void MainWindow::readLibSettings()
 
 	dseq.expect_and_set(0,1);
 
-    auto extfuture_initial_lib_load = QtConcurrent::run([=](QPromise<SerializableQVariantList>& ef) {
-
-		qIn() << "READING XML DB FROM FILE:" << overlay_filename;
-		dseq.expect_and_set(1,2);
-		SerializableQVariantList list("library_list", "library_list_item");
-		Stopwatch library_list_read(tostdstr(QString("Loading: ") + overlay_filename));
-		XmlSerializer xmlser;
-		xmlser.set_default_namespace("http://xspf.org/ns/0/", "1");
-		/// @todo This takes ~10 secs at the moment with a 300MB XML file.
-		bool success = xmlser.load(list, QUrl::fromLocalFile(overlay_filename));
-    	qIn() << "Load of" << overlay_filename << "success: " << success;
-        ef.addResult(list);
-	})
-    .then(this, [this, overlay_filename, prog](QFuture<SerializableQVariantList> ef){
-    	dseq.expect_and_set(2, 3);
-		if(!ef.isValid())
+	// Pick up whatever changes were journaled after the snapshot was written.
+	m_lib_journal->open(LibraryJournal::readSnapshotSeq(overlay_filename));
+	m_lib_load_in_progress = true;
+
+	// GUI thread: create the models and open their views, with no entries yet.
+	auto create_models = [this, state, overlay_filename](const SerializableQVariantList& list, const std::vector<std::size_t>& run_sizes){
+		dseq.expect_and_set(2, 3);
+		qIn() << "###### READ" << list.size() << "libraries from XML DB:" << overlay_filename;
+
+		state->m_run_models.resize(run_sizes.size());
+		state->m_run_num_appended.resize(run_sizes.size(), 0);
+		state->m_run_pending_chunks.resize(run_sizes.size());
+		state->m_run_needs_replay.resize(run_sizes.size(), false);
+		state->m_num_entries = std::accumulate(run_sizes.cbegin(), run_sizes.cend(), std::size_t{0});
+		if(state->m_progress_bar)
 		{
-			qWr() << "XML Deserialization failed:" << overlay_filename;
-			return;
+			state->m_progress_bar->setRange(0, static_cast<int>(state->m_num_entries));
 		}
 
-		SerializableQVariantList list = ef.result();
-
-        qIn() << "###### READ" << list.size() << "libraries from XML DB:" << overlay_filename;
-
 		for(const auto& list_entry : list)
 		{
 			QVariant qv = list_entry;
 			Q_ASSERT(qv.isValid());
 			Q_ASSERT(!qv.isNull());
 
-			// Create a new LibraryModel and read contents into it.
+			// Create a new LibraryModel and read everything but the entries into it.
 			QPointer<LibraryModel> library_model = new LibraryModel(this);
+			std::optional<std::size_t> run_index = library_model->fromVariantSplit(qv);
+			const bool streamed = run_index && *run_index < state->m_run_models.size() && run_sizes[*run_index] > 0;
+			if(streamed)
 			{
-				Stopwatch sw("library_model-from-variant");
-				library_model->fromVariant(qv);
+				state->m_run_models[*run_index] = library_model;
+				state->m_run_needs_replay[*run_index] = m_lib_journal->hasReplayRecords(library_model->getLibRootDir());
+			}
+			else
+			{
+				// It already has everything it's getting from the snapshot, so bring it up to date now.
+				state->m_num_replayed += m_lib_journal->replay(library_model);
 			}
-
 			Q_ASSERT(library_model->getLibRootDir().isValid());
 
-			if(!library_model)
+			// Journal it from the start, so nothing which happens to it while it's loading is lost.  Nothing in the
+			// journal can happen to a row before it's appended, and rows are only ever appended at the end, so the
+			// rows of each record are the same as they will be once it's fully loaded.
+			m_lib_journal->attach(library_model);
+
+			MDIModelViewPair mvpair;
+			mvpair.appendModel(library_model);
+			mvpair.m_model_was_existing = false;
+
+			// Already in the snapshot and attached to the journal.
+			addChildMDIModelViewPair_Library(mvpair, false);
+			onShowLibrary(library_model);
+		}
+	};
+
+	// GUI thread: a chunk of entries is ready, append it and anything after it which was waiting on it.
+	auto append_chunk = [this, state](std::size_t run, std::size_t first_index, std::size_t count){
+		auto& pending = state->m_run_pending_chunks[run];
+		pending.emplace(first_index, count);
+
+		// These are all in the snapshot already.
+		LibraryJournal::ScopedPause pause(*m_lib_journal);
+
+		LibraryModel* library_model = state->m_run_models[run];
+		auto& entries = state->m_runs[run];
+		auto& num_appended = state->m_run_num_appended[run];
+		for(auto it = pending.begin(); it != pending.end() && it->first == num_appended; it = pending.erase(it))
+		{
+			if(library_model != nullptr && !state->m_run_needs_replay[run])
 			{
-				QMessageBox::critical(this, qApp->applicationDisplayName(), tr("Failed to open library"),
-									  QMessageBox::Ok);
+				std::vector<std::shared_ptr<LibraryEntry>> chunk(entries.begin() + it->first, entries.begin() + it->first + it->second);
+				library_model->appendRows(std::move(chunk));
 			}
-			else
-			{
-				MDIModelViewPair mvpair;
-				mvpair.appendModel(library_model);
-				mvpair.m_model_was_existing = false;
+			num_appended += it->second;
+			state->m_num_entries_loaded += it->second;
+		}
 
-				addChildMDIModelViewPair_Library(mvpair);
-                onShowLibrary(library_model);
+		if(state->m_run_needs_replay[run] && num_appended == entries.size())
+		{
+			// The whole library's in, bring it up to date with the journal before the model ever sees it.
+			state->m_run_needs_replay[run] = false;
+			if(library_model != nullptr)
+			{
+				state->m_num_replayed += m_lib_journal->replay(library_model->getLibRootDir(), &entries);
+				if(!entries.empty())
+				{
+					library_model->appendRows(std::move(entries));
+				}
 			}
 		}
+
+		if(state->m_progress_bar)
+		{
+			state->m_progress_bar->setValue(static_cast<int>(state->m_num_entries_loaded));
+		}
+	};
+
+	QPointer<MainWindow> self = this;
+    auto extfuture_initial_lib_load = AMLMExecutor::io().run([=](){
+
+		qIn() << "READING XML DB FROM FILE:" << overlay_filename;
+		dseq.expect_and_set(1,2);
+		SerializableQVariantList list("library_list", "library_list_item");
+		Stopwatch library_list_read(tostdstr(QString("Loading: ") + overlay_filename));
+		XmlSerializer xmlser;
+		xmlser.set_default_namespace("http://xspf.org/ns/0/", "1");
+		// The library entries are by far most of the file, and independent of each other, so split them out and
+		// read them on all cores, handing them to the models a chunk at a time as they're done.
+		// Everything handed to the GUI thread goes in order through its event queue, so the models are created before
+		// any entries show up, and the .then() below runs after the last of them.
+		bool success = xmlser.load_split(list, QUrl::fromLocalFile(overlay_filename), "library_entry",
+			[&](const std::vector<std::size_t>& run_sizes){
+				state->m_runs.resize(run_sizes.size());
+				for(std::size_t i = 0; i < run_sizes.size(); ++i)
+				{
+					state->m_runs[i].resize(run_sizes[i]);
+				}
+				QMetaObject::invokeMethod(self, [=](){ create_models(list, run_sizes); }, Qt::QueuedConnection);
+			},
+			[&](std::size_t run, std::size_t index, QByteArrayView item_xml){
+				// Only what the views need is read now, the full Metadata of each entry is deserialized the first time
+				// something asks for it.
+				state->m_runs[run][index] = LibraryEntry::fromXmlDeferred(item_xml);
+			},
+			[&](std::size_t run, std::size_t first_index, std::size_t count){
+				QMetaObject::invokeMethod(self, [=](){ append_chunk(run, first_index, count); }, Qt::QueuedConnection);
+			});
+    	qIn() << "Load of" << overlay_filename << "success: " << success;
+	})
+    .then(this, [this, overlay_filename, state](){
+		StartupProfiler::mark("Libraries loaded");
+
 		qIn() << "###### READ AND CONVERTED XML DB:" << overlay_filename;
 
-		prog->hide();
-		prog->deleteLater();
+		m_lib_load_in_progress = false;
+		if(state->m_num_replayed > 0 || std::exchange(m_lib_snapshot_deferred, false))
+		{
+			// Fold the replayed changes, and any libraries added while we were loading, into a new snapshot now.
+			writeLibSettings();
+		}
+
+		if(state->m_progress_bar)
+		{
+			statusBar()->removeWidget(state->m_progress_bar);
+			state->m_progress_bar->deleteLater();
+		}
+		statusBar()->showMessage(tr("Loaded %1 library entries").arg(state->m_num_entries_loaded), 5000);
 	});
 
 	// Set extfuture_initial_lib_load to the PerfectDeleter.
@@ -1652,8 +1798,14 @@ void MainWindow::writeSettings()
 //	settings.setValue("geometry", saveGeometry());
 //	settings.setValue("window_state", saveState());
 //	settings.endGroup();
-	// Write the open library settings.
-    writeLibSettings();
+	// The journal already has every library change but the last second's worth, and every library added or removed
+	// was snapshotted when that happened, so there's no need to write out the whole library here.  Just get the rest
+	// of the journal on disk, and let any compaction in progress finish.
+	if(m_lib_journal)
+	{
+		m_lib_journal->flush();
+	}
+	m_lib_settings_write_future.waitForFinished();
 	qDebug() << "writeSettings() end";
 }
 
@@ -1662,27 +1814,82 @@ void MainWindow::writeLibSettings()
 {
 	qDebug() << "writeLibSettings() start";
 
-	Stopwatch libsave_sw("writeLibSettings()");
-
 	QString database_filename = QDir::homePath() + "/AMLMDatabaseSerDes.xml";
 
+	if(m_lib_load_in_progress)
+	{
+		qIn() << "Libraries still loading, deferring the write of" << database_filename;
+		m_lib_snapshot_deferred = true;
+		return;
+	}
+
 	qIn() << "WRITING" << m_libmodels.size() << "libmodels to XML file:" << database_filename;
 
-	XmlSerializer xmlser;
-	xmlser.set_default_namespace("http://xspf.org/ns/0/", "1");
+	// Don't have two writes to the same file going at once.
+	m_lib_settings_write_future.waitForFinished();
 
-	SerializableQVariantList list("library_list", "library_list_item");
+	// Snapshot the libraries here in the GUI thread.  This is O(1) per library if it hasn't changed since the last
+	// write, and the models can keep changing while the snapshots are serialized below.
+	// Start a new journal at the same point, so the snapshots and the journal dovetail exactly.
+	const quint64 journal_seq = m_lib_journal->beginCompaction();
+	QPointer<LibraryJournal> journal = m_lib_journal;
+	std::vector<std::shared_ptr<const LibrarySnapshot>> snapshots;
+	snapshots.reserve(m_libmodels.size());
 	for(size_t i = 0; i < m_libmodels.size(); ++i)
 	{
 		// m_libmodels are pointers to QObject-derived, we need to push into the list manually.
         LibraryModel* lmp = qobject_cast<LibraryModel*>(m_libmodels[i]->getRootModel());
-		QVariant qv = lmp->toVariant();
-		list.push_back(qv);
+		snapshots.push_back(lmp->getLibrarySnapshot());
 	}
 
-	xmlser.save(list, QUrl::fromLocalFile(database_filename), "the_library_model_list");
+	const bool compress = AMLMSettings::compressDatabase();
+
+	m_lib_settings_write_future = AMLMExecutor::io().run([database_filename, snapshots = std::move(snapshots), journal, journal_seq, compress](){
+
+		Stopwatch libsave_sw("writeLibSettings()");
+
+		// Nobody's waiting on this, don't compete with the GUI.
+		const auto saved_priority = QThread::currentThread()->priority();
+		QThread::currentThread()->setPriority(QThread::LowPriority);
+
+		XmlSerializer xmlser;
+		xmlser.set_default_namespace("http://xspf.org/ns/0/", "1");
+		xmlser.set_compression(compress);
+
+		// Stream the snapshots straight out, in the same layout as saving a
+		// SerializableQVariantList("library_list", "library_list_item") of LibraryModel::toVariant()s would produce,
+		// but without ever building that QVariant tree.
+		bool saved = xmlser.save(QUrl::fromLocalFile(database_filename), [&](XmlStreamVisitor& visitor){
+			visitor.beginMap("the_library_model_list", {},
+					{{LibraryJournal::c_snapshot_seq_attr.toString().toStdString(), std::to_string(journal_seq)}});
+			visitor.beginList<SerializableQVariantList>("library_list");
+			for(const auto& snapshot : snapshots)
+			{
+				LibraryModel::toXmlStream(*snapshot, visitor, "library_list_item");
+			}
+			visitor.endElement();
+			visitor.endElement();
+		});
+
+		QThread::currentThread()->setPriority(saved_priority);
 
-	qIn() << "###### WROTE XML DB:" << database_filename;
+		if(!saved)
+		{
+			qWr() << "###### FAILED TO WRITE XML DB:" << database_filename << ", keeping the old journal";
+			return;
+		}
+		qIn() << "###### WROTE XML DB:" << database_filename;
+
+		QMetaObject::invokeMethod(qApp, [journal, journal_seq](){
+			if(journal)
+			{
+				journal->endCompaction(journal_seq);
+			}
+		});
+	});
+
+	// Make sure we don't exit with the write still in progress.
+	PerfectDeleter::instance().addQFuture(m_lib_settings_write_future);
 
 	qDebug() << "writeLibSettings() end";
 }
@@ -1787,6 +1994,39 @@ void MainWindow::onCancelRescan()
 	}
 }
 
+void MainWindow::onRecordTrace(bool record)
+{
+	if(record)
+	{
+		// Start a new recording.
+		Trace::clear();
+		Trace::enable();
+	}
+	else
+	{
+		Trace::disable();
+	}
+}
+
+void MainWindow::onSaveTrace()
+{
+	const QString file_path = QFileDialog::getSaveFileName(this, tr("Save Trace"), QStringLiteral("amlm_trace.json"),
+														   tr("Chrome trace files (*.json)"));
+	if(file_path.isEmpty())
+	{
+		return;
+	}
+
+	if(Trace::writeChromeTrace(file_path))
+	{
+		statusBar()->showMessage(tr("Trace saved"), 2000);
+	}
+	else
+	{
+		QMessageBox::warning(this, tr("Save Trace"), tr("Couldn't save the trace to %1.").arg(file_path));
+	}
+}
+
 void MainWindow::onShowLibrary(QPointer<LibraryModel> libmodel)
 {
 	// We'll just try to open the same URL as the libmodel, and let the "opening an existing view/model"
@@ -1985,7 +2225,7 @@ void MainWindow::addChildMDIView(MDITreeViewBase* child)
 	mdisubwindow->show();
 }
 
-void MainWindow::addChildMDIModelViewPair_Library(const MDIModelViewPair& mvpair)
+void MainWindow::addChildMDIModelViewPair_Library(const MDIModelViewPair& mvpair, bool journal_new_model)
 {
 	if(mvpair.hasView())
 	{
@@ -2037,6 +2277,14 @@ void MainWindow::addChildMDIModelViewPair_Library(const MDIModelViewPair& mvpair
 			*lmvpair = mvpair;
             m_libmodels.push_back(lmvpair);
 
+			if(journal_new_model)
+			{
+				// Journal all changes to it from here on.  The journal only replays into libraries which are in
+				// the snapshot, so write one with this library in it.
+				m_lib_journal->attach(libmodel);
+				writeLibSettings();
+			}
+
             /// @todo This needs cleanup.
 			dynamic_cast<CollectionStatsWidget*>(m_collection_stats_dock_widget->widget())->setModel(libmodel);
 
@@ -30,6 +30,7 @@
 // Qt
 #include <QComboBox>
 #include <QUrl>
+#include <QFuture>
 
 class ShuffleProxyModel;
 class LibrarySortFilterProxyModel;
@@ -91,6 +92,7 @@ class Experimental;
 class ExperimentalKDEView1;
 class SettingsDialog;
 class LibraryModel;
+class LibraryJournal;
 class PlaylistModel;
 
 class LibraryEntry;
@@ -201,6 +203,12 @@ public Q_SLOTS:
 
 	void onCancelRescan();
 
+	/// @name Trace actions.
+	/// @{
+	void onRecordTrace(bool record);
+	void onSaveTrace();
+	/// @}
+
     void startSettingsDialog();
 
     void onOpenShortcutDlg();
@@ -320,7 +328,11 @@ private:
     void newCollectionView();
 
 	void addChildMDIView(MDITreeViewBase* child);
-	void addChildMDIModelViewPair_Library(const MDIModelViewPair& mvpair);
+	/**
+	 * @param journal_new_model  If the model is new, start journaling its changes.  false for a model which is
+	 *                           still being loaded, it's attached to the journal once it's complete.
+	 */
+	void addChildMDIModelViewPair_Library(const MDIModelViewPair& mvpair, bool journal_new_model = true);
 	void addChildMDIModelViewPair_Playlist(const MDIModelViewPair& mvpair);
 	MDITreeViewBase* activeChildMDIView();
 
@@ -370,7 +382,12 @@ private:
  */
     void openWindows();
     void writeSettings();
-    /// Writes the Library settings to ${HOME}/AMLMDatabaseSerDes.xml (not a QSettings or KConfig settings file).
+    /**
+     * Writes the Library settings to ${HOME}/AMLMDatabaseSerDes.xml (not a QSettings or KConfig settings file).
+     * Only snapshotting the libraries happens in the GUI thread, the serialization and writing are done in the background.
+     * This is also the compaction of m_lib_journal, and is called when it says one is due.
+     * @see m_lib_settings_write_future.
+     */
     void writeLibSettings();
     /// Reads the Library settings from ${HOME}/AMLMDatabaseSerDes.xml (not a QSettings or KConfig settings file).
     void readLibSettings();
@@ -422,6 +439,17 @@ private:
     /// The library models.
     std::vector<MDIModelViewPair*> m_libmodels;
 
+    /// The in-flight background write started by the last writeLibSettings(), if any.
+    QFuture<void> m_lib_settings_write_future;
+
+    /// Journal of the library model changes since the last writeLibSettings().
+    QPointer<LibraryJournal> m_lib_journal;
+
+    /// True from readLibSettings() until the libraries are fully loaded and replayed.  A snapshot taken before then
+    /// would be missing entries, so writeLibSettings() only notes that one is wanted, in m_lib_snapshot_deferred.
+    bool m_lib_load_in_progress {false};
+    bool m_lib_snapshot_deferred {false};
+
 	QPointer<LibrarySortFilterProxyModel> m_libraryview_sort_filter_proxy_model;
 
 		/// @name The "Now Playing" playlist model and view.
@@ -490,6 +518,8 @@ private:
 	/// @{
 	QAction* m_rescanLibraryAct;
 	QAction* m_cancelRescanAct;
+	QAction* m_act_record_trace;
+	QAction* m_act_save_trace;
 	/// @}
 
 	/// @name Settings actions.
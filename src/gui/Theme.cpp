@@ -163,6 +163,54 @@ void Theme::initialize()
 {
     qIn() << "START Initializing Theme";
 
+    // The icon theme search paths etc. are only logged, and that takes a while, so that's done after startup,
+    // see LogStartupDiagnostics().
+
+    // Get all the QStyle styles we have available.
+    m_available_qstyles = QStyleFactory::keys();
+	// Get the current desktop style.
+	QString desktop_style = QApplication::style()->objectName();
+
+	if(AMLMSettings::widgetStyle().isEmpty())
+	{
+		// This is the first program start.
+		QStringList styles_to_ignore;
+		/// @note If we want to ignore any styles by name, this is where we'd list the names.
+//		styles_to_ignore << QStringLiteral("GTK+");
+
+		if(styles_to_ignore.contains(desktop_style, Qt::CaseInsensitive))
+		{
+			// We don't want/can't use the current desktop style.
+			qIn() << "Current desktop style \"" << desktop_style << "\" can't be used, looking for alternatives.";
+
+			// Is Breeze available?
+            if(m_available_qstyles.contains(QStringLiteral("breeze"), Qt::CaseInsensitive))
+			{
+				// Yes, use it.
+				qIn() << "Style Breeze available, using it.";
+				AMLMSettings::setWidgetStyle(QStringLiteral("Breeze"));
+			}
+            else if(m_available_qstyles.contains(QStringLiteral("fusion"), Qt::CaseInsensitive))
+			{
+				// Second choice is Fusion, use that.
+				qIn() << "Style \"Fusion\" available, using it.";
+				AMLMSettings::setWidgetStyle(QStringLiteral("Fusion"));
+			}
+		}
+		else
+		{
+			// Use the current default desktop widget style.
+            qIn() << "Using current desktop widget style:" << desktop_style;
+			AMLMSettings::setWidgetStyle(QStringLiteral("Default"));
+		}
+	}
+    qIn() << "END Initializing Theme";
+}
+
+void Theme::LogStartupDiagnostics()
+{
+    qIn() << "START Theme startup diagnostics";
+
     auto app_dir_path = QCoreApplication::applicationDirPath();
     qIn() << "App dir path:" << app_dir_path;
 
@@ -384,46 +432,7 @@ void Theme::initialize()
     QStringList retval = FindIconThemes();
     qIn() << "Discovered Icon Themes:" << retval;
 
-
-    // Get all the QStyle styles we have available.
-    m_available_qstyles = QStyleFactory::keys();
-	// Get the current desktop style.
-	QString desktop_style = QApplication::style()->objectName();
-
-	if(AMLMSettings::widgetStyle().isEmpty())
-	{
-		// This is the first program start.
-		QStringList styles_to_ignore;
-		/// @note If we want to ignore any styles by name, this is where we'd list the names.
-//		styles_to_ignore << QStringLiteral("GTK+");
-
-		if(styles_to_ignore.contains(desktop_style, Qt::CaseInsensitive))
-		{
-			// We don't want/can't use the current desktop style.
-			qIn() << "Current desktop style \"" << desktop_style << "\" can't be used, looking for alternatives.";
-
-			// Is Breeze available?
-            if(m_available_qstyles.contains(QStringLiteral("breeze"), Qt::CaseInsensitive))
-			{
-				// Yes, use it.
-				qIn() << "Style Breeze available, using it.";
-				AMLMSettings::setWidgetStyle(QStringLiteral("Breeze"));
-			}
-            else if(m_available_qstyles.contains(QStringLiteral("fusion"), Qt::CaseInsensitive))
-			{
-				// Second choice is Fusion, use that.
-				qIn() << "Style \"Fusion\" available, using it.";
-				AMLMSettings::setWidgetStyle(QStringLiteral("Fusion"));
-			}
-		}
-		else
-		{
-			// Use the current default desktop widget style.
-            qIn() << "Using current desktop widget style:" << desktop_style;
-			AMLMSettings::setWidgetStyle(QStringLiteral("Default"));
-		}
-	}
-    qIn() << "END Initializing Theme";
+    qIn() << "END Theme startup diagnostics";
 }
 
 QActionGroup* Theme::getWidgetStylesActionGroup(MainWindow *main_window)
@@ -44,6 +44,12 @@ public:
 
     static void initialize();
 
+	/**
+	 * Log the icon theme search paths, the icon themes we can find, etc.  Nothing depends on this, and it's slow enough
+	 * to notice, so it's deferred until after startup.
+	 */
+	static void LogStartupDiagnostics();
+
 	/**
 	 * Get a "Widget Styles" QActionGroup.
 	 */
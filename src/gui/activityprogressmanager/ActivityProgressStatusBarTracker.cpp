@@ -39,6 +39,9 @@
 #include "CumulativeStatusWidget.h"
 #include <gui/MainWindow.h>
 
+/// ~60 Hz.  No point updating the progress widgets faster than they can be displayed.
+static constexpr int c_progress_sample_interval_ms = 16;
+
 ActivityProgressStatusBarTracker::ActivityProgressStatusBarTracker(QWidget *parent) : BASE_CLASS(parent),
     m_tracked_job_state_mutex()
 {
@@ -80,6 +83,11 @@ ActivityProgressStatusBarTracker::ActivityProgressStatusBarTracker(QWidget *pare
     connect_or_die(this, &ActivityProgressStatusBarTracker::number_of_jobs_changed,
                    m_cumulative_status_widget, &CumulativeStatusWidget::slot_number_of_jobs_changed);
 
+	m_progress_sample_timer = new QTimer(this);
+	m_progress_sample_timer->setInterval(c_progress_sample_interval_ms);
+	m_progress_sample_timer->setTimerType(Qt::CoarseTimer);
+	connect_or_die(m_progress_sample_timer, &QTimer::timeout, this, &ActivityProgressStatusBarTracker::SLOT_sampleProgressCounters);
+
     // Make our internal signal->slot connections.
     make_internal_connections();
 }
@@ -210,6 +218,11 @@ void ActivityProgressStatusBarTracker::registerJob(KJob* kjob)
     // Emit a signal that a job has been added.
     Q_EMIT number_of_jobs_changed(m_amlmjob_to_widget_map.size());
 
+	if(!m_progress_sample_timer->isActive())
+	{
+		m_progress_sample_timer->start();
+	}
+
 //    qDb() << "REGISTERED JOB:" << kjob;
 //    dump_qobject(kjob);
 
@@ -231,18 +244,32 @@ void ActivityProgressStatusBarTracker::SLOT_onKJobDestroyed(QObject *kjob)
 {
     QMutexLocker locker(&m_tracked_job_state_mutex);
 
-    KJob* kjob_ptr = dynamic_cast<KJob*>(kjob);
+    // It's only a QObject by now, so this is only good for looking it up, not for calling anything on it.
+    KJob* kjob_ptr = static_cast<KJob*>(kjob);
 
     Q_CHECK_PTR(kjob_ptr);
 
     // Check if the job was destroyed prior to being unregistered.
-    if(m_amlmjob_to_widget_map.keys().contains(kjob_ptr))
+    if(m_amlmjob_to_widget_map.contains(kjob_ptr))
     {
         qWr() << "KJOB DESTROYED BEFORE BEING UNREGISTERED:" << kjob_ptr;
         unregisterJob(kjob_ptr);
     }
 }
 
+void ActivityProgressStatusBarTracker::SLOT_sampleProgressCounters()
+{
+	// Copy the keys out so the map isn't locked while the jobs emit their progress signals.
+	const auto jobs = m_amlmjob_to_widget_map.keys();
+	for(KJob* kjob : jobs)
+	{
+		if(auto amlmjob = qobject_cast<AMLMJob*>(kjob); amlmjob != nullptr)
+		{
+			amlmjob->sampleProgressCounter();
+		}
+	}
+}
+
 void ActivityProgressStatusBarTracker::SLOT_onShowProgressWidget(KJob* kjob)
 {
     QMutexLocker locker(&m_tracked_job_state_mutex);
@@ -274,20 +301,20 @@ void ActivityProgressStatusBarTracker::SLOT_CancelAllKJobs()
     qDb() << "CANCELLING ALL JOBS";
 
     //  Get a copy of the list of all the keys in the map, because composite jobs will delete subjobs.
-    QList<QPointer<KJob>> kjoblist = m_amlmjob_to_widget_map.keys();
+    QList<KJob*> kjoblist = m_amlmjob_to_widget_map.keys();
 
     qDb() << "CANCELLING ALL JOBS: Num KJobs:" << m_amlmjob_to_widget_map.size() << "List size:" << kjoblist.size();
 
-    for(const QPointer<KJob>& kjob : std::as_const(kjoblist))
+    for(KJob* kjob : std::as_const(kjoblist))
     {
-		if(kjob == nullptr || !m_amlmjob_to_widget_map.keys().contains(kjob))
+		if(!m_amlmjob_to_widget_map.contains(kjob))
         {
             // No such KJob anymore.
             continue;
         }
 		if(kjob->capabilities() & KJob::Killable)
         {
-            qIno() << "Killing KJob:" << kjob.data();
+            qIno() << "Killing KJob:" << kjob;
             // Synchronous call of KJob::kill().
             /// @todo Don't know if we want EmitResult here or not.
             kjob->kill(KJob::EmitResult);
@@ -565,15 +592,13 @@ void ActivityProgressStatusBarTracker::make_connections_with_newly_registered_jo
 
 void ActivityProgressStatusBarTracker::INTERNAL_unregisterJob(KJob *kjob)
 {
-    QPointer<KJob> kjob_qp(kjob);
-
-// M_WARNING("Could KJob* already be finished and autoDeleted here?");
-    Q_CHECK_PTR(kjob_qp);
+    // No QPointer<KJob> here, this is also called from SLOT_onKJobDestroyed(), and a QPointer can't be made to an object
+    // which is being destroyed.
+    Q_CHECK_PTR(kjob);
 
-    qIno() << "UNREGISTERING JOB:" << kjob_qp.data();
+    qIno() << "UNREGISTERING JOB:" << kjob;
 
     Q_CHECK_PTR(this);
-    Q_CHECK_PTR(kjob_qp);
 
     // KAbstractWidgetJobTracker::unregisterJob() calls:
     //   KJobTrackerInterface::unregisterJob(job);, which calls:
@@ -581,23 +606,21 @@ void ActivityProgressStatusBarTracker::INTERNAL_unregisterJob(KJob *kjob)
 
     // Call down to the base class first.
     // A number of examples, including KDevelop, do this first like this.
-    BASE_CLASS::unregisterJob(kjob_qp);
-
-    Q_CHECK_PTR(kjob_qp);
+    BASE_CLASS::unregisterJob(kjob);
 
-    qIno() << "SIGNALS DISCONNECTED:" << kjob_qp.data();
+    qIno() << "SIGNALS DISCONNECTED:" << kjob;
 
     // If kjob was never registered, something's broken.
-    AMLM_ASSERT_EQ(m_amlmjob_to_widget_map.keys().contains(kjob_qp), true);
+    AMLM_ASSERT_EQ(m_amlmjob_to_widget_map.contains(kjob), true);
 
     // Get ptr to the widget, if any.
-    auto w = m_amlmjob_to_widget_map.value(kjob_qp, nullptr);
+    auto w = m_amlmjob_to_widget_map.value(kjob, nullptr);
 
     qDb() << "REMOVING FROM MAP:" << kjob << w.data();
     if(w == nullptr)
     {
         qWro() << "KJob" << kjob << "was registered but has no widget.";
-        m_amlmjob_to_widget_map.remove(kjob_qp);
+        m_amlmjob_to_widget_map.remove(kjob);
     }
     else
     {
@@ -605,7 +628,7 @@ void ActivityProgressStatusBarTracker::INTERNAL_unregisterJob(KJob *kjob)
         m_expanding_frame_widget->removeWidget(w);
         m_expanding_frame_widget->reposition();
 		// Remove this job from the map, which will remove its widget.
-        m_amlmjob_to_widget_map.remove(kjob_qp);
+        m_amlmjob_to_widget_map.remove(kjob);
         w->deleteLater();
     }
 
@@ -619,11 +642,14 @@ void ActivityProgressStatusBarTracker::INTERNAL_unregisterJob(KJob *kjob)
 //        w->deleteLater();
 //        });
 
-    Q_CHECK_PTR(kjob_qp);
-
     Q_EMIT number_of_jobs_changed(m_amlmjob_to_widget_map.size());
 
-    qDb() << "JOB UNREGISTERED:" << kjob_qp.data();
+	if(m_amlmjob_to_widget_map.size() == 0)
+	{
+		m_progress_sample_timer->stop();
+	}
+
+    qDb() << "JOB UNREGISTERED:" << kjob;
 }
 
 int ActivityProgressStatusBarTracker::calculate_summary_percent()
@@ -633,8 +659,13 @@ int ActivityProgressStatusBarTracker::calculate_summary_percent()
     long long total_jobs = 0;
     long long cumulative_completion_pct = 0;
     m_amlmjob_to_widget_map.for_each_key_value_pair([&](KJob* job, BaseActivityProgressStatusBarWidget* widget) {
-        // We do the total_jobs++ in here vs. a .size() outside this loop because in here we have
-        // the map locked, so the numbers will be consistent.
+        // We do the total_jobs++ in here vs. a .size() outside this loop because we're iterating over
+        // a snapshot of the map, so the numbers will be consistent.
+        if(!m_amlmjob_to_widget_map.contains(job))
+        {
+            // Unregistered since the snapshot, it may be gone.
+            return;
+        }
         total_jobs += 1;
         cumulative_completion_pct += job->percent();
         ;});
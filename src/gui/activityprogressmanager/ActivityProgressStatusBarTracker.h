@@ -27,6 +27,7 @@ class QWidget;
 class QLabel;
 class QToolButton;
 class QProgressBar;
+class QTimer;
 #include <QTime>
 #include <QMap>
 #include <QPointer>
@@ -52,7 +53,9 @@ class BaseActivityProgressStatusBarWidget;
 class ActivityProgressStatusBarTracker;
 using ActivityProgressStatusBarTrackerPtr = ActivityProgressStatusBarTracker*;
 
-using TSActiveActivitiesMap = ThreadsafeMap<QPointer<KJob>, QPointer<BaseActivityProgressStatusBarWidget>>;
+/// Keyed by KJob*, not QPointer<KJob>: a QPointer goes null when its job's destroyed, before SLOT_onKJobDestroyed()
+/// gets to remove it.  Only dereference the keys of jobs which are still in the map.
+using TSActiveActivitiesMap = ThreadsafeMap<KJob*, QPointer<BaseActivityProgressStatusBarWidget>>;
 
 
 /**
@@ -298,6 +301,9 @@ protected Q_SLOTS:
     /// Slot to display the progress widget for @a kjob.
     void SLOT_onShowProgressWidget(KJob *kjob);
 
+	/// Connected to m_progress_sample_timer.  Passes on the progress of every job reporting through a ProgressCounter.
+	void SLOT_sampleProgressCounters();
+
     /**
      * Connections/signal/slots notes
      *
@@ -550,6 +556,9 @@ protected: // Variable members
     /// Showable/hidable window containing all sub-trackers.
     QPointer<ExpandingFrameWidget> m_expanding_frame_widget {nullptr};
 
+	/// Samples the jobs' ProgressCounters at display refresh rate.  Only runs while there are jobs registered.
+	QTimer* m_progress_sample_timer {nullptr};
+
 private:
     Q_DISABLE_COPY(ActivityProgressStatusBarTracker)
 
@@ -37,6 +37,7 @@
 #include <utils/RegisterQtMetatypes.h>
 #include <utils/DebugHelpers.h>
 #include <logic/serialization/SerializationHelpers.h>
+#include <logic/serialization/XmlStreamVisitor.h>
 
 
 AMLM_QREG_CALLBACK([](){
@@ -229,6 +230,27 @@ QVariant AMLMTagMap::toVariant() const
 	return list;
 }
 
+void AMLMTagMap::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	// Same layout as toVariant(): a list of {key, list of values} maps.
+	visitor.beginList(node_name);
+
+	for(const auto& key : keys())
+	{
+		visitor.beginMap("entry");
+		visitor.writeField("key", toqstr(key));
+		visitor.beginList("values");
+		for(const auto& value : equal_range_vector(key))
+		{
+			visitor.writeField("value", toqstr(value));
+		}
+		visitor.endElement();
+		visitor.endElement();
+	}
+
+	visitor.endElement();
+}
+
 void AMLMTagMap::fromVariant(const QVariant& variant)
 {
 	clear();
@@ -212,6 +212,7 @@ public:
 	QTH_FRIEND_QDATASTREAM_OPS(AMLMTagMap);
 	QVariant toVariant() const override;
 	void fromVariant(const QVariant& variant) override;
+	void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const override;
 	/// @}
 
 	/// @name Debug
@@ -0,0 +1,358 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file CollectionStore.cpp
+/// Implementation of CollectionStore.
+
+#include "CollectionStore.h"
+
+// Std C++
+#include <algorithm>
+#include <mutex>
+
+// Ours
+#include <utils/DebugHelpers.h>
+#include "LibraryEntry.h"
+
+
+/// How long to collect changes for before emitting SIGNAL_changed().
+static constexpr int f_change_coalesce_ms = 1000;
+
+namespace
+{
+	/// True if @a a and @a b are the same track of the same file.
+	bool is_same_track(const LibraryEntry& a, const LibraryEntry& b)
+	{
+		return a.getTrackNumber() == b.getTrackNumber()
+			&& a.isSubtrack() == b.isSubtrack()
+			&& a.get_offset_frames() == b.get_offset_frames();
+	}
+}
+
+CollectionStore& CollectionStore::instance(QObject* parent)
+{
+	// Unlike the other app singletons, don't insist on a parent, models get created in unit tests without an app.
+	static CollectionStore* m_the_instance = new CollectionStore(parent);
+
+	Q_ASSERT(parent == nullptr || parent == m_the_instance->parent());
+
+	return *m_the_instance;
+}
+
+CollectionStore::CollectionStore(QObject* parent) : QObject(parent)
+{
+	setObjectName("CollectionStore");
+
+	m_change_timer.setSingleShot(true);
+	m_change_timer.setInterval(f_change_coalesce_ms);
+	connect(&m_change_timer, &QTimer::timeout, this, &CollectionStore::flushChanges);
+}
+
+CollectionStore::~CollectionStore()
+{
+}
+
+QString CollectionStore::fileKey(const QUrl& url)
+{
+	return url.adjusted(QUrl::NormalizePathSegments).toString();
+}
+
+std::vector<std::shared_ptr<LibraryEntry>> CollectionStore::intern(std::vector<std::shared_ptr<LibraryEntry>> entries, InternMode mode)
+{
+	{
+		std::unique_lock write_lock(m_mutex);
+		for(auto& entry : entries)
+		{
+			TSI_intern(entry, mode);
+		}
+	}
+	return entries;
+}
+
+std::shared_ptr<LibraryEntry> CollectionStore::intern(std::shared_ptr<LibraryEntry> entry, InternMode mode)
+{
+	{
+		std::unique_lock write_lock(m_mutex);
+		TSI_intern(entry, mode);
+	}
+	return entry;
+}
+
+void CollectionStore::TSI_intern(std::shared_ptr<LibraryEntry>& entry, InternMode mode)
+{
+	if(!entry || !entry->getUrl().isValid())
+	{
+		return;
+	}
+
+	const QString key = fileKey(entry->getUrl());
+	FileRecord& record = m_files[key];
+	if(record.m_url.isEmpty())
+	{
+		record.m_url = entry->getUrl();
+	}
+	record.m_had_entries = true;
+
+	std::erase_if(record.m_entries, [](const std::weak_ptr<LibraryEntry>& weak_entry){ return weak_entry.expired(); });
+
+	for(auto& weak_entry : record.m_entries)
+	{
+		std::shared_ptr<LibraryEntry> existing = weak_entry.lock();
+		if(existing == entry)
+		{
+			// Already have it.
+			return;
+		}
+		if(entry->isPopulated() && existing->isPopulated() && is_same_track(*existing, *entry))
+		{
+			if(mode == InternMode::PreferExisting)
+			{
+				entry = existing;
+			}
+			else
+			{
+				// Anybody else still holding the old one gets told to swap this one in.
+				weak_entry = entry;
+				m_pending_replacements.emplace_back(std::move(existing), entry);
+				TSI_changed(key);
+			}
+			return;
+		}
+	}
+
+	if(entry->isPopulated())
+	{
+		// Any placeholder for the file is superseded.
+		std::erase_if(record.m_entries, [](const std::weak_ptr<LibraryEntry>& weak_entry){
+			auto existing = weak_entry.lock();
+			return !existing || !existing->isPopulated();
+		});
+	}
+	record.m_entries.push_back(entry);
+	TSI_changed(key);
+}
+
+bool CollectionStore::TSI_isCurrent(const FileRecord& record, const LibraryEntry& entry)
+{
+	if(!record.m_dsr)
+	{
+		// Never scanned this session, so we don't know what the file looks like now.
+		return false;
+	}
+	const ExtUrl& scanned = record.m_dsr->getMediaExtUrl();
+	return entry.isPopulatedFrom(scanned.m_file_size_bytes, scanned.m_last_modified_timestamp);
+}
+
+std::vector<std::shared_ptr<LibraryEntry>> CollectionStore::populatedEntries(const QUrl& url) const
+{
+	std::vector<std::shared_ptr<LibraryEntry>> retval;
+
+	std::shared_lock read_lock(m_mutex);
+
+	auto it = m_files.constFind(fileKey(url));
+	if(it == m_files.cend())
+	{
+		return retval;
+	}
+	for(const auto& weak_entry : it->m_entries)
+	{
+		auto entry = weak_entry.lock();
+		if(!entry || !entry->isPopulated())
+		{
+			continue;
+		}
+		if(!TSI_isCurrent(*it, *entry))
+		{
+			// Some of what we have is out of date, so all of it might be, e.g. the number of tracks.  Read it again.
+			return {};
+		}
+		retval.push_back(std::move(entry));
+	}
+	std::sort(retval.begin(), retval.end(), [](const auto& a, const auto& b){ return a->getTrackNumber() < b->getTrackNumber(); });
+
+	return retval;
+}
+
+bool CollectionStore::isCurrent(const LibraryEntry& entry) const
+{
+	std::shared_lock read_lock(m_mutex);
+
+	auto it = m_files.constFind(fileKey(entry.getUrl()));
+	return it != m_files.cend() && TSI_isCurrent(*it, entry);
+}
+
+void CollectionStore::refreshPopulatedFrom(LibraryEntry& existing, const LibraryEntry& reread)
+{
+	std::unique_lock write_lock(m_mutex);
+	existing.setPopulatedFrom(reread);
+}
+
+void CollectionStore::addScanResult(const DirScanResult& dsr)
+{
+	const QUrl url(dsr.getMediaExtUrl());
+	const QString key = fileKey(url);
+
+	std::unique_lock write_lock(m_mutex);
+
+	FileRecord& record = m_files[key];
+	if(record.m_url.isEmpty())
+	{
+		record.m_url = url;
+	}
+	if(record.m_dsr && record.m_dsr->isSameScanAs(dsr))
+	{
+		// A rescan which found the file as it was.
+		return;
+	}
+	record.m_dsr = dsr;
+	TSI_changed(key);
+}
+
+void CollectionStore::entriesReleased()
+{
+	m_prune_pending = true;
+	scheduleFlush();
+}
+
+std::optional<CollectionStore::FileView> CollectionStore::file(const QString& file_key) const
+{
+	std::shared_lock read_lock(m_mutex);
+
+	auto it = m_files.constFind(file_key);
+	if(it == m_files.cend())
+	{
+		return std::nullopt;
+	}
+
+	FileView file_view;
+	for(const auto& weak_entry : it->m_entries)
+	{
+		if(auto entry = weak_entry.lock())
+		{
+			file_view.m_entries.push_back(std::move(entry));
+		}
+	}
+	if(file_view.m_entries.empty())
+	{
+		// No library has it anymore.
+		return std::nullopt;
+	}
+	file_view.m_key = it.key();
+	// Files which came from a saved library rather than this session's scan only have their URL.
+	file_view.m_dsr = it->m_dsr.value_or(DirScanResult(it->m_url));
+	return file_view;
+}
+
+std::vector<CollectionStore::FileView> CollectionStore::files() const
+{
+	std::vector<FileView> retval;
+
+	std::shared_lock read_lock(m_mutex);
+
+	retval.reserve(m_files.size());
+	for(auto it = m_files.cbegin(); it != m_files.cend(); ++it)
+	{
+		FileView file_view;
+		for(const auto& weak_entry : it->m_entries)
+		{
+			if(auto entry = weak_entry.lock())
+			{
+				file_view.m_entries.push_back(std::move(entry));
+			}
+		}
+		if(file_view.m_entries.empty())
+		{
+			// No library has it anymore.
+			continue;
+		}
+		file_view.m_key = it.key();
+		file_view.m_dsr = it->m_dsr.value_or(DirScanResult(it->m_url));
+		retval.push_back(std::move(file_view));
+	}
+
+	return retval;
+}
+
+qsizetype CollectionStore::numFileRecords() const
+{
+	std::shared_lock read_lock(m_mutex);
+	return m_files.size();
+}
+
+void CollectionStore::flushChanges()
+{
+	m_change_timer.stop();
+	m_flush_pending = false;
+
+	QStringList changed_keys;
+	Replacements replacements;
+	{
+		std::unique_lock write_lock(m_mutex);
+
+		if(m_prune_pending.exchange(false))
+		{
+			TSI_prune();
+		}
+		changed_keys = QStringList(m_changed_keys.cbegin(), m_changed_keys.cend());
+		m_changed_keys.clear();
+		replacements.swap(m_pending_replacements);
+	}
+
+	// Replacements first, so the views of SIGNAL_changed() see the new entries in the models too.
+	if(!replacements.empty())
+	{
+		Q_EMIT SIGNAL_entriesReplaced(replacements);
+	}
+	if(!changed_keys.isEmpty())
+	{
+		Q_EMIT SIGNAL_changed(changed_keys);
+	}
+}
+
+void CollectionStore::TSI_prune()
+{
+	for(auto it = m_files.begin(); it != m_files.end(); )
+	{
+		std::erase_if(it->m_entries, [](const std::weak_ptr<LibraryEntry>& weak_entry){ return weak_entry.expired(); });
+		if(it->m_entries.empty() && it->m_had_entries)
+		{
+			m_changed_keys.insert(it.key());
+			it = m_files.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void CollectionStore::TSI_changed(const QString& file_key)
+{
+	m_changed_keys.insert(file_key);
+	scheduleFlush();
+}
+
+void CollectionStore::scheduleFlush()
+{
+	if(!m_flush_pending.exchange(true))
+	{
+		// Timers have to be started from their own thread.
+		QMetaObject::invokeMethod(this, [this](){ m_change_timer.start(); }, Qt::QueuedConnection);
+	}
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_LOGIC_COLLECTIONSTORE_H_
+#define SRC_LOGIC_COLLECTIONSTORE_H_
+
+/// @file CollectionStore.h
+/// Interface of CollectionStore, the one in-memory record of every media file in the collection.
+
+// Std C++
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QUrl>
+
+// Ours
+#include <future/guideline_helpers.h>
+#include "DirScanResult.h"
+class LibraryEntry;
+
+
+/**
+ * The single in-memory store of the media files in the collection, keyed by file identity (the normalized file URL).
+ *
+ * The LibraryModels and the ScanResultsTreeModel are views onto this:
+ * - A directory scan records each file it finds here once, with addScanResult().
+ * - LibraryModels intern() their LibraryEntry's here as they're added, loaded or re-populated, so a file which is in
+ *   more than one library is one set of LibraryEntry's, and a file whose metadata has already been read, and which
+ *   hasn't changed since, isn't read again.
+ * - The ScanResultsTreeModel follows the files which SIGNAL_changed() reports, rather than being scanned, saved and
+ *   loaded on its own.
+ *
+ * The store only holds weak references to the entries, it's the models which own them.  A file's record goes away when
+ * the last model holding its entries lets go and tells the store with entriesReleased().
+ *
+ * LibraryEntry's are never modified once they're shared, a changed entry is a new LibraryEntry which replaces the old
+ * one.  When one model replaces a shared entry (InternMode::Replace), the store tells the other models holding the old
+ * one with SIGNAL_entriesReplaced().
+ *
+ * All members are threadsafe, the signals are emitted in the store's thread.
+ */
+class CollectionStore : public QObject
+{
+	Q_OBJECT
+
+public:
+	/// Old entry, and the entry which replaced it.
+	using Replacements = std::vector<std::pair<std::shared_ptr<LibraryEntry>, std::shared_ptr<LibraryEntry>>>;
+
+Q_SIGNALS:
+	/**
+	 * The files with fileKey()s @a file_keys have been added to, changed in or dropped from the store since the last
+	 * emission.  Coalesced, emitted at most about once a second.  Use file() to find out what they are now.
+	 */
+	void SIGNAL_changed(const QStringList& file_keys);
+
+	/**
+	 * Shared entries have been replaced by newer ones, e.g. by a rescan or an edit in one of the libraries.  Models
+	 * which hold any of the old entries should swap in the new ones.  Emitted just before SIGNAL_changed().
+	 */
+	void SIGNAL_entriesReplaced(const CollectionStore::Replacements& replacements);
+
+public:
+	explicit CollectionStore(QObject* parent = nullptr);
+	~CollectionStore() override;
+	M_GH_POLYMORPHIC_SUPPRESS_COPYING_C67(CollectionStore)
+
+	/// The first call creates the store, parented to @a parent.  AMLMApp::Init() makes that call.
+	static CollectionStore& instance(QObject* parent = nullptr);
+
+	/// How intern() treats an entry for a track the store already has a populated entry for.
+	enum class InternMode
+	{
+		/// Use the store's entry instead, e.g. when loading a library.
+		PreferExisting,
+		/// The new entry supersedes the store's, e.g. it's the result of a rescan.
+		Replace
+	};
+
+	/**
+	 * Record @a entries in the store.
+	 * @returns The entries the caller should hold on to, in the same order.  With InternMode::PreferExisting, entries
+	 *          for tracks the store already has a populated entry for are replaced by that entry.
+	 */
+	std::vector<std::shared_ptr<LibraryEntry>> intern(std::vector<std::shared_ptr<LibraryEntry>> entries, InternMode mode);
+	std::shared_ptr<LibraryEntry> intern(std::shared_ptr<LibraryEntry> entry, InternMode mode);
+
+	/**
+	 * The populated entries the store has for the file at @a url, in track order, if they were read from the file as the
+	 * last addScanResult() for it found it, i.e. it hasn't changed since.
+	 * Empty if the file isn't in the store, its metadata hasn't been read yet, or it may have changed since it was.
+	 */
+	std::vector<std::shared_ptr<LibraryEntry>> populatedEntries(const QUrl& url) const;
+
+	/// True if @a entry is populated and was read from its file as the last addScanResult() for it found it.
+	bool isCurrent(const LibraryEntry& entry) const;
+
+	/**
+	 * For a rescan which re-read @a existing's file and got @a reread, with the same content: @a existing is kept, it's
+	 * just marked current with the file as @a reread was read from it.  Nothing's signaled, nothing visible changed.
+	 */
+	void refreshPopulatedFrom(LibraryEntry& existing, const LibraryEntry& reread);
+
+	/**
+	 * Record what a directory scan found out about a file, including its current size and last-modified time.
+	 * Only signaled if it's not what the last scan found.
+	 */
+	void addScanResult(const DirScanResult& dsr);
+
+	/**
+	 * Let the store know that a model has let go of some entries, so it can drop its records of any files nobody
+	 * holds entries for anymore.  That happens with the next SIGNAL_changed().
+	 */
+	void entriesReleased();
+
+	struct FileView
+	{
+		/// The file's fileKey().
+		QString m_key;
+		DirScanResult m_dsr;
+		std::vector<std::shared_ptr<LibraryEntry>> m_entries;
+	};
+
+	/// The file with fileKey() @a file_key, or std::nullopt if no library holds any entries for it.
+	std::optional<FileView> file(const QString& file_key) const;
+
+	/// All the files in the store with at least one live entry, in no particular order.
+	std::vector<FileView> files() const;
+
+	/// The number of files the store has records of, including ones it hasn't dropped yet.
+	qsizetype numFileRecords() const;
+
+	/// Drop what's been released and emit the signals for what's changed now, instead of waiting.  Store's thread only.
+	void flushChanges();
+
+	/// The key the store uses for @a url.
+	static QString fileKey(const QUrl& url);
+
+private:
+	struct FileRecord
+	{
+		QUrl m_url;
+		std::optional<DirScanResult> m_dsr;
+		std::vector<std::weak_ptr<LibraryEntry>> m_entries;
+		/// Whether any entries have ever been interned for the file.  A record which only has a scan result so far
+		/// is waiting for the model to add the file, not abandoned.
+		bool m_had_entries {false};
+	};
+
+	/// Must be called with m_mutex held for writing.
+	void TSI_intern(std::shared_ptr<LibraryEntry>& entry, InternMode mode);
+
+	/// Same, is @a entry current for @a record.
+	static bool TSI_isCurrent(const FileRecord& record, const LibraryEntry& entry);
+
+	/// Must be called with m_mutex held for writing.  Drop expired entries, and records with none left.
+	void TSI_prune();
+
+	/// Note that the file with key @a file_key has changed, and schedule SIGNAL_changed().  Must be called with m_mutex
+	/// held for writing.
+	void TSI_changed(const QString& file_key);
+
+	/// Have flushChanges() called soon, from any thread.
+	void scheduleFlush();
+
+	mutable std::shared_mutex m_mutex;
+	QHash<QString, FileRecord> m_files;
+	/// Keys of the files changed since the last SIGNAL_changed().
+	QSet<QString> m_changed_keys;
+	/// Replacements since the last SIGNAL_entriesReplaced().
+	Replacements m_pending_replacements;
+
+	std::atomic<bool> m_flush_pending {false};
+	std::atomic<bool> m_prune_pending {false};
+	QTimer m_change_timer;
+};
+
+#endif /* SRC_LOGIC_COLLECTIONSTORE_H_ */
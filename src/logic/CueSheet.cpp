@@ -50,6 +50,7 @@ extern "C" {
 // Ours
 #include "TrackMetadata.h"  ///< Per-track cue sheet info
 #include <logic/serialization/SerializationHelpers.h>
+#include <logic/serialization/XmlStreamVisitor.h>
 #include <future/string_ops.h>
 
 
@@ -345,6 +346,30 @@ QVariant CueSheet::toVariant() const
 	return map;
 }
 
+void CueSheet::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	// Keep this in sync with toVariant().
+	visitor.beginMap(node_name, QMetaType::fromType<CueSheet>().name());
+
+	// CD-level fields.
+#define X(field_tag, member_field) visitor.writeField(field_tag, member_field);
+    M_SERDES_FIELDS_GENERAL(X)
+    M_DATASTREAM_FIELDS_DISC(X)
+#undef X
+
+	// Track-level fields.
+	AMLM_WARNIF(m_tracks.size() != m_disc_num_tracks && m_tracks.size() != 1);
+
+	visitor.beginList(XMLTAG_TRACK_METADATA);
+	for(const auto& it : m_tracks)
+	{
+		it.second.toXmlStream(visitor, "track");
+	}
+	visitor.endElement();
+
+	visitor.endElement();
+}
+
 void CueSheet::fromVariant(const QVariant& variant)
 {
 	InsertionOrderedMap<QString, QVariant> map;
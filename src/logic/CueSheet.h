@@ -167,6 +167,7 @@ public:
 	/// @{
 	QVariant toVariant() const override;
 	void fromVariant(const QVariant& variant) override;
+	void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const override;
 	/// @}
 
 	/// Equality operator
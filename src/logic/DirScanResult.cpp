@@ -36,7 +36,10 @@
 // Ours
 // #include "models/ScanResultsTreeModel.h"
 #include <utils/EnumFlagHelpers.h>
+#include <utils/StringHelpers.h>
 #include <logic/serialization/SerializationHelpers.h>
+#include <logic/serialization/XmlStreamReadVisitor.h>
+#include <logic/serialization/XmlStreamVisitor.h>
 
 
 AMLM_QREG_CALLBACK([](){
@@ -53,6 +56,52 @@ DirScanResult::DirScanResult(const QUrl &found_url, const QFileInfo &found_url_f
 	determineDirProps(found_url_finfo);
 }
 
+DirScanResult::DirScanResult(const QUrl& found_url)
+{
+	// Assign rather than construct, the ExtUrl constructor stats the file.
+	m_exturl_media = found_url;
+}
+
+DirScanResult::DirScanResult(const QUrl& found_url, const QFileInfo& found_url_finfo, const ExtUrl& dir_exturl,
+							 bool has_sidecar_cuesheet)
+	: m_exturl_dir_url(dir_exturl), m_exturl_media(found_url, &found_url_finfo)
+{
+	m_has_sidecar_cuesheet = has_sidecar_cuesheet;
+	if(has_sidecar_cuesheet)
+	{
+		m_exturl_cuesheet = ExtUrl(sidecarCuesheetUrlFor(found_url));
+		m_flags_dirprops |= HasSidecarCueSheet;
+	}
+}
+
+bool DirScanResult::isSameScanAs(const DirScanResult& other) const
+{
+	// Everything but the ExtUrls' m_timestamp_last_refresh, which is when they were found.
+	auto same_file = [](const ExtUrl& a, const ExtUrl& b){
+		return a.m_url == b.m_url
+			&& a.m_file_size_bytes == b.m_file_size_bytes
+			&& a.m_creation_timestamp == b.m_creation_timestamp
+			&& a.m_last_modified_timestamp == b.m_last_modified_timestamp
+			&& a.m_metadata_last_modified_timestamp == b.m_metadata_last_modified_timestamp;
+	};
+	return m_flags_dirprops == other.m_flags_dirprops
+		&& m_has_sidecar_cuesheet == other.m_has_sidecar_cuesheet
+		&& m_has_embedded_cuesheet == other.m_has_embedded_cuesheet
+		&& m_single_album == other.m_single_album
+		&& same_file(m_exturl_media, other.m_exturl_media)
+		&& same_file(m_exturl_dir_url, other.m_exturl_dir_url)
+		&& same_file(m_exturl_cuesheet, other.m_exturl_cuesheet);
+}
+
+QUrl DirScanResult::sidecarCuesheetUrlFor(const QUrl& media_url)
+{
+	QString cue_url_as_str = media_url.toString();
+	Q_ASSERT(!cue_url_as_str.isEmpty());
+	static const QRegularExpression re("\\.[[:alnum:]]+$");
+	cue_url_as_str.replace(re, ".cue");
+	return QUrl(cue_url_as_str);
+}
+
 #define M_DATASTREAM_FIELDS(X) \
 	X(XMLTAG_FLAGS_DIRPROPS, m_flags_dirprops) \
 	X(XMLTAG_HAS_SIDECAR_CUESHEET, m_has_sidecar_cuesheet) \
@@ -66,6 +115,8 @@ DirScanResult::DirScanResult(const QUrl &found_url, const QFileInfo &found_url_f
 	M_DATASTREAM_FIELDS(X);
 #undef X
 
+M_DEFINE_FIELD_REFLECTION(DirScanResult, M_DATASTREAM_FIELDS)
+
 QVariant DirScanResult::toVariant() const
 {
 	InsertionOrderedMap<QString, QVariant> map;
@@ -94,6 +145,17 @@ void DirScanResult::fromVariant(const QVariant& variant)
 #undef X
 }
 
+void DirScanResult::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	visitor.writeReflected(node_name, *this, {}, {{"xml:id", get_prefixed_uuid()}});
+}
+
+void DirScanResult::fromXmlStream(XmlStreamReadVisitor& visitor)
+{
+	set_prefixed_uuid(tostdstr(visitor.attribute("xml:id")));
+	visitor.readReflected(*this);
+}
+
 void DirScanResult::determineDirProps(const QFileInfo &found_url_finfo)
 {
     // Separate out just the directory part of the URL.
@@ -106,12 +168,7 @@ void DirScanResult::determineDirProps(const QFileInfo &found_url_finfo)
 
 	// Create the URL the *.cue file would have.
 	ExtUrl possible_cue_url;
-	possible_cue_url = QUrl(m_exturl_media);
-	QString cue_url_as_str = possible_cue_url.m_url.toString();
-    Q_ASSERT(!cue_url_as_str.isEmpty());
-    static QRegularExpression re("\\.[[:alnum:]]+$");
-    cue_url_as_str.replace(re, ".cue");
-    possible_cue_url = cue_url_as_str;
+	possible_cue_url = sidecarCuesheetUrlFor(QUrl(m_exturl_media));
 	Q_ASSERT(possible_cue_url.m_url.isValid());
 
 	// Does the possible cue sheet file actually exist?
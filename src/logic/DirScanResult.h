@@ -40,6 +40,7 @@
 #include "ExtUrl.h"
 #include <logic/models/AbstractTreeModelItem.h>
 #include <logic/serialization/ISerializable.h>
+#include <logic/serialization/FieldReflection.h>
 #include <future/guideline_helpers.h>
 
 class CollectionMedium;
@@ -56,6 +57,7 @@ class ScanResultsTreeModelItem;
 class DirScanResult : public ISerializable
 {
 	Q_GADGET // Needed for DirProp enum below.
+	M_FIELD_REFLECTION_FRIEND
 
 public:
 	/// @name Public default and copy constructors and destructor needed for Q_DECLARE_METATYPE().
@@ -66,6 +68,14 @@ public:
 
     /// Constructor for public consumption.
 	explicit DirScanResult(const QUrl& found_url, const QFileInfo& found_url_finfo);
+	/// Just the media file URL, without looking at the filesystem.  The dir props are Unknown.
+	explicit DirScanResult(const QUrl& found_url);
+	/**
+	 * For a file in a directory which has already been looked at, e.g. one a DirSummary says hasn't changed: only
+	 * the file itself (@a found_url_finfo) is stat()ed, the directory and whether there's a sidecar cue sheet are as given.
+	 */
+	explicit DirScanResult(const QUrl& found_url, const QFileInfo& found_url_finfo, const ExtUrl& dir_exturl,
+						   bool has_sidecar_cuesheet);
 
 	friend class CollectionMedium;
 
@@ -108,11 +118,19 @@ public:
     /// Returned URL will not be valid if there was no sidecar cue sheet.
 	const ExtUrl& getSidecarCuesheetExtUrl() const { return m_exturl_cuesheet; }
 
+	/// True if @a other found the same files, dir props, sizes and modification times as this.  When they were found doesn't matter.
+	bool isSameScanAs(const DirScanResult& other) const;
+
+	/// The URL a sidecar cue sheet for the media file at @a media_url would have.
+	static QUrl sidecarCuesheetUrlFor(const QUrl& media_url);
+
 	/// @name Serialization
 	/// @{
 
 	QVariant toVariant() const override;
 	void fromVariant(const QVariant& variant) override;
+	void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const override;
+	void fromXmlStream(XmlStreamReadVisitor& visitor) override;
 
 	/// @}
 
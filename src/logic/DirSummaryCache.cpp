@@ -0,0 +1,236 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file DirSummaryCache.cpp
+/// Implementation of DirSummaryCache.
+
+#include "DirSummaryCache.h"
+
+// Std C++
+#include <array>
+
+// Qt
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStorageInfo>
+
+#if defined(Q_OS_UNIX)
+#include <sys/stat.h>
+#endif
+
+// Ours
+#include <utils/DebugHelpers.h>
+
+
+namespace
+{
+	constexpr quint32 c_cache_file_magic = 0x414d4453; // "AMDS"
+	/// Bump this whenever DirSummary or the hash changes, old files are then ignored.
+	constexpr quint32 c_cache_file_version = 2;
+
+	constexpr quint64 c_fnv_offset_basis = 14695981039346656037ULL;
+	constexpr quint64 c_fnv_prime = 1099511628211ULL;
+
+	quint64 fnv1a(quint64 hash, const void* data, std::size_t size)
+	{
+		const auto* bytes = static_cast<const unsigned char*>(data);
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= c_fnv_prime;
+		}
+		return hash;
+	}
+}
+
+// Outside the anonymous namespace so QHash's stream operators can find them.
+static QDataStream& operator<<(QDataStream& out, const DirSummary& summary)
+{
+	return out << summary.m_mtime_ns << summary.m_inode << summary.m_num_entries << summary.m_children_hash
+		<< summary.m_files << summary.m_files_with_sidecar_cuesheet << summary.m_subdirs << summary.m_scanned_at_ns;
+}
+
+static QDataStream& operator>>(QDataStream& in, DirSummary& summary)
+{
+	return in >> summary.m_mtime_ns >> summary.m_inode >> summary.m_num_entries >> summary.m_children_hash
+		>> summary.m_files >> summary.m_files_with_sidecar_cuesheet >> summary.m_subdirs >> summary.m_scanned_at_ns;
+}
+
+quint64 dir_summary_hash_child(quint64 hash, const QString& name, qint64 size, qint64 mtime_ms)
+{
+	if(hash == 0)
+	{
+		hash = c_fnv_offset_basis;
+	}
+	hash = fnv1a(hash, name.constData(), name.size() * sizeof(QChar));
+	// Separator, so ("ab", 1) and ("a", ...) can't run together.
+	hash = fnv1a(hash, "\0", 1);
+	hash = fnv1a(hash, &size, sizeof(size));
+	hash = fnv1a(hash, &mtime_ms, sizeof(mtime_ms));
+	return hash;
+}
+
+std::optional<DirStat> DirStat::of(const QString& path)
+{
+#if defined(Q_OS_UNIX)
+	struct stat st {};
+	if(::stat(QFile::encodeName(path).constData(), &st) != 0)
+	{
+		return std::nullopt;
+	}
+	DirStat retval;
+#if defined(Q_OS_DARWIN)
+	retval.m_mtime_ns = qint64(st.st_mtimespec.tv_sec) * 1'000'000'000 + st.st_mtimespec.tv_nsec;
+#else
+	retval.m_mtime_ns = qint64(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+#endif
+	retval.m_inode = st.st_ino;
+	return retval;
+#else
+	// No inode, the mtime alone will have to do.
+	QFileInfo finfo(path);
+	if(!finfo.exists())
+	{
+		return std::nullopt;
+	}
+	DirStat retval;
+	retval.m_mtime_ns = finfo.lastModified().toMSecsSinceEpoch() * 1'000'000;
+	return retval;
+#endif
+}
+
+DirSummaryCache::DirSummaryCache(const QUrl& root_url) : m_root_url(root_url)
+{
+}
+
+QString DirSummaryCache::cacheFileFor(const QUrl& root_url)
+{
+	const QByteArray root_hash = QCryptographicHash::hash(root_url.toString(QUrl::FullyEncoded).toUtf8(),
+														  QCryptographicHash::Sha1).toHex();
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+			+ QStringLiteral("/dirsummaries/") + QString::fromLatin1(root_hash) + QStringLiteral(".dat");
+}
+
+bool DirSummaryCache::hasUnreliableDirMtimes(const QUrl& root_url)
+{
+	const QByteArray fs_type = QStorageInfo(root_url.toLocalFile()).fileSystemType();
+
+	static constexpr std::array c_unreliable_fs_types {"nfs", "nfs4", "cifs", "smb3", "smbfs", "9p", "vboxsf",
+													   "davfs", "afs"};
+	for(const char* unreliable : c_unreliable_fs_types)
+	{
+		if(fs_type == unreliable)
+		{
+			return true;
+		}
+	}
+	// FUSE filesystems are whatever the userspace side makes of them.  fuseblk is the local-disk kind, e.g. ntfs-3g.
+	return fs_type.startsWith("fuse.");
+}
+
+bool DirSummaryCache::load()
+{
+	m_summaries.clear();
+
+	QFile file(cacheFileFor(m_root_url));
+	if(!file.exists())
+	{
+		return false;
+	}
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		qWr() << "Couldn't open directory summaries" << file.fileName() << ":" << file.errorString();
+		return false;
+	}
+
+	QDataStream in(&file);
+	quint32 magic = 0;
+	quint32 version = 0;
+	QString root;
+	in >> magic >> version;
+	if(magic != c_cache_file_magic || version != c_cache_file_version)
+	{
+		qIn() << "Ignoring old or unrecognized directory summaries:" << file.fileName();
+		return false;
+	}
+	in.setVersion(QDataStream::Qt_6_0);
+	in >> root >> m_summaries;
+	if(in.status() != QDataStream::Ok || root != m_root_url.toString())
+	{
+		qWr() << "Ignoring corrupt directory summaries:" << file.fileName();
+		m_summaries.clear();
+		return false;
+	}
+	return true;
+}
+
+bool DirSummaryCache::save() const
+{
+	const QString filename = cacheFileFor(m_root_url);
+	if(!QDir().mkpath(QFileInfo(filename).absolutePath()))
+	{
+		qWr() << "Couldn't create directory summary cache dir for" << filename;
+		return false;
+	}
+
+	QSaveFile file(filename);
+	if(!file.open(QIODevice::WriteOnly))
+	{
+		qWr() << "Couldn't write directory summaries" << filename << ":" << file.errorString();
+		return false;
+	}
+	QDataStream out(&file);
+	out << c_cache_file_magic << c_cache_file_version;
+	out.setVersion(QDataStream::Qt_6_0);
+	out << m_root_url.toString() << m_summaries;
+	return file.commit();
+}
+
+const DirSummary* DirSummaryCache::find(const QString& dir_path) const
+{
+	auto it = m_summaries.constFind(dir_path);
+	return it == m_summaries.cend() ? nullptr : &it.value();
+}
+
+bool DirSummaryCache::isUnchanged(const DirSummary& summary, const DirStat& current)
+{
+	if(summary.m_mtime_ns != current.m_mtime_ns || summary.m_inode != current.m_inode)
+	{
+		return false;
+	}
+	// If the directory was modified right around the time it was listed, something could have been added after the
+	// listing without the mtime visibly changing.  Don't trust it, list it again, and next time it'll be settled.
+	return current.m_mtime_ns + c_racy_window_ns < summary.m_scanned_at_ns;
+}
+
+void DirSummaryCache::record(const QString& dir_path, DirSummary summary)
+{
+	m_recorded.insert(dir_path, std::move(summary));
+}
+
+void DirSummaryCache::commitRecorded()
+{
+	m_summaries = std::move(m_recorded);
+	m_recorded.clear();
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_LOGIC_DIRSUMMARYCACHE_H_
+#define SRC_LOGIC_DIRSUMMARYCACHE_H_
+
+/// @file DirSummaryCache.h
+/// Interface of DirSummaryCache, the per-directory summaries which let a rescan skip unchanged directories.
+
+// Std C++
+#include <optional>
+
+// Qt
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+
+// Ours
+#include <future/guideline_helpers.h>
+
+
+/**
+ * What a directory looked like the last time it was scanned, enough to tell if it's changed since.
+ */
+struct DirSummary
+{
+	/// @name The directory's own metadata.
+	/// @{
+	qint64 m_mtime_ns {0};
+	quint64 m_inode {0};
+	/// @}
+
+	/// Number of entries the scan listed, i.e. matching files plus subdirectories.
+	quint32 m_num_entries {0};
+	/// Hash over the listed children's (name, size, mtime), in name order.
+	quint64 m_children_hash {0};
+
+	/// Names of the matching media files in the directory.
+	QStringList m_files;
+	/// The ones of m_files which have a sidecar cue sheet.  Adding or removing one changes the directory's mtime too.
+	QStringList m_files_with_sidecar_cuesheet;
+	/// Names of the subdirectories.
+	QStringList m_subdirs;
+
+	/// Wall-clock time the directory was listed, to catch changes made in the same mtime tick as the listing.
+	qint64 m_scanned_at_ns {0};
+};
+
+/**
+ * The directory metadata a scan compares against a DirSummary.
+ */
+struct DirStat
+{
+	qint64 m_mtime_ns {0};
+	quint64 m_inode {0};
+
+	/// stat() @a path.  Returns nullopt if it can't be stat()ed.
+	static std::optional<DirStat> of(const QString& path);
+};
+
+/**
+ * The DirSummary's of every directory under one scan root, persisted in the cache directory between runs.
+ *
+ * Not threadsafe, it's meant to be loaded, used and saved by the one thread doing the scan.
+ */
+class DirSummaryCache
+{
+public:
+	M_GH_RULE_OF_FIVE_DEFAULT_C21(DirSummaryCache)
+
+	/**
+	 * How much a rescan relies on the summaries.
+	 */
+	enum class Mode
+	{
+		/// Don't use or keep summaries, list and stat everything.
+		Off,
+		/// List and stat everything, and compare each directory's children against its summary.  Doesn't skip
+		/// anything, but is safe on filesystems which don't keep directory mtimes up to date, and keeps the
+		/// summaries current.
+		Verify,
+		/// A directory whose own mtime and inode haven't changed isn't listed again, its files are taken from the
+		/// summary.  Its subdirectories are still stat()ed, since changes in them don't touch its mtime.
+		TrustDirMtime
+	};
+
+	/// How close a directory's mtime can be to when it was listed before the summary isn't trusted.
+	/// Covers coarse (e.g. FAT's 2 s) mtime granularity.
+	static constexpr qint64 c_racy_window_ns = 2'000'000'000;
+
+	explicit DirSummaryCache(const QUrl& root_url);
+
+	/// Where the summaries for @a root_url are kept.
+	static QString cacheFileFor(const QUrl& root_url);
+
+	/**
+	 * True if the filesystem @a root_url is on is known to not reliably update directory mtimes, e.g. network and FUSE
+	 * filesystems.  Mode::TrustDirMtime is downgraded to Mode::Verify for these.
+	 */
+	static bool hasUnreliableDirMtimes(const QUrl& root_url);
+
+	/// Load the summaries from cacheFileFor().  A missing, old or corrupt file just means an empty cache.
+	bool load();
+	/// Save the summaries to cacheFileFor(), atomically.
+	bool save() const;
+
+	/// The summary of @a dir_path from the last scan, or nullptr if there isn't one.
+	const DirSummary* find(const QString& dir_path) const;
+
+	/**
+	 * True if @a summary can stand in for listing a directory whose current metadata is @a current: its mtime and
+	 * inode are the same, and its mtime was safely before it was listed.
+	 */
+	static bool isUnchanged(const DirSummary& summary, const DirStat& current);
+
+	/// Record the summary of a directory seen by this scan.
+	void record(const QString& dir_path, DirSummary summary);
+
+	/// Replace the summaries with the ones record()ed by this scan, dropping those of directories which have gone.
+	/// Only call this if the scan covered the whole tree, i.e. it wasn't canceled.
+	void commitRecorded();
+
+	/// Number of summaries from the last scan.
+	qsizetype size() const { return m_summaries.size(); }
+
+private:
+	QUrl m_root_url;
+
+	/// Summaries from the last scan, keyed by absolute directory path.
+	QHash<QString, DirSummary> m_summaries;
+
+	/// Summaries recorded by this scan.
+	QHash<QString, DirSummary> m_recorded;
+};
+
+/// Incrementally hash one listed child of a directory into @a hash, FNV-1a.  Stable across runs and Qt versions.
+quint64 dir_summary_hash_child(quint64 hash, const QString& name, qint64 size, qint64 mtime_ms);
+
+#endif /* SRC_LOGIC_DIRSUMMARYCACHE_H_ */
@@ -32,6 +32,8 @@
 // Ours
 #include <utils/DebugHelpers.h>
 #include <logic/serialization/SerializationHelpers.h>
+#include <logic/serialization/XmlStreamReadVisitor.h>
+#include <logic/serialization/XmlStreamVisitor.h>
 
 
 AMLM_QREG_CALLBACK([](){
@@ -59,6 +61,8 @@ ExtUrl::ExtUrl(const QUrl& qurl, const QFileInfo* qurl_finfo) : m_url(qurl)
 	M_DATASTREAM_FIELDS(X);
 #undef X
 
+M_DEFINE_FIELD_REFLECTION(ExtUrl, M_DATASTREAM_FIELDS)
+
 QVariant ExtUrl::toVariant() const
 {
 	InsertionOrderedMap<QString, QVariant> map;
@@ -84,6 +88,17 @@ void ExtUrl::fromVariant(const QVariant& variant)
 #undef X
 }
 
+void ExtUrl::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	// Same class info as toVariant()'s set_map_class_info().
+	visitor.writeReflected(node_name, *this, QMetaType::fromType<ExtUrl>().name());
+}
+
+void ExtUrl::fromXmlStream(XmlStreamReadVisitor& visitor)
+{
+	visitor.readReflected(*this);
+}
+
 void ExtUrl::save_mod_info(const QFileInfo* qurl_finfo)
 {
 	Q_CHECK_PTR(qurl_finfo);
@@ -35,6 +35,7 @@ class QFileInfo;
 #include <utils/QtHelpers.h>
 #include <logic/serialization/XmlObjects.h>
 #include <logic/serialization/ISerializable.h>
+#include <logic/serialization/FieldReflection.h>
 
 
 #if 0 // FileInfo
@@ -80,6 +81,7 @@ Q_DECLARE_METATYPE(FileModificationInfo);
 class ExtUrl : public ISerializable
 {
 	Q_GADGET
+	M_FIELD_REFLECTION_FRIEND
 
 public:
 	ExtUrl() = default;
@@ -160,6 +162,8 @@ public:
 
 	QVariant toVariant() const override;
 	void fromVariant(const QVariant& variant) override;
+	void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const override;
+	void fromXmlStream(XmlStreamReadVisitor& visitor) override;
 
 	QTH_FRIEND_QDATASTREAM_OPS(ExtUrl);
 
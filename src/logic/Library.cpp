@@ -19,6 +19,10 @@
 
 #include "Library.h"
 
+// Std C++
+#include <algorithm>
+#include <optional>
+
 // Qt
 #include <QDateTime>
 #include <QDebug>
@@ -30,6 +34,8 @@
 #include <future/preproc.h>
 #include <utils/Stopwatch.h>
 #include <logic/serialization/SerializationHelpers.h>
+#include <logic/serialization/XmlStreamVisitor.h>
+#include <logic/serialization/XmlSerializer.h>
 
 AMLM_QREG_CALLBACK([](){
 	qIn() << "Registering Library";
@@ -41,8 +47,12 @@ void Library::clear()
 {
 	m_root_url = QUrl();
 	m_lib_entries.clear();
+	m_lib_entry_ids.clear();
+	m_id_to_row_map.clear();
+	m_row_shifts.clear();
 	m_num_unpopulated = 0;
 	m_num_populated = 0;
+	invalidateSnapshot();
 	///discovered_metadata_keys = []
 }
 
@@ -62,11 +72,18 @@ QString Library::getLibraryName() const
 
 void Library::addNewEntries(std::vector<std::shared_ptr<LibraryEntry>> entries)
 {
+	m_lib_entries.reserve(m_lib_entries.size() + entries.size());
+	m_lib_entry_ids.reserve(m_lib_entry_ids.size() + entries.size());
 	for(auto& e : entries)
 	{
+		// Appends don't move any existing rows, so no shift to log.
+		const UUIncD id = UUIncD::create();
+		m_id_to_row_map.emplace(id, IdRow{m_lib_entries.size(), m_row_shifts.size()});
+		m_lib_entry_ids.push_back(id);
 		m_lib_entries.push_back(e);
 		addingEntry(e.get());
 	}
+	invalidateSnapshot();
 }
 
 void Library::removeRow(int row)
@@ -92,6 +109,18 @@ void Library::removeRows(int row, int count)
 
 	// erase the entries.
 	m_lib_entries.erase(first, last_plus_one);
+	for(auto i = row; i < row+count; ++i)
+	{
+		m_id_to_row_map.erase(m_lib_entry_ids[i]);
+	}
+	m_lib_entry_ids.erase(m_lib_entry_ids.begin() + row, m_lib_entry_ids.begin() + row + count);
+
+	if(row < static_cast<int>(m_lib_entry_ids.size()))
+	{
+		logRowShift(row + count, -count);
+	}
+	// else they were the last rows, nothing moved.
+	invalidateSnapshot();
 }
 
 void Library::insertEntry(int row, std::shared_ptr<LibraryEntry> entry)
@@ -100,6 +129,13 @@ void Library::insertEntry(int row, std::shared_ptr<LibraryEntry> entry)
 	auto it = m_lib_entries.begin();
 	std::advance(it, row);
 	m_lib_entries.insert(it, entry);
+	const UUIncD id = UUIncD::create();
+	m_lib_entry_ids.insert(m_lib_entry_ids.begin() + row, id);
+
+	logRowShift(row, 1);
+	// After the shift, so it isn't applied to the new row.
+	m_id_to_row_map.emplace(id, IdRow{static_cast<size_t>(row), m_row_shifts.size()});
+	invalidateSnapshot();
 }
 
 void Library::replaceEntry(int row, std::shared_ptr<LibraryEntry> entry)
@@ -110,6 +146,7 @@ void Library::replaceEntry(int row, std::shared_ptr<LibraryEntry> entry)
 	addingEntry(entry.get());
 	m_lib_entries[row] = entry;
 	removingEntry(old_entry.get());
+	invalidateSnapshot();
 	//delete old_entry;
 }
 
@@ -118,6 +155,70 @@ std::shared_ptr<LibraryEntry> Library::operator[](size_t index) const
 	return m_lib_entries.at(index);
 }
 
+UUIncD Library::getIdAt(size_t row) const
+{
+	return m_lib_entry_ids.at(row);
+}
+
+int Library::getRowFromId(UUIncD id) const
+{
+	auto it = m_id_to_row_map.find(id);
+	if(it == m_id_to_row_map.end())
+	{
+		// Removed, or never was.
+		return -1;
+	}
+
+	// Apply the shifts since this ID was last resolved.
+	IdRow& id_row = it->second;
+	for(size_t i = id_row.m_num_shifts_applied; i < m_row_shifts.size(); ++i)
+	{
+		if(id_row.m_row >= m_row_shifts[i].m_first_row)
+		{
+			id_row.m_row += m_row_shifts[i].m_delta;
+		}
+	}
+	id_row.m_num_shifts_applied = m_row_shifts.size();
+
+	AMLM_ASSERT_EQ(m_lib_entry_ids.at(id_row.m_row), id);
+	return static_cast<int>(id_row.m_row);
+}
+
+void Library::logRowShift(size_t first_row, std::ptrdiff_t delta)
+{
+	m_row_shifts.push_back({first_row, delta});
+	if(m_row_shifts.size() > c_max_row_shifts)
+	{
+		rebuildIdMap();
+	}
+}
+
+void Library::rebuildIdMap() const
+{
+	m_row_shifts.clear();
+	m_id_to_row_map.clear();
+	m_id_to_row_map.reserve(m_lib_entry_ids.size());
+	for(size_t row = 0; row < m_lib_entry_ids.size(); ++row)
+	{
+		m_id_to_row_map.emplace(m_lib_entry_ids[row], IdRow{row, 0});
+	}
+}
+
+
+std::shared_ptr<const LibrarySnapshot> Library::snapshot() const
+{
+	if(!m_snapshot)
+	{
+		auto new_snapshot = std::make_shared<LibrarySnapshot>();
+		new_snapshot->m_root_url = m_root_url;
+		new_snapshot->m_num_unpopulated = m_num_unpopulated;
+		new_snapshot->m_num_populated = m_num_populated;
+		new_snapshot->m_lib_entries.assign(m_lib_entries.cbegin(), m_lib_entries.cend());
+		new_snapshot->m_lib_entry_ids = m_lib_entry_ids;
+		m_snapshot = std::move(new_snapshot);
+	}
+	return m_snapshot;
+}
 
 bool Library::areAllEntriesFullyPopulated() const
 {
@@ -166,34 +267,78 @@ static const strviw_type XMLTAG_NUM_LIBRARY_ENTRIES("num_lib_entries");
 
 
 QVariant Library::toVariant() const
+{
+	return toVariant(*snapshot());
+}
+
+// static
+QVariant Library::toVariant(const LibrarySnapshot& snapshot)
 {
 	InsertionOrderedMap<QString, QVariant> map;
 
-#define X(field_tag, member_field)   map_insert_or_die(map, field_tag, member_field);
+	// The snapshot has the same member names as the Library.
+#define X(field_tag, member_field)   map_insert_or_die(map, field_tag, snapshot.member_field);
 	M_DATASTREAM_FIELDS(X);
 #undef X
 
 	// Write some derived info re: the Library.
 	map_insert_or_die(map, XMLTAG_WRITE_TIMESTAMP_MS, QDateTime::currentMSecsSinceEpoch());
 	map_insert_or_die(map, XMLTAG_WRITE_TIMESTAMP_UTC, QDateTime::currentDateTimeUtc());
-	map_insert_or_die(map, XMLTAG_NUM_LIBRARY_ENTRIES, static_cast<qint64>(m_lib_entries.size()));
-	if(!m_lib_entries.empty())
+	map_insert_or_die(map, XMLTAG_NUM_LIBRARY_ENTRIES, static_cast<qint64>(snapshot.m_lib_entries.size()));
+	if(!snapshot.m_lib_entries.empty())
 	{
 		// Serialize the LibraryEntry's into an ordered list.
 		QVariantHomogenousList list("m_lib_entries", "library_entry");
 
 		// ... in parallel, at least somewhat.
-		list_blocking_map_reduce_push_back_or_die(list, m_lib_entries);
+		list_blocking_map_reduce_push_back_or_die(list, snapshot.m_lib_entries);
 
 		map_insert_or_die(map, XMLTAG_LIBRARY_ENTRIES, list);
 	}
 
-qDb() << "EXIT, wrote:" << m_lib_entries.size() << "libentries";
+qDb() << "EXIT, wrote:" << snapshot.m_lib_entries.size() << "libentries";
 
 	return map;
 }
 
+void Library::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	toXmlStream(*snapshot(), visitor, node_name);
+}
+
+// static
+void Library::toXmlStream(const LibrarySnapshot& snapshot, XmlStreamVisitor& visitor, const QString& node_name)
+{
+	// Keep this in sync with toVariant().
+	visitor.beginMap(node_name);
+
+#define X(field_tag, member_field)   visitor.writeField(field_tag, snapshot.member_field);
+	M_DATASTREAM_FIELDS(X);
+#undef X
+
+	visitor.writeField(XMLTAG_WRITE_TIMESTAMP_MS, QDateTime::currentMSecsSinceEpoch());
+	visitor.writeField(XMLTAG_WRITE_TIMESTAMP_UTC, QDateTime::currentDateTimeUtc());
+	visitor.writeField(XMLTAG_NUM_LIBRARY_ENTRIES, static_cast<qint64>(snapshot.m_lib_entries.size()));
+	if(!snapshot.m_lib_entries.empty())
+	{
+		// One entry at a time, so only one entry's worth of anything is ever in memory.
+		visitor.beginList(XMLTAG_LIBRARY_ENTRIES);
+		for(const auto& entry : snapshot.m_lib_entries)
+		{
+			entry->toXmlStream(visitor, "library_entry");
+		}
+		visitor.endElement();
+	}
+
+	visitor.endElement();
+}
+
 void Library::fromVariant(const QVariant& variant)
+{
+	fromVariantSplit(variant);
+}
+
+std::optional<std::size_t> Library::fromVariantSplit(const QVariant& variant)
 {
 	Stopwatch sw("################### Library::fromVariant()");
 
@@ -216,10 +361,27 @@ void Library::fromVariant(const QVariant& variant)
 	QVariantHomogenousList list("m_lib_entries", "library_entry");
 	list = qvar_list.value<QVariantHomogenousList>();
 
+	std::optional<std::size_t> run_index = XmlSerializer::split_run_index(list);
+	if(run_index)
+	{
+		// The entries are being loaded separately, and will come in through addNewEntries().
+		return run_index;
+	}
+
 	// Concurrency.  Vs. the loop we used to have here, we went from 2.x secs to 0.5 secs.
 	list_blocking_map_reduce_read_all_entries_or_warn(list, &m_lib_entries);
 
+	// IDs are runtime-only, hand out a fresh one for each entry.
+	m_lib_entry_ids.resize(m_lib_entries.size());
+	for(auto& id : m_lib_entry_ids)
+	{
+		id = UUIncD::create();
+	}
+	rebuildIdMap();
+
 	AMLM_WARNIF(m_lib_entries.size() != num_lib_entries);
+
+	return std::nullopt;
 }
 
 void Library::addingEntry(const LibraryEntry* entry)
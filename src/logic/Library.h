@@ -23,7 +23,11 @@
 /// @file
 
 // Std C++
+#include <memory>
+#include <optional>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 // Qt
 #include <QUrl>
@@ -32,9 +36,28 @@
 #include <logic/serialization/ISerializable.h>
 
 #include "LibraryEntry.h"
+#include <logic/UUIncD.h>
 
 class QFileDevice;
 
+/**
+ * Immutable point-in-time view of a Library, safe to hand to and walk from any thread.
+ * The LibraryEntry's are shared with the Library they came from.  That's only safe as long as nothing modifies an
+ * entry once it's in a Library.  LibraryEntry itself doesn't enforce that, populate(), refresh_metadata() and
+ * setMetadata() all modify in place, so everything which calls them (the rescanner and the entry loader) does so on
+ * a copy, and the copy is swapped in with replaceEntry().  Deferred Metadata is filled in on first use under a
+ * std::call_once, which is safe.
+ */
+struct LibrarySnapshot
+{
+	QUrl m_root_url;
+	qint64 m_num_unpopulated {0};
+	qint64 m_num_populated {0};
+	std::vector<std::shared_ptr<const LibraryEntry>> m_lib_entries;
+	/// Parallel to m_lib_entries.
+	std::vector<UUIncD> m_lib_entry_ids;
+};
+
 class Library final : public ISerializable
 {
 	Q_GADGET
@@ -43,7 +66,7 @@ public:
 	~Library() override = default;
 
 	void clear();
-	void setRootUrl(const QUrl& url) { m_root_url = url; }
+	void setRootUrl(const QUrl& url) { m_root_url = url; invalidateSnapshot(); }
 	QUrl getRootUrl() const { return m_root_url; }
 	QString getLibraryName() const;
 
@@ -55,6 +78,43 @@ public:
 
 	std::shared_ptr<LibraryEntry> operator[](size_t index) const;
 
+	/// The number of rows.
+	std::size_t size() const { return m_lib_entries.size(); }
+	bool empty() const { return m_lib_entries.empty(); }
+	/// Unchecked operator[], for the model's hot paths.
+	LibraryEntry* entryAt(std::size_t row) const { return m_lib_entries[row].get(); }
+
+	/// @name Stable entry IDs.
+	/// Each row is assigned a UUIncD when it's added to the Library.  The ID follows the row through
+	/// inserts and removes of other rows, and survives replaceEntry(), so async results can be addressed
+	/// by ID and only resolved to a row when they're applied.
+	/// @{
+
+	/// Returns the UUIncD of the entry at @a row.
+	UUIncD getIdAt(size_t row) const;
+
+	/**
+	 * Returns the current row of the entry with UUIncD @a id, or -1 if there is no such entry
+	 * (e.g. it's been removed since the ID was handed out).
+	 * Inserts and removes don't touch the id-to-row map, they log a row shift, and a lookup applies the shifts
+	 * logged since that ID's row was last resolved.  So it's O(shifts since then), at most c_max_row_shifts.
+	 */
+	int getRowFromId(UUIncD id) const;
+
+	/// Row shifts logged before the id-to-row map is brought fully up to date and the log is cleared.
+	static constexpr std::size_t c_max_row_shifts = 256;
+
+	/// @}
+
+	/**
+	 * Returns an immutable snapshot of the current state of this Library.
+	 * Must be called from the thread which owns the Library, but the returned snapshot can then be walked
+	 * from any thread without any locking, while the Library continues to be modified.
+	 * O(1) if nothing has changed since the last call, otherwise one pass copying the entry pointers
+	 * (no LibraryEntry's are copied).
+	 */
+	std::shared_ptr<const LibrarySnapshot> snapshot() const;
+
 	bool areAllEntriesFullyPopulated() const;
 	qint64 getNumEntries() const;
 	qint64 getNumPopulatedEntries() const;
@@ -63,14 +123,38 @@ public:
 	/// @{
 	QVariant toVariant() const override;
 	void fromVariant(const QVariant& variant) override;
+
+	/**
+	 * fromVariant() for a @a variant from XmlSerializer::load_split(), whose entry list is a placeholder for one of the
+	 * split runs.  The Library is left with no entries, they're to be added with addNewEntries() as they're loaded.
+	 * @returns The index of the run holding this Library's entries, or std::nullopt if the entries weren't split out
+	 *          and have been read from @a variant as usual.
+	 */
+	std::optional<std::size_t> fromVariantSplit(const QVariant& variant);
+
+	/**
+	 * Serialize @a snapshot exactly as toVariant() would serialize the Library it was taken from.
+	 * Threadsafe, FBO saving from a non-GUI thread.
+	 */
+	static QVariant toVariant(const LibrarySnapshot& snapshot);
+
+	void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const override;
+	/// Streaming version of toVariant(const LibrarySnapshot&), same threadsafety.
+	static void toXmlStream(const LibrarySnapshot& snapshot, XmlStreamVisitor& visitor, const QString& node_name);
 	/// @}
 
 private:
 	void addingEntry(const LibraryEntry* entry);
 	void removingEntry(const LibraryEntry* entry);
 
-//private:
-public:
+	/// Log that rows at or past @a first_row have moved by @a delta.
+	void logRowShift(size_t first_row, std::ptrdiff_t delta);
+
+	/// Bring every entry of the id-to-row map up to date and clear the shift log.
+	void rebuildIdMap() const;
+
+	/// Drop the cached snapshot, called by everything which modifies the Library.
+	void invalidateSnapshot() { m_snapshot.reset(); }
 
 	QUrl m_root_url;
 
@@ -78,6 +162,29 @@ public:
 	qint64 m_num_populated {0};
 
 	std::vector<std::shared_ptr<LibraryEntry>> m_lib_entries;
+
+	/// Parallel to m_lib_entries, the stable ID of each row.
+	std::vector<UUIncD> m_lib_entry_ids;
+
+	/// Rows at or past m_first_row moved by m_delta.
+	struct RowShift
+	{
+		size_t m_first_row;
+		std::ptrdiff_t m_delta;
+	};
+	std::vector<RowShift> m_row_shifts;
+
+	/// Where an ID's row was the last time it was resolved: m_row as of m_row_shifts[m_num_shifts_applied].
+	struct IdRow
+	{
+		size_t m_row;
+		size_t m_num_shifts_applied;
+	};
+	/// Reverse map of m_lib_entry_ids, brought up to date an entry at a time by getRowFromId().
+	mutable std::unordered_map<UUIncD, IdRow> m_id_to_row_map;
+
+	/// The most recent snapshot(), or null if the Library has changed since it was taken.
+	mutable std::shared_ptr<const LibrarySnapshot> m_snapshot;
 };
 
 Q_DECLARE_METATYPE(Library);
@@ -26,7 +26,9 @@
 
 // Qt
 #include <QDataStream>
+#include <QFileInfo>
 #include <QUrlQuery>
+#include <QXmlStreamReader>
 
 // TagLib
 #include <taglib/tag.h>
@@ -44,6 +46,9 @@
 #include "TrackMetadata.h"
 #include "npt.h"
 #include <logic/serialization/SerializationHelpers.h>
+#include <logic/serialization/XmlSerializer.h>
+#include <logic/serialization/XmlStreamReadVisitor.h>
+#include <logic/serialization/XmlStreamVisitor.h>
 
 #define LIBRARY_ENTRY_MAGIC_NUMBER 0x98542123
 #define LIBRARY_ENTRY_VERSION 0x01
@@ -70,7 +75,7 @@ std::shared_ptr<LibraryEntry> LibraryEntry::fromUrl(const QUrl &fileurl)
 std::vector<std::shared_ptr<LibraryEntry>> LibraryEntry::split_to_tracks()
 {
 	std::vector<std::shared_ptr<LibraryEntry>> retval;
-	auto file_metadata = m_metadata;
+	auto file_metadata = fullMetadata();
 
 	if(m_total_track_number == 0 || m_total_track_number == 1)
 	{
@@ -110,12 +115,13 @@ std::vector<std::shared_ptr<LibraryEntry>> LibraryEntry::split_to_tracks()
 			new_entry->m_track_number = tn;
 
 			new_entry->m_total_track_number = file_metadata.numTracks();
-			new_entry->m_metadata = track_metadata;
+			new_entry->setMetadata(track_metadata);
 			new_entry->m_offset_frames = m_offset_frames;
 			new_entry->m_length_frames = m_length_frames;
 			new_entry->m_is_subtrack = (file_metadata.numTracks() > 1);
 			new_entry->m_is_populated = true;
 			new_entry->m_is_error = false;
+			new_entry->updateSummary();
 
 //			qDb() << "LIBENTRY:" << tn << new_entry->getAllMetadata();
 
@@ -143,6 +149,14 @@ void LibraryEntry::populate(bool force_refresh)
 		qDebug() << "Already populated.";
 	}
 
+	// Note what the file looks like before we read it, so a later scan can tell whether it's changed since.
+	if(m_url.isLocalFile())
+	{
+		const QFileInfo file_info(m_url.toLocalFile());
+		m_populated_file_size = file_info.size();
+		m_populated_file_mtime = file_info.lastModified();
+	}
+
     // Get the MIME type.
 	auto& mdb = amlmApp->mime_db();
 	m_mime_type = mdb.mimeTypeForUrl(m_url);
@@ -162,7 +176,7 @@ void LibraryEntry::populate(bool force_refresh)
 		{
 			// Couldn't load a cue sheet, this is probably a single-song file.
 //			qDebug() << "No cuesheet for file" << this->m_url;
-			m_metadata = file_metadata;
+			setMetadata(file_metadata);
 			m_length_frames = file_metadata.total_length_frames();
 			m_is_subtrack = false;
 			m_is_populated = true;
@@ -172,11 +186,10 @@ void LibraryEntry::populate(bool force_refresh)
 		{
 			// We did get a cue sheet, could be more than one track in this file,
 			// but we'll let the caller decide whether to split into tracks or not.
-			m_metadata = file_metadata;
+			setMetadata(file_metadata);
 			/// Create the new entry.
 			m_track_number = -1; /// @todo DUMMY VAL
 			m_total_track_number = file_metadata.numTracks();
-			m_metadata = file_metadata;
 			m_offset_frames = 0;
 			m_length_frames = file_metadata.total_length_frames();
 			m_is_subtrack = (file_metadata.numTracks() > 1);
@@ -184,6 +197,8 @@ void LibraryEntry::populate(bool force_refresh)
 			m_is_error = false;
 		}
 	}
+
+	updateSummary();
 }
 
 void LibraryEntry::refresh_metadata()
@@ -205,36 +220,39 @@ bool LibraryEntry::isFromSameFileAs(const LibraryEntry *other) const
 	}
 }
 
+bool LibraryEntry::hasSameContentAs(const LibraryEntry& other) const
+{
+	// The cheap fields first, the Metadata only if they all match.
+	return m_url == other.m_url
+		&& m_is_populated == other.m_is_populated
+		&& m_is_error == other.m_is_error
+		&& m_is_subtrack == other.m_is_subtrack
+		&& m_track_number == other.m_track_number
+		&& m_total_track_number == other.m_total_track_number
+		&& m_pre_gap_offset_frames == other.m_pre_gap_offset_frames
+		&& m_offset_frames == other.m_offset_frames
+		&& m_length_frames == other.m_length_frames
+		&& m_mime_type == other.m_mime_type
+		&& m_display_fields == other.m_display_fields
+		&& getAllMetadata() == other.getAllMetadata();
+}
 
-bool LibraryEntry::hasNoPregap() const
+bool LibraryEntry::isPopulatedFrom(qint64 file_size, const QDateTime& file_mtime) const
 {
-	if(isPopulated() && !isError())
-	{
-		if(isSubtrack())
-		{
-			if(m_metadata)
-			{
-				if(m_track_number < 1)
-				{
-//					qCritical() << "TRACK NO LESS THAN 1:" << m_track_number;
-					return false;
-				}
-				if(!m_metadata.hasTrack(m_track_number))
-				{
-					qWr() << "Possible database corruption, no such metadata track:" << m_track_number;
-					return false;
-				}
-				TrackMetadata tm = m_metadata.track(m_track_number);
-				if(tm.m_is_part_of_gapless_set)
-				{
-//					qDebug() << "Track is part of gapless set:" << m_track_number << "in file:" << m_url;
-					return true;
-				}
-			}
-		}
-	}
+	return m_is_populated && m_populated_file_mtime.isValid()
+		&& m_populated_file_size == file_size && m_populated_file_mtime == file_mtime;
+}
 
-	return false;
+void LibraryEntry::setPopulatedFrom(const LibraryEntry& other)
+{
+	m_populated_file_size = other.m_populated_file_size;
+	m_populated_file_mtime = other.m_populated_file_mtime;
+}
+
+
+bool LibraryEntry::hasNoPregap() const
+{
+	return m_has_no_pregap;
 }
 
 QUrl LibraryEntry::getM2Url() const
@@ -276,8 +294,7 @@ QUrl LibraryEntry::getM2Url() const
 	X(XMLTAG_TOTAL_TRACK_NUMBER, m_total_track_number) \
 	X(XMLTAG_PRE_GAP_OFFSET_FRAMES, m_pre_gap_offset_frames) \
 	X(XMLTAG_OFFSET_FRAMES, m_offset_frames) \
-	X(XMLTAG_LENGTH_FRAMES, m_length_frames) \
-	X(XMLTAG_METADATA, m_metadata)
+	X(XMLTAG_LENGTH_FRAMES, m_length_frames)
 
 using strviw_type = QLatin1String;
 
@@ -286,6 +303,15 @@ using strviw_type = QLatin1String;
 	M_DATASTREAM_FIELDS(X);
 #undef X
 
+/// @name Fields not in M_DATASTREAM_FIELDS, since they can't be read or written as simply.
+/// The summary fields are written ahead of m_metadata, and are all fromXmlDeferred() reads of it.
+/// @{
+static const strviw_type XMLTAG_DISPLAY_FIELDS ("m_display_fields");
+static const strviw_type XMLTAG_HAS_NO_PREGAP ("m_has_no_pregap");
+static const strviw_type XMLTAG_FILE_TYPE ("m_file_type");
+static const strviw_type XMLTAG_METADATA ("m_metadata");
+/// @}
+
 
 QDebug operator<<(QDebug dbg, const LibraryEntry& obj)
 {
@@ -293,6 +319,14 @@ QDebug operator<<(QDebug dbg, const LibraryEntry& obj)
 #define X(field_tag, member_field) << (field_tag) << obj.member_field << ","
 	dbg M_DATASTREAM_FIELDS(X);
 #undef X
+	if(obj.isMetadataDeferred())
+	{
+		dbg << XMLTAG_METADATA << "(deferred)";
+	}
+	else
+	{
+		dbg << XMLTAG_METADATA << obj.m_metadata;
+	}
 	return dbg;
 }
 
@@ -305,7 +339,10 @@ QVariant LibraryEntry::toVariant() const
 	M_DATASTREAM_FIELDS(X);
 #undef X
 
-//	map_insert_or_die(map, XMLTAG_METADATA, m_metadata);
+	map_insert_or_die(map, XMLTAG_DISPLAY_FIELDS, m_display_fields);
+	map_insert_or_die(map, XMLTAG_HAS_NO_PREGAP, m_has_no_pregap);
+	map_insert_or_die(map, XMLTAG_FILE_TYPE, m_file_type);
+	map_insert_or_die(map, XMLTAG_METADATA, fullMetadata());
 
 	if(isPopulated())
 	{
@@ -327,6 +364,12 @@ void LibraryEntry::fromVariant(const QVariant& variant)
 	M_DATASTREAM_FIELDS(X);
 #undef X
 
+	// The summary is recomputed rather than read, it isn't in older files.
+	Metadata metadata;
+	map_read_field_or_warn(map, XMLTAG_METADATA, &metadata);
+	setMetadata(metadata);
+	updateSummary();
+
 	/// @todo
 	if(isPopulated())
 	{
@@ -352,13 +395,185 @@ void LibraryEntry::fromVariant(const QVariant& variant)
 	// qDb() << "LIBRARYENTRY:" << *this;
 }
 
+void LibraryEntry::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	visitor.beginMap(node_name);
+
+#define X(field_tag, member_field)   visitor.writeField(field_tag, member_field);
+	M_DATASTREAM_FIELDS(X);
+#undef X
+
+	visitor.writeField(XMLTAG_DISPLAY_FIELDS, m_display_fields);
+	visitor.writeField(XMLTAG_HAS_NO_PREGAP, m_has_no_pregap);
+	visitor.writeField(XMLTAG_FILE_TYPE, m_file_type);
+
+	if(m_deferred_metadata)
+	{
+		// Pass the Metadata XML we read straight through, no need to deserialize it just to serialize it again.
+		QXmlStreamReader xmlstream(m_deferred_metadata->m_entry_xml);
+		xmlstream.readNextStartElement();
+		while(xmlstream.readNextStartElement())
+		{
+			if(xmlstream.name() == XMLTAG_METADATA)
+			{
+				visitor.copyElement(xmlstream);
+				break;
+			}
+			xmlstream.skipCurrentElement();
+		}
+	}
+	else
+	{
+		visitor.writeField(XMLTAG_METADATA, m_metadata);
+	}
+
+	visitor.endElement();
+}
+
+// static
+std::shared_ptr<LibraryEntry> LibraryEntry::fromXmlDeferred(QByteArrayView entry_xml)
+{
+	auto retval = std::make_shared<LibraryEntry>();
+
+	QByteArray xml_bytes = entry_xml.toByteArray();
+
+	XmlSerializer xmlser;
+	QXmlStreamReader xmlstream(xml_bytes);
+	xmlstream.readNextStartElement();
+	XmlStreamReadVisitor visitor(xmlser, xmlstream);
+
+	bool have_summary = false;
+	bool have_file_type = false;
+	bool have_metadata = false;
+	while(xmlstream.readNextStartElement())
+	{
+		const QStringView name = xmlstream.name();
+		if(name == XMLTAG_METADATA)
+		{
+			// The expensive part, leave it for later.
+			xmlstream.skipCurrentElement();
+			have_metadata = true;
+		}
+		else if(name == XMLTAG_DISPLAY_FIELDS)
+		{
+			visitor.readField(retval->m_display_fields);
+			have_summary = true;
+		}
+		else if(name == XMLTAG_HAS_NO_PREGAP)
+		{
+			visitor.readField(retval->m_has_no_pregap);
+		}
+		else if(name == XMLTAG_FILE_TYPE)
+		{
+			visitor.readField(retval->m_file_type);
+			have_file_type = true;
+		}
+#define X(field_tag, member_field) \
+		else if(name == field_tag) \
+		{ \
+			visitor.readField(retval->member_field); \
+		}
+		M_DATASTREAM_FIELDS(X)
+#undef X
+		else
+		{
+			qWr() << "Skipping unknown LibraryEntry field:" << name;
+			xmlstream.skipCurrentElement();
+		}
+	}
+
+	if(xmlstream.hasError())
+	{
+		qWr() << "XML error in library entry:" << xmlstream.errorString();
+	}
+
+	if(have_metadata && have_summary && have_file_type)
+	{
+		retval->m_deferred_metadata = std::make_shared<DeferredMetadata>();
+		retval->m_deferred_metadata->m_entry_xml = std::move(xml_bytes);
+	}
+	else if(have_metadata)
+	{
+		// Written before there was a summary, or before the file type was in it, so we need the Metadata now to
+		// make one.
+		QXmlStreamReader full_xmlstream(xml_bytes);
+		full_xmlstream.readNextStartElement();
+		XmlStreamReadVisitor full_visitor(xmlser, full_xmlstream);
+		retval->fromXmlStream(full_visitor);
+	}
+
+	return retval;
+}
+
+const Metadata& LibraryEntry::fullMetadata() const
+{
+	if(!m_deferred_metadata)
+	{
+		return m_metadata;
+	}
+
+	DeferredMetadata& deferred = *m_deferred_metadata;
+	std::call_once(deferred.m_once, [&deferred](){
+		XmlSerializer xmlser;
+		QXmlStreamReader xmlstream(deferred.m_entry_xml);
+		xmlstream.readNextStartElement();
+		XmlStreamReadVisitor visitor(xmlser, xmlstream);
+		while(xmlstream.readNextStartElement())
+		{
+			if(xmlstream.name() == XMLTAG_METADATA)
+			{
+				visitor.readField(deferred.m_metadata);
+				break;
+			}
+			xmlstream.skipCurrentElement();
+		}
+		if(xmlstream.hasError())
+		{
+			qWr() << "XML error in deferred metadata:" << xmlstream.errorString();
+		}
+	});
+	return deferred.m_metadata;
+}
+
+void LibraryEntry::setMetadata(const Metadata& metadata)
+{
+	m_metadata = metadata;
+	m_deferred_metadata.reset();
+}
+
+void LibraryEntry::updateSummary()
+{
+	const Metadata& metadata = fullMetadata();
+
+	m_display_fields = metadata.display_fields();
+	m_file_type = metadata ? QString::fromUtf8(metadata.GetFiletypeName().c_str()) : QString();
+
+	m_has_no_pregap = false;
+	if(isPopulated() && !isError() && isSubtrack() && metadata)
+	{
+		if(m_track_number < 1)
+		{
+//			qCritical() << "TRACK NO LESS THAN 1:" << m_track_number;
+		}
+		else if(!metadata.hasTrack(m_track_number))
+		{
+			qWr() << "Possible database corruption, no such metadata track:" << m_track_number;
+		}
+		else
+		{
+			TrackMetadata tm = metadata.track(m_track_number);
+			m_has_no_pregap = tm.m_is_part_of_gapless_set;
+		}
+	}
+}
+
 #undef M_DATASTREAM_FIELDS
 
 QByteArray LibraryEntry::getCoverImageBytes()
 {
 	if(isPopulated() && !isError())
 	{
-		return m_metadata.getCoverArtBytes();
+		return fullMetadata().getCoverArtBytes();
 	}
 	else
 	{
@@ -372,7 +587,7 @@ AMLMTagMap LibraryEntry::getAllMetadata() const
 
 	if(isPopulated())
 	{
-		AMLMTagMap tm = m_metadata.filled_fields();
+		AMLMTagMap tm = fullMetadata().filled_fields();
 #if 1
 		retval = tm;
 #else
@@ -402,14 +617,14 @@ QStringList LibraryEntry::getMetadata(QString key) const
 {
 	if(isPopulated() && !isError())
 	{
-		std::string str = m_metadata[tostdstr(key)];
-		if(str.empty())
+		std::vector<std::string> values = m_display_fields.equal_range_vector(tostdstr(key));
+		if(values.empty() || values[0].empty())
 		{
 			return QStringList();
 		}
 		else
 		{
-			return QStringList(toqstr(str));
+			return QStringList(toqstr(values[0]));
 		}
 	}
 	else
@@ -25,8 +25,12 @@
 // Std C++
 #include <vector>
 #include <memory>
+#include <mutex>
 
 // Qt
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDateTime>
 #include <QMetaType>
 #include <QObject>
 #include <QUrl>
@@ -55,6 +59,12 @@ public:
 
     static std::shared_ptr<LibraryEntry> fromUrl(const QUrl& fileurl = QUrl());
 
+	/**
+	 * Create a LibraryEntry from the XML of one of its toXmlStream() elements, reading only what a view needs to
+	 * show it.  The full Metadata stays XML until something asks for it, see metadata().  Threadsafe.
+	 */
+	static std::shared_ptr<LibraryEntry> fromXmlDeferred(QByteArrayView entry_xml);
+
 	void populate(bool force_refresh = false);
 	std::vector<std::shared_ptr<LibraryEntry>> split_to_tracks();
 
@@ -64,7 +74,22 @@ public:
 	bool isPopulated() const { return m_is_populated; }
 	bool isError() const { return m_is_error; }
 	bool isSubtrack() const { return m_is_subtrack; }
+	/// True if the Metadata of this entry hasn't been deserialized yet.
+	bool isMetadataDeferred() const { return m_deferred_metadata != nullptr; }
 	bool isFromSameFileAs(const LibraryEntry *other) const;
+	/// True if @a other would be saved the same as this, i.e. a rescan which produced it changed nothing.
+	bool hasSameContentAs(const LibraryEntry& other) const;
+	/**
+	 * True if this entry was populated from the file as it was when it had size @a file_size and last-modified time
+	 * @a file_mtime.  Always false for entries which came from a saved library, they don't know.
+	 */
+	bool isPopulatedFrom(qint64 file_size, const QDateTime& file_mtime) const;
+	/**
+	 * Take on the version of the file @a other was populated from, for when @a other is a re-read of this entry's file
+	 * which came out the same.  Only through CollectionStore::refreshPopulatedFrom(), which serializes it with the
+	 * isPopulatedFrom() checks.
+	 */
+	void setPopulatedFrom(const LibraryEntry& other);
 
 	bool hasNoPregap() const;
 	int getTrackNumber() const { return m_track_number; }
@@ -76,7 +101,8 @@ public:
 	QUrl getM2Url() const;
 
 	QString getFilename() const { return m_url.fileName(); }
-	QString getFileType() const { return m_metadata ? QString::fromUtf8(m_metadata.GetFiletypeName().c_str()) : QString(); }
+	/// The file type name from the Metadata, e.g. "FLAC".  Doesn't need the full Metadata.
+	QString getFileType() const { return m_file_type; }
     QMimeType getMimeType() const { return m_mime_type; };
 
 	/// @name Serialization
@@ -89,6 +115,8 @@ public:
 	QVariant toVariant() const override;
 	/// Serialize item and any children from a QVariant.
 	void fromVariant(const QVariant& variant) override;
+	/// Stream out the same thing toVariant() returns.
+	void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const override;
 
 	/// @} // END ISerializable
 
@@ -111,11 +139,34 @@ public:
 	qint64 get_offset_frames() const { return m_offset_frames; }
 	qint64 get_length_frames() const { return m_length_frames; }
 
-	Metadata metadata() const { return m_metadata; }
+	/// The full Metadata, which is deserialized here if this entry came from fromXmlDeferred().
+	Metadata metadata() const { return fullMetadata(); }
 	Metadata track_cuesheet_metadata() const;
 
+	/// The value of one of the Metadata::display_fields().  Doesn't need the full Metadata.
 	QStringList getMetadata(QString key) const;
 
+private:
+
+	/// The Metadata of an entry from fromXmlDeferred(), deserialized on first use.  Shared by copies of the entry,
+	/// which is fine since it never changes once it's deserialized.
+	struct DeferredMetadata
+	{
+		std::once_flag m_once;
+		/// The whole entry element, m_metadata is deserialized from its m_metadata child.
+		QByteArray m_entry_xml;
+		Metadata m_metadata;
+	};
+
+	/// m_metadata, or the deferred one.  Threadsafe.
+	const Metadata& fullMetadata() const;
+
+	/// Set m_metadata, dropping any deferred Metadata.  Call updateSummary() once the other fields are set.
+	void setMetadata(const Metadata& metadata);
+
+	/// Recompute m_display_fields, m_has_no_pregap and m_file_type from the full Metadata.
+	void updateSummary();
+
 
 protected:
 
@@ -149,6 +200,22 @@ protected:
 	qint64 m_length_frames {0};
 
 	Metadata m_metadata;
+
+	/// Set instead of m_metadata by fromXmlDeferred().
+	std::shared_ptr<DeferredMetadata> m_deferred_metadata;
+
+	/// @name Summary of the full Metadata for views, so they never need to deserialize it.
+	/// @{
+	AMLMTagMap m_display_fields;
+	bool m_has_no_pregap {false};
+	QString m_file_type;
+	/// @}
+
+	/// @name What the file looked like when populate() read it.  Not serialized.
+	/// @{
+	qint64 m_populated_file_size {-1};
+	QDateTime m_populated_file_mtime;
+	/// @}
 };
 
 inline QDebug operator<<(QDebug dbg, const std::shared_ptr<LibraryEntry>& libentry)
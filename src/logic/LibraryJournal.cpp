@@ -0,0 +1,607 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file LibraryJournal.cpp
+/// Implementation of LibraryJournal.
+
+#include "LibraryJournal.h"
+
+// Std C++
+#include <algorithm>
+#include <chrono>
+
+// Qt
+#include <QByteArray>
+#include <QDataStream>
+#include <QtEndian>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+// Ours
+#include <utils/ConnectHelpers.h>
+#include <utils/DebugHelpers.h>
+#include <logic/serialization/BlockCompressedIO.h>
+#include <logic/serialization/XmlSerializer.h>
+#include <logic/serialization/XmlStreamReadVisitor.h>
+#include <logic/serialization/XmlStreamVisitor.h>
+#include "LibraryEntry.h"
+#include "models/LibraryModel.h"
+
+
+/// @name Journal file format.
+/// The file is a sequence of frames, each one:
+///   quint8 kind, quint32 payload size, quint16 qChecksum() of the payload (all big-endian), payload.
+/// A file starts with a header frame.  A compaction which finds an old moved-aside journal still there appends the
+/// current journal to it, header and all, so a header can also show up in the middle.
+/// A frame which is cut short or fails its checksum ends the file, that's where we crashed.
+/// @{
+
+static constexpr quint8 c_frame_kind_header = 0x4A; // 'J'
+static constexpr quint8 c_frame_kind_record = 0x52; // 'R'
+static constexpr qsizetype c_frame_header_size = 1 + 4 + 2;
+static constexpr quint32 c_journal_format_version = 1;
+static const QByteArray c_journal_magic = QByteArrayLiteral("AMLMJRNL");
+
+/// @}
+
+/// Journal size at which a compaction is due.
+static constexpr qint64 c_compaction_bytes = 8 * 1024 * 1024;
+/// Compact at least this often if there's anything in the journal at all.
+static constexpr auto c_compaction_max_interval = std::chrono::minutes(10);
+
+static QByteArray make_frame(quint8 kind, const QByteArray& payload)
+{
+	QByteArray frame(c_frame_header_size, Qt::Uninitialized);
+	frame[0] = static_cast<char>(kind);
+	qToBigEndian<quint32>(static_cast<quint32>(payload.size()), frame.data() + 1);
+	qToBigEndian<quint16>(qChecksum(payload), frame.data() + 5);
+	frame.append(payload);
+	return frame;
+}
+
+/// A copy of @a model's entry at @a row, for a Record to hold on to.
+static std::shared_ptr<LibraryEntry> copy_entry(LibraryModel* model, int row)
+{
+	return std::make_shared<LibraryEntry>(*model->getItem(model->index(row, 0)));
+}
+
+static QByteArray make_header_frame()
+{
+	QByteArray payload;
+	QDataStream out(&payload, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_6_0);
+	out.writeRawData(c_journal_magic.constData(), c_journal_magic.size());
+	out << c_journal_format_version;
+	return make_frame(c_frame_kind_header, payload);
+}
+
+
+LibraryJournal::LibraryJournal(const QString& journal_file_path, QObject* parent)
+	: QObject(parent), m_journal_file_path(journal_file_path), m_compacting_file_path(journal_file_path + ".compacting")
+{
+	setObjectName("LibraryJournal");
+
+	m_write_pool.setObjectName("LibraryJournalWritePool");
+	m_write_pool.setMaxThreadCount(1);
+
+	m_flush_timer.setSingleShot(true);
+	m_flush_timer.setInterval(std::chrono::seconds(1));
+	connect_or_die(&m_flush_timer, &QTimer::timeout, this, &LibraryJournal::flushPending);
+
+	m_compaction_check_timer.setInterval(std::chrono::seconds(30));
+	connect_or_die(&m_compaction_check_timer, &QTimer::timeout, this, &LibraryJournal::checkCompactionDue);
+
+	m_since_last_compaction.start();
+}
+
+LibraryJournal::~LibraryJournal()
+{
+	flush();
+}
+
+quint64 LibraryJournal::readSnapshotSeq(const QString& snapshot_file_path)
+{
+	QFile file(snapshot_file_path);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		return 0;
+	}
+
+	// The snapshot may be compressed.  Only the first block or so gets decompressed here.
+	BlockCompressedReader decompressor(&file);
+	QIODevice* xml_device = &file;
+	if(BlockCompressedFormat::detect(&file))
+	{
+		if(!decompressor.open(QIODevice::ReadOnly))
+		{
+			return 0;
+		}
+		xml_device = &decompressor;
+	}
+
+	// The document element, then the library list element.
+	QXmlStreamReader xmlstream(xml_device);
+	if(!xmlstream.readNextStartElement() || !xmlstream.readNextStartElement())
+	{
+		return 0;
+	}
+	return xmlstream.attributes().value(c_snapshot_seq_attr).toULongLong();
+}
+
+void LibraryJournal::open(quint64 snapshot_seq)
+{
+	std::vector<Record> records;
+	quint64 max_seq = 0;
+
+	// Anything still in the moved-aside journal comes first.
+	readFile(m_compacting_file_path, snapshot_seq, &records, &max_seq);
+	const qint64 intact_size = readFile(m_journal_file_path, snapshot_seq, &records, &max_seq);
+
+	// Appending one journal to another can duplicate records, keep only the first of each.
+	quint64 last_seq = 0;
+	for(auto& rec : records)
+	{
+		if(rec.m_seq <= last_seq)
+		{
+			continue;
+		}
+		last_seq = rec.m_seq;
+		m_replay_records[rec.m_lib_root].push_back(std::move(rec));
+	}
+
+	m_next_seq = std::max(snapshot_seq, max_seq + 1);
+	qIn() << "Journal:" << m_journal_file_path << "has" << records.size() << "records newer than the snapshot, next seq:" << m_next_seq;
+
+	// Anything appended after a torn frame would never be read back, so cut it off before appending.
+	m_write_pool.start([this, intact_size](){ openFileForAppend(intact_size); });
+	m_compaction_check_timer.start();
+}
+
+int LibraryJournal::replay(const QUrl& lib_root, std::vector<std::shared_ptr<LibraryEntry>>* entries)
+{
+	Q_CHECK_PTR(entries);
+
+	auto it = m_replay_records.find(lib_root);
+	if(it == m_replay_records.end())
+	{
+		return 0;
+	}
+
+	int num_applied = 0;
+	for(const auto& rec : std::as_const(it.value()))
+	{
+		if(!applyRecord(entries, rec))
+		{
+			qWr() << "Journal record" << rec.m_seq << "doesn't fit library" << lib_root << ", stopping replay";
+			break;
+		}
+		++num_applied;
+	}
+	m_replay_records.erase(it);
+
+	qIn() << "Replayed" << num_applied << "journal records into library" << lib_root;
+	return num_applied;
+}
+
+int LibraryJournal::replay(LibraryModel* model)
+{
+	Q_CHECK_PTR(model);
+
+	if(!hasReplayRecords(model->getLibRootDir()))
+	{
+		return 0;
+	}
+
+	std::vector<std::shared_ptr<LibraryEntry>> entries;
+	entries.reserve(model->rowCount());
+	for(int row = 0; row < model->rowCount(); ++row)
+	{
+		entries.push_back(model->getItem(model->index(row, 0)));
+	}
+
+	const int num_applied = replay(model->getLibRootDir(), &entries);
+	if(num_applied > 0)
+	{
+		ScopedPause pause(*this);
+		if(model->rowCount() > 0)
+		{
+			model->removeRows(0, model->rowCount());
+		}
+		if(!entries.empty())
+		{
+			model->appendRows(std::move(entries));
+		}
+	}
+	return num_applied;
+}
+
+void LibraryJournal::attach(LibraryModel* model)
+{
+	Q_CHECK_PTR(model);
+
+	connect_or_die(model, &QAbstractItemModel::rowsInserted, this, [this, model](const QModelIndex& parent, int first, int last){
+		Q_UNUSED(parent);
+		if(m_pause_depth > 0)
+		{
+			return;
+		}
+		Record rec;
+		rec.m_op = OpType::InsertRows;
+		rec.m_lib_root = model->getLibRootDir();
+		rec.m_row = first;
+		rec.m_count = last - first + 1;
+		rec.m_entries.reserve(rec.m_count);
+		for(int row = first; row <= last; ++row)
+		{
+			rec.m_entries.push_back(copy_entry(model, row));
+		}
+		record(std::move(rec));
+	});
+	connect_or_die(model, &QAbstractItemModel::rowsRemoved, this, [this, model](const QModelIndex& parent, int first, int last){
+		Q_UNUSED(parent);
+		if(m_pause_depth > 0)
+		{
+			return;
+		}
+		Record rec;
+		rec.m_op = OpType::RemoveRows;
+		rec.m_lib_root = model->getLibRootDir();
+		rec.m_row = first;
+		rec.m_count = last - first + 1;
+		record(std::move(rec));
+	});
+	connect_or_die(model, &LibraryModel::SIGNAL_entryReplaced, this, [this, model](int row){
+		if(m_pause_depth > 0)
+		{
+			return;
+		}
+		Record rec;
+		rec.m_op = OpType::ReplaceEntry;
+		rec.m_lib_root = model->getLibRootDir();
+		rec.m_row = row;
+		rec.m_count = 1;
+		rec.m_entries.push_back(copy_entry(model, row));
+		record(std::move(rec));
+	});
+	connect_or_die(model, &QAbstractItemModel::modelReset, this, [this, model](){
+		if(m_pause_depth > 0)
+		{
+			return;
+		}
+		// No telling what changed, so record everything that's there now.
+		Record rec;
+		rec.m_op = OpType::ResetModel;
+		rec.m_lib_root = model->getLibRootDir();
+		rec.m_count = model->rowCount();
+		rec.m_entries.reserve(rec.m_count);
+		for(int row = 0; row < rec.m_count; ++row)
+		{
+			rec.m_entries.push_back(copy_entry(model, row));
+		}
+		record(std::move(rec));
+	});
+}
+
+quint64 LibraryJournal::beginCompaction()
+{
+	// Whatever's pending predates the snapshot, and goes in the journal file being moved aside.
+	flushPending();
+	m_write_pool.start([this](){ rotateFile(); });
+	m_since_last_compaction.restart();
+	m_compaction_seq = m_next_seq;
+	return m_compaction_seq;
+}
+
+void LibraryJournal::endCompaction(quint64 snapshot_seq)
+{
+	if(snapshot_seq != m_compaction_seq)
+	{
+		qIn() << "Compaction" << snapshot_seq << "superseded by" << m_compaction_seq << ", keeping the old journal";
+		return;
+	}
+
+	// In line behind the rotateFile() from the matching beginCompaction().
+	m_write_pool.start([this, snapshot_seq](){
+		if(QFile::exists(m_compacting_file_path) && !QFile::remove(m_compacting_file_path))
+		{
+			// Harmless, replay will skip what's in there.
+			qWr() << "Couldn't remove compacted journal" << m_compacting_file_path;
+		}
+		qIn() << "Journal compacted into snapshot, seq:" << snapshot_seq;
+	});
+}
+
+void LibraryJournal::flush()
+{
+	flushPending();
+	m_write_pool.waitForDone();
+}
+
+void LibraryJournal::record(Record&& rec)
+{
+	rec.m_seq = m_next_seq++;
+	m_pending.push_back(std::move(rec));
+	if(!m_flush_timer.isActive())
+	{
+		m_flush_timer.start();
+	}
+}
+
+void LibraryJournal::flushPending()
+{
+	m_flush_timer.stop();
+	if(m_pending.empty())
+	{
+		return;
+	}
+
+	m_write_pool.start([this, records = std::move(m_pending)](){ appendRecords(records); });
+	m_pending.clear();
+}
+
+void LibraryJournal::checkCompactionDue()
+{
+	const qint64 journal_bytes = m_journal_bytes.load();
+	if(journal_bytes > c_compaction_bytes
+		|| (journal_bytes > 0 && m_since_last_compaction.durationElapsed() > c_compaction_max_interval))
+	{
+		Q_EMIT SIGNAL_compactionDue();
+	}
+}
+
+void LibraryJournal::openFileForAppend(qint64 intact_size)
+{
+	m_file.setFileName(m_journal_file_path);
+	if(!m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		qCr() << "Couldn't open journal" << m_journal_file_path << ":" << m_file.errorString();
+		return;
+	}
+	if(intact_size >= 0 && m_file.size() > intact_size)
+	{
+		qWr() << "Truncating journal" << m_journal_file_path << "from" << m_file.size() << "to its last intact frame at" << intact_size;
+		m_file.resize(intact_size);
+	}
+	if(m_file.size() == 0)
+	{
+		m_file.write(make_header_frame());
+		m_file.flush();
+	}
+	m_journal_bytes = m_file.size();
+}
+
+void LibraryJournal::appendRecords(const std::vector<Record>& records)
+{
+	if(!m_file.isOpen())
+	{
+		qWr() << "Journal not open, dropping" << records.size() << "records";
+		return;
+	}
+
+	QByteArray frames;
+	for(const auto& rec : records)
+	{
+		frames.append(make_frame(c_frame_kind_record, encodeRecord(rec)));
+	}
+
+	// One write for the lot, and out to the OS right away.  That's all it takes to survive us crashing.
+	if(m_file.write(frames) != frames.size() || !m_file.flush())
+	{
+		qCr() << "Journal write failed:" << m_file.errorString();
+	}
+	m_journal_bytes += frames.size();
+}
+
+void LibraryJournal::rotateFile()
+{
+	m_file.close();
+
+	if(QFile::exists(m_compacting_file_path))
+	{
+		// The last compaction didn't finish.  Keep its records along with these, replay sorts it out.
+		QFile old_journal(m_journal_file_path);
+		QFile compacting(m_compacting_file_path);
+		if(old_journal.open(QIODevice::ReadOnly) && compacting.open(QIODevice::WriteOnly | QIODevice::Append))
+		{
+			compacting.write(old_journal.readAll());
+			compacting.close();
+			old_journal.close();
+			QFile::remove(m_journal_file_path);
+		}
+		else
+		{
+			qCr() << "Couldn't append journal to" << m_compacting_file_path << ", keeping both";
+		}
+	}
+	else if(!QFile::rename(m_journal_file_path, m_compacting_file_path))
+	{
+		qCr() << "Couldn't move journal aside to" << m_compacting_file_path;
+	}
+
+	// And start a fresh one, unless we failed to move the old one.
+	openFileForAppend();
+}
+
+QByteArray LibraryJournal::encodeRecord(const Record& rec)
+{
+	// The entries go as the same XML they'd have in the snapshot.
+	QByteArray entries_xml;
+	if(!rec.m_entries.empty())
+	{
+		XmlSerializer xmlser;
+		QXmlStreamWriter xmlstream(&entries_xml);
+		XmlStreamVisitor visitor(xmlser, xmlstream);
+		visitor.beginList("entries");
+		for(const auto& entry : rec.m_entries)
+		{
+			entry->toXmlStream(visitor, "library_entry");
+		}
+		visitor.endElement();
+	}
+
+	QByteArray payload;
+	QDataStream out(&payload, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_6_0);
+	out << rec.m_seq << static_cast<quint8>(rec.m_op) << rec.m_lib_root << rec.m_row << rec.m_count << entries_xml;
+	return payload;
+}
+
+bool LibraryJournal::decodeRecord(const QByteArray& payload, Record* rec)
+{
+	QDataStream in(payload);
+	in.setVersion(QDataStream::Qt_6_0);
+	quint8 op = 0;
+	QByteArray entries_xml;
+	in >> rec->m_seq >> op >> rec->m_lib_root >> rec->m_row >> rec->m_count >> entries_xml;
+	if(in.status() != QDataStream::Ok)
+	{
+		return false;
+	}
+	rec->m_op = static_cast<OpType>(op);
+
+	if(!entries_xml.isEmpty())
+	{
+		XmlSerializer xmlser;
+		QXmlStreamReader xmlstream(entries_xml);
+		xmlstream.readNextStartElement();
+		XmlStreamReadVisitor visitor(xmlser, xmlstream);
+		while(xmlstream.readNextStartElement())
+		{
+			auto entry = std::make_shared<LibraryEntry>();
+			entry->fromXmlStream(visitor);
+			rec->m_entries.push_back(std::move(entry));
+		}
+		if(xmlstream.hasError())
+		{
+			return false;
+		}
+	}
+
+	switch(rec->m_op)
+	{
+	case OpType::InsertRows:
+	case OpType::ResetModel:
+		return rec->m_count == static_cast<qint32>(rec->m_entries.size());
+	case OpType::RemoveRows:
+		return rec->m_count > 0;
+	case OpType::ReplaceEntry:
+		return rec->m_entries.size() == 1;
+	}
+	return false;
+}
+
+qint64 LibraryJournal::readFile(const QString& file_path, quint64 first_seq, std::vector<Record>* records, quint64* max_seq)
+{
+	QFile file(file_path);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		return QFile::exists(file_path) ? -1 : 0;
+	}
+	const QByteArray bytes = file.readAll();
+
+	qsizetype pos = 0;
+	while(pos < bytes.size())
+	{
+		if(pos + c_frame_header_size > bytes.size())
+		{
+			qWr() << "Journal" << file_path << "ends with a partial frame header at offset" << pos;
+			break;
+		}
+		const auto kind = static_cast<quint8>(bytes[pos]);
+		const auto size = qFromBigEndian<quint32>(bytes.constData() + pos + 1);
+		const auto checksum = qFromBigEndian<quint16>(bytes.constData() + pos + 5);
+		const qsizetype payload_pos = pos + c_frame_header_size;
+		if(payload_pos + qsizetype(size) > bytes.size())
+		{
+			qWr() << "Journal" << file_path << "ends with a partial frame at offset" << pos;
+			break;
+		}
+		const QByteArray payload = bytes.sliced(payload_pos, size);
+		if(qChecksum(payload) != checksum)
+		{
+			qWr() << "Journal" << file_path << "has a corrupt frame at offset" << pos << ", ignoring the rest";
+			break;
+		}
+
+		if(kind == c_frame_kind_header)
+		{
+			if(!payload.startsWith(c_journal_magic))
+			{
+				qWr() << "Not a journal file:" << file_path;
+				break;
+			}
+			pos = payload_pos + size;
+			continue;
+		}
+		if(kind != c_frame_kind_record)
+		{
+			qWr() << "Unknown journal frame kind" << kind << "in" << file_path << ", ignoring the rest";
+			break;
+		}
+
+		Record rec;
+		if(!decodeRecord(payload, &rec))
+		{
+			qWr() << "Couldn't decode journal record at offset" << pos << "in" << file_path << ", ignoring the rest";
+			break;
+		}
+		pos = payload_pos + size;
+		*max_seq = std::max(*max_seq, rec.m_seq);
+		if(rec.m_seq >= first_seq)
+		{
+			records->push_back(std::move(rec));
+		}
+	}
+
+	return pos;
+}
+
+bool LibraryJournal::applyRecord(std::vector<std::shared_ptr<LibraryEntry>>* entries, const Record& rec)
+{
+	const auto num_rows = static_cast<qint32>(entries->size());
+
+	switch(rec.m_op)
+	{
+	case OpType::InsertRows:
+		if(rec.m_row < 0 || rec.m_row > num_rows)
+		{
+			return false;
+		}
+		entries->insert(entries->begin() + rec.m_row, rec.m_entries.cbegin(), rec.m_entries.cend());
+		return true;
+	case OpType::RemoveRows:
+		if(rec.m_row < 0 || rec.m_row + rec.m_count > num_rows)
+		{
+			return false;
+		}
+		entries->erase(entries->begin() + rec.m_row, entries->begin() + rec.m_row + rec.m_count);
+		return true;
+	case OpType::ReplaceEntry:
+		if(rec.m_row < 0 || rec.m_row >= num_rows)
+		{
+			return false;
+		}
+		(*entries)[rec.m_row] = rec.m_entries[0];
+		return true;
+	case OpType::ResetModel:
+		*entries = rec.m_entries;
+		return true;
+	}
+	return false;
+}
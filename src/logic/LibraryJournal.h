@@ -0,0 +1,234 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_LOGIC_LIBRARYJOURNAL_H_
+#define SRC_LOGIC_LIBRARYJOURNAL_H_
+
+/// @file LibraryJournal.h
+/// Interface of LibraryJournal, the append-only on-disk log of LibraryModel changes.
+
+// Std C++
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Qt
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QLatin1StringView>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QUrl>
+
+// Ours
+#include <future/guideline_helpers.h>
+class LibraryEntry;
+class LibraryModel;
+
+
+/**
+ * Append-only journal of the changes made to the LibraryModels since the last library snapshot
+ * (i.e. ${HOME}/AMLMDatabaseSerDes.xml) was written.
+ *
+ * Every row insert, remove, entry replacement and reset in an attach()ed model is recorded as it happens.  Records
+ * are serialized and appended to the journal file on a background thread about once a second, so a crash loses at
+ * most about the last second of work.  On startup, replay() re-applies the records the snapshot doesn't have to each
+ * library's entries as they come out of the snapshot, before anything else can change them.
+ *
+ * Records are keyed by library root, and only replayed into libraries which are in the snapshot, so the owner has
+ * to write a snapshot whenever a library is added or removed.
+ *
+ * Each record has a sequence number which keeps increasing across runs.  Compaction, i.e. writing a new snapshot,
+ * goes:
+ * - beginCompaction() in the GUI thread, at the same moment the snapshots of the models are taken.  The current
+ *   journal file is moved aside, and the returned sequence number is written into the snapshot
+ *   (see c_snapshot_seq_attr): everything before it is in the snapshot, nothing after it is.
+ * - endCompaction() after the snapshot is committed, which deletes the moved-aside journal.
+ * Replay skips records older than the snapshot's sequence number, so a crash at any point along the way
+ * never applies a record twice or loses one.
+ */
+class LibraryJournal : public QObject
+{
+	Q_OBJECT
+
+Q_SIGNALS:
+	/// The journal has grown enough, or enough time has passed since the last compaction, that it's time for another.
+	void SIGNAL_compactionDue();
+
+public:
+	explicit LibraryJournal(const QString& journal_file_path, QObject* parent = nullptr);
+	~LibraryJournal() override;
+	M_GH_POLYMORPHIC_SUPPRESS_COPYING_C67(LibraryJournal)
+
+	/// Attribute of the snapshot's library list element holding the journal sequence number it's current up to.
+	static constexpr QLatin1StringView c_snapshot_seq_attr {"amlm_journal_seq"};
+
+	/**
+	 * Read the journal sequence number the snapshot in @a snapshot_file_path is current up to, without loading it.
+	 * @returns 0 if there isn't one, e.g. the snapshot predates the journal.
+	 */
+	static quint64 readSnapshotSeq(const QString& snapshot_file_path);
+
+	/// @name Startup
+	/// @{
+
+	/**
+	 * Read in the records which came after the snapshot, which was current up to @a snapshot_seq, and open the journal
+	 * for appending.  Call once, before replay() and attach().
+	 */
+	void open(quint64 snapshot_seq);
+
+	/// True if open() read records for the library rooted at @a lib_root which haven't been replayed yet.
+	bool hasReplayRecords(const QUrl& lib_root) const { return m_replay_records.contains(lib_root); }
+
+	/**
+	 * Apply the records open() read for the library rooted at @a lib_root to @a entries, all of that library's
+	 * entries from the snapshot.  Stops at the first record which doesn't fit, which shouldn't happen unless the
+	 * files were tampered with.
+	 * @returns The number of records applied.
+	 */
+	int replay(const QUrl& lib_root, std::vector<std::shared_ptr<LibraryEntry>>* entries);
+
+	/// Same as above, for a @a model which already has all its entries from the snapshot.  Not recorded if @a model
+	/// is attach()ed.
+	int replay(LibraryModel* model);
+
+	/// @}
+
+	/// Start recording changes to @a model.  @a model's library should already be in the snapshot, or be about to be.
+	void attach(LibraryModel* model);
+
+	/**
+	 * RAII helper to not record the changes to attach()ed models made while it's in scope, e.g. appending the
+	 * entries of a library as they're loaded from the snapshot, which has them already.
+	 */
+	class ScopedPause
+	{
+	public:
+		M_GH_DELETE_COPY_AND_MOVE(ScopedPause)
+		explicit ScopedPause(LibraryJournal& journal) : m_journal(journal) { ++m_journal.m_pause_depth; }
+		~ScopedPause() { --m_journal.m_pause_depth; }
+	private:
+		LibraryJournal& m_journal;
+	};
+
+	/// @name Compaction
+	/// @{
+
+	/**
+	 * Start a new journal file.  Must be called in the GUI thread, with no model changes between it and taking
+	 * the snapshots which will be written.
+	 * @returns The sequence number to write into the snapshot.
+	 */
+	quint64 beginCompaction();
+
+	/**
+	 * The snapshot which beginCompaction() returned @a snapshot_seq for is safely on disk, the old journal can go.
+	 * Does nothing if another compaction has begun since, its snapshot still needs the old journal.
+	 */
+	void endCompaction(quint64 snapshot_seq);
+
+	/// @}
+
+	/// Write out everything recorded so far, and wait for it to be written.  For shutdown.
+	void flush();
+
+private:
+
+	enum class OpType : quint8
+	{
+		InsertRows = 1,
+		RemoveRows = 2,
+		ReplaceEntry = 3,
+		/// The model was reset, m_entries is all its rows after the reset.
+		ResetModel = 4
+	};
+
+	struct Record
+	{
+		quint64 m_seq {0};
+		OpType m_op {OpType::InsertRows};
+		QUrl m_lib_root;
+		qint32 m_row {0};
+		qint32 m_count {0};
+		/// For InsertRows, ReplaceEntry and ResetModel.  Copies of the model's entries as of the change, since those
+		/// can be modified in place (e.g. by populate()) while the record waits to be written out in the background.
+		std::vector<std::shared_ptr<LibraryEntry>> m_entries;
+	};
+
+	void record(Record&& rec);
+
+	/// Hand everything in m_pending to the write thread.
+	void flushPending();
+
+	void checkCompactionDue();
+
+	/// @name Only called on m_write_pool.
+	/// @{
+	/// Open the journal file, first cutting off anything after its first @a intact_size bytes if that's >= 0.
+	void openFileForAppend(qint64 intact_size = -1);
+	void appendRecords(const std::vector<Record>& records);
+	void rotateFile();
+	/// @}
+
+	static QByteArray encodeRecord(const Record& rec);
+	static bool decodeRecord(const QByteArray& payload, Record* rec);
+
+	/**
+	 * Read all the intact records with sequence number >= @a first_seq in @a file_path, in file order.
+	 * @returns The size of the intact part of the file, i.e. where a crash cut it short, or -1 if it couldn't be read.
+	 */
+	static qint64 readFile(const QString& file_path, quint64 first_seq, std::vector<Record>* records, quint64* max_seq);
+
+	static bool applyRecord(std::vector<std::shared_ptr<LibraryEntry>>* entries, const Record& rec);
+
+	QString m_journal_file_path;
+	QString m_compacting_file_path;
+
+	/// The next record's sequence number.
+	quint64 m_next_seq {1};
+	/// What the last beginCompaction() returned.
+	quint64 m_compaction_seq {0};
+
+	/// ScopedPause nesting depth, nothing is recorded while it's > 0.
+	int m_pause_depth {0};
+
+	/// Records not yet handed to the write thread.
+	std::vector<Record> m_pending;
+	QTimer m_flush_timer;
+
+	/// Records from open(), by library root, waiting for replay().
+	QHash<QUrl, std::vector<Record>> m_replay_records;
+
+	/// Single thread, so appends and rotations happen in the order they're requested.
+	QThreadPool m_write_pool;
+	/// The journal file.  Only touched on m_write_pool.
+	QFile m_file;
+
+	/// Bytes written since the last beginCompaction().
+	std::atomic<qint64> m_journal_bytes {0};
+	QElapsedTimer m_since_last_compaction;
+	QTimer m_compaction_check_timer;
+};
+
+#endif /* SRC_LOGIC_LIBRARYJOURNAL_H_ */
@@ -48,11 +48,13 @@
 #include <utils/TheSimplestThings.h>
 #include <utils/RegisterQtMetatypes.h>
 #include <utils/QtHelpers.h>
+#include "CollectionStore.h"
 #include "SupportedMimeTypes.h"
 
 
 // Ours
 #include <AMLMApp.h>
+#include <AMLMSettings.h>
 #include <Core.h>
 #include <gui/MainWindow.h>
 #include <logic/models/AbstractTreeModelItem.h>
@@ -61,7 +63,11 @@
 #include <utils/DebugHelpers.h>
 #include <utils/ext_iterators.h>
 
+#include <concurrency/AMLMExecutor.h>
 #include <concurrency/AsyncTaskManager.h>
+#include <concurrency/BoundedChannel.h>
+#include <concurrency/CoTask.h>
+#include <concurrency/ProgressCounter.h>
 #include <jobs/DirectoryScanJob.h>
 
 #include <jobs/LibraryRescannerJob.h>
@@ -70,16 +76,27 @@
 #include <logic/serialization/SerializationExceptions.h>
 #include <logic/serialization/SerializationHelpers.h>
 #include <utils/Stopwatch.h>
+#include <utils/Trace.h>
 
 #include "models/LibraryModel.h"
 
 
+namespace
+{
+	/// How many DirScanResults the dir scan can get ahead of the model population before it blocks.
+	constexpr std::size_t c_dirscan_channel_capacity = 1024;
+	/// How many MetadataReturnVals the metadata rescan can get ahead of the GUI thread before it blocks.
+	constexpr std::size_t c_metadata_channel_capacity = 256;
+}
+
 AMLM_QREG_CALLBACK([](){
 	qIn() << "Registering LibraryRescanner types";
 	// From #include <logic/LibraryRescanner.h>
 	qRegisterMetaType<MetadataReturnVal>();
 	qRegisterMetaType<QFuture<MetadataReturnVal>>();
 	qRegisterMetaType<QVector<LibraryRescannerMapItem>>("VecLibRescannerMapItems");
+	// For addressing results by Library entry ID across threads.
+	qRegisterMetaType<UUIncD>();
     });
 
 
@@ -92,13 +109,14 @@ LibraryRescanner::LibraryRescanner(LibraryModel* parent) : QObject(parent)
 
     connect_or_die(this, &LibraryRescanner::SIGNAL_onIncomingPopulateRowWithItems_Multiple,
                    m_current_libmodel, &LibraryModel::SLOT_onIncomingPopulateRowWithItems_Multiple);
-    connect_or_die(this, &LibraryRescanner::SIGNAL_setData,
-    				m_current_libmodel, &LibraryModel::setData);
+    connect_or_die(this, &LibraryRescanner::SIGNAL_onIncomingPopulateRowWithItems_Single,
+    				m_current_libmodel, &LibraryModel::SLOT_onIncomingPopulateRowWithItems_Single);
 }
 
 LibraryRescanner::~LibraryRescanner()
 {
-	//M_WARNING("TODO: THIS SHOULD CANCEL THE JOBS, OR THE JOBS SHOULDNT BE OWNED BY THIS");
+	// The workers hold references to what they use, but their results would land on us.
+	m_cancel_source.cancel();
 }
 
 
@@ -122,8 +140,8 @@ M_WARNING("There's no locking here, there needs to be, or these need to be copie
 		{
 			// Item's metadata has not been looked at.  We may have multiple tracks.
 
-			// Only one pindex though.
-			retval.m_original_pindexes.push_back(mapitem[0].pindex);
+			// Only one entry ID though.
+			retval.m_original_ids.push_back(mapitem[0].entry_id);
 
 			auto vec_items = item->populate();
 			for (auto i : vec_items)
@@ -150,14 +168,14 @@ M_WARNING("There's no locking here, there needs to be, or these need to be copie
 				// Couldn't load the metadata from the file.
 				// Only option here is to return the old item, which should now be marked with an error.
 				qCritical() << "Couldn't load metadata for file" << item->getUrl();
-				retval.m_original_pindexes.push_back(mapitem[0].pindex);
+				retval.m_original_ids.push_back(mapitem[0].entry_id);
 				retval.m_new_libentries.push_back(item);
 				retval.m_num_tracks_found = 1;
 			}
 			else
 			{
 				// Repackage it and return.
-				retval.m_original_pindexes.push_back(mapitem[0].pindex);
+				retval.m_original_ids.push_back(mapitem[0].entry_id);
 				retval.m_new_libentries.push_back(new_entry);
 				retval.m_num_tracks_found = 1;
 			}
@@ -186,7 +204,7 @@ M_WARNING("There's no locking here, there needs to be, or these need to be copie
 		for(int i=0; i<mapitem.size(); ++i)
 		{
 			Q_ASSERT(subtracks[i] != nullptr);
-			retval.push_back(mapitem[i].pindex, subtracks[i]);
+			retval.push_back(mapitem[i].entry_id, subtracks[i]);
 		}
 	}
 	else
@@ -232,16 +250,53 @@ void LibraryRescanner::startAsyncDirectoryTraversal(const QUrl& dir_url)
 		m_current_libmodel, &LibraryModel::SLOT_onIncomingFilename,
 		Qt::BlockingQueuedConnection);
 
+	// How much the scan can rely on what it found last time.
+	DirSummaryCache::Mode dir_summary_mode = DirSummaryCache::Mode::TrustDirMtime;
+	switch(AMLMSettings::rescanSkipUnchangedDirs())
+	{
+	case AMLMSettings::RescanDirSummaryMode::Off:
+		dir_summary_mode = DirSummaryCache::Mode::Off;
+		break;
+	case AMLMSettings::RescanDirSummaryMode::Verify:
+		dir_summary_mode = DirSummaryCache::Mode::Verify;
+		break;
+	default:
+		break;
+	}
+
+	// The stages are connected by BoundedChannels, so the DirScanResults and MetadataReturnVals are freed as they're
+	// consumed instead of piling up in the futures' result stores.  The futures are just for progress and cancellation.
+	auto dirscan_channel = std::make_shared<BoundedChannel<DirScanResult>>(c_dirscan_channel_capacity);
+	auto metadata_channel = std::make_shared<BoundedChannel<MetadataReturnVal>>(c_metadata_channel_capacity);
+
+	// A new cancellation scope for this scan.  Everything below checks or is bound to scan_cancel_token.
+	// Cancel the last scan's first, just dropping it would leave anything of it which is still running to finish,
+	// and cancelAsyncDirectoryTraversal() couldn't reach it anymore.
+	m_scan_cancel_source.cancel();
+	m_scan_cancel_source = CancellationSource(m_cancel_source.token());
+	const CancellationToken scan_cancel_token = m_scan_cancel_source.token();
+	// Canceling the channels wakes any stage blocked on them, and makes the consumers finish canceled.
+	scan_cancel_token.onCancel([dirscan_channel, metadata_channel](){
+		dirscan_channel->cancel();
+		metadata_channel->cancel();
+	});
+
+	// Both workers report progress through counters, which the tracker samples at display rate.
+	auto dirscan_progress = std::make_shared<ProgressCounter>(tr("File: %1"));
+	auto lib_rescan_progress = std::make_shared<ProgressCounter>(tr("Refreshing: %1"));
+
     // Set up the directory scan to run in another thread.
-    QFuture<DirScanResult> dirresults_future = QtConcurrent::run(DirScanFunction,
-                                                                     dir_url,
-                                                                     extensions,
-                                                                     QDir::Filters(QDir::Files |
-                                                                                   QDir::AllDirs |
-                                                                                   QDir::NoDotAndDotDot),
-                                                                     QDirIterator::Subdirectories);
+    QFuture<Unit> dirresults_future = AMLMExecutor::io().run(DirScanIncrementalFunction,
+                                                             dirscan_channel,
+                                                             dirscan_progress,
+                                                             scan_cancel_token,
+                                                             dir_url,
+                                                             extensions,
+                                                             dir_summary_mode);
 	// Create/Attach an AMLMJobT to the dirscan future.
-	QPointer<AMLMJobT<ExtFuture<DirScanResult>>> dirtrav_job = make_async_AMLMJobT(dirresults_future, "DirResultsJob", AMLMApp::instance());
+	QPointer<AMLMJobT<ExtFuture<Unit>>> dirtrav_job = make_async_AMLMJobT(dirresults_future, "DirResultsJob", AMLMApp::instance());
+	dirtrav_job->setProgressCounter(dirscan_progress);
+	scan_cancel_token.bind(dirresults_future);
 
 	// The promise/future that we'll use to move the LibraryRescannerMapItems to the library_metadata_rescan_task().
     QPromise<VecLibRescannerMapItems> rescan_items_in_promise;
@@ -250,198 +305,157 @@ void LibraryRescanner::startAsyncDirectoryTraversal(const QUrl& dir_url)
     //
     // Start the library_metadata_rescan_task.
     //
-	ExtFuture<MetadataReturnVal> lib_rescan_future = QtConcurrent::run(library_metadata_rescan_task,
-																							 rescan_items_in_future
-																							 );
+	ExtFuture<Unit> lib_rescan_future = AMLMExecutor::io().run(library_metadata_rescan_task,
+														       rescan_items_in_future,
+														       metadata_channel,
+														       lib_rescan_progress,
+														       scan_cancel_token);
 	// Make a new AMLMJobT for the metadata rescan.
-	AMLMJobT<ExtFuture<MetadataReturnVal>>* lib_rescan_job = make_async_AMLMJobT(lib_rescan_future, "LibRescanJob", AMLMApp::instance());
+	AMLMJobT<ExtFuture<Unit>>* lib_rescan_job = make_async_AMLMJobT(lib_rescan_future, "LibRescanJob", AMLMApp::instance());
+	lib_rescan_job->setProgressCounter(lib_rescan_progress);
+	scan_cancel_token.bind(lib_rescan_future);
+	// Stops the rescan task waiting for items which aren't coming.
+	scan_cancel_token.bind(rescan_items_in_future);
 
 	m_timer.lap("End setup, start continuation attachments");
 
-	streaming_then(dirresults_future, [this](QFuture<DirScanResult> sthen_future, int begin, int end) -> Unit {
-		// Start of the dirtrav streaming_then callback.  This should be a non-main thread.
-		// This will be called multiple times by streaming_then() as DirScanResult's become available.
+	QFuture<void> dirscan_consumed = streaming_consume(dirscan_channel, [this, first_batch = true](std::vector<DirScanResult> batch) mutable {
+		// This will be called with each batch of DirScanResult's as the dir scan pushes them, in order, on a non-main
+		// thread.
 
 		AMLM_ASSERT_NOT_IN_GUITHREAD();
+		Trace::Span span("DirScan::consumeBatch");
+		span.counter("files", batch.size());
 
-		if(begin == 0)
+		if(first_batch)
 		{
             expect_and_set(1, 2);
+			first_batch = false;
 		}
 
-		// Create a new container instance we'll use to pass the incoming values to the GUI thread below.
-		// Note The container here is really of type vector<shared_ptr<ScanResultsTreeModelItem>>
-		SharedItemContType new_items = std::make_shared<ItemContType>();
-
-		int original_end = end;
-		for(int i=begin; i<end; i++)
+		for(const DirScanResult& dsr : batch)
 		{
-			DirScanResult dsr = sthen_future.resultAt(i);
-
-			// Add another entry to the vector we'll send to the model.
-			/// @todo It looks like this can be simplified, no longer a need for ScanResultsTreeModelItem in here.
-            std::shared_ptr<ScanResultsTreeModelItem> new_item = ScanResultsTreeModelItem::create(dsr);
-            new_items->push_back(new_item);
+			// Record the file in the store, this is the only place a scanned file's DirScanResult is kept.
+			CollectionStore::instance().addScanResult(dsr);
 
-			if(i >= end)
-			{
-				// We're about to leave the loop.  Check if we have more ready results now than was originally reported.
-				if(sthen_future.isResultReadyAt(end+1) || sthen_future.resultCount() > (end+1))
-				{
-					// There are more results now than originally reported.
-					qIn() << "##### MORE RESULTS:" << M_NAME_VAL(original_end) << M_NAME_VAL(end) << M_NAME_VAL(sthen_future.resultCount());
-					end = end+1;
-				}
-			}
-		}
-		// Broke out of loop, check for problems.
-		if(sthen_future.isCanceled())
-		{
-			// We've been canceled.
-			/// @todo Not sure if we should see that in here or not, probably not.
-			qWr() << "sthen_callback saw canceled";
-			return unit;
-		}
-		if(sthen_future.isFinished())
-		{
-			qIn() << "sthen_callback saw finished";
-			if(new_items->empty())
-			{
-                qWr() << "sthen_callback saw finished/empty new_items";
-				return unit;
-			}
-            qIn() << "sthen_callback saw finished, but with" << new_items->size() << "outstanding results.";
+			// Send the URL to the LibraryModel.
+			// Because of Qt's model/view system not being threadsafeable, we have to do at least the final
+			// model item entry from the GUI thread.
+			Q_EMIT SIGNAL_FileUrlQString(QUrl(dsr.getMediaExtUrl()).toString());
 		}
+		// The batch is freed here.
+	});
+
+	// The rest of the dir scan, on to the metadata rescan.
+	finishDirTravThenStartRescan(dirscan_consumed, std::move(rescan_items_in_promise));
 
-		// Shouldn't get here with no incoming items.
-        Q_ASSERT_X(!new_items->empty(), "DIRTRAV CALLBACK", "NO NEW ITEMS BUT HIT STHEN CALLBACK");
+	if(dirtrav_job.isNull())
+	{
+		Q_ASSERT_X(0, __func__, "dirtrav is null");
+	}
 
-		// Got all the ready results, send them to the model(s).
-        // Because of Qt's model/view system not being threadsafeable, we have to do at least the final
-		// model item entry from the GUI thread.
+    master_job_tracker->registerJob(dirtrav_job);
+//	master_job_tracker->setAutoDelete(dirtrav_job, false);
+//  master_job_tracker->setStopOnClose(dirtrav_job, true);
+	master_job_tracker->registerJob(lib_rescan_job);
+//	master_job_tracker->setAutoDelete(lib_rescan_job, false);
+//	master_job_tracker->setStopOnClose(lib_rescan_job, true);
 
-		for(std::shared_ptr<AbstractTreeModelItem> entry : *new_items)
+    streaming_consume(metadata_channel, [this](std::vector<MetadataReturnVal> batch){
+		Trace::Span span("Metadata::consumeBatch");
+		span.counter("items", batch.size());
+		for(MetadataReturnVal& result : batch)
 		{
-			// Send the URL ~dsr.getMediaExtUrl().m_url.toString()) to the LibraryModel.
-			Q_EMIT SIGNAL_FileUrlQString(entry->data(1).toString());
+			this->SLOT_processReadyResults(std::move(result));
 		}
-
-		Q_ASSERT(new_items->size() == 1);
-
-    	return unit;
-    })
-/// .then() ############################################
-	.then([](ExtFuture<void> fut_ignored) -> Unit {
-                  fut_ignored.waitForFinished();
-		// The dirscan is complete.
-		qDb() << "DIRSCAN COMPLETE .then()";
-
-		return unit;
 	})
-/// .then() ############################################
-	// Finish the output future.
-    .then([this](ExtFuture<Unit> future) mutable {
-
-    	expect_and_set(2, 3);
-		AMLM_ASSERT_NOT_IN_GUITHREAD();
-
-        future.waitForFinished();
+	.then([]()
+	{
+		qDb() << "lib_rescan_future sthen complete.";
+	});
 
-        return unit;
-    })
-	/// .then() ############################################
-	.then(qApp, [this,
-			rescan_items_in_promise = std::move(rescan_items_in_promise)
-			](ExtFuture<Unit> future_unit) mutable {
-		AMLM_ASSERT_IN_GUITHREAD();
+	m_timer.lap("Leaving startAsyncDirTrav");
+}
 
-		m_timer.lap("GUI Thread dirtrav over start.");
+CoTask<void> LibraryRescanner::finishDirTravThenStartRescan(QFuture<void> dirscan_consumed,
+															  QPromise<VecLibRescannerMapItems> rescan_items_in_promise)
+{
+	// Wait for the dir scan to be fully consumed.  Resumes on the thread pool, nothing's held while we wait.
+	// If the scan was canceled or threw, that comes out of here, and rescan_items_in_promise is destroyed unfinished,
+	// which cancels the metadata rescan.
+	co_await dirscan_consumed;
 
-		expect_and_set(3, 4);
+	qDb() << "DIRSCAN COMPLETE";
+	expect_and_set(2, 3);
+	AMLM_ASSERT_NOT_IN_GUITHREAD();
 
-		qDb() << "DIRTRAV COMPLETE, NOW IN GUI THREAD";
+	// The model has to be read from the GUI thread.
+	co_await CoExecutor::guiThread();
+	AMLM_ASSERT_IN_GUITHREAD();
 
-		// Succeeded, but we may still have outgoing filenames in flight.
-		/// @todo Do we need to do something for potential in-flight filenames?
-		qIn() << "DIRTRAV SUCCEEDED";
-		m_timer.lap("DirTrav succeeded");
-		qIn() << "Directory scan time params:";
-		m_timer.print_results();
+	m_timer.lap("GUI Thread dirtrav over start.");
 
-        m_model_ready_to_save_to_db = true; /// @todo REMOVE?
-		Q_ASSERT(m_model_ready_to_save_to_db == true);
-		m_model_ready_to_save_to_db = false;
+	expect_and_set(3, 4);
 
-		m_timer.lap("dirtrav over partial, starting metadata rescan.");
+	qDb() << "DIRTRAV COMPLETE, NOW IN GUI THREAD";
 
-		// Directory traversal complete, start rescan.
+	// Succeeded, but we may still have outgoing filenames in flight.
+	/// @todo Do we need to do something for potential in-flight filenames?
+	qIn() << "DIRTRAV SUCCEEDED";
+	m_timer.lap("DirTrav succeeded");
+	qIn() << "Directory scan time params:";
+	m_timer.print_results();
+	AMLMExecutor::logStats();
 
-		QVector<VecLibRescannerMapItems> rescan_items;
+	m_model_ready_to_save_to_db = true; /// @todo REMOVE?
+	Q_ASSERT(m_model_ready_to_save_to_db == true);
+	m_model_ready_to_save_to_db = false;
 
-		qDb() << "GETTING RESCAN ITEMS";
-		/// @todo What do we need to do with potential in-flight filenames that haven't landed in the model yet?
-		rescan_items = m_current_libmodel->getLibRescanItems();
+	m_timer.lap("dirtrav over partial, starting metadata rescan.");
 
-		qDb() << M_ID_VAL(rescan_items.size());
+	// Directory traversal complete, start rescan.
 
-		if(rescan_items.empty())
-		{
-			qIn() << "Model has no items to rescan:" << m_current_libmodel;
-		}
-		else
-		{
-			// Push all the LibraryRescannerMapItems into the promise and start the metadata rescan.
-			rescan_items_in_promise.start();
-			rescan_items_in_promise.addResults(rescan_items);
-			rescan_items_in_promise.finish();
+	QVector<VecLibRescannerMapItems> rescan_items;
 
-			m_timer.lap("GUI Thread dirtrav over partial, metadata rescan complete.");
+	qDb() << "GETTING RESCAN ITEMS";
+	/// @todo What do we need to do with potential in-flight filenames that haven't landed in the model yet?
+	rescan_items = m_current_libmodel->getLibRescanItems();
 
-			// Start the metadata scan.
-			qDb() << "STARTING RESCAN";
-			// lib_rescan_job->start();
-		}
-		//            lib_rescan_job->start();
-    });
+	qDb() << M_ID_VAL(rescan_items.size());
 
-	if(dirtrav_job.isNull())
+	if(rescan_items.empty())
 	{
-		Q_ASSERT_X(0, __func__, "dirtrav is null");
+		qIn() << "Model has no items to rescan:" << m_current_libmodel;
 	}
-
-    master_job_tracker->registerJob(dirtrav_job);
-//	master_job_tracker->setAutoDelete(dirtrav_job, false);
-//  master_job_tracker->setStopOnClose(dirtrav_job, true);
-	master_job_tracker->registerJob(lib_rescan_job);
-//	master_job_tracker->setAutoDelete(lib_rescan_job, false);
-//	master_job_tracker->setStopOnClose(lib_rescan_job, true);
-
-    streaming_then(lib_rescan_future, [this](QFuture<MetadataReturnVal> lib_rescan_future, int begin, int end){
-		for(int i = begin; i<end; ++i)
-		{
-			qDb() << "lib_rescan_future sthen:" << i;
-			this->SLOT_processReadyResults(lib_rescan_future.resultAt(i));
-		}
-	})
-	.then([]()
+	else
 	{
-		qDb() << "lib_rescan_future sthen complete.";
-	});
+		// Push all the LibraryRescannerMapItems into the promise and start the metadata rescan.
+		rescan_items_in_promise.start();
+		rescan_items_in_promise.addResults(rescan_items);
+		rescan_items_in_promise.finish();
 
-	m_timer.lap("Leaving startAsyncDirTrav");
+		m_timer.lap("GUI Thread dirtrav over partial, metadata rescan complete.");
+
+		// Start the metadata scan.
+		qDb() << "STARTING RESCAN";
+		// lib_rescan_job->start();
+	}
 }
 
 void LibraryRescanner::cancelAsyncDirectoryTraversal()
 {
-//	m_dirtrav_future.cancel();
+	qIn() << "Canceling directory scan and metadata rescan";
+	m_scan_cancel_source.cancel();
 }
 
 void LibraryRescanner::SLOT_processReadyResults(MetadataReturnVal lritem_vec)
 {
 	// We got one of ??? things back:
-	// - A single pindex and associated LibraryEntry*, maybe new, maybe a rescan..
-	// - A single pindex and more than one LibraryEntry*, the result of the first scan after the file was found.
-	// - Multiple pindexs and LibraryEntry*'s.  The result of a multi-track file rescan.
+	// - A single entry ID and associated LibraryEntry*, maybe new, maybe a rescan..
+	// - A single entry ID and more than one LibraryEntry*, the result of the first scan after the file was found.
+	// - Multiple entry IDs and LibraryEntry*'s.  The result of a multi-track file rescan.
+	// Note that we may not be in the GUI thread here, so we don't try to resolve the IDs to rows.  The model
+	// does that when the signals land.
 
 	if(lritem_vec.m_num_tracks_found == 0)
 	{
@@ -450,44 +464,37 @@ void LibraryRescanner::SLOT_processReadyResults(MetadataReturnVal lritem_vec)
 	}
 
 	if(lritem_vec.m_num_tracks_found > 1
-	   && lritem_vec.m_original_pindexes.size() == 1
+	   && lritem_vec.m_original_ids.size() == 1
 			&& lritem_vec.m_new_libentries.size() == lritem_vec.m_num_tracks_found)
 	{
 		// It's a valid, new, multi-track entry.
-        Q_EMIT SIGNAL_onIncomingPopulateRowWithItems_Multiple(lritem_vec.m_original_pindexes[0], lritem_vec.m_new_libentries);
+        Q_EMIT SIGNAL_onIncomingPopulateRowWithItems_Multiple(lritem_vec.m_original_ids[0], lritem_vec.m_new_libentries);
 	}
 	else if(lritem_vec.m_new_libentries.size() == lritem_vec.m_num_tracks_found
-			&& lritem_vec.m_original_pindexes.size() == lritem_vec.m_num_tracks_found)
+			&& lritem_vec.m_original_ids.size() == lritem_vec.m_num_tracks_found)
 	{
-		// It's a matching set of pindexes and libentries.
+		// It's a matching set of entry IDs and libentries.
 
 		for(int i=0; i<lritem_vec.m_num_tracks_found; ++i)
 		{
-			if (!lritem_vec.m_original_pindexes[i].isValid())
+			if (!lritem_vec.m_original_ids[i].isValid())
 			{
-				qWarning() << "Invalid persistent index, ignoring update";
+				qWarning() << "Invalid entry ID, ignoring update";
 				return;
 			}
 
 			// None of the returned entries should be null.
 			Q_ASSERT(lritem_vec.m_new_libentries[i] != nullptr);
 
-			qDebug() << "Replacing entry"; // << item->getUrl();
-			// item is a single song which has its metadata populated.
-			// Reconstruct the QModelIndex we sent out.
-			auto initial_row_index = QModelIndex(lritem_vec.m_original_pindexes[i]);
-			auto row = initial_row_index.row();
-			qDebug() << QString("incoming single item, row %1").arg(row);
 			// Metadata's been populated.
-            Q_EMIT SIGNAL_setData(initial_row_index, QVariant::fromValue(lritem_vec.m_new_libentries[i]));
+            Q_EMIT SIGNAL_onIncomingPopulateRowWithItems_Single(lritem_vec.m_original_ids[i], lritem_vec.m_new_libentries[i]);
 		}
 	}
 	else
 	{
 		// Not sure what we got.
-		qCritical() << "pindexes/libentries/num_new_entries:" << lritem_vec.m_original_pindexes.size()
+		qCritical() << "entry ids/libentries/num_new_entries:" << lritem_vec.m_original_ids.size()
 															  << lritem_vec.m_new_libentries.size();
-															  // lritem_vec.m_new_libentries;
 		Q_ASSERT_X(0, "Scanning", "Not sure what we got");
 	}
 }
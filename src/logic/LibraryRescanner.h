@@ -29,14 +29,17 @@
 
 // Qt
 #include <QObject>
-#include <QPersistentModelIndex>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QPromise>
 #include <QVector>
 
 // Ours
 #include "LibraryRescannerMapItem.h"
+#include "UUIncD.h"
 #include <logic/models/AbstractTreeModelItem.h>
+#include <concurrency/CancellationToken.h>
+#include <concurrency/CoTask.h>
 #include <utils/Stopwatch.h>
 
 class LibraryModel;
@@ -46,15 +49,20 @@ class ScanResultsTreeModelItem;
 class SharedItemContType;
 
 
+/**
+ * The results of a metadata (re)scan of one file.
+ * Entries are addressed by their stable Library entry IDs, which are only resolved to rows
+ * by the LibraryModel when the results are applied in the GUI thread.
+ */
 struct MetadataReturnVal
 {
-	std::vector<QPersistentModelIndex> m_original_pindexes;
+	std::vector<UUIncD> m_original_ids;
 	std::vector<std::shared_ptr<LibraryEntry>> m_new_libentries;
 	int m_num_tracks_found {0};
 
-	void push_back(QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> le)
+	void push_back(UUIncD id, std::shared_ptr<LibraryEntry> le)
 	{
-		m_original_pindexes.push_back(pmi);
+		m_original_ids.push_back(id);
 		m_new_libentries.push_back(le);
 		m_num_tracks_found++;
 	}
@@ -94,9 +102,9 @@ Q_SIGNALS:
 
 	void SIGNAL_appendChild(std::shared_ptr<AbstractTreeModelItem> new_child, UUIncD parent_id);
 
-    void SIGNAL_onIncomingPopulateRowWithItems_Multiple(QPersistentModelIndex, std::vector<std::shared_ptr<LibraryEntry>>);
+    void SIGNAL_onIncomingPopulateRowWithItems_Multiple(UUIncD, std::vector<std::shared_ptr<LibraryEntry>>);
 
-    void SIGNAL_setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+    void SIGNAL_onIncomingPopulateRowWithItems_Single(UUIncD, std::shared_ptr<LibraryEntry>);
 
 public:
 	explicit LibraryRescanner(LibraryModel* parent);
@@ -114,13 +122,14 @@ public Q_SLOTS:
 	 */
 	void startAsyncDirectoryTraversal(const QUrl& dir_url);
 
+	/// Cancels the scan started by the last startAsyncDirectoryTraversal(), both the dir scan and the metadata rescan.
 	void cancelAsyncDirectoryTraversal();
 
 //	void onDirTravFinished();
 	/**
 	 * @todo This doesn't need to be a slot anymore AFAICT.
 	 * Slot which accepts the incoming metadata from the async scan.
-	 * Emits signals SIGNAL_onIncomingPopulateRowWithItems_Multiple(), SIGNAL_setData().
+	 * Emits signals SIGNAL_onIncomingPopulateRowWithItems_Multiple(), SIGNAL_onIncomingPopulateRowWithItems_Single().
 	 */
 	void SLOT_processReadyResults(MetadataReturnVal lritem_vec);
 
@@ -135,6 +144,13 @@ protected:
 	void SaveDatabase(std::shared_ptr<ScanResultsTreeModel> tree_model_ptr, const QString& database_filename);
 	void LoadDatabase(std::shared_ptr<ScanResultsTreeModel> tree_model_ptr, const QString& database_filename);
 
+	/**
+	 * Waits for @a dirscan_consumed, then gets the rescan items from the model in the GUI thread and pushes them into
+	 * @a rescan_items_in_promise to start the metadata rescan.
+	 */
+	CoTask<void> finishDirTravThenStartRescan(QFuture<void> dirscan_consumed,
+											  QPromise<VecLibRescannerMapItems> rescan_items_in_promise);
+
 
 private:
 	Q_DISABLE_COPY(LibraryRescanner)
@@ -154,6 +170,11 @@ private:
 
 	Stopwatch m_timer;
 
+	/// Canceled when we're destroyed, or when the app shuts down.
+	CancellationSource m_cancel_source {CancellationSource::appRoot().token()};
+	/// The current scan's, under m_cancel_source.
+	CancellationSource m_scan_cancel_source {m_cancel_source.token()};
+
 };
 
 
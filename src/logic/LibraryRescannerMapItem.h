@@ -27,14 +27,16 @@
 
 // Qt
 #include <QDebug>
-#include <QPersistentModelIndex>
 #include <QVector>
 
 // Ours
 #include "LibraryEntry.h"
+#include "UUIncD.h"
 
 /**
  * Represents a single item in the LibraryModel which needs its data refreshed.
+ * The item is addressed by its stable Library entry ID, not by a QPersistentModelIndex, so a
+ * rescan snapshot doesn't put any load on the model's persistent index bookkeeping.
  */
 struct LibraryRescannerMapItem
 {
@@ -42,13 +44,13 @@ private:
     Q_GADGET
 
 public:
-	QPersistentModelIndex pindex {QPersistentModelIndex()};
+	UUIncD entry_id {UUIncD::null()};
 	std::shared_ptr<LibraryEntry> item {nullptr};
 };
 
 //inline static QDebug operator<<(QDebug dbg, const LibraryRescannerMapItem &item)
 //{
-//    return dbg << QStringLiteral("LibraryRescannerMapItem(") << item.pindex << "," << item.item << ")";
+//    return dbg << QStringLiteral("LibraryRescannerMapItem(") << item.entry_id << "," << item.item << ")";
 //}
 
 using VecLibRescannerMapItems = QVector<LibraryRescannerMapItem>;
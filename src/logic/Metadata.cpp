@@ -70,6 +70,7 @@
 #include <utils/RegisterQtMetatypes.h>
 #include "CueSheet.h"
 #include <logic/serialization/SerializationHelpers.h>
+#include <logic/serialization/XmlStreamVisitor.h>
 
 
 AMLM_QREG_CALLBACK([](){
@@ -613,6 +614,20 @@ std::string Metadata::operator[](const std::string& key) const
 	}
 }
 
+AMLMTagMap Metadata::display_fields() const
+{
+	AMLMTagMap retval;
+	for(const auto& entry : f_name_normalization_map)
+	{
+		std::string value = (*this)[entry.first];
+		if(!value.empty())
+		{
+			retval.insert(entry.first, value);
+		}
+	}
+	return retval;
+}
+
 using strviw_type = QLatin1String;
 
 #define M_DATASTREAM_FIELDS(X) \
@@ -683,6 +698,31 @@ QVariant Metadata::toVariant() const
 	return map;
 }
 
+void Metadata::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	// Keep this in sync with toVariant().
+	visitor.beginMap(node_name);
+
+#define X(field_tag, member_field)   visitor.writeField(field_tag, member_field);
+    M_DATASTREAM_FIELDS(X)
+    M_DATASTREAM_FIELDS_MAPS(X)
+#undef X
+
+	// All tracks on the disc.
+	visitor.beginList(XMLTAG_TRACKS);
+	for(const auto& it : m_tracks)
+	{
+		it.second.toXmlStream(visitor, "track");
+	}
+	visitor.endElement();
+
+	// The cuesheets, again.
+	visitor.writeField(XMLTAG_CUESHEET_EMBEDDED, m_cuesheet_embedded);
+	visitor.writeField(XMLTAG_CUESHEET_SIDECAR, m_cuesheet_sidecar);
+
+	visitor.endElement();
+}
+
 void Metadata::fromVariant(const QVariant& variant)
 {
 	InsertionOrderedMap<QString, QVariant> map;
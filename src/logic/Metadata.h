@@ -120,6 +120,9 @@ public:
 	/// Return all string metadata as a map.
 	AMLMTagMap filled_fields() const;
 
+	/// Return operator[]() of every key it knows which has a value, i.e. everything operator[]() can return.
+	AMLMTagMap display_fields() const;
+
 	/// Cue sheet support.
 	bool hasCueSheet() const { return m_has_cuesheet; }
     bool hasCueSheetEmbedded() const { return m_cuesheet_embedded.origin() == CueSheet::Origin::Embedded; }
@@ -162,6 +165,8 @@ public:
 	QVariant toVariant() const override;
 	/// Serialize item and any children from a QVariant.
 	void fromVariant(const QVariant& variant) override;
+	/// Stream out the same thing toVariant() returns.
+	void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const override;
 
 	/// @}
 
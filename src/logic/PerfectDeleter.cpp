@@ -28,12 +28,17 @@
 #include <future/future_algorithms.h> ///< For Uniform Container Erasure.
 
 // Qt
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
 #include <QtConcurrentFilter>
 
 // Ours
 #include <utils/DebugHelpers.h>
 #include <utils/StringHelpers.h>
+#include <concurrency/AMLMExecutor.h>
 #include <concurrency/AMLMJob.h>
+#include <concurrency/CancellationToken.h>
 
 /**
  * Some notes on resource management in the bizzaro-world of Qt5:
@@ -151,7 +156,7 @@ public:
 		// Killing them softly is probably the right way to go here.
 		object()->kill(KJob::KillVerbosity::Quietly);
 	};
-	bool poll_wait() override { return true; /** @todo */ };
+	bool poll_wait() override { return object() == nullptr || object()->isFinished(); };
 
 	AMLMJob* object() const override { return dynamic_cast<AMLMJob*>(m_to_be_deleted); };
 };
@@ -172,8 +177,8 @@ public:
 	};
 	bool poll_wait() override
 	{
-		// Block and wait until the QThread completes (or hasn't started).
-		return object()->wait();
+		// Don't block, true if the QThread has completed (or hasn't started).
+		return object()->wait(0);
 	};
 
 	QThread* object() const override { return dynamic_cast<QThread*>(m_to_be_deleted); };
@@ -200,57 +205,200 @@ PerfectDeleter& PerfectDeleter::instance(QObject* parent)
 	return *m_the_instance;
 }
 
-void PerfectDeleter::cancel_and_wait_for_all()
+bool PerfectDeleter::cancel_and_wait_for_all(std::chrono::milliseconds budget)
 {
-	std::lock_guard lock(m_mutex);
+	return cancel_and_wait_for_all(CancellationSource::appRoot(), budget);
+}
 
+bool PerfectDeleter::cancel_and_wait_for_all(CancellationSource& root, std::chrono::milliseconds budget)
+{
 	// Ok, we're going down, so try to do so with as little leakage as possible.
+	QElapsedTimer shutdown_timer;
+	shutdown_timer.start();
+
+	// Everything which checks a CancellationToken starts stopping now.  Not under m_mutex, the callbacks can do anything.
+	root.cancel();
+
+	std::vector<QPointer<KJob>> jobs_to_kill;
+	std::vector<std::shared_ptr<DeletableBase>> deletables_to_cancel;
+	{
+		std::lock_guard lock(m_mutex);
+
+		// First print some stats.
+		qIno() << "END OF PROGRAM SUMMARY OF OPEN RESOURCES";
+		auto stats_text = stats_internal();
+		for(const auto& line : std::as_const(stats_text))
+		{
+			qIno() << line;
+		}
+
+		// Killing a job can emit finished() right here, and the removers take m_mutex, so just collect them here.
+		for(const auto& d : m_watched_AMLMJobs)
+		{
+			jobs_to_kill.emplace_back(qobject_cast<KJob*>(d->object()));
+		}
+		for(const QPointer<KJob>& kjob : m_watched_KJobs)
+		{
+			jobs_to_kill.emplace_back(kjob);
+		}
+		deletables_to_cancel.assign(m_watched_QThreads.cbegin(), m_watched_QThreads.cend());
+		deletables_to_cancel.insert(deletables_to_cancel.end(), m_watched_deletables.cbegin(), m_watched_deletables.cend());
+
+		// Canceling a QFuture doesn't call anything of ours.
+		qIno() << "Canceling" << m_future_synchronizer.futures().size() << "QFuture<void>'s";
+		for(QFuture<void>& f : m_future_synchronizer.futures())
+		{
+			f.cancel();
+		}
+	}
+
+	qIno() << "Killing" << jobs_to_kill.size() << "AMLMJobs and KJobs";
+	for(const QPointer<KJob>& kjob : jobs_to_kill)
+	{
+		if(!kjob.isNull())
+		{
+			// Killing them softly is probably the right way to go here.
+			kjob->kill(KJob::KillVerbosity::Quietly);
+		}
+	}
 
-	// First print some stats.
-	qIno() << "END OF PROGRAM SUMMARY OF OPEN RESOURCES";
-	auto stats_text = stats_internal();
-    for(const auto& line : std::as_const(stats_text))
+	qIno() << "Canceling" << deletables_to_cancel.size() << "Deletables";
+	for(auto& d : deletables_to_cancel)
 	{
-		qIno() << line;
+		d->cancel();
 	}
 
-	// Cancel all registered AMLMJobs.
-	qIno() << "Killing" << m_watched_AMLMJobs.size() << "AMLMJobs";
-	for(auto& it : m_watched_AMLMJobs)
+	// Wait for it all to finish, or for the budget to run out.
+	// The event loop has to keep running while we wait: a dir scan can be blocked on the GUI thread, and the watch
+	// lists are pruned by queued signals.  So no m_mutex held across the processEvents().
+	QStringList still_running;
+	while(true)
 	{
-		it->cancel();
+		QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+
+		{
+			std::lock_guard lock(m_mutex);
+			still_running = still_running_internal();
+		}
+
+		if(still_running.isEmpty() || shutdown_timer.hasExpired(budget.count()))
+		{
+			break;
+		}
+
+		QThread::msleep(5);
 	}
 
-	// Cancel all registered KJobs.
-	qIno() << "Killing" << m_watched_KJobs.size() << "KJobs";
-	for(KJob* i : m_watched_KJobs)
+	const bool all_finished = still_running.isEmpty();
+	if(all_finished)
 	{
-		if(i != nullptr)
+		std::lock_guard lock(m_mutex);
+		m_future_synchronizer.clearFutures();
+		qIno() << "Everything canceled and finished in" << shutdown_timer.elapsed() << "ms";
+	}
+	else
+	{
+		qWro() << "Shutdown budget of" << budget.count() << "ms spent, still running:";
+		for(const auto& line : std::as_const(still_running))
 		{
-			// Killing them softly is probably the right way to go here.
-			i->kill(KJob::KillVerbosity::Quietly);
+			qWro() << line;
 		}
 	}
+	CancellationSource::logLatencyStats();
+
+	return all_finished;
+}
 
-	// Wait for the QFutures to finish.
-	/// @todo Need to keep event loop running here?
-//	scan_and_purge_futures();
-	qIno() << "Canceling" << m_future_synchronizer.futures().size() << "QFuture<void>'s and waiting for them to finish...";
-	m_future_synchronizer.waitForFinished();
+void PerfectDeleter::abandon_still_running()
+{
+	std::lock_guard lock(m_mutex);
+
+	// They've all been canceled, and QFutureSynchronizer's destructor would wait for them regardless.
 	m_future_synchronizer.clearFutures();
-	qIno() << "QFuture<void> wait complete.";
 
-	// Wait for the AMLMJobs to finish.
-	/// @todo Probably need to keep event loop running here.
-	waitForAMLMJobsFinished(true);
+	int num_abandoned = 0;
+	auto abandon = [&](QObject* object){
+		if(object != nullptr)
+		{
+			qWro() << "Abandoning:" << object;
+			object->setParent(nullptr);
+			num_abandoned++;
+		}
+	};
+	for(const auto& d : m_watched_AMLMJobs)
+	{
+		if(!d->poll_wait())
+		{
+			abandon(d->object());
+		}
+	}
+	for(const QPointer<KJob>& kjob : m_watched_KJobs)
+	{
+		if(!kjob.isNull() && !kjob->isFinished())
+		{
+			abandon(kjob);
+		}
+	}
+	for(const auto& d : m_watched_QThreads)
+	{
+		if(!d->poll_wait())
+		{
+			abandon(d->object());
+		}
+	}
+	qWro() << "Abandoned" << num_abandoned << "jobs and threads";
+}
 
-	// Cancel all "deletables".
-	qIno() << "Canceling" << m_watched_deletables.size() << "Deletables";
-	for(auto& d : m_watched_deletables)
+QStringList PerfectDeleter::still_running_internal()
+{
+	/// @note Requires m_mutex to already be held.
+	QStringList retval;
+
+	for(const QFuture<void>& f : m_future_synchronizer.futures())
 	{
-		d->cancel();
+		if(!f.isFinished())
+		{
+			retval << tr("QFuture<void>");
+		}
 	}
-	// Wait for them to be canceled and deleted.
+	for(const auto& d : m_watched_AMLMJobs)
+	{
+		if(!d->poll_wait())
+		{
+			retval << tr("AMLMJob: %1").arg(toqstr(d->name()));
+		}
+	}
+	for(const QPointer<KJob>& kjob : m_watched_KJobs)
+	{
+		if(!kjob.isNull() && !kjob->isFinished())
+		{
+			retval << tr("KJob: %1").arg(kjob->objectName());
+		}
+	}
+	for(const auto& d : m_watched_QThreads)
+	{
+		if(!d->poll_wait())
+		{
+			retval << tr("QThread: %1").arg(toqstr(d->name()));
+		}
+	}
+	for(const auto& d : m_watched_deletables)
+	{
+		if(!d->poll_wait())
+		{
+			retval << tr("Deletable: %1").arg(toqstr(d->name()));
+		}
+	}
+	// Work which isn't watched, e.g. TaskGroup tasks, still has to be out of the executors.
+	for(AMLMExecutor* executor : {&AMLMExecutor::io(), &AMLMExecutor::cpu(), &AMLMExecutor::interactive()})
+	{
+		if(!executor->pool()->waitForDone(0))
+		{
+			retval << tr("Executor: %1").arg(executor->name());
+		}
+	}
+
+	return retval;
 }
 
 bool PerfectDeleter::empty() const
@@ -23,6 +23,7 @@
 /// @file
 
 // Std C++
+#include <chrono>
 #include <deque>
 #include <mutex>
 #include <memory>
@@ -45,6 +46,7 @@ class AMLMJob;
 
 // Ours
 #include <utils/DebugHelpers.h>
+#include <concurrency/CancellationToken.h>
 #include <concurrency/ExtFuture.h>
 // template <class T> class ExtFuture; // !QT6
 template <class T>
@@ -180,7 +182,28 @@ public:
 	static PerfectDeleter& instance(QObject* parent = nullptr);
 
 
-	void cancel_and_wait_for_all();
+	/// How long cancel_and_wait_for_all() waits by default.
+	static constexpr std::chrono::milliseconds c_default_shutdown_budget {3000};
+
+	/**
+	 * Cancels everything, CancellationSource::appRoot() first, then the jobs, futures and Deletables, and waits up
+	 * to @a budget for them to finish.  Keeps the event loop running while it waits, since some of them need the GUI
+	 * thread to get to their next cancellation check.  Logs whatever's still running when the budget's spent.
+	 * @returns true if everything finished in time.
+	 */
+	bool cancel_and_wait_for_all(std::chrono::milliseconds budget = c_default_shutdown_budget);
+
+	/// cancel_and_wait_for_all(), but canceling @a root instead of CancellationSource::appRoot().
+	bool cancel_and_wait_for_all(CancellationSource& root, std::chrono::milliseconds budget = c_default_shutdown_budget);
+
+	/**
+	 * For after cancel_and_wait_for_all() has run out of time: lets go of whatever's still running instead of
+	 * destroying it.  The jobs and QThreads which haven't finished are unparented, so the app's teardown doesn't
+	 * delete them out from under their workers, and the futures are dropped, so our destructor doesn't wait on them.
+	 * They're leaked, the process is going away anyway.  The AMLMExecutors are never destroyed, so their threads aren't
+	 * waited on either.
+	 */
+	void abandon_still_running();
 
 	bool empty() const;
 	size_t size() const;
@@ -240,6 +263,9 @@ private:
 
 	bool waitForAMLMJobsFinished(bool spin);
 
+	/// One poll of everything cancel_and_wait_for_all() is waiting on.  Requires m_mutex.
+	QStringList still_running_internal();
+
 	/// Private helper for clearing out completed futures.
 	void scan_and_purge_futures();
 
@@ -54,6 +54,8 @@
 
 /// Ours
 #include "TagLibHelpers.h"
+#include <concurrency/AMLMExecutor.h>
+#include <concurrency/TaskGroup.h>
 
 CoverArtJob::CoverArtJob(QObject* parent, const QUrl &url) : BASE_CLASS(parent), m_audio_file_url(url)
 {
@@ -82,7 +84,10 @@ ExtFuture<QByteArray> CoverArtJob::make_task(QObject* parent, const QUrl& url)
 	return ret_future;
 #endif
 
-    return QtConcurrent::run(&CoverArtJob::LoadCoverArt, nullptr, url);
+	// The user's waiting on this one, don't let it queue up behind a scan.
+	// One per selected row, so no AMLMJob each, they're shown together.
+	static TaskGroup s_cover_art_tasks("CoverArtLoads", AMLMExecutor::interactive());
+	return s_cover_art_tasks.run(&CoverArtJob::LoadCoverArt, nullptr, url);
 }
 
 ///
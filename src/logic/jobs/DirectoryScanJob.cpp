@@ -19,7 +19,12 @@
 
 #include "DirectoryScanJob.h"
 
+// Std C++
+#include <vector>
+
 // Qt
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QString>
 #include <QUrl>
 #include <QDirIterator>
@@ -28,8 +33,14 @@
 // Ours
 #include <utils/TheSimplestThings.h>
 #include <logic/DirScanResult.h>
+#include <logic/DirSummaryCache.h>
 #include <utils/Stopwatch.h>
+#include <utils/Trace.h>
+
 
+/// DirScanFunction() reports progress through the promise, which posts an event per call.  Per file was swamping
+/// the GUI thread on big trees, so it's limited to this many times a second.
+static constexpr qint64 c_min_ms_between_progress_reports = 1000 / 60;
 
 void DirScanFunction(QPromise<DirScanResult>& promise,
                      const QUrl& dir_url, // The URL pointing at the directory to recursively scan.
@@ -81,6 +92,9 @@ void DirScanFunction(QPromise<DirScanResult>& promise,
 	promise.setProgressRange(0, 0);
 	promise.setProgressValueAndText(0, status_text);
 
+	QElapsedTimer since_last_progress_report;
+	since_last_progress_report.start();
+
 	// Iterate through the directory tree.
 	while(dir_iterator.hasNext())
 	{
@@ -106,8 +120,12 @@ void DirScanFunction(QPromise<DirScanResult>& promise,
 //            setTotalAmountAndSize(KJob::Unit::Directories, num_discovered_dirs+1);
 //            setProcessedAmountAndSize(KJob::Unit::Directories, num_discovered_dirs);
 //            setTotalAmountAndSize(KJob::Unit::Files, num_possible_files+1);
-			promise.setProgressRange(0, num_possible_files + 1);
-			promise.setProgressValue(num_files_found_so_far);
+			if(since_last_progress_report.elapsed() >= c_min_ms_between_progress_reports)
+			{
+				promise.setProgressRange(0, num_possible_files + 1);
+				promise.setProgressValue(num_files_found_so_far);
+				since_last_progress_report.restart();
+			}
 		}
 		else if(file_info.isFile())
 		{
@@ -124,8 +142,6 @@ void DirScanFunction(QPromise<DirScanResult>& promise,
 			DirScanResult dir_scan_result(file_url, file_info);
 //			qDb() << "DIRSCANRESULT:" << dir_scan_result;
 
-            promise.setProgressValueAndText(num_files_found_so_far, QObject::tr("File: %1").arg(file_url.toString()));
-
 			// Update progress.
 			/// @note Bytes is being used for "Size" == progress by the system.
 			/// No real need to accumulate that here anyway.
@@ -137,10 +153,14 @@ void DirScanFunction(QPromise<DirScanResult>& promise,
 			{
 				// Keep progress range at least one more than the number of files we've found.
 				num_possible_files = num_files_found_so_far+1;
+			}
+			if(since_last_progress_report.elapsed() >= c_min_ms_between_progress_reports)
+			{
 //                setTotalAmountAndSize(KJob::Unit::Files, num_possible_files);
 				promise.setProgressRange(0, num_possible_files);
+				promise.setProgressValueAndText(num_files_found_so_far, QObject::tr("File: %1").arg(file_url.toString()));
+				since_last_progress_report.restart();
 			}
-			promise.setProgressValue(num_files_found_so_far);
 
 			// Report the URL we found to the future.
             promise.addResult(dir_scan_result);
@@ -173,3 +193,232 @@ void DirScanFunction(QPromise<DirScanResult>& promise,
 	return;
 }
 
+static QString child_path(const QString& dir_path, const QString& name)
+{
+	return dir_path.endsWith(u'/') ? dir_path + name : dir_path + u'/' + name;
+}
+
+void DirScanIncrementalFunction(QPromise<Unit>& promise,
+                                std::shared_ptr<BoundedChannel<DirScanResult>> out_channel,
+                                std::shared_ptr<ProgressCounter> progress,
+                                CancellationToken cancel_token,
+                                const QUrl& dir_url,
+                                const QStringList& name_filters,
+                                DirSummaryCache::Mode mode)
+{
+	Stopwatch sw;
+	sw.start("DirScanningIncremental");
+
+	if(!dir_url.isLocalFile())
+	{
+		out_channel->cancel();
+		throw QException();//, "NOT IMPLEMENTED", "dir_url is not a local file");
+	}
+
+	const QString root_path = QDir::cleanPath(dir_url.toLocalFile());
+
+	// Check for errors.
+	QFileInfo root_info(root_path);
+	if(!(root_info.exists() && root_info.isReadable() && root_info.isDir()))
+	{
+		qWr() << "UNABLE TO READ TOP-LEVEL DIRECTORY:" << dir_url;
+		/// @todo Need to report something here.  Or maybe throw?
+		out_channel->close();
+		return;
+	}
+
+	if(mode == DirSummaryCache::Mode::TrustDirMtime && DirSummaryCache::hasUnreliableDirMtimes(dir_url))
+	{
+		qIn() << "Directory mtimes aren't reliable on the filesystem of" << dir_url << ", verifying every directory";
+		mode = DirSummaryCache::Mode::Verify;
+	}
+
+	DirSummaryCache cache(dir_url);
+	if(mode != DirSummaryCache::Mode::Off)
+	{
+		cache.load();
+		sw.lap("Loaded directory summaries");
+	}
+
+	int num_files_found_so_far = 0;
+	int num_dirs_listed = 0;
+	int num_dirs_skipped = 0;
+	int num_dirs_changed = 0;
+
+	QString status_text = QObject::tr("Scanning for music files");
+
+	promise.setProgressValueAndText(0, status_text);
+
+	// Depth-first, with the subdirectories pushed in reverse so they're visited in name order.
+	std::vector<QString> dirs_to_scan {root_path};
+	QStringList subdirs_to_push;
+
+	while(!dirs_to_scan.empty())
+	{
+		// Have we been canceled, or has the consumer gone away?
+		promise.suspendIfRequested();
+		if(cancel_token.checkpoint() || promise.isCanceled() || out_channel->isCanceled())
+		{
+			qIn() << "CANCELLED";
+			break;
+		}
+
+		const QString dir_path = std::move(dirs_to_scan.back());
+		dirs_to_scan.pop_back();
+
+		Trace::Span dir_span("DirScan::dir");
+
+		const std::optional<DirStat> dir_stat = DirStat::of(dir_path);
+		if(!dir_stat)
+		{
+			qWr() << "UNREADABLE/NON-EXISTENT DIRECTORY:" << dir_path;
+			/// @todo Collect errors
+			continue;
+		}
+
+		const DirSummary* last_summary = (mode == DirSummaryCache::Mode::Off) ? nullptr : cache.find(dir_path);
+
+		if(mode == DirSummaryCache::Mode::TrustDirMtime && last_summary != nullptr
+			&& DirSummaryCache::isUnchanged(*last_summary, *dir_stat))
+		{
+			// Nothing's been added, removed or renamed in here since the last scan, so no need to list it.  The files
+			// can still have been modified in place though, so they're stat()ed, but that's all: the directory and the
+			// sidecar cue sheets are as the summary has them.
+			// Its subdirectories still need to be looked at, changes in them don't touch this one's mtime.
+			const QFileInfo dir_info(dir_path);
+			const ExtUrl dir_exturl(QUrl::fromLocalFile(child_path(dir_path, QString())), &dir_info);
+			std::vector<DirScanResult> unchanged_files;
+			unchanged_files.reserve(last_summary->m_files.size());
+			for(const QString& file_name : last_summary->m_files)
+			{
+				const QFileInfo file_info(child_path(dir_path, file_name));
+				if(!file_info.exists())
+				{
+					// Gone without the directory's mtime changing, it'll be picked up next time.
+					qWr() << "FILE FROM UNCHANGED DIRECTORY NO LONGER EXISTS:" << file_info.absoluteFilePath();
+					continue;
+				}
+				unchanged_files.emplace_back(QUrl::fromLocalFile(file_info.absoluteFilePath()), file_info, dir_exturl,
+											 last_summary->m_files_with_sidecar_cuesheet.contains(file_name));
+			}
+			num_files_found_so_far += static_cast<int>(unchanged_files.size());
+			dir_span.counter("unchanged_files", unchanged_files.size());
+			progress->setProcessed(num_files_found_so_far);
+			progress->setTotal(num_files_found_so_far + 1);
+			progress->updateCurrentItem([&](){ return dir_path; });
+			if(!out_channel->push_batch(std::move(unchanged_files)))
+			{
+				// The consumer's gone.
+				break;
+			}
+			for(auto it = last_summary->m_subdirs.crbegin(); it != last_summary->m_subdirs.crend(); ++it)
+			{
+				dirs_to_scan.push_back(child_path(dir_path, *it));
+			}
+			cache.record(dir_path, *last_summary);
+			num_dirs_skipped++;
+			continue;
+		}
+
+		// List and stat everything in the directory.
+		DirSummary summary;
+		summary.m_mtime_ns = dir_stat->m_mtime_ns;
+		summary.m_inode = dir_stat->m_inode;
+		// Before the listing, so anything which changes while we're listing is inside the racy window.
+		summary.m_scanned_at_ns = QDateTime::currentMSecsSinceEpoch() * 1'000'000;
+
+		const QFileInfoList children = QDir(dir_path).entryInfoList(name_filters,
+																	 QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot,
+																	 QDir::Name);
+		subdirs_to_push.clear();
+		for(const QFileInfo& file_info : children)
+		{
+			if(cancel_token.checkpoint())
+			{
+				break;
+			}
+
+			// First check that we have a valid file or dir: Currently exists and is readable by current user.
+			if(!(file_info.exists() && file_info.isReadable()))
+			{
+				qWr() << "UNREADABLE/NON-EXISTENT FILE:" << file_info.absoluteFilePath();
+				/// @todo Collect errors
+			}
+			else if(file_info.isDir())
+			{
+				summary.m_children_hash = dir_summary_hash_child(summary.m_children_hash, file_info.fileName(), 0, 0);
+				// Symlinked dirs aren't followed, same as DirScanFunction().
+				if(!file_info.isSymLink())
+				{
+					summary.m_subdirs.append(file_info.fileName());
+					subdirs_to_push.append(file_info.absoluteFilePath());
+				}
+			}
+			else if(file_info.isFile())
+			{
+				summary.m_children_hash = dir_summary_hash_child(summary.m_children_hash, file_info.fileName(),
+																 file_info.size(), file_info.lastModified().toMSecsSinceEpoch());
+				summary.m_files.append(file_info.fileName());
+
+				num_files_found_so_far++;
+				progress->setProcessed(num_files_found_so_far);
+				progress->setTotal(num_files_found_so_far + 1);
+				progress->updateCurrentItem([&](){ return file_info.absoluteFilePath(); });
+				DirScanResult dsr(QUrl::fromLocalFile(file_info.absoluteFilePath()), file_info);
+				if(dsr.getDirProps().testFlag(DirScanResult::HasSidecarCueSheet))
+				{
+					summary.m_files_with_sidecar_cuesheet.append(file_info.fileName());
+				}
+				// Blocks while the consumer catches up.
+				if(!out_channel->push(std::move(dsr), promise))
+				{
+					break;
+				}
+			}
+		}
+		summary.m_num_entries = children.size();
+		dir_span.counter("entries", children.size());
+
+		for(auto it = subdirs_to_push.crbegin(); it != subdirs_to_push.crend(); ++it)
+		{
+			dirs_to_scan.push_back(*it);
+		}
+
+		if(last_summary == nullptr || last_summary->m_num_entries != summary.m_num_entries
+			|| last_summary->m_children_hash != summary.m_children_hash)
+		{
+			num_dirs_changed++;
+		}
+		if(mode != DirSummaryCache::Mode::Off)
+		{
+			cache.record(dir_path, std::move(summary));
+		}
+		num_dirs_listed++;
+	}
+
+	// We've either completed our work or been canceled.
+	if(cancel_token.isCanceled() || promise.isCanceled() || out_channel->isCanceled())
+	{
+		out_channel->cancel();
+	}
+	else
+	{
+		out_channel->close();
+
+		progress->setTotal(num_files_found_so_far);
+		promise.setProgressValueAndText(num_files_found_so_far, status_text);
+
+		if(mode != DirSummaryCache::Mode::Off)
+		{
+			// Only a complete scan knows which directories are gone.
+			cache.commitRecorded();
+			cache.save();
+		}
+	}
+
+	qIn() << "Directory scan of" << dir_url << ":" << num_files_found_so_far << "files," << num_dirs_listed << "dirs listed,"
+		<< num_dirs_skipped << "unchanged dirs skipped," << num_dirs_changed << "dirs new or changed";
+
+	sw.stop();
+	sw.print_results();
+}
@@ -24,6 +24,9 @@
 
 #include <config.h>
 
+// Std C++
+#include <memory>
+
 // Qt
 #include <QObject>
 #include <QUrl>
@@ -35,8 +38,12 @@
 
 // Ours
 #include <logic/DirScanResult.h>
+#include <logic/DirSummaryCache.h>
 #include "concurrency/AMLMJobT.h"
+#include <concurrency/BoundedChannel.h>
+#include <concurrency/CancellationToken.h>
 #include <concurrency/ExtFuture.h>
+#include <concurrency/ProgressCounter.h>
 // #include "utils/UniqueIDMixin.h"
 
 /**
@@ -54,4 +61,30 @@ void DirScanFunction(QPromise<DirScanResult>& promise,
                      const QDir::Filters dir_filters = QDir::NoFilter,
                      const QDirIterator::IteratorFlags iterator_flags = QDirIterator::NoIteratorFlags);
 
+/**
+ * Worker function which rescans a directory tree for files, using the DirSummaryCache of @a dir_url from the last scan
+ * to skip listing directories which haven't changed.  Finds the same files as DirScanFunction() does, and each
+ * DirScanResult has the file's current size and mtime.  For the files of a skipped directory, only the file itself is
+ * stat()ed; the directory's info and whether the file has a sidecar cue sheet come from the summary.
+ *
+ * Only media files (matching @a name_filters) and directories are listed, and symlinked directories aren't followed.
+ * The summaries are saved when the scan completes, but not if it's canceled.
+ *
+ * @param promise  Status text and cancellation only, the results go to @a out_channel.
+ * @param out_channel  Where the DirScanResults go.  Closed when the scan is done, canceled if the scan is.
+ * @param progress  Files found so far, and the current file as the item.
+ * @param cancel_token  Checked between files as well as directories, so a cancel doesn't wait out a big directory.
+ * @param dir_url  The URL pointing at the directory to recursively scan.
+ * @param name_filters
+ * @param mode  How much to rely on the summaries.  DirSummaryCache::Mode::TrustDirMtime is downgraded to
+ *              DirSummaryCache::Mode::Verify if @a dir_url is on a filesystem with unreliable directory mtimes.
+ */
+void DirScanIncrementalFunction(QPromise<Unit>& promise,
+                                std::shared_ptr<BoundedChannel<DirScanResult>> out_channel,
+                                std::shared_ptr<ProgressCounter> progress,
+                                CancellationToken cancel_token,
+                                const QUrl& dir_url,
+                                const QStringList& name_filters,
+                                DirSummaryCache::Mode mode);
+
 #endif /* SRC_CONCURRENCY_DIRECTORYSCANJOB_H_ */
@@ -24,6 +24,8 @@
 #include "LibraryRescanner.h"
 #include <utils/RegisterQtMetatypes.h>
 #include <utils/DebugHelpers.h>
+#include <concurrency/AMLMExecutor.h>
+#include <concurrency/TaskGroup.h>
 
 AMLM_QREG_CALLBACK([](){
     qIn() << "Registering LibraryEntryLoaderJob types";
@@ -35,7 +37,7 @@ AMLM_QREG_CALLBACK([](){
 /// @{
 #if 0
 #define DATASTREAM_FIELDS(X) \
-	X(m_original_pindex)\
+	X(m_original_id)\
 	X(m_original_libentry)\
 	X(m_new_libentries)\
 	X(m_num_tracks_found)
@@ -66,27 +68,29 @@ QDataStream &operator>>(QDataStream &in, LibraryEntryLoaderJobResult & myObj)
 #endif
 /// @}
 
-LibraryEntryLoaderJobPtr LibraryEntryLoaderJob::make_job(QObject *parent, QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry)
+LibraryEntryLoaderJobPtr LibraryEntryLoaderJob::make_job(QObject *parent, UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry)
 {
-    auto retval = new LibraryEntryLoaderJob(parent, pmi, libentry);
+    auto retval = new LibraryEntryLoaderJob(parent, entry_id, libentry);
 
     /// @todo Hook things up in here.
 
     return retval;
 }
 
-LibraryEntryLoaderJobPtr LibraryEntryLoaderJob::make_job(QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry)
+LibraryEntryLoaderJobPtr LibraryEntryLoaderJob::make_job(UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry)
 {
-	return make_job(AMLMApp::instance(), pmi, libentry);
+	return make_job(AMLMApp::instance(), entry_id, libentry);
 }
 
-ExtFuture<LibraryEntryLoaderJobResult> LibraryEntryLoaderJob::make_task(QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry)
+ExtFuture<LibraryEntryLoaderJobResult> LibraryEntryLoaderJob::make_task(UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry)
 {
-    return QtConcurrent::run(&LibraryEntryLoaderJob::LoadEntry, nullptr, pmi, libentry);
+	// One per row, so no AMLMJob each, they're shown together.
+	static TaskGroup s_entry_load_tasks("LibraryEntryLoads", AMLMExecutor::interactive());
+	return s_entry_load_tasks.run(&LibraryEntryLoaderJob::LoadEntry, nullptr, entry_id, libentry);
 }
 
-LibraryEntryLoaderJob::LibraryEntryLoaderJob(QObject *parent, QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry)
-    : BASE_CLASS(parent), m_pmi(pmi), m_libentry(libentry)
+LibraryEntryLoaderJob::LibraryEntryLoaderJob(QObject *parent, UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry)
+    : BASE_CLASS(parent), m_entry_id(entry_id), m_libentry(libentry)
 {
     // Set our object name.
     setObjectName(uniqueQObjectName());
@@ -103,27 +107,32 @@ LibraryEntryLoaderJob::~LibraryEntryLoaderJob()
 }
 
 void LibraryEntryLoaderJob::LoadEntry(QPromise<LibraryEntryLoaderJobResult>& promise, LibraryEntryLoaderJob* kjob,
-									  QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry)
+									  UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry)
 {
-//	qDb() << "START LibraryEntryLoaderJob LoadEntry" << pmi << libentry;
+//	qDb() << "START LibraryEntryLoaderJob LoadEntry" << entry_id << libentry;
 
-	LibraryEntryLoaderJobResult retval(pmi, libentry);
+	LibraryEntryLoaderJobResult retval(entry_id, libentry);
 
     Q_ASSERT(retval.isValid());
 
-    // Make sure the index is still valid.  The model may have been destroyed since the message was sent.
-	if(!pmi.isValid())
+    // Make sure we were given a real ID.  Whether the entry still exists is checked by the model when
+    // the result is applied.
+	if(!entry_id.isValid())
     {
-		qWr() << "INVALID QPersistentModelIndex:" << pmi << ", ABORTING LOAD";
+		qWr() << "INVALID entry ID:" << entry_id << ", ABORTING LOAD";
 		if(kjob != nullptr)
 		{
-			kjob->setError(InvalidQPersistentModelIndex);
+			kjob->setError(InvalidEntryID);
 		}
         return;
     }
     // Make sure the LibraryEntry hasn't been deleted.  It shouldn't have been since we hold a shared_ptr<> to it.
 	Q_ASSERT(libentry);
 
+	// Work on a copy.  The model's entry may be shared with a LibrarySnapshot or another library, so it's left
+	// untouched until the result is swapped in in the GUI thread.
+	libentry = std::make_shared<LibraryEntry>(*libentry);
+
     // Make sure the LibraryEntry has a valid QUrl.  It should, but ATM we're getting here with empty URLs.
 //    AMLM_ASSERT_EQ(m_libentry->getUrl().isValid(), true);
 	if(!libentry->getUrl().isValid())
@@ -172,14 +181,12 @@ void LibraryEntryLoaderJob::LoadEntry(QPromise<LibraryEntryLoaderJobResult>& pro
             // Couldn't load the metadata from the file.
             // Only option here is to return the old item, which should now be marked with an error.
 			qCr() << "Couldn't load metadata for file" << libentry->getUrl();
-//            retval.m_original_pindexes.push_back(m_pmi);
 			retval.m_new_libentries.push_back(libentry);
             retval.m_num_tracks_found = 1;
         }
         else
         {
             // Repackage it and return.
-//            retval.m_original_pindexes.push_back(m_pmi);
             retval.m_new_libentries.push_back(libentry);
             retval.m_num_tracks_found = 1;
         }
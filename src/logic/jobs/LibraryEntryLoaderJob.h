@@ -30,13 +30,13 @@
 
 // Qt
 #include <QObject>
-#include <QPersistentModelIndex>
 #include <QPointer>
 
 // Ours
 #include <concurrency/AMLMJobT.h>
 #include "LibraryEntry.h"
 #include "LibraryRescanner.h" // For MetadataReturnVal
+#include "UUIncD.h"
 
 
 class LibraryEntryLoaderJobResult
@@ -46,9 +46,9 @@ class LibraryEntryLoaderJobResult
 public:
     LibraryEntryLoaderJobResult() = default;
     LibraryEntryLoaderJobResult(const LibraryEntryLoaderJobResult& other) = default;
-    explicit LibraryEntryLoaderJobResult(QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> le)
+    explicit LibraryEntryLoaderJobResult(UUIncD entry_id, std::shared_ptr<LibraryEntry> le)
     {
-		m_original_pindex = std::move(pmi);
+		m_original_id = entry_id;
 		m_original_libentry = std::move(le);
     }
     ~LibraryEntryLoaderJobResult() = default;
@@ -68,8 +68,8 @@ public:
         m_num_tracks_found++;
     }
 
-    // The original QPMI and LibraryEntry we were called with.
-    QPersistentModelIndex m_original_pindex;
+    // The original Library entry ID and LibraryEntry we were called with.
+    UUIncD m_original_id {UUIncD::null()};
     std::shared_ptr<LibraryEntry> m_original_libentry;
 
 	std::vector<std::shared_ptr<LibraryEntry>> m_new_libentries;
@@ -97,7 +97,7 @@ class LibraryEntryLoaderJob : public AMLMJobT<ExtFuture<LibraryEntryLoaderJobRes
 //Q_SIGNALS:
 
 protected:
-    explicit LibraryEntryLoaderJob(QObject* parent, QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry);
+    explicit LibraryEntryLoaderJob(QObject* parent, UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry);
 
 
 public:
@@ -109,7 +109,7 @@ public:
     /// Errors.
     enum
     {
-      InvalidQPersistentModelIndex = KJob::UserDefinedError,
+      InvalidEntryID = KJob::UserDefinedError,
       InvalidLibraryEntryURL,
     };
 
@@ -117,20 +117,20 @@ public:
 
     ~LibraryEntryLoaderJob() override;
 
-    static LibraryEntryLoaderJobPtr make_job(QObject *parent, QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry);
+    static LibraryEntryLoaderJobPtr make_job(QObject *parent, UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry);
 
     /// Overload which makes the AMLMApp singleton the parent.
-    static LibraryEntryLoaderJobPtr make_job(QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry);
+    static LibraryEntryLoaderJobPtr make_job(UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry);
 
 	/// No AMLMJob, just an ExtFuture<>.
-    static ExtFuture<LibraryEntryLoaderJobResult> make_task(QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry);
+    static ExtFuture<LibraryEntryLoaderJobResult> make_task(UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry);
 
     /**
      * Worker function.
      * Loads the data for the given entry and sends it out via @a promise.
      */
     static void LoadEntry(QPromise<LibraryEntryLoaderJobResult>& promise, LibraryEntryLoaderJob* kjob,
-						  QPersistentModelIndex pmi, std::shared_ptr<LibraryEntry> libentry);
+						  UUIncD entry_id, std::shared_ptr<LibraryEntry> libentry);
 
 
 protected:
@@ -138,7 +138,7 @@ protected:
 
 private:
 
-    QPersistentModelIndex m_pmi;
+    UUIncD m_entry_id;
     std::shared_ptr<LibraryEntry> m_libentry;
 };
 
@@ -30,6 +30,7 @@
 // Ours
 #include <utils/DebugHelpers.h>
 #include <utils/TheSimplestThings.h>
+#include <utils/Trace.h>
 #include <models/LibraryModel.h>
 
 MetadataReturnVal refresher_callback(const VecLibRescannerMapItems &mapitem)
@@ -43,16 +44,16 @@ MetadataReturnVal refresher_callback(const VecLibRescannerMapItems &mapitem)
 	{
 		// Only one entry.
 
-		// Get the LibraryEntry* to the existing entry.
-// M_WARNING("There's no locking here, there needs to be, or these need to be copies.");
-		std::shared_ptr<LibraryEntry> item = mapitem[0].item;
+		// Work on a copy of the existing entry.  The model's entry is left untouched until the result is applied
+		// in the GUI thread, which can then diff the two and skip rows which didn't change.
+		std::shared_ptr<LibraryEntry> item = std::make_shared<LibraryEntry>(*mapitem[0].item);
 
 		if(!item->isPopulated())
 		{
 			// Item's metadata has not been looked at.  We may have multiple tracks.
 
-			// Only one pindex though.
-			retval.m_original_pindexes.push_back(mapitem[0].pindex);
+			// Only one entry ID though.
+			retval.m_original_ids.push_back(mapitem[0].entry_id);
 
 			item->populate();
 			auto vec_items = item->split_to_tracks();
@@ -83,14 +84,14 @@ MetadataReturnVal refresher_callback(const VecLibRescannerMapItems &mapitem)
 				// Couldn't load the metadata from the file.
 				// Only option here is to return the old item, which should now be marked with an error.
 				qCritical() << "Couldn't load metadata for file" << item->getUrl();
-				retval.m_original_pindexes.push_back(mapitem[0].pindex);
+				retval.m_original_ids.push_back(mapitem[0].entry_id);
 				retval.m_new_libentries.push_back(item);
 				retval.m_num_tracks_found = 1;
 			}
 			else
 			{
 				// Repackage it and return.
-				retval.m_original_pindexes.push_back(mapitem[0].pindex);
+				retval.m_original_ids.push_back(mapitem[0].entry_id);
 				retval.m_new_libentries.push_back(item);
 				retval.m_num_tracks_found = 1;
 			}
@@ -98,8 +99,8 @@ MetadataReturnVal refresher_callback(const VecLibRescannerMapItems &mapitem)
 	}
 	else if (mapitem.size() > 1)
 	{
-		// Multiple incoming tracks.
-		std::shared_ptr<LibraryEntry> first_item = mapitem[0].item;
+		// Multiple incoming tracks.  As above, work on a copy.
+		std::shared_ptr<LibraryEntry> first_item = std::make_shared<LibraryEntry>(*mapitem[0].item);
 		first_item->populate(true);
 		auto subtracks = first_item->split_to_tracks();
 		if(subtracks.size() < mapitem.size())
@@ -120,7 +121,7 @@ MetadataReturnVal refresher_callback(const VecLibRescannerMapItems &mapitem)
 		for(int i=0; i<mapitem.size(); ++i)
 		{
 			Q_ASSERT(subtracks[i] != nullptr);
-			retval.push_back(mapitem[i].pindex, subtracks[i]);
+			retval.push_back(mapitem[i].entry_id, subtracks[i]);
 		}
 	}
 	else
@@ -132,8 +133,11 @@ MetadataReturnVal refresher_callback(const VecLibRescannerMapItems &mapitem)
 }
 
 
-void library_metadata_rescan_task(QPromise<MetadataReturnVal>& promise,
-								ExtFuture<VecLibRescannerMapItems> in_future)
+void library_metadata_rescan_task(QPromise<Unit>& promise,
+								ExtFuture<VecLibRescannerMapItems> in_future,
+								std::shared_ptr<BoundedChannel<MetadataReturnVal>> out_channel,
+								std::shared_ptr<ProgressCounter> progress,
+								CancellationToken cancel_token)
 {
 	qDb() << "ENTER library_metadata_rescan_task with" << M_ID_VAL(in_future.resultCount());
 
@@ -156,10 +160,11 @@ void library_metadata_rescan_task(QPromise<MetadataReturnVal>& promise,
 #endif
 
 	promise.suspendIfRequested();
-	if (promise.isCanceled())
+	if (cancel_token.checkpoint() || promise.isCanceled())
 	{
 		// We've been canceled.
 		qIn() << "CANCELED";
+		out_channel->cancel();
 		return;
 	}
 
@@ -171,28 +176,47 @@ void library_metadata_rescan_task(QPromise<MetadataReturnVal>& promise,
 	/// @todo
 	//setTotalAmountAndSize(KJob::Unit::Files, m_items_to_rescan.size());
 
-	promise.setProgressRange(0, items_to_rescan.size());
+	progress->setTotal(items_to_rescan.size());
 	promise.setProgressValueAndText(0, status_text);
 
 	qulonglong num_items = 0;
 	for(QList<VecLibRescannerMapItems>::const_iterator i = items_to_rescan.cbegin(); i != items_to_rescan.cend(); ++i)
 	{
-		qDb() << "Item number:" << num_items;
+		// One TagLib read per item, so this is as long as a cancel has to wait.
+		if(cancel_token.checkpoint())
+		{
+			qIn() << "CANCELED";
+			out_channel->cancel();
+			return;
+		}
 
-		/// @todo eliminate the_job ptr.
-		MetadataReturnVal a = /*the_job->*/refresher_callback(*i);
+		progress->updateCurrentItem([&](){
+			return (i->empty() || !i->front().item) ? QString() : i->front().item->getUrl().toDisplayString();
+			});
 
-		// Report the new results to The Future.
-		promise.addResult(a);
+		MetadataReturnVal a;
+		{
+			Trace::Span span("Metadata::read");
+			/// @todo eliminate the_job ptr.
+			a = /*the_job->*/refresher_callback(*i);
+			span.counter("tracks", a.m_num_tracks_found);
+		}
+
+		// Send the new results downstream.  Blocks while the consumer catches up.
+		Trace::Span push_span("Metadata::push");
+		if(!out_channel->push(std::move(a), promise))
+		{
+			qIn() << "CANCELED";
+			out_channel->cancel();
+			return;
+		}
 
 		num_items++;
 
-		/// @todo
-		//		setProcessedAmountAndSize(KJob::Unit::Files, num_items);
-		/// @note New, temp.
-		promise.setProgressValue(num_items);
+		progress->setProcessed(num_items);
 	}
 	// And we're done.
+	out_channel->close();
 }
 
 
@@ -22,27 +22,39 @@
 
 /// @file
 
+// Std C++
+#include <memory>
+
 // Qt
 #include <QPromise>
 
 // Ours
 #include <logic/LibraryRescannerMapItem.h>
 #include <logic/LibraryRescanner.h> ///< For MetadataReturnVal
+#include <concurrency/BoundedChannel.h>
+#include <concurrency/CancellationToken.h>
 #include <concurrency/ExtFuture.h>
 #include <concurrency/AMLMJob.h>
+#include <concurrency/ProgressCounter.h>
 
 
 class LibraryModel;
 
 /**
  * Worker function which converts the LibraryRescanMapItems from @a in_future
- * to MetadataReturnVal's which are sent to @a promise.
+ * to MetadataReturnVal's which are pushed to @a out_channel.
  *
- * @param promise
+ * @param promise  Status text and cancellation only.
  * @param in_future
+ * @param out_channel  Closed when all the items have been rescanned, canceled if the rescan is.
+ * @param progress  Items rescanned so far, and the current item's URL.
+ * @param cancel_token  Checked before each item's metadata read.
  */
-void library_metadata_rescan_task(QPromise<MetadataReturnVal>& promise,
-								ExtFuture<VecLibRescannerMapItems> in_future);
+void library_metadata_rescan_task(QPromise<Unit>& promise,
+								ExtFuture<VecLibRescannerMapItems> in_future,
+								std::shared_ptr<BoundedChannel<MetadataReturnVal>> out_channel,
+								std::shared_ptr<ProgressCounter> progress,
+								CancellationToken cancel_token);
 
 
 #endif /* SRC_LOGIC_JOBS_LIBRARYRESCANNERJOB_H_ */
@@ -370,85 +370,110 @@ std::shared_ptr<AbstractTreeModelItem> AbstractTreeModel::append_child(const QVe
 	return new_child;
 }
 
-Fun AbstractTreeModel::addItem_lambda(const std::shared_ptr<AbstractTreeModelItem>& new_item, UUIncD parentId)
+bool AbstractTreeModel::insertItemRows(UUIncD parent_id, int first_row, std::span<const std::shared_ptr<AbstractTreeModelItem>> items)
 {
-	return [this, new_item, parentId]() {
-		// Insertion is simply setting the parent of the item...
-		std::shared_ptr<AbstractTreeModelItem> parent;
-		if (parentId != UUIncD::null())
+	if(items.empty())
+	{
+		return true;
+	}
+
+	std::shared_ptr<AbstractTreeModelItem> parent = getItemById(parent_id);
+	if(!parent || first_row < 0 || first_row > parent->childCount())
+	{
+		qCr() << "Bad insert position:" << M_ID_VAL(parent_id) << M_ID_VAL(first_row);
+		return false;
+	}
+
+	const int last_row = first_row + static_cast<int>(items.size()) - 1;
+	beginInsertRows(getIndexFromItem(parent), first_row, last_row);
+
+	for(const auto& item : items)
+	{
+		AMLM_ASSERT_X(item->parent_item().expired(), "Item already has a parent.");
+		if(item->m_model.expired())
 		{
-			parent = getItemById(parentId);
-			if (!parent)
-			{
-				Q_ASSERT(parent);
-				return false;
-			}
+			item->m_model = parent->m_model;
 		}
-		// ...and fixing up the parent.
-		return new_item->changeParent(parent);
-	};
+		item->updateParent(parent);
+	}
+	// One insert for the whole range.
+	parent->m_child_items.insert(parent->m_child_items.begin() + first_row, items.begin(), items.end());
+	for(const auto& item : items)
+	{
+		AbstractTreeModelItem::register_self(item);
+	}
+
+	endInsertRows();
+
+	m_command_log.recordInsertRows(parent_id, first_row, items);
+
+	return true;
 }
 
-Fun AbstractTreeModel::removeItem_lambda(UUIncD id)
+bool AbstractTreeModel::removeItemRows(UUIncD parent_id, int first_row, int count,
+									   std::vector<std::shared_ptr<AbstractTreeModelItem>>* removed_items)
 {
-	return [this, id]() {
-		/* Deletion simply deregister the item and remove it from parent.
-		   The item object is not actually deleted, because a shared_pointer to it
-		   is captured by the reverse operation.
-		   Actual deletions occurs when the undo object is destroyed.
-		*/
-		auto item = m_model_item_map[id].lock();
-		Q_ASSERT(item);
-		if (!item)
-		{
-			return false;
-		}
-		auto parent = item->parent_item().lock();
-		parent->removeChild(item);
-		return true;
-	};
+	std::shared_ptr<AbstractTreeModelItem> parent = getItemById(parent_id);
+	if(!parent || count <= 0 || first_row < 0 || first_row + count > parent->childCount())
+	{
+		qCr() << "Bad remove range:" << M_ID_VAL(parent_id) << M_ID_VAL(first_row) << M_ID_VAL(count);
+		return false;
+	}
+
+	beginRemoveRows(getIndexFromItem(parent), first_row, first_row + count - 1);
+
+	// One erase for the whole range.
+	auto first = parent->m_child_items.begin() + first_row;
+	auto last = first + count;
+	std::vector<std::shared_ptr<AbstractTreeModelItem>> removed(std::make_move_iterator(first), std::make_move_iterator(last));
+	parent->m_child_items.erase(first, last);
+	for(const auto& item : removed)
+	{
+		item->m_depth = 0;
+		item->m_parent_item.reset();
+		item->deregister_self();
+	}
+
+	endRemoveRows();
+
+	m_command_log.recordRemoveRows(parent_id, first_row, removed);
+
+	if(removed_items != nullptr)
+	{
+		*removed_items = std::move(removed);
+	}
+	return true;
 }
 
-Fun AbstractTreeModel::moveItem_lambda(UUIncD id, int destRow, bool force)
+bool AbstractTreeModel::moveItemRow(UUIncD id, int dest_row)
 {
-	Fun lambda = []() { return true; };
-
-	std::vector<std::shared_ptr<AbstractTreeModelItem>> oldStack;
 	auto item = getItemById(id);
-	if (!force && item->childNumber() == destRow)
+	auto parent = item->parent_item().lock();
+	if(!parent || dest_row < 0 || dest_row >= parent->childCount())
 	{
-		// nothing to do
-		return lambda;
+		return false;
 	}
-	if (auto parent = item->parent_item().lock())
+	const int source_row = item->childNumber();
+	if(source_row == dest_row)
 	{
-		if (destRow > parent->childCount() || destRow < 0)
-		{
-			return []() { return false; };
-		}
-		UUIncD parentId = parent->getId();
-		// remove the element to move
-		oldStack.push_back(item);
-		Fun oper = removeItem_lambda(id);
-		PUSH_LAMBDA(oper, lambda);
-		// remove the tail of the stack
-		for (int i = destRow; i < parent->childCount(); ++i) {
-			auto current = parent->child(i);
-			if (current->getId() != id) {
-				oldStack.push_back(current);
-				oper = removeItem_lambda(current->getId());
-				PUSH_LAMBDA(oper, lambda);
-			}
-		}
-		// insert back in order
-		for (const auto &elem : oldStack)
-		{
-			oper = addItem_lambda(elem, parentId);
-			PUSH_LAMBDA(oper, lambda);
-		}
-		return lambda;
+		// Nothing to do.
+		return true;
 	}
-	return []() { return false; };
+
+	TreeModelCommandLog::ScopedStep step(m_command_log, tr("Move item"));
+	std::vector<std::shared_ptr<AbstractTreeModelItem>> moved;
+	return removeItemRows(parent->getId(), source_row, 1, &moved)
+		&& insertItemRows(parent->getId(), dest_row, moved);
+}
+
+bool AbstractTreeModel::undo()
+{
+	return m_command_log.undo(*this);
+}
+
+bool AbstractTreeModel::redo()
+{
+	return m_command_log.redo(*this);
 }
 
 bool AbstractTreeModel::LoadDatabase(const QString& database_filename)
@@ -469,8 +494,9 @@ bool AbstractTreeModel::LoadDatabase(const QString& database_filename)
 	}
 	xmlser.HACK_skip_extra(false);
 
-	beginResetModel();
+	// clear() does its own model reset.
 	clear();
+	beginResetModel();
 
 	bool success = xmlser.load(*this, QUrl::fromLocalFile(database_filename));
 	endResetModel();
@@ -574,6 +600,45 @@ void AbstractTreeModel::deregister_item(UUIncD id, AbstractTreeModelItem* item)
 	}
 }
 
+void AbstractTreeModel::bulk_remove_all_items()
+{
+	Q_ASSERT(m_root_item);
+
+	// Take the whole tree off the root in one go.
+	AbstractTreeModelItem::ChildItemContainerType children;
+	children.swap(m_root_item->m_child_items);
+
+	// Forget every registration at once instead of having each item erase itself from the map.
+	const UUIncD root_id = m_root_item->getId();
+	m_model_item_map.clear();
+	m_model_item_map[root_id] = m_root_item;
+
+	// Mark the detached items as out of the model so that their destructors don't try to deregister, which
+	// matters if anything (e.g. an undo lambda) keeps some of them alive past this point.
+	// Iterative, trees can be deep.
+	std::vector<AbstractTreeModelItem*> stack;
+	stack.reserve(children.size());
+	for(const auto& child : children)
+	{
+		child->m_parent_item.reset();
+		stack.push_back(child.get());
+	}
+	while(!stack.empty())
+	{
+		AbstractTreeModelItem* item = stack.back();
+		stack.pop_back();
+		item->m_is_in_model = false;
+		for(const auto& grandchild : item->m_child_items)
+		{
+			stack.push_back(grandchild.get());
+		}
+	}
+
+	// Now drop them.  The nodes are freed back to the arena's free lists, and the arena's chunks themselves
+	// are released in bulk when the arena goes away.
+	children.clear();
+}
+
 void AbstractTreeModel::notifyColumnsAboutToInserted(const std::shared_ptr<AbstractTreeModelItem>& parent, int first_column, int last_column)
 {
 	auto parent_index = getIndexFromItem(parent);
@@ -773,6 +838,7 @@ bool AbstractTreeModel::insertRows(int insert_before_row, int num_rows, const QM
 	std::shared_ptr<AbstractTreeModelItem> parentItem = getItem(parent_model_index);
 	bool success;
 
+	TreeModelCommandLog::ScopedStep step(m_command_log, tr("Insert items"));
 	beginInsertRows(parent_model_index, insert_before_row, insert_before_row + num_rows - 1);
 
 	// Create @a rows default-constructed children of parent.
@@ -788,6 +854,8 @@ bool AbstractTreeModel::insertRows(int insert_before_row, int num_rows, const QM
 
 	endInsertRows();
 
+	m_command_log.recordInsertRows(parentItem->getId(), insert_before_row, new_children);
+
 	return success;
 #else
 	///AQP
@@ -872,20 +940,62 @@ bool AbstractTreeModel::removeRows(int remove_start_row, int num_rows, const QMo
 		return false;
 	}
 
-	std::shared_ptr<AbstractTreeModelItem> parentItem = getItemById(static_cast<UUIncD>(parent_item_index.internalId()));
-    bool success = true;
+	std::shared_ptr<AbstractTreeModelItem> parentItem = getItem(parent_item_index);
 
-    beginRemoveRows(parent_item_index, remove_start_row, remove_start_row + num_rows - 1);
-    success = parentItem->removeChildren(remove_start_row, num_rows);
-    endRemoveRows();
-
-	return success;
+	// This is what views call for a delete, and once per selection range; a caller deleting several ranges
+	// should open its own step around all of them.
+	TreeModelCommandLog::ScopedStep step(m_command_log, tr("Delete items"));
+	return removeItemRows(parentItem->getId(), remove_start_row, num_rows);
 }
 
 bool AbstractTreeModel::moveRows(const QModelIndex& sourceParent, int sourceRow, int count, const QModelIndex& destinationParent, int destinationChild)
 {
-	// Defer to base class.
-	return this->BASE_CLASS::moveRows(sourceParent, sourceRow, count, destinationParent, destinationChild);
+	std::shared_ptr<AbstractTreeModelItem> source_parent = getItem(sourceParent);
+	std::shared_ptr<AbstractTreeModelItem> dest_parent = getItem(destinationParent);
+	if(count <= 0 || sourceRow < 0 || sourceRow + count > source_parent->childCount()
+		|| destinationChild < 0 || destinationChild > dest_parent->childCount())
+	{
+		qCr() << "Bad move range:" << M_ID_VAL(sourceRow) << M_ID_VAL(count) << M_ID_VAL(destinationChild);
+		return false;
+	}
+
+	// Can't move an item under itself or one of its descendants.
+	for(auto ancestor = dest_parent; ancestor; ancestor = ancestor->parent_item().lock())
+	{
+		if(ancestor->parent_item().lock() == source_parent
+			&& ancestor->childNumber() >= sourceRow && ancestor->childNumber() < sourceRow + count)
+		{
+			return false;
+		}
+	}
+
+	if(source_parent == dest_parent)
+	{
+		if(destinationChild >= sourceRow && destinationChild <= sourceRow + count)
+		{
+			// Nothing to do.
+			return true;
+		}
+		// Qt's destinationChild is the row before the source rows are taken out.
+		if(destinationChild > sourceRow)
+		{
+			destinationChild -= count;
+		}
+	}
+
+	// Same as moveItemRow(), a remove and an insert, undone together.
+	TreeModelCommandLog::ScopedStep step(m_command_log, tr("Move items"));
+	std::vector<std::shared_ptr<AbstractTreeModelItem>> moved;
+	return removeItemRows(source_parent->getId(), sourceRow, count, &moved)
+		&& insertItemRows(dest_parent->getId(), destinationChild, moved);
+}
+
+bool AbstractTreeModel::dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex& parent)
+{
+	// The base class drops via insertRows() and setItemData(), one insertRows() per dropped row.  Make the
+	// whole drop one undo step.
+	TreeModelCommandLog::ScopedStep step(m_command_log, tr("Drop items"));
+	return BASE_CLASS::dropMimeData(data, action, row, column, parent);
 }
 
 bool AbstractTreeModel::moveColumns(const QModelIndex& sourceParent, int sourceColumn, int count, const QModelIndex& destinationParent, int destinationChild)
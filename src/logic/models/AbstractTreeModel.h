@@ -26,14 +26,16 @@
 
 // Std C++
 #include <memory>
+#include <span>
 #include <vector>
-#include <map>
+#include <unordered_map>
 
 // Qt
 #include <QAbstractItemModel>
 #include <QModelIndex>
 #include <QVariant>
 class QAbstractItemModelTester;
+class QMimeData;
 
 // Ours
 class AbstractTreeModelItem;
@@ -44,6 +46,8 @@ class ColumnSpec;
 #include <logic/UUIncD.h>
 #include <future/enable_shared_from_this_virtual.h>
 #include "UndoRedoHelper.h"
+#include "TreeNodeArena.h"
+#include "TreeModelCommandLog.h"
 
 
 /**
@@ -201,12 +205,20 @@ public:
     bool removeRows(int remove_start_row, int num_rows,
                     const QModelIndex& parent_item_index = QModelIndex()) override;
 
-    /// @todo These currently just call the base class functions.
+	/**
+	 * Move rows [@a sourceRow, @a sourceRow + @a count) of @a sourceParent to before row @a destinationChild of
+	 * @a destinationParent, as a remove and an insert recorded as one undo step.
+	 */
     bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
 	                      const QModelIndex &destinationParent, int destinationChild) override;
+    /// @todo This currently just calls the base class function.
 	bool moveColumns(const QModelIndex &sourceParent, int sourceColumn, int count,
 	                         const QModelIndex &destinationParent, int destinationChild) override;
 
+	/// Drop @a data via the base class, recorded as one undo step.
+	bool dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column,
+					  const QModelIndex& parent) override;
+
 	/// @} // END row/col insert/remove/move.
 
 
@@ -229,20 +241,44 @@ public:
 	virtual std::shared_ptr<AbstractTreeModelItem> getItem(const QModelIndex &index) const;
 
 
-	/// @name Public interface: Lambda generators for tree structure modification.
+	/// @name Public interface: Bulk tree structure modification.
+	/// These are the primitives undo/redo is built on.  Each is one begin/endXxxRows() pair on the model and is
+	/// recorded as one command in the command log if a step is open.
 	/// @{
 
-	/* @brief Helper function to generate a lambda that adds an item to the tree */
-	Fun addItem_lambda(const std::shared_ptr<AbstractTreeModelItem>& new_item, UUIncD parentId);
+	/**
+	 * Insert @a items, which must not currently be in a model, as children of @a parent_id at rows
+	 * [@a first_row, @a first_row + items.size()).
+	 */
+	bool insertItemRows(UUIncD parent_id, int first_row, std::span<const std::shared_ptr<AbstractTreeModelItem>> items);
 
-	/* @brief Helper function to generate a lambda that removes an item from the tree */
-	Fun removeItem_lambda(UUIncD id);
+	/**
+	 * Remove the @a count children of @a parent_id starting at row @a first_row.  The removed items are not
+	 * deleted if anything (e.g. the command log, or @a removed_items if given) still holds them.
+	 */
+	bool removeItemRows(UUIncD parent_id, int first_row, int count,
+						std::vector<std::shared_ptr<AbstractTreeModelItem>>* removed_items = nullptr);
+
+	/**
+	 * Move item @a id to row @a dest_row of its current parent, recorded as a single undo step.
+	 */
+	bool moveItemRow(UUIncD id, int dest_row);
+
+	/// @} // END Bulk tree structure modification.
+
+	/// @name Undo/redo.
+	/// @{
 
-	/* @brief Helper function to generate a lambda that changes the row of an item */
-	Fun moveItem_lambda(UUIncD id, int destRow, bool force = false);
+	/**
+	 * The log all structure changes are recorded in while a step is open.  Use
+	 * TreeModelCommandLog::ScopedStep(model->commandLog(), "text") to group changes into one undo step.
+	 */
+	TreeModelCommandLog& commandLog() { return m_command_log; }
 
-	/// @} // END Lambda generators.
+	virtual bool undo();
+	virtual bool redo();
 
+	/// @}
 
 	/// @name Cut/Copy/Paste support.
 	/// @{
@@ -282,17 +318,30 @@ public:
 
 	friend class AbstractTreeModelItem;
 
+	/**
+	 * The arena this model's items are allocated from.
+	 * Items created by the model's item create() functions, ItemFactory etc. are allocated from here.
+	 */
+	const std::shared_ptr<TreeNodeArena>& getNodeArena() const { return m_node_arena; }
+
+	/**
+	 * Allocate items created from here on from the heap instead of the arena, FBO A/B measurements.
+	 * Call right after create(), before anything else is added to the model.
+	 */
+	void disableNodeArena() { m_node_arena.reset(); }
+
 	/// @name Debug
 	/// @{
 
 	long get_total_model_node_count() const { return m_model_item_map.size(); };
+	long get_total_arena_node_count() const { return m_node_arena ? m_node_arena->num_live_nodes() : 0; };
 
 	void dump_model_info() const;
 
 	/// @}
 
 	/// @temp?
-	using item_map_type = std::map<UUIncD, std::weak_ptr<AbstractTreeModelItem>>;
+	using item_map_type = std::unordered_map<UUIncD, std::weak_ptr<AbstractTreeModelItem>>;
 	/// Generic node iterator type.  No order guarantees at all.
 	using iterator = item_map_type::iterator;
 	iterator begin();
@@ -306,6 +355,13 @@ protected:
 	virtual void register_item(const std::shared_ptr<AbstractTreeModelItem>& item);
 	virtual void deregister_item(UUIncD id, AbstractTreeModelItem* item);
 
+	/**
+	 * Fast bulk teardown of everything but the root item, FBO clear().
+	 * No per-item deregistration, row notifications or undo/redo; the caller must wrap this in
+	 * beginResetModel()/endResetModel().
+	 */
+	void bulk_remove_all_items();
+
 	/// @name Derived-class serialization info.
 	/// @{
 
@@ -375,13 +431,19 @@ protected:
     /// Pulls double duty as the horizontal header item.
 	std::shared_ptr<AbstractTreeModelHeaderItem> m_root_item;
 
+	/// Undo/redo history of this model's structure changes.
+	TreeModelCommandLog m_command_log;
+
 private:
 	/**
 	 * Map of UUIncD's to AbstractTreeModelItems.
-	 * Currently: std::map<UUIncD, std::weak_ptr<AbstractTreeModelItem>> m_model_item_map;
+	 * Currently: std::unordered_map<UUIncD, std::weak_ptr<AbstractTreeModelItem>> m_model_item_map;
 	 */
 	item_map_type m_model_item_map;
 
+	/// Slab storage for this model's items.  Shared with the items themselves, so it lives until the last
+	/// of them does.
+	std::shared_ptr<TreeNodeArena> m_node_arena {TreeNodeArena::create()};
 };
 
 
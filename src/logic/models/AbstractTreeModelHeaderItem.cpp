@@ -49,7 +49,8 @@ std::shared_ptr<AbstractTreeModelHeaderItem>
 AbstractTreeModelHeaderItem::create(std::initializer_list<ColumnSpec> column_specs,
 									   const std::shared_ptr<AbstractTreeModel>& parent_model)
 {
-    std::shared_ptr<AbstractTreeModelHeaderItem> new_item(new AbstractTreeModelHeaderItem(column_specs, parent_model));
+    auto new_item = TreeNodeArena::make_node<AbstractTreeModelHeaderItem>(parent_model ? parent_model->getNodeArena() : nullptr,
+            [&](void* mem){ return new (mem) AbstractTreeModelHeaderItem(column_specs, parent_model); });
 
     new_item->setColumnSpecs(column_specs);
     new_item->m_is_root = true;
@@ -62,7 +62,9 @@ std::shared_ptr<AbstractTreeModelItem> AbstractTreeModelItem::create(const std::
 																	const std::shared_ptr<AbstractTreeModel>& model,
 																	bool is_root)
 {
-    std::shared_ptr<AbstractTreeModelItem> new_item = std::shared_ptr<AbstractTreeModelItem>(new AbstractTreeModelItem(data, model));
+    // Allocate from the model's node arena if we have a model.
+    auto new_item = TreeNodeArena::make_node<AbstractTreeModelItem>(model ? model->getNodeArena() : nullptr,
+            [&](void* mem){ return new (mem) AbstractTreeModelItem(data, model); });
     baseFinishCreate(new_item);
 
 	return new_item;
@@ -471,7 +473,8 @@ void AbstractTreeModelItem::fromVariant(const QVariant& variant)
     		Q_ASSERT(0);
     	}
 
-    	auto derived_child_ptr = ItemFactory::instance().createItem(class_attr);
+    	// Allocate it from the model's node arena.
+    	auto derived_child_ptr = ItemFactory::instance().createItem(class_attr, model_ptr);
 
     	if (derived_child_ptr)
     	{
@@ -27,7 +27,6 @@
 
 // Std C++
 #include <memory>
-#include <deque>
 #include <vector>
 #include <mutex>
 #include <iterator>
@@ -320,12 +319,14 @@ protected:
 
 	bool m_is_root {false};
 
-    /// Deque of std::shared_ptr's to child items.
-	std::deque<std::shared_ptr<AbstractTreeModelItem>> m_child_items;
+	/// A std::vector, not a std::deque: an empty deque still allocates, and most items are leaves.
+	using ChildItemContainerType = std::vector<std::shared_ptr<AbstractTreeModelItem>>;
+
+    /// The std::shared_ptr's to child items.
+	ChildItemContainerType m_child_items;
 
 private:
 
-	using ChildItemContainerType = std::deque<std::shared_ptr<AbstractTreeModelItem>>;
 	using CICTIteratorType = ChildItemContainerType::iterator;
 
 	/**
@@ -32,21 +32,21 @@ struct ItemCreatorRegistration
 {
 	ItemCreatorRegistration()
 	{
-		ItemFactory::instance().registerItemCreator("AbstractTreeModelItem", []()
+		ItemFactory::instance().registerItemCreator("AbstractTreeModelItem", [](const std::shared_ptr<AbstractTreeModel>& model)
 		{
-            return AbstractTreeModelItem::create();
+            return AbstractTreeModelItem::create({}, model);
 		});
-		ItemFactory::instance().registerItemCreator("AbstractTreeModelHeaderItem", []()
+		ItemFactory::instance().registerItemCreator("AbstractTreeModelHeaderItem", [](const std::shared_ptr<AbstractTreeModel>& model)
 		{
-            return AbstractTreeModelHeaderItem::create();
+            return AbstractTreeModelHeaderItem::create({}, model);
 		});
-		ItemFactory::instance().registerItemCreator("ScanResultsTreeModelItem", []()
+		ItemFactory::instance().registerItemCreator("ScanResultsTreeModelItem", [](const std::shared_ptr<AbstractTreeModel>& model)
 		{
-            return ScanResultsTreeModelItem::create();
+            return ScanResultsTreeModelItem::create_shared(model);
 		});
-		ItemFactory::instance().registerItemCreator("SRTMItem_LibEntry", []()
+		ItemFactory::instance().registerItemCreator("SRTMItem_LibEntry", [](const std::shared_ptr<AbstractTreeModel>& model)
 		{
-            return SRTMItem_LibEntry::create();
+            return SRTMItem_LibEntry::create_shared(model);
 		});
 	}
 };
@@ -64,11 +64,12 @@ void ItemFactory::registerItemCreator(const std::string classname, Creator creat
 	m_creators[classname] = creator;
 }
 
-std::shared_ptr<AbstractTreeModelItem> ItemFactory::createItem(std::string classname) const
+std::shared_ptr<AbstractTreeModelItem> ItemFactory::createItem(std::string classname,
+															   const std::shared_ptr<AbstractTreeModel>& model) const
 {
 	if (m_creators.contains(classname))
 	{
-		return m_creators[classname]();
+		return m_creators[classname](model);
 	}
 	else
 	{
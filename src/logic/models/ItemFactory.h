@@ -37,13 +37,15 @@
 class ItemFactory
 {
 public:
-  	using Creator = std::function<std::shared_ptr<AbstractTreeModelItem>()>;
+	/// Creates a new item of a registered class, allocated from the given model's node arena if it's non-null.
+  	using Creator = std::function<std::shared_ptr<AbstractTreeModelItem>(const std::shared_ptr<AbstractTreeModel>&)>;
 
 	static ItemFactory& instance();
 
 	void registerItemCreator(const std::string classname, Creator creator);
 
-	std::shared_ptr<AbstractTreeModelItem> createItem(std::string classname) const;
+	std::shared_ptr<AbstractTreeModelItem> createItem(std::string classname,
+													  const std::shared_ptr<AbstractTreeModel>& model = nullptr) const;
 
 private:
 	QMap<std::string, Creator> m_creators;
@@ -22,6 +22,9 @@
 #include "LibraryModel.h"
 
 // Stc C++
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -32,6 +35,7 @@
 #include <QDebug>
 #include <QTemporaryFile>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileIconProvider>
 
 // Ours
@@ -42,6 +46,8 @@
 #include "LibraryEntryMimeData.h"
 #include "utils/StringHelpers.h"
 #include "utils/DebugHelpers.h"
+#include <utils/Trace.h>
+#include "logic/CollectionStore.h"
 #include "logic/Library.h"
 #include "logic/ModelUserRoles.h"
 #include <logic/PerfectDeleter.h>
@@ -50,6 +56,7 @@
 #include <logic/jobs/LibraryEntryLoaderJob.h>
 #include <logic/jobs/LibraryRescannerJob.h>
 #include <logic/serialization/SerializationHelpers.h>
+#include <logic/serialization/XmlStreamVisitor.h>
 
 
 AMLM_QREG_CALLBACK([](){
@@ -93,7 +100,41 @@ LibraryModel::LibraryModel(QObject *parent) : QAbstractItemModel(parent)
 	// Create the asynchronous rescanner.
 	m_rescanner = new LibraryRescanner(this);
 
+	// Incoming entry updates are applied in roughly frame-sized batches.
+	m_apply_updates_timer.setSingleShot(true);
+	m_apply_updates_timer.setInterval(std::chrono::milliseconds(16));
+	connect_or_die(&m_apply_updates_timer, &QTimer::timeout, this, &LibraryModel::applyPendingEntryUpdates);
+
 	// Connections.
+
+	// When another library replaces an entry we share, e.g. by rescanning or editing it, swap the new one in here too.
+	connect_or_die(&CollectionStore::instance(), &CollectionStore::SIGNAL_entriesReplaced, this,
+				   [this](const CollectionStore::Replacements& replacements){
+		if(!sharesCollectionEntries())
+		{
+			return;
+		}
+		std::unordered_map<const LibraryEntry*, std::shared_ptr<LibraryEntry>> replaced_by;
+		for(const auto& [old_entry, new_entry] : replacements)
+		{
+			replaced_by.emplace(old_entry.get(), new_entry);
+		}
+		for(std::size_t row = 0; row < m_library.size(); ++row)
+		{
+			auto it = replaced_by.find(m_library.entryAt(row));
+			if(it == replaced_by.end())
+			{
+				continue;
+			}
+			// It may have been replaced more than once since the last signal.
+			std::shared_ptr<LibraryEntry> newest = it->second;
+			for(auto next = replaced_by.find(newest.get()); next != replaced_by.end(); next = replaced_by.find(newest.get()))
+			{
+				newest = next->second;
+			}
+			queueEntryUpdate(m_library.getIdAt(row), std::move(newest));
+		}
+	});
 }
 
 LibraryModel::~LibraryModel()
@@ -118,11 +159,11 @@ QModelIndex LibraryModel::index(int row, int column, const QModelIndex &parent)
 {
 	if(!parent.isValid())
 	{
-		if((!m_library.m_lib_entries.empty())
+		if((!m_library.empty())
 				&& (row >= 0 && row < rowCount())
 				&& (column >= 0 && column < static_cast<int>(m_columnSpecs.size())))
 		{
-			return createIndex(row, column, m_library.m_lib_entries[row].get());
+			return createIndex(row, column, m_library.entryAt(row));
 		}
 	}
 	//logger.warning("Returning invalid index: {}/{}/{}".format(row, column, parent))
@@ -153,7 +194,7 @@ int LibraryModel::rowCount(const QModelIndex &parent) const
 {
 	if(!parent.isValid())
 	{
-		return m_library.m_lib_entries.size();
+		return m_library.size();
 	}
 	return 0;
 }
@@ -295,7 +336,6 @@ void LibraryModel::multiData(const QModelIndex& index, QModelRoleDataSpan roleDa
 	        if(item->isPopulated())
 			{
 	            // Item has data.
-				QVariant metaentry;
 				if(sec_id == SectionID::Status)
 				{
 					// We get a flood of requests for the status column for some reason.
@@ -311,51 +351,56 @@ void LibraryModel::multiData(const QModelIndex& index, QModelRoleDataSpan roleDa
 					// Short-circuit the rest of the logic, we have nothing to return here.
 					continue;
 				}
-				else if(sec_id == SectionID::Length)
-				{
-					// Return Fraction as a string.
-					// return QVariant::fromValue(item->get_length_secs());
-					roleData.setData(item->get_length_secs());
-				}
-				else if(sec_id == SectionID::MIMEType)
-				{
-					roleData.setData(item->getMimeType());
-				}
-				else if(sec_id == SectionID::Filename)
-				{
-					// return item->getFilename();
-					roleData.setData(item->getFilename());
-				}
-				else
-				{
-					// Get the list of metadata entry names which will work for this column's text,
-					// in descending order of preference.
-					QStringList metadata_choices = m_columnSpecs[index.column()].metadata_list;
-	//                qDebug() << "metadata_choices:" << metadata_choices;
-					for(QString& key: metadata_choices)
-					{
-						QStringList metadata_value_str_list = item->getMetadata(key);
-	//                    qDb() << "KEY:" << key << "LIST:" << metadata_value_str_list;
-						if(!metadata_value_str_list.isEmpty() && !metadata_value_str_list[0].isEmpty())
-						{
-							//qDebug() << "was valid: (" << metadata_value_str_list[0] << ")";
-							metaentry = QVariant::fromValue(metadata_value_str_list[0]);
-							break;
-						}
-					}
-				}
+				QVariant metaentry = getDisplayDataForEntry(*item, index.column());
 				if(!metaentry.isNull() && metaentry.isValid())
 				{
 					// return QVariant(metaentry);
 					roleData.setData(metaentry);
 				}
 			}
-			else
+		}
+	}
+}
+
+QVariant LibraryModel::getDisplayDataForEntry(const LibraryEntry& item, int column) const
+{
+	if(!item.isPopulated())
+	{
+		// Entry hasn't been populated yet.
+		return QVariant();
+	}
+
+	QVariant metaentry;
+	auto sec_id = getSectionFromCol(column);
+	if(sec_id == SectionID::Length)
+	{
+		// Return Fraction as a string.
+		metaentry = item.get_length_secs();
+	}
+	else if(sec_id == SectionID::MIMEType)
+	{
+		metaentry = QVariant::fromValue(item.getMimeType());
+	}
+	else if(sec_id == SectionID::Filename)
+	{
+		metaentry = item.getFilename();
+	}
+	else
+	{
+		// Get the list of metadata entry names which will work for this column's text,
+		// in descending order of preference.
+		const QStringList& metadata_choices = m_columnSpecs[column].metadata_list;
+		for(const QString& key: metadata_choices)
+		{
+			QStringList metadata_value_str_list = item.getMetadata(key);
+			if(!metadata_value_str_list.isEmpty() && !metadata_value_str_list[0].isEmpty())
 			{
-				// Entry hasn't been populated yet.
+				metaentry = QVariant::fromValue(metadata_value_str_list[0]);
+				break;
 			}
 		}
 	}
+	return metaentry;
 }
 
 QMap<int, QVariant> LibraryModel::itemData(const QModelIndex& index) const
@@ -436,6 +481,16 @@ std::shared_ptr<LibraryEntry> LibraryModel::createDefaultConstructedEntry() cons
 	return std::make_shared<LibraryEntry>();
 }
 
+QModelIndex LibraryModel::getIndexFromId(UUIncD id) const
+{
+	int row = m_library.getRowFromId(id);
+	if(row < 0)
+	{
+		return QModelIndex();
+	}
+	return index(row, 0);
+}
+
 std::shared_ptr<LibraryEntry> LibraryModel::getItem(const QModelIndex& index) const
 {
 	if (index.isValid())
@@ -500,12 +555,18 @@ bool LibraryModel::setData(const QModelIndex& index, const QVariant& value, int
 
 	Q_ASSERT(replacement_item);
 
+	if(sharesCollectionEntries())
+	{
+		replacement_item = CollectionStore::instance().intern(std::move(replacement_item), CollectionStore::InternMode::Replace);
+	}
+
 	m_library.replaceEntry(index.row(), replacement_item);
 
 	// Tell anybody that's listening that all data in this row has changed.
 	QModelIndex bottom_right_index = index.sibling(index.row(), columnCount() - 1);
 	//	qDebug() << "EMITTING DATACHANGED:" << index << index.parent() << bottom_right_index << bottom_right_index.parent() << Qt::ItemDataRole(role);
 	Q_EMIT dataChanged(index, bottom_right_index, {role});
+	Q_EMIT SIGNAL_entryReplaced(index.row());
 	return true;
 }
 
@@ -558,6 +619,11 @@ bool LibraryModel::removeRows(int row, int count, const QModelIndex& parent)
 	m_library.removeRows(row, count);
 
 	endRemoveRows();
+
+	if(sharesCollectionEntries())
+	{
+		CollectionStore::instance().entriesReleased();
+	}
 	return true;
 }
 
@@ -577,6 +643,12 @@ void LibraryModel::appendRows(std::vector<std::shared_ptr<LibraryEntry>> libentr
 {
 	auto start_rowcount = rowCount();
 
+	if(sharesCollectionEntries())
+	{
+		// Share the entries of any files another library already has.
+		libentries = CollectionStore::instance().intern(std::move(libentries), CollectionStore::InternMode::PreferExisting);
+	}
+
 	beginInsertRows(QModelIndex(), start_rowcount, start_rowcount+libentries.size()-1);
 
 	m_library.addNewEntries(libentries);
@@ -649,6 +721,11 @@ void LibraryModel::close(bool delete_cache)
 
 	// Stop the background thread.
 	stopAllBackgroundThreads();
+	// Drop any results which haven't been applied yet.
+	m_apply_updates_timer.stop();
+	m_pending_entry_updates.clear();
+	// Our entries go with us, the store can drop its records of them after that.
+	CollectionStore::instance().entriesReleased();
 	// Disconnect signals so we don't get any pending messages from the thread we just stopped.
 	disconnectIncomingSignals();
 	if(delete_cache)
@@ -659,15 +736,44 @@ void LibraryModel::close(bool delete_cache)
 }
 
 QVariant LibraryModel::toVariant() const
+{
+	return toVariant(*m_library.snapshot());
+}
+
+// static
+QVariant LibraryModel::toVariant(const LibrarySnapshot& snapshot)
 {
 	InsertionOrderedMap<QString, QVariant> map;
 
-	map_insert_or_die(map, "the_models_library", m_library);
+	map_insert_or_die(map, "the_models_library", Library::toVariant(snapshot));
 
 	return map;
 }
 
+void LibraryModel::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	toXmlStream(*m_library.snapshot(), visitor, node_name);
+}
+
+// static
+void LibraryModel::toXmlStream(const LibrarySnapshot& snapshot, XmlStreamVisitor& visitor, const QString& node_name)
+{
+	visitor.beginMap(node_name);
+	Library::toXmlStream(snapshot, visitor, "the_models_library");
+	visitor.endElement();
+}
+
+std::shared_ptr<const LibrarySnapshot> LibraryModel::getLibrarySnapshot() const
+{
+	return m_library.snapshot();
+}
+
 void LibraryModel::fromVariant(const QVariant& variant)
+{
+	fromVariantSplit(variant);
+}
+
+std::optional<std::size_t> LibraryModel::fromVariantSplit(const QVariant& variant)
 {
 	InsertionOrderedMap<QString, QVariant> map;
 	qviomap_from_qvar_or_die(&map, variant);
@@ -678,10 +784,12 @@ void LibraryModel::fromVariant(const QVariant& variant)
 	InsertionOrderedMap<QString, QVariant> qvar_temp_lib = temp.value<InsertionOrderedMap<QString, QVariant>>();
 	Library temp_lib;
 
-	temp_lib.fromVariant(qvar_temp_lib);
+	std::optional<std::size_t> run_index = temp_lib.fromVariantSplit(qvar_temp_lib);
 
 // #warning "Do we need to delete any old library here?"
 	m_library = temp_lib;
+
+	return run_index;
 }
 
 Qt::DropActions LibraryModel::supportedDragActions() const
@@ -736,17 +844,32 @@ QMimeData* LibraryModel::mimeData(const QModelIndexList& indexes) const
 
 void LibraryModel::SLOT_onIncomingFilename(QString filename)
 {
+	Trace::Span span("Model::insertFilename");
+
     auto new_entry = LibraryEntry::fromUrl(filename);
 //	qDb() << "URL:" << new_entry->getUrl();
+
+	if(sharesCollectionEntries())
+	{
+		// If the file's metadata has already been read, e.g. it's in another library too, and the file hasn't changed
+		// since, use what we have.
+		auto known_entries = CollectionStore::instance().populatedEntries(new_entry->getUrl());
+		if(!known_entries.empty())
+		{
+			appendRows(std::move(known_entries));
+			return;
+		}
+	}
+
 	appendRow(new_entry);
 }
 
 void LibraryModel::SLOT_processReadyResults(MetadataReturnVal lritem_vec)
 {
     // We got one of ??? things back:
-    // - A single pindex and associated LibraryEntry*, maybe new, maybe a rescan..
-    // - A single pindex and more than one LibraryEntry*, the result of the first scan after the file was found.
-    // - Multiple pindexes and LibraryEntry*'s. The result of a multi-track file rescan.
+    // - A single entry ID and associated LibraryEntry*, maybe new, maybe a rescan..
+    // - A single entry ID and more than one LibraryEntry*, the result of the first scan after the file was found.
+    // - Multiple entry IDs and LibraryEntry*'s. The result of a multi-track file rescan.
 
     if(lritem_vec.m_num_tracks_found == 0)
     {
@@ -754,44 +877,31 @@ void LibraryModel::SLOT_processReadyResults(MetadataReturnVal lritem_vec)
     }
 
     if(lritem_vec.m_num_tracks_found > 1
-       && lritem_vec.m_original_pindexes.size() == 1
+       && lritem_vec.m_original_ids.size() == 1
             && lritem_vec.m_new_libentries.size() == lritem_vec.m_num_tracks_found)
     {
         // It's a valid, new, multi-track entry.
-        SLOT_onIncomingPopulateRowWithItems_Multiple(lritem_vec.m_original_pindexes[0], lritem_vec.m_new_libentries);
+        SLOT_onIncomingPopulateRowWithItems_Multiple(lritem_vec.m_original_ids[0], lritem_vec.m_new_libentries);
     }
     else if(lritem_vec.m_new_libentries.size() == lritem_vec.m_num_tracks_found
-            && lritem_vec.m_original_pindexes.size() == lritem_vec.m_num_tracks_found)
+            && lritem_vec.m_original_ids.size() == lritem_vec.m_num_tracks_found)
     {
-        // It's a matching set of pindexes and libentries.
+        // It's a matching set of entry IDs and libentries.
 
         for(int i=0; i<lritem_vec.m_num_tracks_found; ++i)
         {
-            if (!lritem_vec.m_original_pindexes[i].isValid())
-            {
-                qWarning() << "Invalid persistent index, ignoring update";
-                return;
-            }
-
             // None of the returned entries should be null.
             Q_ASSERT(lritem_vec.m_new_libentries[i] != nullptr);
 
-            qDebug() << "Replacing entry"; // << item->getUrl();
             // item is a single song which has its metadata populated.
-            // Reconstruct the QModelIndex we sent out.
-            auto initial_row_index = QModelIndex(lritem_vec.m_original_pindexes[i]);
-            auto row = initial_row_index.row();
-            qDebug() << QString("incoming single item, row %1").arg(row);
-            // Metadata's been populated.
-            setData(initial_row_index, QVariant::fromValue(lritem_vec.m_new_libentries[i]));
+            SLOT_onIncomingPopulateRowWithItems_Single(lritem_vec.m_original_ids[i], lritem_vec.m_new_libentries[i]);
         }
     }
     else
     {
         // Not sure what we got.
-        qCritical() << "pindexes/libentries/num_new_entries:" << lritem_vec.m_original_pindexes.size()
+        qCritical() << "entry ids/libentries/num_new_entries:" << lritem_vec.m_original_ids.size()
                                                               << lritem_vec.m_new_libentries.size();
-                                                              // lritem_vec.m_new_libentries;
         Q_ASSERT_X(0, "Scanning", "Not sure what we got");
     }
 }
@@ -799,9 +909,8 @@ void LibraryModel::SLOT_processReadyResults(MetadataReturnVal lritem_vec)
 void LibraryModel::SLOT_processReadyResults(LibraryEntryLoaderJobResult loader_results)
 {
     // We got one of ??? things back:
-    // - A single pindex and associated LibraryEntry*, maybe new, maybe a rescan..
-    // - A single pindex and more than one LibraryEntry*, the result of the first scan after the file was found.
-    // - Multiple pindexs and LibraryEntry*'s.  The result of a multi-track file rescan.
+    // - A single entry ID and associated LibraryEntry*, maybe new, maybe a rescan..
+    // - A single entry ID and more than one LibraryEntry*, the result of the first scan after the file was found.
 
     if(loader_results.m_num_tracks_found == 0)
     {
@@ -817,74 +926,98 @@ void LibraryModel::SLOT_processReadyResults(LibraryEntryLoaderJobResult loader_r
     if(loader_results.m_new_libentries.size() > 1)
     {
         // It's a single file/multi-track.
-        SLOT_onIncomingPopulateRowWithItems_Multiple(loader_results.m_original_pindex, loader_results.m_new_libentries);
+        SLOT_onIncomingPopulateRowWithItems_Multiple(loader_results.m_original_id, loader_results.m_new_libentries);
     }
     else if(loader_results.m_new_libentries.size() == 1)
     {
         // It's a single file/single track.
-        SLOT_onIncomingPopulateRowWithItems_Single(loader_results.m_original_pindex, loader_results.m_new_libentries[0]);
-
-//        for(int i=0; i<loader_results.m_num_tracks_found; ++i)
-//        {
-//            if (!loader_results.m_original_pindex.isValid())
-//            {
-//                qWarning() << "Invalid persistent index, ignoring update";
-//                Q_ASSERT(0);
-//                return;
-//            }
-
-//            // None of the returned entries should be null.
-//            Q_ASSERT(loader_results.m_new_libentries[i] != nullptr);
-
-//            qDebug() << "Replacing entry"; // << item->getUrl();
-//            // item is a single song which has its metadata populated.
-//            // Reconstruct the QModelIndex we sent out.
-//            auto initial_row_index = QModelIndex(loader_results.m_original_pindexes[i]);
-//            auto row = initial_row_index.row();
-//            qDebug() << QString("incoming single item, row %1").arg(row);
-//            // Metadata's been populated.
-//            setData(initial_row_index, QVariant::fromValue(loader_results.m_new_libentries[i]));
-//        }
+        SLOT_onIncomingPopulateRowWithItems_Single(loader_results.m_original_id, loader_results.m_new_libentries[0]);
     }
     else
     {
         // Not sure what we got.
-        qCritical() << "pindexes/libentries/num_new_entries:" << loader_results.m_original_pindex
+        qCritical() << "entry id/libentries/num_new_entries:" << loader_results.m_original_id
                                                               << loader_results.m_new_libentries.size();
-                                                              // lritem_vec.m_new_libentries;
         Q_ASSERT_X(0, "Scanning", "Not sure what we got");
     }
 }
 
-void LibraryModel::SLOT_onIncomingPopulateRowWithItems_Single(QPersistentModelIndex pindex, std::shared_ptr<LibraryEntry> item)
+void LibraryModel::requestEntryLoads(const std::vector<int>& rows)
 {
-	// item is a single song which has its metadata populated.
-	// Reconstruct the QModelIndex we sent out.
-    Q_ASSERT(pindex.isValid());
-    Q_ASSERT(pindex.model() == this);
-    const QModelIndex& initial_row_index = pindex;
+	if(!sharesCollectionEntries())
+	{
+		// The loader reads a plain LibraryEntry, derived models' entries are more than that.
+		return;
+	}
+
+	for(int row : rows)
+	{
+		if(row < 0 || static_cast<size_t>(row) >= m_library.size())
+		{
+			continue;
+		}
+		const std::shared_ptr<LibraryEntry> item = m_library[row];
+		if(!item->isPopulated())
+		{
+			requestEntryLoad(row, item);
+		}
+	}
+}
 
-    // Metadata's been populated.
-	setData(initial_row_index, QVariant::fromValue(item));
-//	setData(initial_row_index, QVariant::fromValue(item), ModelUserRoles::PointerToItemRole);
+void LibraryModel::requestEntryLoad(int row, const std::shared_ptr<LibraryEntry>& item)
+{
+	const UUIncD entry_id = m_library.getIdAt(row);
+	if(m_pending_async_item_loads.contains(entry_id))
+	{
+		return;
+	}
+	m_pending_async_item_loads.insert(entry_id, true);
+
+	// One task per row, they're shown as one job.  If the model's gone by the time it's done, the result's dropped.
+	// The .then() isn't run if the load is canceled or throws, so it's forgotten on those paths too, or the row would
+	// never be loaded again, and getLibRescanItems() would skip it.
+	auto forget_pending = [this, entry_id](){ m_pending_async_item_loads.remove(entry_id); };
+	QFuture<LibraryEntryLoaderJobResult>(LibraryEntryLoaderJob::make_task(entry_id, item))
+	.then(this, [this, forget_pending](QFuture<LibraryEntryLoaderJobResult> future){
+		forget_pending();
+		if(future.isCanceled() || future.resultCount() == 0)
+		{
+			// Canceled, or it couldn't be read, the next rescan will pick it up.
+			return;
+		}
+		SLOT_processReadyResults(future.result());
+	})
+	.onFailed(this, [entry_id, forget_pending](){
+		qWr() << "Loading entry" << entry_id << "failed, the next rescan will retry it";
+		forget_pending();
+	})
+	.onCanceled(this, forget_pending);
+}
 
-	finishIncoming();
+void LibraryModel::SLOT_onIncomingPopulateRowWithItems_Single(UUIncD entry_id, std::shared_ptr<LibraryEntry> item)
+{
+	// item is a single song which has its metadata populated.
+	// Queue it up, it'll be applied along with any others which arrive in the same frame.
+	queueEntryUpdate(entry_id, std::move(item));
 }
 
-void LibraryModel::SLOT_onIncomingPopulateRowWithItems_Multiple(QPersistentModelIndex pindex, std::vector<std::shared_ptr<LibraryEntry> > items)
+void LibraryModel::SLOT_onIncomingPopulateRowWithItems_Multiple(UUIncD entry_id, std::vector<std::shared_ptr<LibraryEntry> > items)
 {
-	if(!pindex.isValid())
+	Trace::Span span("Model::insertTracks");
+	span.counter("tracks", items.size());
+
+	// Resolve the entry ID we sent out to wherever that entry is now.
+	auto initial_row_index = getIndexFromId(entry_id);
+	if(!initial_row_index.isValid())
 	{
-		qCritical() << QString("invalid pindex, item list len: %1, first item: %2").arg(items.size()).arg(items[0]->getUrl().toString());
+		qCritical() << QString("Entry no longer in model, item list len: %1, first item: %2").arg(items.size()).arg(items[0]->getUrl().toString());
 		return;
 	}
-	// Reconstruct the QModelIndex we sent out.
-	auto initial_row_index = QModelIndex(pindex);
 	auto row = initial_row_index.row();
 	Q_ASSERT(row >= 0);
 
 	// This was a multi-track file which was split into its subtracks.
-	// items is a list which needs to be added to the model, pindex needs to be removed.
+	// items is a list which needs to be added to the model, the original entry needs to be removed.
 
 	insertRows(row + 1, items.size());
 
@@ -893,7 +1026,6 @@ void LibraryModel::SLOT_onIncomingPopulateRowWithItems_Multiple(QPersistentModel
 	for(int i = 0; i < static_cast<int>(items.size()); ++i)
 	{
 		setData(index(row + 1 + i, 0), QVariant::fromValue(items[i]), Qt::EditRole);
-//		setData(index(row + 1 + i, 0), QVariant::fromValue(items[i]), ModelUserRoles::PointerToItemRole);
 	}
 
 	// Delete the original LibraryEntry which pointed to the entire album.
@@ -901,6 +1033,173 @@ void LibraryModel::SLOT_onIncomingPopulateRowWithItems_Multiple(QPersistentModel
 }
 
 
+void LibraryModel::queueEntryUpdate(UUIncD entry_id, std::shared_ptr<LibraryEntry> new_entry)
+{
+	Q_ASSERT(new_entry);
+	m_pending_entry_updates.push_back({entry_id, std::move(new_entry)});
+	if(!m_apply_updates_timer.isActive())
+	{
+		m_apply_updates_timer.start();
+	}
+}
+
+void LibraryModel::applyPendingEntryUpdates()
+{
+	// Leave the rest of the frame for painting.
+	constexpr auto c_time_budget = std::chrono::milliseconds(8);
+
+	Trace::Span span("Model::applyEntryUpdates");
+	span.counter("pending", m_pending_entry_updates.size());
+
+	QElapsedTimer budget_timer;
+	budget_timer.start();
+
+	std::vector<RowChange> changes;
+
+	while(!m_pending_entry_updates.empty() && budget_timer.durationElapsed() < c_time_budget)
+	{
+		PendingEntryUpdate update = std::move(m_pending_entry_updates.front());
+		m_pending_entry_updates.pop_front();
+
+		// Resolve the entry ID we sent out to wherever that entry is now.
+		int row = m_library.getRowFromId(update.m_entry_id);
+		if(row < 0)
+		{
+			// Entry was removed while the load was in flight.
+			continue;
+		}
+
+		std::shared_ptr<LibraryEntry> old_entry = m_library[row];
+		if(old_entry == update.m_new_entry)
+		{
+			continue;
+		}
+		RowChange change = diffEntries(*old_entry, *update.m_new_entry);
+		if(change.isEmpty() && old_entry->hasSameContentAs(*update.m_new_entry))
+		{
+			// A rescan which found nothing new.  Keep the entry everybody already has, so nothing downstream (the
+			// CollectionStore, its tree model, the journal) sees a change, it just learns which version of the file
+			// it's current with.
+			if(sharesCollectionEntries())
+			{
+				CollectionStore::instance().refreshPopulatedFrom(*old_entry, *update.m_new_entry);
+			}
+			continue;
+		}
+
+		if(sharesCollectionEntries())
+		{
+			update.m_new_entry = CollectionStore::instance().intern(std::move(update.m_new_entry), CollectionStore::InternMode::Replace);
+		}
+
+		// Changes no view can see, e.g. to the Metadata, still get swapped in.
+		m_library.replaceEntry(row, update.m_new_entry);
+		Q_EMIT SIGNAL_entryReplaced(row);
+
+		if(!change.isEmpty())
+		{
+			change.m_row = row;
+			changes.push_back(change);
+		}
+	}
+
+	if(!changes.empty())
+	{
+		std::sort(changes.begin(), changes.end(), [](const RowChange& a, const RowChange& b){ return a.m_row < b.m_row; });
+		emitCoalescedDataChanged(changes);
+		finishIncoming();
+	}
+
+	if(!m_pending_entry_updates.empty())
+	{
+		// More to do next frame.
+		m_apply_updates_timer.start();
+	}
+}
+
+LibraryModel::RowChange LibraryModel::diffEntries(const LibraryEntry& old_entry, const LibraryEntry& new_entry) const
+{
+	RowChange retval;
+
+	const int num_cols = columnCount();
+	for(int col = 0; col < num_cols; ++col)
+	{
+		unsigned int roles = 0;
+
+		switch(getSectionFromCol(col))
+		{
+		case SectionID::Status:
+			if(old_entry.isPopulated() != new_entry.isPopulated() || old_entry.isError() != new_entry.isError())
+			{
+				roles |= RoleBitDecoration;
+			}
+			if(old_entry.hasNoPregap() != new_entry.hasNoPregap())
+			{
+				roles |= RoleBitDisplay;
+			}
+			if(!(old_entry.getAllMetadata() == new_entry.getAllMetadata()))
+			{
+				roles |= RoleBitToolTip;
+			}
+			break;
+		case SectionID::MIMEType:
+			if(old_entry.isPopulated() != new_entry.isPopulated() || old_entry.getMimeType() != new_entry.getMimeType())
+			{
+				roles |= RoleBitDisplay | RoleBitToolTip | RoleBitDecoration;
+			}
+			break;
+		default:
+			if(getDisplayDataForEntry(old_entry, col) != getDisplayDataForEntry(new_entry, col))
+			{
+				roles |= RoleBitDisplay | RoleBitToolTip;
+			}
+			break;
+		}
+
+		if(roles != 0)
+		{
+			if(retval.m_first_col < 0)
+			{
+				retval.m_first_col = col;
+			}
+			retval.m_last_col = col;
+			retval.m_roles |= roles;
+		}
+	}
+
+	return retval;
+}
+
+void LibraryModel::emitCoalescedDataChanged(const std::vector<RowChange>& changes)
+{
+	auto roles_to_list = [](unsigned int role_bits) {
+		QList<int> retval;
+		if(role_bits & RoleBitDisplay) { retval.push_back(Qt::DisplayRole); }
+		if(role_bits & RoleBitToolTip) { retval.push_back(Qt::ToolTipRole); }
+		if(role_bits & RoleBitDecoration) { retval.push_back(Qt::DecorationRole); }
+		return retval;
+	};
+
+	auto range_start = changes.cbegin();
+	for(auto it = changes.cbegin(); it != changes.cend(); ++it)
+	{
+		auto next = std::next(it);
+		bool extends_range = next != changes.cend()
+				&& next->m_row == it->m_row + 1
+				&& next->m_first_col == range_start->m_first_col
+				&& next->m_last_col == range_start->m_last_col
+				&& next->m_roles == range_start->m_roles;
+		if(!extends_range)
+		{
+			// End of a run of adjacent rows with identical changes.
+			Q_EMIT dataChanged(index(range_start->m_row, range_start->m_first_col),
+							   index(it->m_row, range_start->m_last_col),
+							   roles_to_list(range_start->m_roles));
+			range_start = next;
+		}
+	}
+}
+
 void LibraryModel::createCacheFile(QUrl root_url)
 {
 	// Make sure the cache directory exists.
@@ -1017,48 +1316,49 @@ QVector<VecLibRescannerMapItems> LibraryModel::getLibRescanItems()
     QVector<VecLibRescannerMapItems> items_to_rescan;
 
     // Get a list of all entries we'll need to do an asynchronous rescan of the library.
-    if(rowCount() > 0)
-    {
-        // At least one row, so we have something to refresh.
+    // This runs in the GUI thread, so it's kept to a straight walk of the Library's entries: no QModelIndex
+    // or QPersistentModelIndex construction, and no per-row logging.
+    const auto num_entries = m_library.size();
+    items_to_rescan.reserve(num_entries);
 
-        // Collect a snapshot of info to send to the other thread for refreshing.
+    VecLibRescannerMapItems multientry;
+    const LibraryEntry* last_entry = nullptr;
 
-        VecLibRescannerMapItems multientry;
-        std::shared_ptr<LibraryEntry> last_entry = nullptr;
+    for(size_t i=0; i<num_entries; ++i)
+    {
+        const std::shared_ptr<LibraryEntry> item = m_library[i];
 
-        for(auto i=0; i<rowCount(); ++i)
+        if(item->isPopulated() && sharesCollectionEntries() && CollectionStore::instance().isCurrent(*item))
         {
-            auto item = getItem(index(i,0));
+            // Read from the file as the scan just found it, e.g. it came from another library, nothing to do.
+            continue;
+        }
 
-            qDebug() << "Item URL:" << i << item->getUrl();
+        if(!item->isPopulated() && m_pending_async_item_loads.contains(m_library.getIdAt(i)))
+        {
+            // Already being loaded because it's on screen, the result will come in through SLOT_processReadyResults().
+            continue;
+        }
 
-            if(last_entry != nullptr && item->isFromSameFileAs(last_entry.get()))
-            {
-                // It's from the same file as the last entry we looked at.
-                // Queue it up in the current batch.
-                multientry.push_back(LibraryRescannerMapItem({QPersistentModelIndex(index(i, 0)), item}));
-            }
-            else
+        if(last_entry == nullptr || !item->isFromSameFileAs(last_entry))
+        {
+            // It's the first entry or it's from a different file.  Send out the previous rescan item(s) and start a new batch.
+            if(!multientry.empty())
             {
-                // It's the first entry or it's from a different file.  Send out the previous rescan item(s) and start a new batch.
-                if(!multientry.empty())
-                {
-                    items_to_rescan.append(multientry);
-                    qDebug() << "PUSHING MULTIENTRY, SIZE:" << multientry.size();
-                }
-                multientry.clear();
-                multientry.push_back(LibraryRescannerMapItem({QPersistentModelIndex(index(i, 0)), item}));
+                items_to_rescan.append(std::move(multientry));
             }
-            last_entry = item;
+            multientry = VecLibRescannerMapItems();
         }
+        // else it's from the same file as the last entry we looked at, queue it up in the current batch.
 
-        if(!multientry.empty())
-        {
-            // It wasn't cleared by the last iteration above, so we have to append it here.
-            items_to_rescan.append(multientry);
-            qDebug() << "PUSHING LAST MULTIENTRY, SIZE:" << multientry.size();
-            multientry.clear();
-        }
+        multientry.push_back(LibraryRescannerMapItem({m_library.getIdAt(i), item}));
+        last_entry = item.get();
+    }
+
+    if(!multientry.empty())
+    {
+        // It wasn't cleared by the last iteration above, so we have to append it here.
+        items_to_rescan.append(std::move(multientry));
     }
 
     qDb() << "RETURNING ITEMS:" << items_to_rescan.size();
@@ -1089,7 +1389,7 @@ void LibraryModel::startRescan()
 			{
 				// It's from the same file as the last entry we looked at.
 				// Queue it up in the current batch.
-                multientry.push_back(LibraryRescannerMapItem({QPersistentModelIndex(index(i, 0)), item}));
+                multientry.push_back(LibraryRescannerMapItem({m_library.getIdAt(i), item}));
 			}
 			else
 			{
@@ -1100,7 +1400,7 @@ void LibraryModel::startRescan()
 					qDebug() << "PUSHING MULTIENTRY, SIZE:" << multientry.size();
 				}
 				multientry.clear();
-                multientry.push_back(LibraryRescannerMapItem({QPersistentModelIndex(index(i, 0)), item}));
+                multientry.push_back(LibraryRescannerMapItem({m_library.getIdAt(i), item}));
 			}
 			last_entry = item;
 		}
@@ -23,13 +23,16 @@
 /** @file LibraryModel.h */
 
 // Std C++
+#include <deque>
 #include <vector>
 #include <memory>
+#include <optional>
 
 // Qt
 #include <QAbstractItemModel>
 #include <QFuture>
 #include <QSaveFile>
+#include <QTimer>
 #include <QUrl>
 #include <QVector>
 class QFileDevice;
@@ -78,6 +81,13 @@ Q_SIGNALS:
 //    void SIGNAL_selfSendReadyResults(MetadataReturnVal results) const;
 	void SIGNAL_selfSendReadyResults(LibraryEntryLoaderJobResult results);
 
+	/**
+	 * Emitted after the LibraryEntry at @a row has been replaced by a new one, whether or not that changed anything
+	 * a view would show (so there may or may not be a corresponding dataChanged()).
+	 * Inserts and removes are covered by the standard rowsInserted()/rowsRemoved().
+	 */
+	void SIGNAL_entryReplaced(int row);
+
 public:
 	explicit LibraryModel(QObject *parent = nullptr);
     ~LibraryModel() override;
@@ -130,8 +140,20 @@ public:
 	/// of an entry derived from LibraryEntry.  Used by insertRows().
 	virtual std::shared_ptr<LibraryEntry> createDefaultConstructedEntry() const;
 
+	/**
+	 * Whether this model's entries are shared through the CollectionStore.  Override to return false in derived classes
+	 * whose entries are more than the LibraryEntry of a file, e.g. playlists.
+	 */
+	virtual bool sharesCollectionEntries() const { return true; }
+
 	virtual std::shared_ptr<LibraryEntry> getItem(const QModelIndex& index) const;
 
+	/**
+	 * Resolve the stable Library entry ID @a id to a column-0 QModelIndex.
+	 * @return The index, or an invalid QModelIndex if the entry no longer exists.
+	 */
+	QModelIndex getIndexFromId(UUIncD id) const;
+
 	bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
 
 
@@ -173,6 +195,27 @@ public:
 
 	QVariant toVariant() const override;
 	void fromVariant(const QVariant& variant) override;
+	/**
+	 * fromVariant() for a @a variant from XmlSerializer::load_split(), see Library::fromVariantSplit().
+	 * The entries of the returned run go in with appendRows() as they're loaded.
+	 */
+	std::optional<std::size_t> fromVariantSplit(const QVariant& variant);
+
+	/**
+	 * Serialize @a snapshot exactly as toVariant() serializes the LibraryModel it was taken from.
+	 * Threadsafe, FBO saving from a non-GUI thread.
+	 */
+	static QVariant toVariant(const LibrarySnapshot& snapshot);
+
+	void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const override;
+	/// Streaming version of toVariant(const LibrarySnapshot&), same threadsafety.
+	static void toXmlStream(const LibrarySnapshot& snapshot, XmlStreamVisitor& visitor, const QString& node_name);
+
+	/**
+	 * Returns an immutable snapshot of the underlying Library, which can be walked from another thread
+	 * while this model continues to change.  @see Library::snapshot().
+	 */
+	std::shared_ptr<const LibrarySnapshot> getLibrarySnapshot() const;
 
 	///
 	/// Drag and drop support.
@@ -191,15 +234,24 @@ public Q_SLOTS:
 	/// All this is for reading the metadata from a non-GUI thread.
     void SLOT_processReadyResults(MetadataReturnVal lritem_vec);
     void SLOT_processReadyResults(LibraryEntryLoaderJobResult loader_results);
-    void SLOT_onIncomingPopulateRowWithItems_Single(QPersistentModelIndex pindex, std::shared_ptr<LibraryEntry> item);
-	void SLOT_onIncomingPopulateRowWithItems_Multiple(QPersistentModelIndex pindex, LibraryModel::StdVecOfSharedPtrToLibEntry items);
+    void SLOT_onIncomingPopulateRowWithItems_Single(UUIncD entry_id, std::shared_ptr<LibraryEntry> item);
+	void SLOT_onIncomingPopulateRowWithItems_Multiple(UUIncD entry_id, LibraryModel::StdVecOfSharedPtrToLibEntry items);
 
 	/**
-	 * 
-	 * @return  A QList of all the items in the LibraryModel which need to be populated with metadata.
+	 * Take a snapshot of the Library for a rescan.  This is a straight walk of the underlying Library,
+	 * no QModelIndexes or QPersistentModelIndexes are created.
+	 * @return  A QList of all the items in the LibraryModel which need to be populated with metadata,
+	 *          grouped by file.  Entries which the CollectionStore says are populated and current, e.g. because they came
+	 *          from another library, are left out.
 	 */
 	virtual QList<VecLibRescannerMapItems> getLibRescanItems();
 
+	/**
+	 * Load the metadata of the unpopulated entries at @a rows in the background, ahead of the rescan.
+	 * For the rows a view actually has on screen, see MDILibraryView::loadVisibleRows().
+	 */
+	void requestEntryLoads(const std::vector<int>& rows);
+
 	/// Let's try something different.
 	virtual void startRescan();
 
@@ -220,6 +272,12 @@ protected:
 
 	virtual QString getEntryStatusToolTip(LibraryEntry* item) const;
 
+	/**
+	 * Returns the Qt::DisplayRole data for @a item in @a column, or an invalid QVariant if there is none.
+	 * Doesn't handle the SectionID::Status column, which has no DisplayRole data to speak of.
+	 */
+	QVariant getDisplayDataForEntry(const LibraryEntry& item, int column) const;
+
 	std::vector<ColumnSpec> m_columnSpecs;
 
 	/// The underlying data store.
@@ -238,9 +296,59 @@ private:
 	/// Icons for various entry states.
 	QVariant m_IconError, m_IconOk, m_IconUnknown;
 
+	/// @name Coalesced application of incoming async entry updates.
+	/// Incoming single-entry results are queued, then applied in time-boxed batches from a timer.  Each batch
+	/// diffs the new entries against the current ones, skips rows which didn't visibly change, and emits one
+	/// dataChanged() per run of adjacent rows with the same changed columns and roles.
+	/// @{
+
+	struct PendingEntryUpdate
+	{
+		UUIncD m_entry_id;
+		std::shared_ptr<LibraryEntry> m_new_entry;
+	};
+
+	/// The visible changes between two versions of a row.
+	struct RowChange
+	{
+		int m_row {-1};
+		int m_first_col {-1};
+		int m_last_col {-1};
+		/// Bitmask of the RoleBit's which changed.
+		unsigned int m_roles {0};
+
+		bool isEmpty() const { return m_first_col < 0; }
+	};
+
+	enum RoleBit : unsigned int
+	{
+		RoleBitDisplay = 0x01,
+		RoleBitToolTip = 0x02,
+		RoleBitDecoration = 0x04,
+	};
+
+	void queueEntryUpdate(UUIncD entry_id, std::shared_ptr<LibraryEntry> new_entry);
+
+	/// Load the metadata of unpopulated @a item at @a row in the background, unless it's already being loaded.
+	void requestEntryLoad(int row, const std::shared_ptr<LibraryEntry>& item);
+
+	/// Timer slot, applies as many queued updates as will fit in one frame's time budget.
+	void applyPendingEntryUpdates();
+
+	/// Diff the parts of @a old_entry and @a new_entry which the views can see.
+	RowChange diffEntries(const LibraryEntry& old_entry, const LibraryEntry& new_entry) const;
+
+	/// Emit the minimal set of dataChanged() signals for @a changes, which must be sorted by row.
+	void emitCoalescedDataChanged(const std::vector<RowChange>& changes);
+
+	std::deque<PendingEntryUpdate> m_pending_entry_updates;
+	QTimer m_apply_updates_timer;
+
+	/// @}
+
 	/// @name Data structures for managing the data loading process.
-//    mutable std::map<std::shared_ptr<LibraryEntry>, LibraryEntryLoaderJobPtr> m_pending_async_item_loads;
-	mutable ThreadsafeMap<QPersistentModelIndex, bool> m_pending_async_item_loads;
+	/// Entries requestEntryLoad() is loading.  Only touched in the GUI thread.
+	ThreadsafeMap<UUIncD, bool> m_pending_async_item_loads;
 };
 
 Q_DECLARE_METATYPE(LibraryModel);
@@ -28,6 +28,7 @@
 // Ours.
 #include "utils/StringHelpers.h"
 #include "utils/DebugHelpers.h"
+#include "logic/serialization/BlockCompressedIO.h"
 #include "LibraryEntryMimeData.h"
 #include "logic/ModelUserRoles.h"
 
@@ -395,9 +396,17 @@ void PlaylistModel::setLibraryRootUrl(const QUrl &url)
     endResetModel();
 }
 
-bool PlaylistModel::serializeToFileAsXSPF(QFileDevice& filedev) const
+bool PlaylistModel::serializeToFileAsXSPF(QFileDevice& filedev, bool compress) const
 {
-	QXmlStreamWriter stream(&filedev);
+	BlockCompressedWriter compressor(&filedev);
+	QIODevice* xml_device = &filedev;
+	if(compress)
+	{
+		compressor.open(QIODevice::WriteOnly);
+		xml_device = &compressor;
+	}
+
+	QXmlStreamWriter stream(xml_device);
 
 	stream.setAutoFormatting(true);
 	stream.writeStartDocument();
@@ -436,7 +445,13 @@ bool PlaylistModel::serializeToFileAsXSPF(QFileDevice& filedev) const
 	}
 	stream.writeEndDocument();
 
-	return true;
+	if(compressor.isOpen())
+	{
+		compressor.close();
+		return !stream.hasError() && compressor.errorString().isEmpty();
+	}
+
+	return !stream.hasError();
 
 }
 
@@ -66,6 +66,9 @@ public:
 	/// of an entry derived from LibraryEntry.  Used by insertRows().
 	std::shared_ptr<LibraryEntry> createDefaultConstructedEntry() const override;
 
+	/// PlaylistModelItems carry per-playlist state, they're never shared.
+	bool sharesCollectionEntries() const override { return false; }
+
 	std::shared_ptr<LibraryEntry> getItem(const QModelIndex& index) const override;
 
 	bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
@@ -90,7 +93,11 @@ public:
 
 	void setLibraryRootUrl(const QUrl& url) override;
 
-	bool serializeToFileAsXSPF(QFileDevice& filedev) const;
+	/**
+	 * Write the playlist to @a filedev as XSPF.
+	 * @param compress  Block-compress it, see BlockCompressedFormat.  Other players won't be able to read it.
+	 */
+	bool serializeToFileAsXSPF(QFileDevice& filedev, bool compress = false) const;
 };
 
 Q_DECLARE_METATYPE(PlaylistModel)
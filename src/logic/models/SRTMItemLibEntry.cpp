@@ -56,6 +56,13 @@ SRTMItem_LibEntry::SRTMItem_LibEntry(std::shared_ptr<LibraryEntry> libentry, con
 
 }
 
+// static
+std::shared_ptr<SRTMItem_LibEntry> SRTMItem_LibEntry::create_shared(const std::shared_ptr<AbstractTreeModel>& model)
+{
+	return TreeNodeArena::make_node<SRTMItem_LibEntry>(model ? model->getNodeArena() : nullptr,
+			[&](void* mem){ return new (mem) SRTMItem_LibEntry(model); });
+}
+
 QVariant SRTMItem_LibEntry::data(int column, int role) const
 {
 	if((role != Qt::ItemDataRole::DisplayRole) && (role != Qt::ItemDataRole::EditRole))
@@ -56,6 +56,8 @@ public:
     {
         return std::unique_ptr<SRTMItem_LibEntry>(new SRTMItem_LibEntry(libentry, model));
     }
+    /// Create a new item in @a model's node arena, or on the heap if @a model is null.
+    static std::shared_ptr<SRTMItem_LibEntry> create_shared(const std::shared_ptr<AbstractTreeModel>& model);
 //	static std::shared_ptr<SRTMItem_LibEntry> construct(std::shared_ptr<LibraryEntry> libentry,
 //	                                                    const std::shared_ptr<AbstractTreeModelItem>& parent = nullptr, UUIncD id = UUIncD::null());
 //	static std::shared_ptr<SRTMItem_LibEntry> construct(const QVariant& variant,
@@ -67,6 +69,7 @@ public:
 	int columnCount() const override;
 
 	void setLibraryEntry(std::shared_ptr<LibraryEntry> libentry) { m_library_entry = libentry; };
+	std::shared_ptr<LibraryEntry> getLibraryEntry() const { return m_library_entry; }
 
 	/// @name ISerializable interface
 	/// @{
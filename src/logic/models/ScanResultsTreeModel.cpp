@@ -21,6 +21,10 @@
 
 #include "ScanResultsTreeModel.h"
 
+// Std C++
+#include <algorithm>
+#include <optional>
+
 // Qt
 #include <QAbstractItemModelTester>
 
@@ -33,6 +37,7 @@
 #include "ScanResultsTreeModelItem.h"
 #include "AbstractTreeModelHeaderItem.h"
 #include "SRTMItemLibEntry.h"
+#include <logic/CollectionStore.h>
 #include <logic/serialization/SerializationHelpers.h>
 
 #include <serialization/XmlSerializer.h>
@@ -98,6 +103,91 @@ void ScanResultsTreeModel::setBaseDirectory(const QUrl &base_directory)
 	m_base_directory = base_directory;
 }
 
+void ScanResultsTreeModel::applyCollectionStoreChanges(const CollectionStore& store, const QStringList& file_keys)
+{
+	AMLM_ASSERT_IN_GUITHREAD();
+
+	std::shared_ptr<AbstractTreeModel> self = shared_from_this();
+	const auto root = getRootItem();
+
+	for(const QString& key : file_keys)
+	{
+		std::optional<CollectionStore::FileView> file = store.file(key);
+
+		// The file rows are kept in key order, so the tree doesn't shuffle as files come and go.
+		auto key_it = std::lower_bound(m_file_keys.begin(), m_file_keys.end(), key);
+		const int row = static_cast<int>(key_it - m_file_keys.begin());
+		const bool have_row = (key_it != m_file_keys.end() && *key_it == key);
+
+		if(!file)
+		{
+			// No library has the file anymore.
+			if(have_row)
+			{
+				removeItemRows(root->getId(), row, 1);
+				m_file_keys.erase(key_it);
+			}
+			continue;
+		}
+
+		std::shared_ptr<AbstractTreeModelItem> file_item;
+		if(have_row)
+		{
+			file_item = root->child(row);
+			auto srtm_file_item = std::dynamic_pointer_cast<ScanResultsTreeModelItem>(file_item);
+			Q_ASSERT(srtm_file_item);
+			if(!srtm_file_item->getDsr().isSameScanAs(file->m_dsr))
+			{
+				srtm_file_item->setDirscanResults(file->m_dsr);
+				Q_EMIT dataChanged(getIndexFromItem(file_item, 0), getIndexFromItem(file_item, std::max(0, columnCount() - 1)));
+			}
+
+			// Leave the track rows alone if they still show the same thing.  Entries which were replaced by ones with
+			// the same content are just swapped in, there's nothing to repaint.
+			std::vector<std::shared_ptr<SRTMItem_LibEntry>> track_items;
+			bool same_entries = (file_item->childCount() == static_cast<int>(file->m_entries.size()));
+			for(int i = 0; same_entries && i < file_item->childCount(); ++i)
+			{
+				auto track_item = std::dynamic_pointer_cast<SRTMItem_LibEntry>(file_item->child(i));
+				const auto old_entry = track_item ? track_item->getLibraryEntry() : nullptr;
+				same_entries = old_entry && (old_entry == file->m_entries[i] || old_entry->hasSameContentAs(*file->m_entries[i]));
+				track_items.push_back(std::move(track_item));
+			}
+			if(same_entries)
+			{
+				for(size_t i = 0; i < track_items.size(); ++i)
+				{
+					track_items[i]->setLibraryEntry(file->m_entries[i]);
+				}
+				continue;
+			}
+			if(file_item->childCount() > 0)
+			{
+				removeItemRows(file_item->getId(), 0, file_item->childCount());
+			}
+		}
+		else
+		{
+			auto srtm_file_item = ScanResultsTreeModelItem::create_shared(self);
+			srtm_file_item->setDirscanResults(file->m_dsr);
+			file_item = srtm_file_item;
+			const std::shared_ptr<AbstractTreeModelItem> new_rows[] {file_item};
+			insertItemRows(root->getId(), row, new_rows);
+			m_file_keys.insert(key_it, key);
+		}
+
+		std::vector<std::shared_ptr<AbstractTreeModelItem>> track_items;
+		track_items.reserve(file->m_entries.size());
+		for(const auto& entry : file->m_entries)
+		{
+			auto track_item = SRTMItem_LibEntry::create_shared(self);
+			track_item->setLibraryEntry(entry);
+			track_items.push_back(track_item);
+		}
+		insertItemRows(file_item->getId(), 0, track_items);
+	}
+}
+
 #if 0
 void ScanResultsTreeModel::LoadDatabase(const QString& database_filename)
 {
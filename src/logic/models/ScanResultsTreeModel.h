@@ -25,10 +25,12 @@
 // Std C++
 #include <shared_mutex>
 #include <initializer_list>
+#include <vector>
 
 // Qt
 #include <QUrl>
 #include <QString>
+#include <QStringList>
 
 // Ours
 #include <utils/QtHelpers.h>
@@ -38,6 +40,7 @@
 #include "ThreadsafeTreeModel.h"
 
 class AbstractTreeModelHeaderItem;
+class CollectionStore;
 #include <future/enable_shared_from_this_virtual.h>
 #include "UndoRedoHelper.h"
 
@@ -91,6 +94,13 @@ public:
      */
     void setBaseDirectory(const QUrl& base_directory) override;
 
+	/**
+	 * Bring the rows for the files with keys @a file_keys up to date with @a store, as reported by
+	 * CollectionStore::SIGNAL_changed().  There's one ScanResultsTreeModelItem per file, in file key order, with an
+	 * SRTMItem_LibEntry child per track.  Only the rows of those files are inserted, changed or removed.  GUI thread only.
+	 */
+	void applyCollectionStoreChanges(const CollectionStore& store, const QStringList& file_keys);
+
 	/// @name Serialization
 	/// @{
 
@@ -145,6 +155,9 @@ protected:
 
 private:
 
+	/// The CollectionStore file keys of the top-level rows, in row order.
+	std::vector<QString> m_file_keys;
+
 	/// KDEN KeyFrameModel
 	QPersistentModelIndex m_pmindex;
 };
@@ -56,6 +56,13 @@ ScanResultsTreeModelItem::ScanResultsTreeModelItem(const QVariant& variant, cons
 //	M_WARNING("TODO: DECODE VARIANT");
 }
 
+// static
+std::shared_ptr<ScanResultsTreeModelItem> ScanResultsTreeModelItem::create_shared(const std::shared_ptr<AbstractTreeModel>& model)
+{
+	return TreeNodeArena::make_node<ScanResultsTreeModelItem>(model ? model->getNodeArena() : nullptr,
+			[&](void* mem){ return new (mem) ScanResultsTreeModelItem(model); });
+}
+
 ScanResultsTreeModelItem::~ScanResultsTreeModelItem()
 {
 }
@@ -66,6 +66,8 @@ public:
     {
         return std::unique_ptr<ScanResultsTreeModelItem>(new ScanResultsTreeModelItem(dsr, parent));
     }
+    /// Create a new item in @a model's node arena, or on the heap if @a model is null.
+    static std::shared_ptr<ScanResultsTreeModelItem> create_shared(const std::shared_ptr<AbstractTreeModel>& model);
 
 
 //	ScanResultsTreeModelItem() {};
@@ -68,62 +68,64 @@ void ThreadsafeTreeModel::clear(bool quit)
 
 	m_closing = true;
 
-	std::vector<std::shared_ptr<AbstractTreeModelItem>> items_to_delete;
+	// This used to requestDeleteItem() each top-level item, which for a big tree meant a row removal notification,
+	// an undo/redo lambda and a map erase per item, none of which we want when everything is going.
+	// Tear the whole tree down in bulk instead, under a single model reset.
+	beginResetModel();
+	// Nothing in the undo history refers to anything which will still exist.
+	m_command_log.clear();
+	bulk_remove_all_items();
+	Q_ASSERT(m_root_item->childCount() == 0);
 
-	items_to_delete.reserve(m_root_item->childCount());
+	// One last thing, our hidden root node / header node still has ColumnSpecs.
+// #warning "@todo If we do this, the view doesn't have any header columns, so you see nothing."
+	m_root_item->clear();
+	endResetModel();
 
-	for (int i = 0; i < m_root_item->childCount(); ++i)
-	{
-		items_to_delete.push_back(std::static_pointer_cast<AbstractTreeModelItem>(m_root_item->child(i)));
-	}
-	Fun undo = []() { return true; };
-	Fun redo = []() { return true; };
-	for (const auto &child : items_to_delete)
-	{
-		qDb() << "Clearing" << items_to_delete.size() << "items, current:" << child->m_uuid;
-		requestDeleteItem(child, undo, redo);
-	}
-	items_to_delete.clear();
-	Q_ASSERT(m_root_item->childCount() == 0);
 	m_closing = false;
 	if (!quit)
 	{
 		// KDen: m_uuid = QUuid::createUuid();
 	}
-
-	// One last thing, our hidden root node / header node still has ColumnSpecs.
-// #warning "@todo If we do this, the view doesn't have any header columns, so you see nothing."
-	m_root_item->clear();
 }
 
-bool ThreadsafeTreeModel::requestDeleteItem(const std::shared_ptr<AbstractTreeModelItem>& item, Fun& undo, Fun& redo)
+bool ThreadsafeTreeModel::requestDeleteItem(const std::shared_ptr<AbstractTreeModelItem>& item)
 {
-	// This is adapted from KDenLive's ProjectItemModel::requestBinClipDeletion().
+	// This was adapted from KDenLive's ProjectItemModel::requestBinClipDeletion().  Undo/redo is now handled
+	// by the command log instead of by the caller's accumulated lambdas.
 	QWriteLocker locker(&m_rw_mutex);
 	Q_ASSERT(item);
 	if (!item)
 	{
 		return false;
 	}
-	UUIncD parentId = UUIncD::null();
 
-	if (auto ptr = item->parent())
-	{
-		parentId = ptr->getId();
-	}
-	if (!item->selfSoftDelete(undo, redo))
+	auto parent = item->parent();
+	if (!parent)
 	{
+		qCr() << "Item has no parent:" << M_ID_VAL(item->getId());
 		return false;
 	}
-	UUIncD id = item->getId();
-	Fun operation = removeItem_lambda(id);
-	Fun reverse = addItem_lambda(item, parentId);
-	bool res = operation();
-	if (res)
-	{
-		UPDATE_UNDO_REDO(m_rw_mutex, operation, reverse, undo, redo);
-	}
-	return res;
+
+	return removeItemRows(parent->getId(), item->childNumber(), 1);
+}
+
+bool ThreadsafeTreeModel::requestMoveItem(UUIncD id, int dest_row)
+{
+	QWriteLocker locker(&m_rw_mutex);
+	return moveItemRow(id, dest_row);
+}
+
+bool ThreadsafeTreeModel::undo()
+{
+	QWriteLocker locker(&m_rw_mutex);
+	return BASE_CLASS::undo();
+}
+
+bool ThreadsafeTreeModel::redo()
+{
+	QWriteLocker locker(&m_rw_mutex);
+	return BASE_CLASS::redo();
 }
 
 QVariant ThreadsafeTreeModel::data(const QModelIndex& index, int role) const
@@ -193,11 +195,11 @@ std::shared_ptr<AbstractTreeModelItem> ThreadsafeTreeModel::getItem(const QModel
 	return BASE_CLASS::getItem(index);
 }
 
-bool ThreadsafeTreeModel::requestAddItem(std::shared_ptr<AbstractTreeModelItem> new_item, UUIncD parent_id, Fun undo, Fun redo)
+bool ThreadsafeTreeModel::requestAddItem(std::shared_ptr<AbstractTreeModelItem> new_item, UUIncD parent_id)
 {
     QWriteLocker locker(&m_rw_mutex);
 
-    bool status = addItem(new_item, parent_id, undo, redo);
+    bool status = addItem(new_item, parent_id);
 
     return status;
 }
@@ -220,7 +222,7 @@ void ThreadsafeTreeModel::deregister_item(UUIncD id, AbstractTreeModelItem* item
 
 }
 
-bool ThreadsafeTreeModel::addItem(const std::shared_ptr<AbstractTreeModelItem>& item, UUIncD parent_id, Fun& undo, Fun& redo)
+bool ThreadsafeTreeModel::addItem(const std::shared_ptr<AbstractTreeModelItem>& item, UUIncD parent_id)
 {
     QWriteLocker locker(&m_rw_mutex);
 
@@ -232,15 +234,8 @@ bool ThreadsafeTreeModel::addItem(const std::shared_ptr<AbstractTreeModelItem>&
 		return false;
 	}
 
-	Fun operation = addItem_lambda(item, parent_item->getId());
-
-	UUIncD itemId = item->getId();
-	Fun reverse = removeItem_lambda(itemId);
-	bool res = operation();
+	// Append.
+	bool res = insertItemRows(parent_id, parent_item->childCount(), {&item, 1});
 	Q_ASSERT(item->isInModel());
-	if (res)
-	{
-        UPDATE_UNDO_REDO(m_rw_mutex, operation, reverse, undo, redo);
-	}
 	return res;
 }
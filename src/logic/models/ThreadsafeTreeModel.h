@@ -82,14 +82,24 @@ public:
 
     /**
      * Add a new AbstractTreeModelItem to the tree.
+     * Undoable if the caller has a step open in commandLog().
      */
-	bool requestAddItem(std::shared_ptr<AbstractTreeModelItem> new_item, UUIncD parent_id,
-						Fun undo = noop_undo_redo_lambda, Fun redo = noop_undo_redo_lambda);
+	bool requestAddItem(std::shared_ptr<AbstractTreeModelItem> new_item, UUIncD parent_id);
 
 	/**
-	 * Request the removal and deletion of @a item from the model.
+	 * Request the removal of @a item from the model.
+	 * Undoable if the caller has a step open in commandLog(), otherwise the item is deleted once the last
+	 * reference to it goes away.
 	 */
-	bool requestDeleteItem(const std::shared_ptr<AbstractTreeModelItem>& item, Fun &undo, Fun &redo);
+	bool requestDeleteItem(const std::shared_ptr<AbstractTreeModelItem>& item);
+
+	/**
+	 * Move item @a id to row @a dest_row under its current parent.  Always a single undo step.
+	 */
+	bool requestMoveItem(UUIncD id, int dest_row);
+
+	bool undo() override;
+	bool redo() override;
 
 	/// @}
 
@@ -120,7 +130,7 @@ protected:
 	 * This is the workhorse threadsafe function which adds all new items to the model.  It should be not be called by clients,
 	 * but rather called by one of the requestAddXxxx() members.
 	 */
-	bool addItem(const std::shared_ptr<AbstractTreeModelItem> &item, UUIncD parent_id, Fun &undo, Fun &redo);
+	bool addItem(const std::shared_ptr<AbstractTreeModelItem> &item, UUIncD parent_id);
 
 
 	/**
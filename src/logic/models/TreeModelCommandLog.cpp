@@ -0,0 +1,205 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file TreeModelCommandLog.cpp
+ * Implementation of TreeModelCommandLog.
+ */
+
+#include "TreeModelCommandLog.h"
+
+// Ours
+#include <utils/DebugHelpers.h>
+#include "AbstractTreeModel.h"
+#include "AbstractTreeModelItem.h"
+
+
+void TreeModelCommandLog::beginStep(const QString& text)
+{
+	if(m_step_depth++ > 0)
+	{
+		// Nested, everything goes into the outermost step.
+		return;
+	}
+
+	discard_undone_steps();
+	m_steps.push_back({m_commands.size(), 0, text});
+}
+
+void TreeModelCommandLog::endStep()
+{
+	Q_ASSERT(m_step_depth > 0);
+	if(--m_step_depth > 0)
+	{
+		return;
+	}
+
+	Step& step = m_steps.back();
+	step.m_num_commands = m_commands.size() - step.m_first_command;
+	if(step.m_num_commands == 0)
+	{
+		// Nothing happened, don't leave a no-op step on the stack.
+		m_steps.pop_back();
+		return;
+	}
+	m_num_done_steps = m_steps.size();
+}
+
+void TreeModelCommandLog::recordInsertRows(UUIncD parent_id, int first_row, std::span<const ItemPtr> items)
+{
+	record(OpType::InsertRows, parent_id, first_row, items);
+}
+
+void TreeModelCommandLog::recordRemoveRows(UUIncD parent_id, int first_row, std::span<const ItemPtr> items)
+{
+	record(OpType::RemoveRows, parent_id, first_row, items);
+}
+
+QString TreeModelCommandLog::undoText() const
+{
+	return canUndo() ? m_steps[m_num_done_steps - 1].m_text : QString();
+}
+
+QString TreeModelCommandLog::redoText() const
+{
+	return canRedo() ? m_steps[m_num_done_steps].m_text : QString();
+}
+
+bool TreeModelCommandLog::undo(AbstractTreeModel& model)
+{
+	if(!canUndo())
+	{
+		return false;
+	}
+
+	const Step& step = m_steps[m_num_done_steps - 1];
+
+	// Commands are undone last-to-first, each one in reverse.
+	for(std::size_t i = step.m_num_commands; i > 0; --i)
+	{
+		if(!apply(model, m_commands[step.m_first_command + i - 1], true))
+		{
+			qCr() << "Undo failed, discarding undo/redo history.";
+			clear();
+			return false;
+		}
+	}
+
+	--m_num_done_steps;
+	return true;
+}
+
+bool TreeModelCommandLog::redo(AbstractTreeModel& model)
+{
+	if(!canRedo())
+	{
+		return false;
+	}
+
+	const Step& step = m_steps[m_num_done_steps];
+
+	for(std::size_t i = 0; i < step.m_num_commands; ++i)
+	{
+		if(!apply(model, m_commands[step.m_first_command + i], false))
+		{
+			qCr() << "Redo failed, discarding undo/redo history.";
+			clear();
+			return false;
+		}
+	}
+
+	++m_num_done_steps;
+	return true;
+}
+
+void TreeModelCommandLog::clear()
+{
+	Q_ASSERT(m_step_depth == 0);
+	m_items.clear();
+	m_commands.clear();
+	m_steps.clear();
+	m_num_done_steps = 0;
+}
+
+void TreeModelCommandLog::record(OpType op, UUIncD parent_id, int first_row, std::span<const ItemPtr> items)
+{
+	if(!isRecording() || items.empty())
+	{
+		return;
+	}
+
+	// Appending to the previous command if it's the same op on the adjacent range keeps e.g. a loop of
+	// single-row appends down to one command.
+	if(m_commands.size() > m_steps.back().m_first_command)
+	{
+		Command& last = m_commands.back();
+		const int last_end_row = last.m_first_row + static_cast<int>(last.m_num_items);
+		if(last.m_op == op && last.m_parent_id == parent_id
+			&& last.m_first_item + last.m_num_items == m_items.size())
+		{
+			if(op == OpType::InsertRows && first_row == last_end_row)
+			{
+				m_items.insert(m_items.end(), items.begin(), items.end());
+				last.m_num_items += items.size();
+				return;
+			}
+			if(op == OpType::RemoveRows && first_row == last.m_first_row)
+			{
+				// Removing the rows which slid up into the previously removed range.
+				m_items.insert(m_items.end(), items.begin(), items.end());
+				last.m_num_items += items.size();
+				return;
+			}
+		}
+	}
+
+	m_commands.push_back({op, parent_id, first_row, m_items.size(), items.size()});
+	m_items.insert(m_items.end(), items.begin(), items.end());
+}
+
+void TreeModelCommandLog::discard_undone_steps()
+{
+	if(m_num_done_steps == m_steps.size())
+	{
+		return;
+	}
+
+	const Step& first_undone = m_steps[m_num_done_steps];
+	const std::size_t first_command = first_undone.m_first_command;
+	const std::size_t first_item = (first_command < m_commands.size()) ? m_commands[first_command].m_first_item : m_items.size();
+
+	m_items.erase(m_items.begin() + first_item, m_items.end());
+	m_commands.erase(m_commands.begin() + first_command, m_commands.end());
+	m_steps.erase(m_steps.begin() + m_num_done_steps, m_steps.end());
+}
+
+bool TreeModelCommandLog::apply(AbstractTreeModel& model, const Command& cmd, bool reverse) const
+{
+	const bool insert = (cmd.m_op == OpType::InsertRows) != reverse;
+
+	if(insert)
+	{
+		std::span<const ItemPtr> items(m_items.data() + cmd.m_first_item, cmd.m_num_items);
+		return model.insertItemRows(cmd.m_parent_id, cmd.m_first_row, items);
+	}
+	else
+	{
+		return model.removeItemRows(cmd.m_parent_id, cmd.m_first_row, static_cast<int>(cmd.m_num_items));
+	}
+}
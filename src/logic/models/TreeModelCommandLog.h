@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_LOGIC_MODELS_TREEMODELCOMMANDLOG_H_
+#define SRC_LOGIC_MODELS_TREEMODELCOMMANDLOG_H_
+
+/**
+ * @file TreeModelCommandLog.h
+ * Interface of TreeModelCommandLog, the undo/redo log for AbstractTreeModel structure changes.
+ */
+
+// Std C++
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Qt
+#include <QString>
+
+// Ours
+#include <future/guideline_helpers.h>
+#include <logic/UUIncD.h>
+class AbstractTreeModel;
+class AbstractTreeModelItem;
+
+
+/**
+ * Undo/redo log of row insertions and removals in an AbstractTreeModel.
+ *
+ * This replaces building up chains of nested std::function<>s (see UndoRedoHelper.h) for each item touched.
+ * Each operation is recorded as one small Command holding a parent ID and a row range, and the items in that
+ * range are stored in a single flat vector shared by all commands.  Undo and redo walk the commands iteratively,
+ * and apply each one as a single bulk row operation on the model, so undoing the removal of 100k rows costs about
+ * what the removal did.
+ *
+ * Commands are only recorded while a step is open, see beginStep()/endStep() and ScopedStep.  Everything recorded
+ * between the outermost beginStep() and its endStep() is undone/redone as a single step.
+ *
+ * Not threadsafe by itself, the owning model serializes access with its own lock.
+ */
+class TreeModelCommandLog
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(TreeModelCommandLog)
+
+	using ItemPtr = std::shared_ptr<AbstractTreeModelItem>;
+
+	TreeModelCommandLog() = default;
+	~TreeModelCommandLog() = default;
+
+	/**
+	 * RAII helper for beginStep()/endStep().
+	 */
+	class ScopedStep
+	{
+	public:
+		M_GH_DELETE_COPY_AND_MOVE(ScopedStep)
+		ScopedStep(TreeModelCommandLog& log, const QString& text) : m_log(log) { m_log.beginStep(text); }
+		~ScopedStep() { m_log.endStep(); }
+	private:
+		TreeModelCommandLog& m_log;
+	};
+
+	/// @name Recording
+	/// @{
+
+	/**
+	 * Open a new undo step, or nest inside the currently open one.  Only the outermost call's @a text is kept.
+	 * Any steps which had been undone are discarded.
+	 */
+	void beginStep(const QString& text);
+	/// Close the step opened by the matching beginStep().  An empty step is dropped.
+	void endStep();
+
+	/// True if a step is open, i.e. if the record functions will do anything.
+	bool isRecording() const { return m_step_depth > 0; }
+
+	/// Record that @a items were inserted under @a parent_id at rows [@a first_row, @a first_row + items.size()).
+	void recordInsertRows(UUIncD parent_id, int first_row, std::span<const ItemPtr> items);
+	/// Record that @a items were removed from under @a parent_id, from rows [@a first_row, @a first_row + items.size()).
+	void recordRemoveRows(UUIncD parent_id, int first_row, std::span<const ItemPtr> items);
+
+	/// @}
+
+	/// @name Undo/redo
+	/// @{
+
+	bool canUndo() const { return m_step_depth == 0 && m_num_done_steps > 0; }
+	bool canRedo() const { return m_step_depth == 0 && m_num_done_steps < m_steps.size(); }
+
+	QString undoText() const;
+	QString redoText() const;
+
+	/**
+	 * Undo the last done step on @a model.  The caller must hold the model's write lock.
+	 * @returns false if there was nothing to undo or if applying a command failed.
+	 */
+	bool undo(AbstractTreeModel& model);
+	/**
+	 * Redo the last undone step on @a model.  The caller must hold the model's write lock.
+	 * @returns false if there was nothing to redo or if applying a command failed.
+	 */
+	bool redo(AbstractTreeModel& model);
+
+	/// @}
+
+	/**
+	 * Forget all steps and release the items they were keeping alive.
+	 * The model calls this whenever its structure changes out from under the log, e.g. on clear().
+	 */
+	void clear();
+
+	/// Number of items currently kept alive by the log.
+	std::size_t num_stored_items() const { return m_items.size(); }
+	/// Number of commands in all steps, done and undone.
+	std::size_t num_commands() const { return m_commands.size(); }
+
+private:
+
+	enum class OpType : std::uint8_t
+	{
+		InsertRows,
+		RemoveRows
+	};
+
+	/// One bulk row operation.  The affected items are m_items[m_first_item, m_first_item + m_num_items).
+	struct Command
+	{
+		OpType m_op;
+		UUIncD m_parent_id;
+		int m_first_row;
+		std::size_t m_first_item;
+		std::size_t m_num_items;
+	};
+
+	/// One undo step.  Its commands are m_commands[m_first_command, m_first_command + m_num_commands).
+	struct Step
+	{
+		std::size_t m_first_command;
+		std::size_t m_num_commands;
+		QString m_text;
+	};
+
+	void record(OpType op, UUIncD parent_id, int first_row, std::span<const ItemPtr> items);
+
+	/// Drop every step from m_num_done_steps on, along with their commands and items.
+	void discard_undone_steps();
+
+	/// Apply @a cmd forwards (@a reverse == false) or backwards.
+	bool apply(AbstractTreeModel& model, const Command& cmd, bool reverse) const;
+
+	std::vector<ItemPtr> m_items;
+	std::vector<Command> m_commands;
+	std::vector<Step> m_steps;
+
+	/// Steps [0, m_num_done_steps) are done, the rest have been undone and can be redone.
+	std::size_t m_num_done_steps {0};
+
+	/// beginStep() nesting depth.
+	int m_step_depth {0};
+};
+
+#endif /* SRC_LOGIC_MODELS_TREEMODELCOMMANDLOG_H_ */
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file TreeNodeArena.cpp
+ * Implementation of TreeNodeArena.
+ */
+
+#include "TreeNodeArena.h"
+
+// Ours
+#include <utils/DebugHelpers.h>
+
+
+// static
+std::shared_ptr<TreeNodeArena> TreeNodeArena::create()
+{
+	return std::shared_ptr<TreeNodeArena>(new TreeNodeArena());
+}
+
+TreeNodeArena::~TreeNodeArena()
+{
+	// Every node holds a ref to us, so there can't be any left.
+	Q_ASSERT(m_num_live_nodes.load() == 0);
+	// m_pool's destructor releases all chunks in one go.
+}
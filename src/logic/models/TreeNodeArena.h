@@ -0,0 +1,173 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_LOGIC_MODELS_TREENODEARENA_H_
+#define SRC_LOGIC_MODELS_TREENODEARENA_H_
+
+/**
+ * @file TreeNodeArena.h
+ * Interface of TreeNodeArena, per-model slab storage for tree model items.
+ */
+
+// Std C++
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+// Ours
+#include <future/guideline_helpers.h>
+
+
+/**
+ * Per-model pool allocator for AbstractTreeModelItems and their shared_ptr control blocks.
+ *
+ * Items are carved out of large chunks instead of each being its own pair of heap allocations, and freeing one
+ * is just a push onto a free list.  The chunks themselves are only returned to the system when the arena is
+ * destroyed, which happens when the last item allocated from it (or the model, whichever goes last) goes away,
+ * so items can safely outlive their model, e.g. in an undo lambda.
+ *
+ * Threadsafe, items are routinely created and released on non-GUI threads.
+ */
+class TreeNodeArena
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(TreeNodeArena)
+
+	static std::shared_ptr<TreeNodeArena> create();
+
+	~TreeNodeArena();
+
+	/**
+	 * Construct a new node of type T in @a arena, or on the heap if @a arena is null.
+	 * @a placement_new is called with suitably sized and aligned raw memory and must placement-new a T into it
+	 * and return the T*.  It's done this way so that create() functions can use their own class's non-public
+	 * constructors.
+	 */
+	template <class T, class PlacementNewFuncType>
+	static std::shared_ptr<T> make_node(const std::shared_ptr<TreeNodeArena>& arena, PlacementNewFuncType&& placement_new);
+
+	/// @name Stats
+	/// @{
+	/// Number of nodes currently allocated from this arena.
+	long num_live_nodes() const { return m_num_live_nodes.load(std::memory_order_relaxed); }
+	/// @}
+
+private:
+	TreeNodeArena() = default;
+
+	template <class T>
+	class Allocator;
+	template <class T>
+	struct Deleter;
+
+	std::pmr::memory_resource* resource() { return &m_pool; }
+
+	std::pmr::synchronized_pool_resource m_pool;
+
+	std::atomic<long> m_num_live_nodes {0};
+};
+
+/**
+ * Allocator for the shared_ptr control blocks.  Keeps the arena alive for as long as any control block allocated
+ * from it is alive.
+ */
+template <class T>
+class TreeNodeArena::Allocator
+{
+public:
+	using value_type = T;
+
+	explicit Allocator(std::shared_ptr<TreeNodeArena> arena) noexcept : m_arena(std::move(arena)) {}
+	template <class U>
+	Allocator(const Allocator<U>& other) noexcept : m_arena(other.m_arena) {}
+
+	T* allocate(std::size_t n)
+	{
+		return static_cast<T*>(m_arena->resource()->allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T* p, std::size_t n) noexcept
+	{
+		m_arena->resource()->deallocate(p, n * sizeof(T), alignof(T));
+	}
+
+	template <class U>
+	bool operator==(const Allocator<U>& other) const noexcept { return m_arena == other.m_arena; }
+
+	std::shared_ptr<TreeNodeArena> m_arena;
+};
+
+/**
+ * Deleter for the nodes themselves.  Doesn't need its own ref to the arena, the control block's Allocator holds
+ * one until after the deleter has run.
+ */
+template <class T>
+struct TreeNodeArena::Deleter
+{
+	TreeNodeArena* m_arena;
+
+	void operator()(T* p) const noexcept
+	{
+		p->~T();
+		m_arena->resource()->deallocate(p, sizeof(T), alignof(T));
+		m_arena->m_num_live_nodes.fetch_sub(1, std::memory_order_relaxed);
+	}
+};
+
+template <class T, class PlacementNewFuncType>
+std::shared_ptr<T> TreeNodeArena::make_node(const std::shared_ptr<TreeNodeArena>& arena, PlacementNewFuncType&& placement_new)
+{
+	if(!arena)
+	{
+		// No arena, plain heap allocation.
+		void* mem = ::operator new(sizeof(T));
+		T* node;
+		try
+		{
+			node = std::forward<PlacementNewFuncType>(placement_new)(mem);
+		}
+		catch(...)
+		{
+			::operator delete(mem);
+			throw;
+		}
+		// If this throws, it deletes the node itself.
+		return std::shared_ptr<T>(node);
+	}
+
+	void* mem = arena->resource()->allocate(sizeof(T), alignof(T));
+	T* node;
+	try
+	{
+		node = std::forward<PlacementNewFuncType>(placement_new)(mem);
+	}
+	catch(...)
+	{
+		arena->resource()->deallocate(mem, sizeof(T), alignof(T));
+		throw;
+	}
+	arena->m_num_live_nodes.fetch_add(1, std::memory_order_relaxed);
+
+	// As above, if this throws it calls the Deleter.
+	return std::shared_ptr<T>(node, Deleter<T>{arena.get()}, Allocator<T>(arena));
+}
+
+#endif /* SRC_LOGIC_MODELS_TREENODEARENA_H_ */
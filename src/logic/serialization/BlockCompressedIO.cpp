@@ -0,0 +1,404 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file BlockCompressedIO.cpp
+ * Implementation of BlockCompressedWriter and BlockCompressedReader.
+ */
+
+#include "BlockCompressedIO.h"
+
+// Std C++
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+// Qt
+#include <QtConcurrent>
+#include <QtEndian>
+
+// Ours
+#include <utils/DebugHelpers.h>
+
+
+namespace
+{
+	struct BlockHeader
+	{
+		quint32 m_uncompressed_size;
+		quint32 m_compressed_size;
+	};
+
+	BlockHeader read_block_header(const char* bytes)
+	{
+		return {qFromBigEndian<quint32>(bytes), qFromBigEndian<quint32>(bytes + 4)};
+	}
+
+	/// zlib can't do better than about 1032:1, so a block claiming more than this is corrupt.
+	constexpr qsizetype c_max_zlib_ratio = 1032;
+	/// qCompress() output is the uncompressed size as a big-endian quint32, then the zlib stream.
+	constexpr qsizetype c_qcompress_prefix_size = 4;
+
+	/**
+	 * Check a (non-end-marker) block header against what BlockCompressedWriter could have written, so that a corrupt
+	 * one can't get us to allocate gigabytes.
+	 */
+	bool is_sane(const BlockHeader& header)
+	{
+		const qsizetype uncompressed_size = header.m_uncompressed_size;
+		const qsizetype compressed_size = header.m_compressed_size;
+		// Worst-case deflate expansion is a few bytes per 16K, this is well above that.
+		constexpr qsizetype max_compressed_size = BlockCompressedFormat::c_max_block_size
+				+ BlockCompressedFormat::c_max_block_size / 256 + 64;
+
+		return uncompressed_size > 0
+				&& uncompressed_size <= BlockCompressedFormat::c_max_block_size
+				&& compressed_size > c_qcompress_prefix_size
+				&& compressed_size <= max_compressed_size
+				&& uncompressed_size <= (compressed_size - c_qcompress_prefix_size) * c_max_zlib_ratio;
+	}
+
+	/// True if the size prefix of the qCompress() output @a compressed agrees with @a header.
+	bool prefix_matches(const BlockHeader& header, const char* compressed)
+	{
+		return qFromBigEndian<quint32>(compressed) == header.m_uncompressed_size;
+	}
+}
+
+bool BlockCompressedFormat::detect(QByteArrayView data)
+{
+	return data.startsWith(c_magic);
+}
+
+bool BlockCompressedFormat::detect(QIODevice* device)
+{
+	return detect(device->peek(c_magic.size()));
+}
+
+bool BlockCompressedFormat::index_blocks(QByteArrayView data, std::vector<Block>* blocks)
+{
+	blocks->clear();
+	if(!detect(data))
+	{
+		return false;
+	}
+
+	qsizetype pos = c_magic.size();
+	qsizetype total_size = 0;
+	while(true)
+	{
+		if(pos + c_block_header_size > data.size())
+		{
+			qWr() << "Block-compressed data is truncated at offset" << pos;
+			return false;
+		}
+		const BlockHeader header = read_block_header(data.data() + pos);
+		pos += c_block_header_size;
+		if(header.m_compressed_size == 0 && header.m_uncompressed_size == 0)
+		{
+			break;
+		}
+		if(!is_sane(header))
+		{
+			qWr() << "Block-compressed data has a corrupt block header at offset" << pos - c_block_header_size;
+			return false;
+		}
+		if(pos + qsizetype(header.m_compressed_size) > data.size())
+		{
+			qWr() << "Block-compressed data is truncated at offset" << pos;
+			return false;
+		}
+		if(!prefix_matches(header, data.data() + pos))
+		{
+			qWr() << "Block-compressed data has a corrupt block at offset" << pos;
+			return false;
+		}
+		blocks->push_back({pos, header.m_compressed_size, total_size, header.m_uncompressed_size});
+		pos += header.m_compressed_size;
+		total_size += header.m_uncompressed_size;
+	}
+
+	// Every block is capped and there's at least a header's worth of input per block, but check the total against
+	// the block count anyway before anybody allocates it.
+	if(total_size > qsizetype(blocks->size()) * c_max_block_size)
+	{
+		qWr() << "Block-compressed data is corrupt, uncompressed size" << total_size << "for" << blocks->size() << "blocks";
+		blocks->clear();
+		return false;
+	}
+	return true;
+}
+
+bool BlockCompressedFormat::decompress_block(QByteArrayView data, const Block& block, QByteArray* out)
+{
+	const QByteArray uncompressed = qUncompress(reinterpret_cast<const uchar*>(data.data() + block.m_compressed_pos),
+												block.m_compressed_size);
+	if(uncompressed.size() != block.m_uncompressed_size)
+	{
+		return false;
+	}
+	out->append(uncompressed);
+	return true;
+}
+
+bool BlockCompressedFormat::decompress_all(QByteArrayView data, QByteArray* out)
+{
+	// Find and check all the blocks first, it's just a walk over the headers.
+	std::vector<Block> blocks;
+	if(!index_blocks(data, &blocks))
+	{
+		return false;
+	}
+	const qsizetype total_size = blocks.empty() ? 0 : blocks.back().m_uncompressed_pos + blocks.back().m_uncompressed_size;
+
+	// Then decompress them all at once, each straight into its place in the output.
+	*out = QByteArray(total_size, Qt::Uninitialized);
+	char* out_data = out->data();
+	std::atomic<bool> failed {false};
+	QtConcurrent::blockingMap(blocks, [&](const Block& block){
+		const QByteArray uncompressed = qUncompress(reinterpret_cast<const uchar*>(data.data() + block.m_compressed_pos),
+													block.m_compressed_size);
+		if(uncompressed.size() != block.m_uncompressed_size)
+		{
+			failed = true;
+			return;
+		}
+		std::memcpy(out_data + block.m_uncompressed_pos, uncompressed.constData(), uncompressed.size());
+	});
+
+	if(failed)
+	{
+		qWr() << "Block-compressed data is corrupt";
+		out->clear();
+		return false;
+	}
+	return true;
+}
+
+/////
+
+BlockCompressedWriter::BlockCompressedWriter(QIODevice* sink, int compression_level, qsizetype block_size)
+	: m_sink(sink), m_compression_level(compression_level), m_block_size(block_size)
+{
+	Q_CHECK_PTR(m_sink);
+	Q_ASSERT(m_block_size > 0 && m_block_size <= BlockCompressedFormat::c_max_block_size);
+}
+
+BlockCompressedWriter::~BlockCompressedWriter()
+{
+	if(isOpen())
+	{
+		close();
+	}
+}
+
+bool BlockCompressedWriter::open(OpenMode mode)
+{
+	if((mode & ReadWrite) != WriteOnly)
+	{
+		setErrorString(QStringLiteral("BlockCompressedWriter is write-only"));
+		return false;
+	}
+	if(!QIODevice::open(mode))
+	{
+		return false;
+	}
+	m_buffer.reserve(m_block_size);
+	return writeToSink(BlockCompressedFormat::c_magic);
+}
+
+void BlockCompressedWriter::close()
+{
+	if(!isOpen())
+	{
+		return;
+	}
+
+	if(!m_buffer.isEmpty())
+	{
+		writeBlock(m_buffer);
+		m_buffer.clear();
+	}
+
+	// The end marker.
+	const char end_marker[BlockCompressedFormat::c_block_header_size] {};
+	writeToSink(QByteArrayView(end_marker, sizeof(end_marker)));
+
+	QIODevice::close();
+}
+
+qint64 BlockCompressedWriter::readData(char* data, qint64 maxlen)
+{
+	Q_UNUSED(data);
+	Q_UNUSED(maxlen);
+	return -1;
+}
+
+qint64 BlockCompressedWriter::writeData(const char* data, qint64 len)
+{
+	qint64 remaining = len;
+	while(remaining > 0)
+	{
+		const qint64 to_copy = std::min<qint64>(remaining, m_block_size - m_buffer.size());
+		m_buffer.append(data, to_copy);
+		data += to_copy;
+		remaining -= to_copy;
+
+		if(m_buffer.size() == m_block_size)
+		{
+			if(!writeBlock(m_buffer))
+			{
+				return -1;
+			}
+			m_buffer.clear();
+		}
+	}
+	return len;
+}
+
+bool BlockCompressedWriter::writeBlock(QByteArrayView uncompressed)
+{
+	const QByteArray compressed = qCompress(reinterpret_cast<const uchar*>(uncompressed.data()), uncompressed.size(),
+											m_compression_level);
+
+	char header[BlockCompressedFormat::c_block_header_size];
+	qToBigEndian<quint32>(static_cast<quint32>(uncompressed.size()), header);
+	qToBigEndian<quint32>(static_cast<quint32>(compressed.size()), header + 4);
+
+	return writeToSink(QByteArrayView(header, sizeof(header))) && writeToSink(compressed);
+}
+
+bool BlockCompressedWriter::writeToSink(QByteArrayView bytes)
+{
+	if(m_sink->write(bytes.data(), bytes.size()) != bytes.size())
+	{
+		setErrorString(m_sink->errorString());
+		return false;
+	}
+	return true;
+}
+
+/////
+
+BlockCompressedReader::BlockCompressedReader(QIODevice* source) : m_source(source)
+{
+	Q_CHECK_PTR(m_source);
+}
+
+bool BlockCompressedReader::open(OpenMode mode)
+{
+	if((mode & ReadWrite) != ReadOnly)
+	{
+		setErrorString(QStringLiteral("BlockCompressedReader is read-only"));
+		return false;
+	}
+	if(m_source->read(BlockCompressedFormat::c_magic.size()) != BlockCompressedFormat::c_magic)
+	{
+		setErrorString(QStringLiteral("Not block-compressed data"));
+		return false;
+	}
+	m_block.clear();
+	m_block_pos = 0;
+	m_at_end_marker = false;
+	return QIODevice::open(mode);
+}
+
+bool BlockCompressedReader::atEnd() const
+{
+	return m_at_end_marker && m_block_pos >= m_block.size() && QIODevice::atEnd();
+}
+
+qint64 BlockCompressedReader::bytesAvailable() const
+{
+	return (m_block.size() - m_block_pos) + QIODevice::bytesAvailable();
+}
+
+qint64 BlockCompressedReader::readData(char* data, qint64 maxlen)
+{
+	qint64 num_read = 0;
+	while(num_read < maxlen)
+	{
+		if(m_block_pos >= m_block.size() && !readBlock())
+		{
+			break;
+		}
+		const qint64 to_copy = std::min<qint64>(maxlen - num_read, m_block.size() - m_block_pos);
+		std::memcpy(data + num_read, m_block.constData() + m_block_pos, to_copy);
+		m_block_pos += to_copy;
+		num_read += to_copy;
+	}
+
+	if(num_read == 0 && m_at_end_marker)
+	{
+		// End of data.
+		return -1;
+	}
+	return num_read;
+}
+
+qint64 BlockCompressedReader::writeData(const char* data, qint64 len)
+{
+	Q_UNUSED(data);
+	Q_UNUSED(len);
+	return -1;
+}
+
+bool BlockCompressedReader::readBlock()
+{
+	if(m_at_end_marker)
+	{
+		return false;
+	}
+
+	const QByteArray header_bytes = m_source->read(BlockCompressedFormat::c_block_header_size);
+	if(header_bytes.size() != BlockCompressedFormat::c_block_header_size)
+	{
+		setErrorString(QStringLiteral("Block-compressed data is truncated"));
+		m_at_end_marker = true;
+		return false;
+	}
+	const BlockHeader header = read_block_header(header_bytes.constData());
+	if(header.m_compressed_size == 0 && header.m_uncompressed_size == 0)
+	{
+		m_at_end_marker = true;
+		return false;
+	}
+	m_block.clear();
+	m_block_pos = 0;
+	if(!is_sane(header))
+	{
+		setErrorString(QStringLiteral("Block-compressed data has a corrupt block header"));
+		m_at_end_marker = true;
+		return false;
+	}
+
+	const QByteArray compressed = m_source->read(header.m_compressed_size);
+	if(compressed.size() == qsizetype(header.m_compressed_size) && prefix_matches(header, compressed.constData()))
+	{
+		m_block = qUncompress(compressed);
+	}
+	if(compressed.size() != qsizetype(header.m_compressed_size) || m_block.size() != qsizetype(header.m_uncompressed_size))
+	{
+		setErrorString(QStringLiteral("Block-compressed data is corrupt or truncated"));
+		m_block.clear();
+		m_at_end_marker = true;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file BlockCompressedIO.h
+ * Interface of BlockCompressedWriter and BlockCompressedReader, QIODevices for the block-compressed file format.
+ */
+
+#ifndef SRC_LOGIC_SERIALIZATION_BLOCKCOMPRESSEDIO_H_
+#define SRC_LOGIC_SERIALIZATION_BLOCKCOMPRESSEDIO_H_
+
+// Std C++
+#include <vector>
+
+// Qt
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QIODevice>
+
+// Ours
+#include <future/guideline_helpers.h>
+
+
+/**
+ * The block-compressed file format:
+ *   - The 8-byte magic "AMLMZBK1".
+ *   - Blocks, each one: quint32 uncompressed size, quint32 compressed size (both big-endian), then that many bytes
+ *     of qCompress() output.  Every block decompresses on its own.
+ *   - A block header with both sizes 0, which marks the end, so a truncated file can be told from a short one.
+ */
+struct BlockCompressedFormat
+{
+	static constexpr QByteArrayView c_magic {"AMLMZBK1"};
+	static constexpr qsizetype c_block_header_size = 8;
+	/// Uncompressed size of all but the last block.  Big enough for zlib to do well, small enough to spread
+	/// decompression of a large file over all cores.
+	static constexpr qsizetype c_default_block_size = 1024 * 1024;
+	/// Largest uncompressed block size the readers accept.  A header claiming more is corrupt, and is rejected
+	/// before anything gets allocated for it.
+	static constexpr qsizetype c_max_block_size = 64 * c_default_block_size;
+
+	/// True if @a data starts with the magic.
+	static bool detect(QByteArrayView data);
+	/// True if what's next in @a device is block-compressed.  Doesn't consume anything.
+	static bool detect(QIODevice* device);
+
+	/// Where one block is in a block-compressed file, and where it goes in the uncompressed data.
+	struct Block
+	{
+		qsizetype m_compressed_pos;
+		qsizetype m_compressed_size;
+		qsizetype m_uncompressed_pos;
+		qsizetype m_uncompressed_size;
+	};
+
+	/**
+	 * Find and check the headers of all the blocks of @a data, a whole block-compressed file, without decompressing
+	 * anything.  For reading it a block at a time.
+	 * @returns false if @a data is corrupt or truncated.
+	 */
+	static bool index_blocks(QByteArrayView data, std::vector<Block>* blocks);
+
+	/**
+	 * Decompress @a block, which index_blocks() found in @a data, and append it to @a out.
+	 * @returns false if it's corrupt.
+	 */
+	static bool decompress_block(QByteArrayView data, const Block& block, QByteArray* out);
+
+	/**
+	 * Decompress all of @a data, a whole block-compressed file, into @a out, decompressing the blocks in parallel on the
+	 * global thread pool.  The block headers are all checked before @a out is allocated.
+	 * @returns false if @a data is corrupt or truncated.
+	 */
+	static bool decompress_all(QByteArrayView data, QByteArray* out);
+};
+
+/**
+ * Write-only sequential QIODevice which block-compresses everything written to it into another device.
+ * Only one block's worth of data is ever held in memory.
+ */
+class BlockCompressedWriter : public QIODevice
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(BlockCompressedWriter)
+
+	/**
+	 * @param sink  Where the compressed data goes, already open for writing.  Not owned.
+	 * @param compression_level  As for qCompress().
+	 * @param block_size  At most BlockCompressedFormat::c_max_block_size.
+	 */
+	explicit BlockCompressedWriter(QIODevice* sink, int compression_level = -1,
+								   qsizetype block_size = BlockCompressedFormat::c_default_block_size);
+	~BlockCompressedWriter() override;
+
+	/// Only WriteOnly is supported.  Writes the magic.
+	bool open(OpenMode mode) override;
+	/// Writes out the last block and the end marker.  Check errorString() if it's not empty afterwards.
+	void close() override;
+	bool isSequential() const override { return true; }
+
+protected:
+	qint64 readData(char* data, qint64 maxlen) override;
+	qint64 writeData(const char* data, qint64 len) override;
+
+private:
+	bool writeBlock(QByteArrayView uncompressed);
+	bool writeToSink(QByteArrayView bytes);
+
+	QIODevice* m_sink;
+	int m_compression_level;
+	qsizetype m_block_size;
+	QByteArray m_buffer;
+};
+
+/**
+ * Read-only sequential QIODevice which decompresses a block-compressed device one block at a time.
+ * For streaming loads, e.g. straight into a QXmlStreamReader.
+ */
+class BlockCompressedReader : public QIODevice
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(BlockCompressedReader)
+
+	/// @param source  The compressed data, already open for reading.  Not owned.
+	explicit BlockCompressedReader(QIODevice* source);
+	~BlockCompressedReader() override = default;
+
+	/// Only ReadOnly is supported.  Fails if @a source isn't block-compressed.
+	bool open(OpenMode mode) override;
+	bool isSequential() const override { return true; }
+	bool atEnd() const override;
+	qint64 bytesAvailable() const override;
+
+protected:
+	qint64 readData(char* data, qint64 maxlen) override;
+	qint64 writeData(const char* data, qint64 len) override;
+
+private:
+	/// Read and decompress the next block into m_block.  Returns false at the end marker or on an error.
+	bool readBlock();
+
+	QIODevice* m_source;
+	QByteArray m_block;
+	qsizetype m_block_pos {0};
+	bool m_at_end_marker {false};
+};
+
+#endif /* SRC_LOGIC_SERIALIZATION_BLOCKCOMPRESSEDIO_H_ */
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file FieldReflection.h
+ * Compile-time field descriptors generated from the M_DATASTREAM_FIELDS X-macros.
+ */
+
+#ifndef SRC_LOGIC_SERIALIZATION_FIELDREFLECTION_H_
+#define SRC_LOGIC_SERIALIZATION_FIELDREFLECTION_H_
+
+// Std C++
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Qt
+#include <QLatin1StringView>
+#include <QStringView>
+
+
+/**
+ * Describes one serialized member of @a ClassType: the tag it's written under and a pointer to it.
+ */
+template <class ClassType, class MemberType>
+struct FieldDescriptor
+{
+	using class_type = ClassType;
+	using member_type = MemberType;
+
+	std::string_view m_name;
+	MemberType ClassType::* m_member;
+};
+
+template <class ClassType, class MemberType>
+constexpr FieldDescriptor<ClassType, MemberType> make_field_descriptor(std::string_view name, MemberType ClassType::* member)
+{
+	return {name, member};
+}
+
+/**
+ * Specialized for each reflected class with M_DEFINE_FIELD_REFLECTION(), which gives it a
+ * `static constexpr std::tuple<FieldDescriptor...> fields`.
+ */
+template <class ClassType>
+struct FieldReflection;
+
+template <class T>
+concept ReflectedType = requires { FieldReflection<std::remove_cv_t<T>>::fields; };
+
+/// Put this in a class whose reflected fields aren't public.
+#define M_FIELD_REFLECTION_FRIEND template <class> friend struct FieldReflection;
+
+/// The X() for turning one M_DATASTREAM_FIELDS() entry into a FieldDescriptor.  The tag is the stringized member
+/// name, same as the "Strings to use for the tags" in the .cpp's.
+#define M_FIELD_REFLECTION_DESCRIPTOR(field_tag, member_field) , make_field_descriptor(# member_field, &reflected_type::member_field)
+
+/**
+ * Define the FieldReflection<> of @a class_name from its M_DATASTREAM_FIELDS()-style X-macro @a fields_xmacro.
+ * Use at namespace scope in the .cpp, after the X-macro is defined.
+ */
+#define M_DEFINE_FIELD_REFLECTION(class_name, fields_xmacro) \
+	template <> \
+	struct FieldReflection<class_name> \
+	{ \
+		using reflected_type = class_name; \
+		static constexpr auto fields = field_reflection_detail::make_field_tuple( \
+			field_reflection_detail::field_tuple_begin{} fields_xmacro(M_FIELD_REFLECTION_DESCRIPTOR)); \
+	};
+
+namespace field_reflection_detail
+{
+	/// Soaks up the leading comma M_FIELD_REFLECTION_DESCRIPTOR leaves.
+	struct field_tuple_begin {};
+
+	template <class... Descriptors>
+	constexpr auto make_field_tuple(field_tuple_begin, Descriptors... descriptors)
+	{
+		return std::tuple<Descriptors...>(descriptors...);
+	}
+
+	/// FNV-1a.  Field names are ASCII, so hashing UTF-16 code units gives the same result as hashing the chars.
+	constexpr std::uint32_t hash_step(std::uint32_t hash, char16_t c)
+	{
+		return (hash ^ static_cast<std::uint32_t>(c)) * 16777619u;
+	}
+}
+
+constexpr std::uint32_t field_name_hash(std::string_view name)
+{
+	std::uint32_t hash = 2166136261u;
+	for(char c : name)
+	{
+		hash = field_reflection_detail::hash_step(hash, static_cast<char16_t>(static_cast<unsigned char>(c)));
+	}
+	return hash;
+}
+
+inline std::uint32_t field_name_hash(QStringView name)
+{
+	std::uint32_t hash = 2166136261u;
+	for(QChar c : name)
+	{
+		hash = field_reflection_detail::hash_step(hash, c.unicode());
+	}
+	return hash;
+}
+
+/**
+ * Compile-time perfect hash from a reflected class's field names to their indexes in its fields tuple.
+ * The constructor searches for the smallest modulus under which none of the names' hashes collide, so a lookup is
+ * one hash, one table read and one string compare to reject names which aren't fields.
+ */
+template <std::size_t N>
+class FieldNameIndex
+{
+	static_assert(N > 0 && N < 0xFF, "Unreasonable number of fields");
+
+	static constexpr std::size_t max_modulus = 16 * N + 16;
+	static constexpr std::uint8_t empty_slot = 0xFF;
+
+public:
+	constexpr explicit FieldNameIndex(const std::array<std::string_view, N>& names) : m_names(names)
+	{
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			m_hashes[i] = field_name_hash(names[i]);
+		}
+
+		for(std::size_t modulus = N; modulus <= max_modulus; ++modulus)
+		{
+			if(try_modulus(modulus))
+			{
+				return;
+			}
+		}
+		// Only reachable at compile time, where this is an error.
+		throw "No collision-free modulus for these field names";
+	}
+
+	/// @returns The index of the field named @a name, or -1 if there isn't one.
+	int find(QStringView name) const
+	{
+		const std::uint32_t hash = field_name_hash(name);
+		const std::uint8_t index = m_slots[hash % m_modulus];
+		if(index == empty_slot || m_hashes[index] != hash
+			|| name != QLatin1StringView(m_names[index].data(), static_cast<qsizetype>(m_names[index].size())))
+		{
+			return -1;
+		}
+		return index;
+	}
+
+private:
+	constexpr bool try_modulus(std::size_t modulus)
+	{
+		for(auto& slot : m_slots)
+		{
+			slot = empty_slot;
+		}
+		for(std::size_t i = 0; i < N; ++i)
+		{
+			auto& slot = m_slots[m_hashes[i] % modulus];
+			if(slot != empty_slot)
+			{
+				return false;
+			}
+			slot = static_cast<std::uint8_t>(i);
+		}
+		m_modulus = static_cast<std::uint32_t>(modulus);
+		return true;
+	}
+
+	std::array<std::string_view, N> m_names {};
+	std::array<std::uint32_t, N> m_hashes {};
+	std::array<std::uint8_t, max_modulus> m_slots {};
+	std::uint32_t m_modulus {1};
+};
+
+template <ReflectedType ClassType>
+constexpr std::size_t num_fields_v = std::tuple_size_v<std::remove_const_t<decltype(FieldReflection<ClassType>::fields)>>;
+
+namespace field_reflection_detail
+{
+	template <class ClassType>
+	constexpr auto make_field_name_index()
+	{
+		constexpr auto& fields = FieldReflection<ClassType>::fields;
+		return std::apply([](const auto&... field){
+			return FieldNameIndex<sizeof...(field)>(std::array<std::string_view, sizeof...(field)>{field.m_name...});
+			}, fields);
+	}
+}
+
+/// The FieldNameIndex of @a ClassType, built at compile time.
+template <ReflectedType ClassType>
+inline constexpr auto field_name_index_v = field_reflection_detail::make_field_name_index<ClassType>();
+
+/**
+ * Call @a func(name, member) for each reflected field of @a obj, in declaration order.  @a member is a const
+ * reference if @a obj is const.
+ */
+template <class ClassType, class Func>
+requires ReflectedType<ClassType>
+void for_each_field(ClassType& obj, Func&& func)
+{
+	std::apply([&](const auto&... field){
+		(func(field.m_name, obj.*(field.m_member)), ...);
+		}, FieldReflection<std::remove_const_t<ClassType>>::fields);
+}
+
+/**
+ * Call @a func(name, member) for the field of @a obj with index @a index.
+ * @returns false if there's no such field.
+ */
+template <class ClassType, class Func>
+requires ReflectedType<ClassType>
+bool visit_field(ClassType& obj, int index, Func&& func)
+{
+	using class_type = std::remove_const_t<ClassType>;
+	constexpr auto& fields = FieldReflection<class_type>::fields;
+	return [&]<std::size_t... Is>(std::index_sequence<Is...>){
+		return ((static_cast<int>(Is) == index ? (func(std::get<Is>(fields).m_name, obj.*(std::get<Is>(fields).m_member)), true) : false) || ...);
+		}(std::make_index_sequence<num_fields_v<class_type>>{});
+}
+
+#endif /* SRC_LOGIC_SERIALIZATION_FIELDREFLECTION_H_ */
@@ -36,6 +36,8 @@
 
 // Ours
 #include <future/InsertionOrderedMap.h>
+#include "XmlStreamReadVisitor.h"
+#include "XmlStreamVisitor.h"
 
 using std_pair_QString_QVariant = std::pair<const QString, QVariant>;
 Q_DECLARE_METATYPE(std_pair_QString_QVariant);
@@ -53,6 +55,16 @@ ISerializable::operator QVariant() const
 	return toVariant();
 }
 
+void ISerializable::toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const
+{
+	visitor.writeVariant(node_name, toVariant());
+}
+
+void ISerializable::fromXmlStream(XmlStreamReadVisitor& visitor)
+{
+	fromVariant(visitor.readVariant());
+}
+
 bool ISerializable::isUuidNull() const
 {
 	return m_uuid.isNull() || m_uuid_prefix.empty();
@@ -38,6 +38,8 @@
 #include "SerializationExceptions.h"
 #include <future/InsertionOrderedMap.h>
 #include "QVariantHomogenousList.h"
+class XmlStreamVisitor;
+class XmlStreamReadVisitor;
 
 
 /**
@@ -68,6 +70,20 @@ public:
 	 */
 	virtual void fromVariant(const QVariant& variant) = 0;
 
+	/**
+	 * Write this object as an element named @a node_name directly to @a visitor's XML stream, without first
+	 * building the whole QVariant tree.  Must produce the same XML as writing out toVariant() would.
+	 * The default does exactly that, so only classes which can be big or have big children need to override it.
+	 */
+	virtual void toXmlStream(XmlStreamVisitor& visitor, const QString& node_name) const;
+
+	/**
+	 * Read this object directly from @a visitor's XML stream, which is positioned on the object's start element.
+	 * Must leave the stream on the matching end element, and read anything toXmlStream() writes.
+	 * The default reads the element into a QVariant and passes it to fromVariant().
+	 */
+	virtual void fromXmlStream(XmlStreamReadVisitor& visitor);
+
 	/// Sort of clumsy way to deal with this it seems.
 //	template <class MapType>
 //	void AddUUIDToVariantMap(MapType* map) const
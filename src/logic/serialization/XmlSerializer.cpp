@@ -26,8 +26,16 @@
 // Std C++ from The Future
 #include <future/overloaded.h>
 
+// Std C++
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <vector>
+
 // Qt
 #include <QFile>
+#include <QThread>
+#include <QtConcurrent>
 #include <QSaveFile>
 #include <QVariant>
 #include <QVariantList>
@@ -39,12 +47,32 @@
 #include <utils/DebugHelpers.h>
 #include <utils/Stopwatch.h>
 #include <future/future_algorithms.h>
+#include <future/guideline_helpers.h>
+#include "BlockCompressedIO.h"
 #include "ISerializable.h"
+#include "XmlStreamReadVisitor.h"
+#include "XmlStreamVisitor.h"
 
 
 void XmlSerializer::save(const ISerializable &serializable, const QUrl &file_url, const QString &root_name,
                          std::function<void(void)> extra_save_actions)
 {
+	// Stream it out, rather than writing out serializable.toVariant().  Anything which hasn't overridden
+	// toXmlStream() still goes through toVariant(), but only for itself, not for the whole document.
+	save_document(file_url, [&](XmlStreamVisitor& visitor){
+		serializable.toXmlStream(visitor, root_name);
+	});
+}
+
+bool XmlSerializer::save(const QUrl& file_url, const std::function<void(XmlStreamVisitor&)>& write_root_element)
+{
+	return save_document(file_url, write_root_element);
+}
+
+bool XmlSerializer::save_document(const QUrl& file_url, const std::function<void(XmlStreamVisitor&)>& write_root_element)
+{
+	Stopwatch sw("###################### XmlSerializer::save()");
+
 	/// @todo file_url Currently only file://'s are supported.
 
 	QString save_file_path = file_url.toLocalFile();
@@ -57,8 +85,17 @@ void XmlSerializer::save(const ISerializable &serializable, const QUrl &file_url
 
 	savefile.open(QIODevice::WriteOnly);
 
+	// If we're compressing, the XML goes through the compressor on its way to the file, a block at a time.
+	BlockCompressedWriter compressor(&savefile);
+	QIODevice* xml_device = &savefile;
+	if(m_compress)
+	{
+		compressor.open(QIODevice::WriteOnly);
+		xml_device = &compressor;
+	}
+
 	// XML writing starts here.
-	QXmlStreamWriter xmlstream(&savefile);
+	QXmlStreamWriter xmlstream(xml_device);
 
 	xmlstream.setAutoFormatting(true);
 	xmlstream.setAutoFormattingIndent(-1);
@@ -66,18 +103,38 @@ void XmlSerializer::save(const ISerializable &serializable, const QUrl &file_url
 	// Start document.
 	xmlstream.writeStartDocument();
 
-//	if(extra_save_actions)
-//	{
-//		extra_save_actions();
-//	}
-	// xmlstream.writeStartElement(str);
 	save_extra_start_info(xmlstream);
 
-	writeVariantToStream(root_name, serializable.toVariant(), xmlstream);
+	{
+		XmlStreamVisitor visitor(*this, xmlstream);
+		write_root_element(visitor);
+	}
 
 	xmlstream.writeEndDocument();
 
-	savefile.commit();
+	if(xmlstream.hasError())
+	{
+		qWr() << "XML WRITE ERROR:" << error_string(xmlstream);
+		savefile.cancelWriting();
+	}
+
+	if(compressor.isOpen())
+	{
+		// Writes the last block.
+		compressor.close();
+		if(!compressor.errorString().isEmpty())
+		{
+			qWr() << "COMPRESSED WRITE ERROR:" << compressor.errorString();
+			savefile.cancelWriting();
+		}
+	}
+
+	const bool committed = savefile.commit();
+	if(!committed)
+	{
+		qWr() << "Couldn't commit" << save_file_path << ":" << savefile.errorString();
+	}
+	return committed;
 }
 
 bool XmlSerializer::load(ISerializable& serializable, const QUrl &file_url)
@@ -93,6 +150,19 @@ bool XmlSerializer::load(ISerializable& serializable, const QUrl &file_url)
 	QFile file(load_file_path);
 	file.open(QFile::ReadOnly);
 
+	// Decompress on the fly if it's compressed.
+	BlockCompressedReader decompressor(&file);
+	QIODevice* xml_device = &file;
+	if(BlockCompressedFormat::detect(&file))
+	{
+		if(!decompressor.open(QIODevice::ReadOnly))
+		{
+			qWr() << "Couldn't read" << load_file_path << ":" << decompressor.errorString();
+			return false;
+		}
+		xml_device = &decompressor;
+	}
+
 #if 0 /// @exp See if reading it all in at once is a win or loss. == It doesn't seem to make a difference.
 	QByteArray whole_file = file.readAll();
 	if(whole_file.size() == 0)
@@ -102,10 +172,14 @@ bool XmlSerializer::load(ISerializable& serializable, const QUrl &file_url)
 	}
 	QXmlStreamReader xmlstream(whole_file);
 #else
-	QXmlStreamReader xmlstream(&file);
+	QXmlStreamReader xmlstream(xml_device);
 #endif
 
+	return load_from_stream(serializable, xmlstream);
+}
 
+bool XmlSerializer::load_from_stream(ISerializable& serializable, QXmlStreamReader& xmlstream)
+{
 	/// @todo EXTRA READ INFO NEEDS TO COME FROM CALLER
 	// Read the first start element of the document.
 	/// @todo Don't just throw it away.
@@ -134,9 +208,10 @@ bool XmlSerializer::load(ISerializable& serializable, const QUrl &file_url)
 	}
 	else
 	{
-		// Stream it all in.
-		QVariant qvar = readVariantFromStream(xmlstream);
-		serializable.fromVariant(qvar);
+		// Stream it all in.  Classes which don't override fromXmlStream() get it via a QVariant.
+		XmlStreamReadVisitor visitor(*this, xmlstream);
+		serializable.fromXmlStream(visitor);
+		check_for_stream_error_and_skip(xmlstream);
 	}
 
 	// Reading completed one way or another, check for errors.
@@ -148,6 +223,430 @@ bool XmlSerializer::load(ISerializable& serializable, const QUrl &file_url)
 	return !xmlstream.error();
 }
 
+/// The "type" of a load_split() placeholder element.
+static constexpr QLatin1String f_split_placeholder_type("qlonglong");
+
+namespace
+{
+	/// One split-out element's byte range in the file.
+	struct SplitElement
+	{
+		qsizetype m_begin;
+		qsizetype m_end;
+	};
+
+	/// A group of consecutive split-out elements from the same run, handled as a unit by one thread.
+	struct SplitChunk
+	{
+		std::size_t m_run;
+		std::size_t m_first_index;
+		qsizetype m_begin;
+		qsizetype m_end;
+	};
+
+	bool is_xml_whitespace(QByteArrayView bytes)
+	{
+		return std::all_of(bytes.begin(), bytes.end(), [](char c){ return c == ' ' || c == '\t' || c == '\n' || c == '\r'; });
+	}
+
+	/**
+	 * The document load_split() splits: the mapped file itself, or for a block-compressed file, its blocks decompressed
+	 * as they're needed, so the whole decompressed document is never in memory at once.  All positions are in the
+	 * uncompressed document.
+	 *
+	 * The first pass reads front to back through a window of the blocks it hasn't released yet, the next block being
+	 * decompressed on the global thread pool while it looks through the last one.  The second pass decompresses just
+	 * the blocks each chunk is in, again.
+	 */
+	class SplitSource
+	{
+	public:
+		SplitSource() = default;
+		M_GH_DELETE_COPY_AND_MOVE(SplitSource)
+		~SplitSource() { m_prefetch.waitForFinished(); }
+
+		/// @a file_data is the whole file, and has to outlive this.  Returns false if it's corrupt.
+		bool open(QByteArrayView file_data)
+		{
+			m_file_data = file_data;
+			if(!BlockCompressedFormat::detect(file_data))
+			{
+				m_window = file_data;
+				return true;
+			}
+			m_compressed = true;
+			return BlockCompressedFormat::index_blocks(file_data, &m_blocks);
+		}
+
+		bool isCompressed() const { return m_compressed; }
+
+		/// @name The first pass.
+		/// @{
+
+		/// Read in everything up to @a end.  Returns false if there isn't that much, or a block's corrupt, see failed().
+		bool ensure(qsizetype end)
+		{
+			while(end > window_end())
+			{
+				if(!read_next_block())
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/// Read in all the rest.
+		void ensure_all()
+		{
+			while(read_next_block()) {}
+		}
+
+		/// Position of the next @a needle at or after @a from, reading in as much as that takes.  -1 if there isn't one.
+		qsizetype find(QByteArrayView needle, qsizetype from)
+		{
+			qsizetype search_from = from;
+			while(true)
+			{
+				const qsizetype found = m_window.indexOf(needle, search_from - m_window_pos);
+				if(found >= 0)
+				{
+					return m_window_pos + found;
+				}
+				// Only the end of what we have could be the start of one which straddles into the next block.
+				search_from = std::max(from, window_end() - needle.size() + 1);
+				if(!read_next_block())
+				{
+					return -1;
+				}
+			}
+		}
+
+		/// The byte at @a pos, which has to have been read in and not released.
+		char at(qsizetype pos) const { return m_window[pos - m_window_pos]; }
+		/// The bytes [@a begin, @a end), which have to have been read in and not released.
+		QByteArrayView bytes(qsizetype begin, qsizetype end) const { return m_window.sliced(begin - m_window_pos, end - begin); }
+		qsizetype window_end() const { return m_window_pos + m_window.size(); }
+
+		/// Nothing before @a pos will be looked at again.  It's dropped when the next block's read in.
+		void release_before(qsizetype pos) { m_release_pos = pos; }
+
+		/// The first pass is done, drop whatever's still read in.
+		void release_all()
+		{
+			m_prefetch.waitForFinished();
+			m_prefetch = QFuture<QByteArray>();
+			m_window_pos = window_end();
+			m_buffer = QByteArray();
+			m_window = QByteArrayView();
+		}
+
+		/// True if a block turned out to be corrupt.
+		bool failed() const { return m_failed; }
+
+		/// @}
+
+		/**
+		 * For the second pass: the bytes [@a begin, @a end), decompressing just the blocks they're in into @a buffer.
+		 * Threadsafe.  Empty if a block's corrupt.
+		 */
+		QByteArrayView range(qsizetype begin, qsizetype end, QByteArray* buffer) const
+		{
+			if(!m_compressed)
+			{
+				return m_file_data.sliced(begin, end - begin);
+			}
+			// The last block which starts at or before begin.
+			auto block = std::prev(std::upper_bound(m_blocks.cbegin(), m_blocks.cend(), begin,
+										  [](qsizetype pos, const BlockCompressedFormat::Block& b){ return pos < b.m_uncompressed_pos; }));
+			const qsizetype buffer_pos = block->m_uncompressed_pos;
+			for(; block != m_blocks.cend() && block->m_uncompressed_pos < end; ++block)
+			{
+				if(!BlockCompressedFormat::decompress_block(m_file_data, *block, buffer))
+				{
+					return {};
+				}
+			}
+			return QByteArrayView(*buffer).sliced(begin - buffer_pos, end - begin);
+		}
+
+	private:
+		/// Block @a index decompressed, or empty if it's corrupt.  No block decompresses to nothing.
+		QByteArray decompress(std::size_t index) const
+		{
+			QByteArray retval;
+			if(!BlockCompressedFormat::decompress_block(m_file_data, m_blocks[index], &retval))
+			{
+				retval.clear();
+			}
+			return retval;
+		}
+
+		bool read_next_block()
+		{
+			if(!m_compressed || m_failed || m_next_block >= m_blocks.size())
+			{
+				return false;
+			}
+
+			const QByteArray block = m_prefetch.isValid() ? m_prefetch.result() : decompress(m_next_block);
+			++m_next_block;
+			if(m_next_block < m_blocks.size())
+			{
+				m_prefetch = QtConcurrent::run([this, index = m_next_block](){ return decompress(index); });
+			}
+			else
+			{
+				m_prefetch = QFuture<QByteArray>();
+			}
+			if(block.isEmpty())
+			{
+				qWr() << "Block-compressed data is corrupt";
+				m_failed = true;
+				return false;
+			}
+
+			// Drop what's been released before growing the window, and only then, it's a move of everything after it.
+			if(m_release_pos > m_window_pos)
+			{
+				m_buffer.remove(0, m_release_pos - m_window_pos);
+				m_window_pos = m_release_pos;
+			}
+			m_buffer.append(block);
+			m_window = m_buffer;
+			return true;
+		}
+
+		QByteArrayView m_file_data;
+		bool m_compressed {false};
+		std::vector<BlockCompressedFormat::Block> m_blocks;
+
+		/// The next block the first pass will read, and its decompression if that's been started.
+		std::size_t m_next_block {0};
+		QFuture<QByteArray> m_prefetch;
+
+		/// What the first pass has read in and not dropped yet, starting at m_window_pos.  Either the whole file, or
+		/// m_buffer.
+		QByteArrayView m_window;
+		qsizetype m_window_pos {0};
+		QByteArray m_buffer;
+		qsizetype m_release_pos {0};
+
+		bool m_failed {false};
+	};
+}
+
+bool XmlSerializer::load_split(ISerializable& serializable, const QUrl& file_url, const QString& split_tag,
+							   const std::function<void(const std::vector<std::size_t>&)>& on_runs_found,
+							   const std::function<void(std::size_t, std::size_t, QByteArrayView)>& on_split_item,
+							   const std::function<void(std::size_t, std::size_t, std::size_t)>& on_chunk_done)
+{
+	Stopwatch sw("###################### XmlSerializer::load_split()");
+
+	QString load_file_path = file_url.toLocalFile();
+	if(load_file_path.isEmpty())
+	{
+		Q_ASSERT_X(0, __PRETTY_FUNCTION__, "LOCAL FILE PATH IS EMPTY");
+	}
+
+	QFile file(load_file_path);
+	if(!file.open(QFile::ReadOnly))
+	{
+		qWr() << "Couldn't open" << load_file_path << ":" << file.errorString();
+		return false;
+	}
+
+	// Map the whole file, nothing below copies more than a chunk of it at a time.
+	QByteArray fallback_bytes;
+	QByteArrayView data;
+	uchar* mapped = file.map(0, file.size());
+	if(mapped != nullptr)
+	{
+		data = QByteArrayView(mapped, file.size());
+	}
+	else
+	{
+		qWr() << "Couldn't mmap" << load_file_path << ", reading it in instead.";
+		fallback_bytes = file.readAll();
+		data = fallback_bytes;
+	}
+
+	// A compressed file is decompressed a block at a time, in both passes.
+	SplitSource source;
+	if(!source.open(data))
+	{
+		qWr() << "Couldn't decompress" << load_file_path;
+		return false;
+	}
+
+	// First pass: find the split elements.  We only look at bytes here, no XML parsing.  This is safe because
+	// what we write never has a literal '<' anywhere but in markup, and we require that split elements don't nest.
+	const QByteArray open_tag = "<" + split_tag.toUtf8();
+	const QByteArray close_tag = "</" + split_tag.toUtf8() + ">";
+
+	std::vector<std::vector<SplitElement>> runs;
+	// The document minus the split elements, with a placeholder per run.
+	QByteArray skeleton;
+	qsizetype skeleton_from = 0;
+	qsizetype last_end = -1;
+
+	for(qsizetype pos = source.find(open_tag, 0); pos >= 0; pos = source.find(open_tag, pos))
+	{
+		const qsizetype name_end = pos + open_tag.size();
+		if(!source.ensure(name_end + 1))
+		{
+			break;
+		}
+		const char c = source.at(name_end);
+		if(c != ' ' && c != '>' && c != '/' && c != '\t' && c != '\n' && c != '\r')
+		{
+			// Some other tag which only starts with split_tag.
+			pos = name_end;
+			continue;
+		}
+
+		const qsizetype gt = source.find(">", name_end);
+		if(gt < 0)
+		{
+			qWr() << "Truncated element at offset" << pos;
+			return false;
+		}
+		qsizetype end;
+		if(source.at(gt - 1) == '/')
+		{
+			end = gt + 1;
+		}
+		else
+		{
+			end = source.find(close_tag, gt);
+			if(end < 0)
+			{
+				qWr() << "No end tag for element at offset" << pos;
+				return false;
+			}
+			end += close_tag.size();
+		}
+
+		// Only whitespace since the last split element means this one continues the same run.
+		if(runs.empty() || !is_xml_whitespace(source.bytes(last_end, pos)))
+		{
+			skeleton.append(source.bytes(skeleton_from, pos));
+			skeleton.append(QStringLiteral("<%1 type=\"%2\">%3</%1>")
+							.arg(split_tag, f_split_placeholder_type, QString::number(runs.size())).toUtf8());
+			runs.emplace_back();
+		}
+		runs.back().push_back({pos, end});
+
+		last_end = end;
+		skeleton_from = end;
+		pos = end;
+		source.release_before(skeleton_from);
+	}
+	source.ensure_all();
+	if(source.failed())
+	{
+		qWr() << "Couldn't decompress" << load_file_path;
+		return false;
+	}
+	skeleton.append(source.bytes(skeleton_from, source.window_end()));
+	source.release_all();
+
+	// The skeleton now only has the non-split parts of the document, load it first so the caller can get ready for
+	// the split elements.
+	QXmlStreamReader skeleton_xmlstream(skeleton);
+	if(!load_from_stream(serializable, skeleton_xmlstream))
+	{
+		return false;
+	}
+
+	std::vector<std::size_t> run_sizes;
+	run_sizes.reserve(runs.size());
+	qsizetype total_split_bytes = 0;
+	for(const auto& run : runs)
+	{
+		run_sizes.push_back(run.size());
+		total_split_bytes += run.back().m_end - run.front().m_begin;
+	}
+	on_runs_found(run_sizes);
+
+	// Group the elements into chunks, several per core so that uneven chunks even out.  Each chunk of a compressed
+	// file is decompressed on its own, so those are kept to a few blocks.
+	qsizetype target_chunk_bytes = std::max<qsizetype>(total_split_bytes / (std::max(1, QThread::idealThreadCount()) * 4), 64 * 1024);
+	if(source.isCompressed())
+	{
+		target_chunk_bytes = std::min(target_chunk_bytes, 4 * BlockCompressedFormat::c_default_block_size);
+	}
+	std::vector<SplitChunk> chunks;
+	for(std::size_t run = 0; run < runs.size(); ++run)
+	{
+		const auto& elements = runs[run];
+		std::size_t first = 0;
+		while(first < elements.size())
+		{
+			std::size_t last = first;
+			while(last + 1 < elements.size() && elements[last].m_end - elements[first].m_begin < target_chunk_bytes)
+			{
+				++last;
+			}
+			chunks.push_back({run, first, elements[first].m_begin, elements[last].m_end});
+			first = last + 1;
+		}
+	}
+
+	qIn() << "Split" << load_file_path << "into" << runs.size() << "runs," << chunks.size() << "chunks, skeleton is"
+		<< skeleton.size() << "bytes";
+
+	// Second pass: hand out the elements in parallel, a chunk at a time.
+	std::atomic<bool> failed {false};
+	QtConcurrent::blockingMap(chunks, [&](const SplitChunk& chunk){
+		QByteArray chunk_buffer;
+		const QByteArrayView chunk_bytes = source.range(chunk.m_begin, chunk.m_end, &chunk_buffer);
+		if(chunk_bytes.isEmpty())
+		{
+			failed = true;
+			return;
+		}
+		const auto& elements = runs[chunk.m_run];
+		std::size_t index = chunk.m_first_index;
+		for(; index < elements.size() && elements[index].m_begin < chunk.m_end; ++index)
+		{
+			const auto& element = elements[index];
+			on_split_item(chunk.m_run, index, chunk_bytes.sliced(element.m_begin - chunk.m_begin, element.m_end - element.m_begin));
+		}
+		if(on_chunk_done)
+		{
+			on_chunk_done(chunk.m_run, chunk.m_first_index, index - chunk.m_first_index);
+		}
+	});
+
+	if(mapped != nullptr)
+	{
+		file.unmap(mapped);
+	}
+
+	if(failed)
+	{
+		qWr() << "Couldn't decompress" << load_file_path;
+		return false;
+	}
+	return true;
+}
+
+// static
+std::optional<std::size_t> XmlSerializer::split_run_index(const QVariantHomogenousList& list)
+{
+	if(list.size() != 1)
+	{
+		return std::nullopt;
+	}
+	const QVariant& only = *list.cbegin();
+	if(only.metaType().id() != QMetaType::LongLong)
+	{
+		return std::nullopt;
+	}
+	return static_cast<std::size_t>(only.toLongLong());
+}
+
 static const int f_iomap_id = qMetaTypeId<InsertionOrderedMap<QString, QVariant>>();
 static const int f_qvarlist_id = qMetaTypeId<QVariantHomogenousList>();
 static const int f_serqvarlist_id = qMetaTypeId<SerializableQVariantList>();
@@ -25,11 +25,14 @@
 #define SRC_LOGIC_SERIALIZATION_XMLSERIALIZER_H_
 
 // Std C++
+#include <cstddef>
 #include <functional>
+#include <optional>
 #include <variant>
 #include <vector>
 
 // Qt
+#include <QByteArrayView>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 #include <QVariant>
@@ -38,6 +41,8 @@ class QVariantHomogenousList;
 
 // Ours
 #include "ISerializer.h"
+class XmlStreamVisitor;
+class XmlStreamReadVisitor;
 
 
 /**
@@ -62,8 +67,42 @@ public:
 			std::function<void(void)> extra_save_actions = nullptr
 			) override;
 
+	/**
+	 * Save a document whose single root element is written by @a write_root_element, e.g. when what's being saved
+	 * isn't a single ISerializable.  @a write_root_element must write exactly one element.
+	 * @returns true if the document was written and committed to @a file_url.
+	 */
+	bool save(const QUrl& file_url, const std::function<void(XmlStreamVisitor& visitor)>& write_root_element);
+
 	bool load(ISerializable& serializable, const QUrl& file_url) override;
 
+	/**
+	 * Parallel, progressive version of load() for big documents which are mostly long lists of independent elements,
+	 * e.g. the LibraryEntries of each Library in the library list.
+	 *
+	 * A cheap first pass over the memory-mapped file finds every @a split_tag element, which must not nest.  A
+	 * block-compressed file is decompressed a block at a time for that, and again a chunk at a time for the elements,
+	 * it's never all decompressed at once.
+	 * @a serializable is then loaded as usual from the rest of the document, in which each run of consecutive
+	 * @a split_tag elements has been replaced by one placeholder element, see split_run_index().  That's small, so it's
+	 * quick, and @a on_runs_found is called next with the number of elements in each run, in document order.
+	 * The caller can set up whatever it needs from @a serializable there, before the bulk of the work starts.
+	 *
+	 * The elements are then handed out in chunks of consecutive ones on the global thread pool, in roughly document
+	 * order.  @a on_split_item is called concurrently with each one's XML, its run and its index in the run.  How much of
+	 * the XML gets parsed is up to @a on_split_item, and @a item_xml is only valid during the call.  If given,
+	 * @a on_chunk_done is called, also concurrently, after the last @a on_split_item of each chunk.
+	 */
+	bool load_split(ISerializable& serializable, const QUrl& file_url, const QString& split_tag,
+					const std::function<void(const std::vector<std::size_t>& run_sizes)>& on_runs_found,
+					const std::function<void(std::size_t run, std::size_t index, QByteArrayView item_xml)>& on_split_item,
+					const std::function<void(std::size_t run, std::size_t first_index, std::size_t count)>& on_chunk_done = nullptr);
+
+	/**
+	 * If @a list is the list of a split run in what load_split() passes to fromVariant(), returns the index of the run.
+	 */
+	static std::optional<std::size_t> split_run_index(const QVariantHomogenousList& list);
+
 	void HACK_skip_extra(bool hack_skip) { m_HACK_SKIP = hack_skip; };
 
 	/**
@@ -73,13 +112,28 @@ public:
 	 */
 	void set_default_namespace(const std::string& default_ns, const std::string& default_ns_version);
 
+	/**
+	 * Call this before save() to write the document block-compressed, see BlockCompressedFormat.
+	 * load() and load_split() detect compressed documents on their own, this only affects saving.
+	 */
+	void set_compression(bool compress) { m_compress = compress; };
+
 protected:
 
 	void save_extra_start_info(QXmlStreamWriter& xmlstream);
+
+	/// Common part of the save()s.
+	bool save_document(const QUrl& file_url, const std::function<void(XmlStreamVisitor& visitor)>& write_root_element);
 	void load_extra_start_info(QXmlStreamReader* xmlstream);
 
+	/// Common part of the load()s.
+	bool load_from_stream(ISerializable& serializable, QXmlStreamReader& xmlstream);
+
 private:
 
+	friend class XmlStreamVisitor;
+	friend class XmlStreamReadVisitor;
+
 	/// @name Write members
 	/// @{
 
@@ -143,6 +197,8 @@ private:
 	std::string m_default_ns_version;
 
 	bool m_HACK_SKIP {true};
+
+	bool m_compress {false};
 };
 
 #endif /* SRC_LOGIC_SERIALIZATION_XMLSERIALIZER_H_ */
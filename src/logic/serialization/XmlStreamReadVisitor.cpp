@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file XmlStreamReadVisitor.cpp
+ * Implementation of XmlStreamReadVisitor.
+ */
+
+#include "XmlStreamReadVisitor.h"
+
+// Ours
+#include <utils/DebugHelpers.h>
+#include "XmlSerializer.h"
+
+
+XmlStreamReadVisitor::XmlStreamReadVisitor(XmlSerializer& serializer, QXmlStreamReader& xmlstream)
+	: m_serializer(serializer), m_xmlstream(xmlstream)
+{
+}
+
+QString XmlStreamReadVisitor::attribute(QAnyStringView qualified_name) const
+{
+	return m_xmlstream.attributes().value(qualified_name).toString();
+}
+
+QVariant XmlStreamReadVisitor::readVariant()
+{
+	return m_serializer.readVariantFromStream(m_xmlstream);
+}
+
+void XmlStreamReadVisitor::skipUnknownElement()
+{
+	qWr() << "Skipping unknown field element:" << m_xmlstream.name();
+	m_xmlstream.skipCurrentElement();
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file XmlStreamReadVisitor.h
+ * Interface of XmlStreamReadVisitor, for reading ISerializables directly from an XML stream.
+ */
+
+#ifndef SRC_LOGIC_SERIALIZATION_XMLSTREAMREADVISITOR_H_
+#define SRC_LOGIC_SERIALIZATION_XMLSTREAMREADVISITOR_H_
+
+// Std C++
+#include <string_view>
+#include <type_traits>
+
+// Qt
+#include <QAnyStringView>
+#include <QString>
+#include <QStringView>
+#include <QVariant>
+#include <QXmlStreamReader>
+
+// Ours
+#include <future/guideline_helpers.h>
+#include "FieldReflection.h"
+#include "ISerializable.h"
+#include "XmlValueCodec.h"
+class XmlSerializer;
+
+
+/**
+ * Streaming counterpart of fromVariant(), and the read side of XmlStreamVisitor.  Passed to
+ * ISerializable::fromXmlStream() positioned on the object's start element, which reads the object's fields straight
+ * off the stream instead of out of a QVariant tree.
+ *
+ * Reads anything XmlSerializer writes for the equivalent toVariant() result.  Fields with a direct XmlValueCodec<>
+ * are converted from the element text straight into the member, everything else is read through a QVariant as
+ * map_read_field_or_warn() would have.
+ */
+class XmlStreamReadVisitor
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(XmlStreamReadVisitor)
+
+	XmlStreamReadVisitor(XmlSerializer& serializer, QXmlStreamReader& xmlstream);
+	~XmlStreamReadVisitor() = default;
+
+	/// The value of attribute @a qualified_name on the current start element, e.g. "xml:id".
+	QString attribute(QAnyStringView qualified_name) const;
+
+	/**
+	 * Read the current element into a QVariant, the way XmlSerializer::load() does.
+	 * This is also the fallback ISerializable::fromXmlStream() uses.
+	 */
+	QVariant readVariant();
+
+	/// @name Streaming versions of the map_read_field_or_warn() overloads.
+	/// Each reads the current element into @a member, and leaves the stream on its end element.
+	/// @{
+
+	void readField(ISerializable& member)
+	{
+		member.fromXmlStream(*this);
+	}
+
+	template <class ValueType>
+	requires (!std::is_pointer_v<ValueType> && !std::is_base_of_v<ISerializable, ValueType>)
+	void readField(ValueType& member)
+	{
+		if constexpr(DirectXmlValueType<ValueType>)
+		{
+			// Only if it was written as what we expect, otherwise let QVariant try to convert it.
+			if(m_xmlstream.attributes().value(QLatin1StringView("type")) == QLatin1StringView(xml_type_name<ValueType>()))
+			{
+				if(!XmlValueCodec<ValueType>::fromText(m_xmlstream.readElementText(), &member))
+				{
+					m_xmlstream.raiseError(QStringLiteral("XML FAIL: Could not convert element text to %1")
+						.arg(QLatin1StringView(xml_type_name<ValueType>())));
+				}
+				return;
+			}
+		}
+		QVariant qvar = readVariant();
+		member = qvar.value<ValueType>();
+	}
+
+	/// std::string is written as a QString.
+	void readField(std::string& member)
+	{
+		QString temp;
+		readField(temp);
+		member = temp.toStdString();
+	}
+
+	/// @}
+
+	/**
+	 * Read the children of the current map element into the reflected fields of @a obj, dispatching on the element
+	 * names with the class's compile-time FieldNameIndex.  Unknown elements are warned about and skipped.
+	 * Read any attributes of the element first, this moves past them.
+	 */
+	template <ReflectedType ClassType>
+	void readReflected(ClassType& obj)
+	{
+		Q_ASSERT(m_xmlstream.isStartElement());
+		while(m_xmlstream.readNextStartElement())
+		{
+			const int index = field_name_index_v<ClassType>.find(m_xmlstream.name());
+			const bool found = (index >= 0) && visit_field(obj, index, [this](std::string_view, auto& member){
+				readField(member);
+			});
+			if(!found)
+			{
+				skipUnknownElement();
+			}
+		}
+	}
+
+private:
+	void skipUnknownElement();
+
+	XmlSerializer& m_serializer;
+	QXmlStreamReader& m_xmlstream;
+};
+
+#endif /* SRC_LOGIC_SERIALIZATION_XMLSTREAMREADVISITOR_H_ */
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file XmlStreamVisitor.cpp
+ * Implementation of XmlStreamVisitor.
+ */
+
+#include "XmlStreamVisitor.h"
+
+// Qt
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+// Ours
+#include <utils/DebugHelpers.h>
+#include <utils/StringHelpers.h>
+#include "XmlSerializer.h"
+
+
+XmlStreamVisitor::XmlStreamVisitor(XmlSerializer& serializer, QXmlStreamWriter& xmlstream)
+	: m_serializer(serializer), m_xmlstream(xmlstream)
+{
+}
+
+XmlStreamVisitor::~XmlStreamVisitor()
+{
+	AMLM_ASSERT_X(m_depth == 0, "Unbalanced begin/endElement()");
+}
+
+void XmlStreamVisitor::beginMap(const QString& node_name, const std::string& class_name, const attr_map_type& attrs)
+{
+	beginTypedElement(node_name, QMetaType::fromType<InsertionOrderedMap<QString, QVariant>>().name());
+
+	// Same attributes, same order, as XmlSerializer::writeVariantOrderedMapToStream().
+	m_xmlstream.writeAttribute("class", toqstr(class_name));
+	for(const auto& it : attrs)
+	{
+		m_xmlstream.writeAttribute(toqstr(it.first), toqstr(it.second));
+	}
+}
+
+void XmlStreamVisitor::endElement()
+{
+	Q_ASSERT(m_depth > 0);
+	--m_depth;
+	m_xmlstream.writeEndElement();
+}
+
+void XmlStreamVisitor::writeVariant(const QString& node_name, const QVariant& value)
+{
+	m_serializer.writeVariantToStream(node_name, value, m_xmlstream);
+}
+
+void XmlStreamVisitor::copyElement(QXmlStreamReader& xmlstream)
+{
+	Q_ASSERT(xmlstream.isStartElement());
+
+	int depth = 0;
+	while(!xmlstream.hasError())
+	{
+		if(xmlstream.isStartElement())
+		{
+			++depth;
+		}
+		else if(xmlstream.isEndElement())
+		{
+			--depth;
+		}
+		m_xmlstream.writeCurrentToken(xmlstream);
+		if(depth == 0)
+		{
+			break;
+		}
+		xmlstream.readNext();
+	}
+}
+
+void XmlStreamVisitor::beginTypedElement(const QString& node_name, const char* type_name)
+{
+	++m_depth;
+	m_xmlstream.writeStartElement(node_name);
+	m_xmlstream.writeAttribute("type", type_name);
+}
+
+void XmlStreamVisitor::writeTextElement(QAnyStringView node_name, const char* type_name, const QString& text)
+{
+	// What writeVariantToStream() + writeVariantValueToStream() write, minus the QVariant.
+	m_xmlstream.writeStartElement(node_name);
+	m_xmlstream.writeAttribute("type", type_name);
+	m_xmlstream.writeCharacters(text);
+	m_xmlstream.writeEndElement();
+}
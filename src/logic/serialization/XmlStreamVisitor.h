@@ -0,0 +1,178 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file XmlStreamVisitor.h
+ * Interface of XmlStreamVisitor, for writing ISerializables directly to an XML stream.
+ */
+
+#ifndef SRC_LOGIC_SERIALIZATION_XMLSTREAMVISITOR_H_
+#define SRC_LOGIC_SERIALIZATION_XMLSTREAMVISITOR_H_
+
+// Std C++
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Qt
+#include <QAnyStringView>
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+class QXmlStreamReader;
+class QXmlStreamWriter;
+
+// Ours
+#include <future/guideline_helpers.h>
+#include <future/InsertionOrderedMap.h>
+#include "FieldReflection.h"
+#include "ISerializable.h"
+#include "QVariantHomogenousList.h"
+#include "SerializationExceptions.h"
+#include "XmlValueCodec.h"
+class XmlSerializer;
+
+
+/**
+ * Streaming counterpart of toVariant().  Passed to ISerializable::toXmlStream(), which writes the object's elements
+ * straight to the XML stream with it instead of building a QVariant tree which then gets written out.
+ *
+ * The XML is exactly what XmlSerializer would write for the equivalent toVariant() result, so it reads back in with
+ * the unchanged fromVariant() path:
+ * - beginMap()/endElement() is an InsertionOrderedMap<QString, QVariant>.
+ * - beginList()/endElement() is a QVariantHomogenousList, whose items are then written with the list's item tag.
+ * - writeField() is the streaming map_insert_or_die().
+ * - writeReflected() writes a whole ReflectedType from its FieldReflection<>.
+ *
+ * Fields with a direct XmlValueCodec<> are written straight from the member, everything else goes through a QVariant.
+ */
+class XmlStreamVisitor
+{
+public:
+	M_GH_DELETE_COPY_AND_MOVE(XmlStreamVisitor)
+
+	using attr_map_type = InsertionOrderedMap<QString, QVariant>::attr_map_type;
+
+	XmlStreamVisitor(XmlSerializer& serializer, QXmlStreamWriter& xmlstream);
+	~XmlStreamVisitor();
+
+	/**
+	 * Start an element which reads back as an InsertionOrderedMap<QString, QVariant>.
+	 * @param class_name  What set_map_class_info() would have put in the map, if anything.
+	 * @param attrs       Any extra attributes, e.g. xml:id.
+	 */
+	void beginMap(const QString& node_name, const std::string& class_name = {}, const attr_map_type& attrs = {});
+
+	/**
+	 * Start an element which reads back as a QVariantHomogenousList, or @a ListType if it's one of its derived classes.
+	 */
+	template <class ListType = QVariantHomogenousList>
+	void beginList(const QString& node_name)
+	{
+		static_assert(std::is_base_of_v<QVariantHomogenousList, ListType>);
+		beginTypedElement(node_name, QMetaType::fromType<ListType>().name());
+	}
+
+	/// End the element started by the last beginMap()/beginList().
+	void endElement();
+
+	/**
+	 * Write @a value as an element named @a node_name, the way XmlSerializer writes a toVariant() result.
+	 * This is also the fallback ISerializable::toXmlStream() uses.
+	 */
+	void writeVariant(const QString& node_name, const QVariant& value);
+
+	/**
+	 * Copy the element @a xmlstream is on the start of, and everything in it, to the output unchanged.  For XML
+	 * which was read in but never deserialized.  Leaves @a xmlstream on the element's end.
+	 */
+	void copyElement(QXmlStreamReader& xmlstream);
+
+	/// @name Streaming versions of the map_insert_or_die() overloads.
+	/// @{
+
+	void writeField(QAnyStringView key, const ISerializable& member)
+	{
+		member.toXmlStream(*this, key.toString());
+	}
+
+	template <class ValueType>
+	requires (!std::is_pointer_v<ValueType> && !std::is_base_of_v<ISerializable, ValueType>)
+	void writeField(QAnyStringView key, const ValueType& member)
+	{
+		if constexpr(DirectXmlValueType<ValueType>)
+		{
+			writeTextElement(key, xml_type_name<ValueType>(), XmlValueCodec<ValueType>::toText(member));
+		}
+		else
+		{
+			QVariant qvalue = QVariant::fromValue(member);
+			if(!qvalue.isValid())
+			{
+				throw SerializationException("Failed to convert member to QVariant.");
+			}
+			writeVariant(key.toString(), qvalue);
+		}
+	}
+
+	/// As with map_insert_or_die(), std::string goes out as a QString.
+	void writeField(QAnyStringView key, const std::string& member)
+	{
+		writeTextElement(key, xml_type_name<QString>(), QString::fromStdString(member));
+	}
+
+	/// As with map_insert_or_die(), nothing is written for a nullptr.
+	void writeField(QAnyStringView key, std::nullptr_t member)
+	{
+		Q_UNUSED(key);
+		Q_UNUSED(member);
+	}
+
+	/// @}
+
+	/**
+	 * Write all the reflected fields of @a obj as a map element, the same XML its X-macro'ed toVariant() gives.
+	 */
+	template <ReflectedType ClassType>
+	void writeReflected(const QString& node_name, const ClassType& obj, const std::string& class_name = {},
+						const attr_map_type& attrs = {})
+	{
+		beginMap(node_name, class_name, attrs);
+		for_each_field(obj, [this](std::string_view name, const auto& member){
+			writeField(QLatin1StringView(name.data(), static_cast<qsizetype>(name.size())), member);
+		});
+		endElement();
+	}
+
+	/// @}
+
+private:
+	void beginTypedElement(const QString& node_name, const char* type_name);
+	void writeTextElement(QAnyStringView node_name, const char* type_name, const QString& text);
+
+	XmlSerializer& m_serializer;
+	QXmlStreamWriter& m_xmlstream;
+
+	/// Open begin/endElement() nesting level, for sanity checking.
+	int m_depth {0};
+};
+
+#endif /* SRC_LOGIC_SERIALIZATION_XMLSTREAMVISITOR_H_ */
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file XmlValueCodec.h
+ * Direct to/from element text conversions for the most common leaf field types.
+ */
+
+#ifndef SRC_LOGIC_SERIALIZATION_XMLVALUECODEC_H_
+#define SRC_LOGIC_SERIALIZATION_XMLVALUECODEC_H_
+
+// Std C++
+#include <type_traits>
+#include <utility>
+
+// Qt
+#include <QDateTime>
+#include <QMetaType>
+#include <QString>
+#include <QUrl>
+
+
+/**
+ * Converts a leaf value to and from the element text XmlSerializer would write/read for it via a QVariant, without
+ * the QVariant.  The text has to be exactly what QVariant's QString conversions produce and accept, so that either
+ * path can read what the other wrote.
+ *
+ * Types without a specialization have is_direct == false, and the visitors fall back to the QVariant path for them.
+ */
+template <class T>
+struct XmlValueCodec
+{
+	static constexpr bool is_direct = false;
+};
+
+template <class T>
+concept DirectXmlValueType = XmlValueCodec<T>::is_direct;
+
+/// The "type" attribute value for a T, same as QVariant::typeName() of a QVariant holding one.
+template <class T>
+const char* xml_type_name()
+{
+	return QMetaType::fromType<T>().name();
+}
+
+template <>
+struct XmlValueCodec<QString>
+{
+	static constexpr bool is_direct = true;
+	static QString toText(const QString& value) { return value; }
+	static bool fromText(QString&& text, QString* value) { *value = std::move(text); return true; }
+};
+
+template <>
+struct XmlValueCodec<bool>
+{
+	static constexpr bool is_direct = true;
+	static QString toText(bool value) { return value ? QStringLiteral("true") : QStringLiteral("false"); }
+	static bool fromText(QString&& text, bool* value)
+	{
+		// Same rule as QVariant's QString->bool.
+		*value = !(text.isEmpty() || text == QLatin1StringView("0") || text.compare(QLatin1StringView("false"), Qt::CaseInsensitive) == 0);
+		return true;
+	}
+};
+
+/// QVariant turns the char types into strings of one character, not numbers, so leave them out.
+template <class T>
+concept XmlNumericIntegral = std::is_integral_v<T> && !std::is_same_v<T, bool>
+	&& !std::is_same_v<T, char> && !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>
+	&& !std::is_same_v<T, char8_t> && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t> && !std::is_same_v<T, wchar_t>;
+
+template <XmlNumericIntegral T>
+struct XmlValueCodec<T>
+{
+	static constexpr bool is_direct = true;
+	static QString toText(T value) { return QString::number(value); }
+	static bool fromText(QString&& text, T* value)
+	{
+		if(text.isEmpty())
+		{
+			*value = T{};
+			return true;
+		}
+		bool ok = false;
+		if constexpr(std::is_signed_v<T>)
+		{
+			*value = static_cast<T>(text.toLongLong(&ok));
+		}
+		else
+		{
+			*value = static_cast<T>(text.toULongLong(&ok));
+		}
+		return ok;
+	}
+};
+
+template <>
+struct XmlValueCodec<QDateTime>
+{
+	static constexpr bool is_direct = true;
+	static QString toText(const QDateTime& value) { return value.toString(Qt::ISODateWithMs); }
+	static bool fromText(QString&& text, QDateTime* value)
+	{
+		*value = text.isEmpty() ? QDateTime() : QDateTime::fromString(text, Qt::ISODateWithMs);
+		return text.isEmpty() || value->isValid();
+	}
+};
+
+template <>
+struct XmlValueCodec<QUrl>
+{
+	static constexpr bool is_direct = true;
+	static QString toText(const QUrl& value) { return value.toString(); }
+	static bool fromText(QString&& text, QUrl* value) { *value = QUrl(text); return true; }
+};
+
+#endif /* SRC_LOGIC_SERIALIZATION_XMLVALUECODEC_H_ */
@@ -20,6 +20,9 @@
 
 #include <config.h>
 
+// Std C++
+#include <optional>
+
 // Qt
 #include <QtGlobal>
 #include <QIcon>
@@ -52,6 +55,9 @@
 #include "gui/MainWindow.h"
 #include "resources/VersionInfo.h"
 #include "utils/Logging.h"
+#include <utils/StartupProfiler.h>
+#include <utils/Trace.h>
+#include <gui/DeferredInit.h>
 
 // Compile-time info/sanity checks.
 M_MESSAGE("BUILDING WITH CMAKE_C_COMPILER_ID: " CMAKE_C_COMPILER_ID " = " CMAKE_C_COMPILER);
@@ -74,6 +80,16 @@ static void LL(const QString& root)
  */
 int main(int argc, char *argv[])
 {
+	// Everything in the startup timeline is relative to this.
+	StartupProfiler::start();
+
+	// Trace from the start, written out at shutdown.
+	if(qEnvironmentVariableIsSet("AMLM_TRACE"))
+	{
+		Trace::setExitTracePath(qEnvironmentVariable("AMLM_TRACE"));
+		Trace::enable();
+	}
+
 	// Make sure our compiled-in static lib resources are linked.
 	// Necessary because the resource files are compiled into a static library.
 	Q_INIT_RESOURCE(xquery_files);
@@ -125,11 +141,13 @@ int main(int argc, char *argv[])
     // @note This should have loaded any bundled icontheme.rcc files.
 	//
     qIn() << "START Constructing AMLMApp";
+    std::optional<StartupProfiler::Phase> app_phase(std::in_place, "Construct AMLMApp");
     AMLMApp app(argc, argv);
+    app_phase.reset();
     qIn() << "END Constructing AMLMApp";
 
-    // Log the startup icon theme info.
-    Theme::LogIconThemeInfo();
+    // Log the startup icon theme info, once the main window is up.
+    DeferredInit::instance()->add("Log icon theme info", [](){ Theme::LogIconThemeInfo(); });
 
 	app.Init();
 
@@ -137,10 +155,13 @@ int main(int argc, char *argv[])
 	KSharedConfigPtr config = KSharedConfig::openConfig();
 	qIn() << M_ID_VAL(config->mainConfigName()) << M_ID_VAL(config->openFlags());
 
-	// Force defaults at startup, KConfig doesn't do this by default.
-	AMLMSettings::self()->setDefaults();
-	// Overlay non-default settings by reading the actual config.
-	AMLMSettings::self()->read();
+	{
+		StartupProfiler::Phase phase("Read settings");
+		// Force defaults at startup, KConfig doesn't do this by default.
+		AMLMSettings::self()->setDefaults();
+		// Overlay non-default settings by reading the actual config.
+		AMLMSettings::self()->read();
+	}
 
 	auto amlmconfig = AMLMSettings::self();
 	qDb() << M_ID_VAL(amlmconfig->collectionSourceUrls());
@@ -199,8 +220,24 @@ int main(int argc, char *argv[])
 	parser.addVersionOption();
 	parser.addHelpOption();
 	// ... addOption() additional options here.
+	QCommandLineOption profile_startup_option(QStringLiteral("profile-startup"),
+		QStringLiteral("Log a timeline of the startup phases.  Setting the AMLM_PROFILE_STARTUP environment variable does the same."));
+	parser.addOption(profile_startup_option);
+	QCommandLineOption trace_option(QStringLiteral("trace"),
+		QStringLiteral("Record a timeline trace and write it to <file> at exit, as Chrome trace event JSON.  Setting the AMLM_TRACE environment variable to <file> does the same."),
+		QStringLiteral("file"));
+	parser.addOption(trace_option);
 	parser.process(app);
 	aboutData.processCommandLine(&parser);
+	if(parser.isSet(profile_startup_option))
+	{
+		StartupProfiler::enable();
+	}
+	if(parser.isSet(trace_option))
+	{
+		Trace::setExitTracePath(parser.value(trace_option));
+		Trace::enable();
+	}
 
 	// Application metadata set, now register to the D-Bus session
 	/// @todo No DBus functionality currently.
@@ -232,6 +269,10 @@ int main(int argc, char *argv[])
 	{
 		// Don't need to deal with KMainWindow::restore(), this takes care of it.
 		kRestoreMainWindows<MainWindow>();
+		if(!KMainWindow::memberList().isEmpty())
+		{
+			DeferredInit::instance()->runAfterFirstPaint(KMainWindow::memberList().first());
+		}
 	}
 	else
 	{
@@ -240,11 +281,14 @@ int main(int argc, char *argv[])
 		// Create and show the main window.
 		// From the KDE5 docs: https://api.kde.org/frameworks/kxmlgui/html/classKMainWindow.html#ab0c194be12f0ad123a9ba8be75bb85c9
 		// "KMainWindows must be created on the heap with 'new'"
+		std::optional<StartupProfiler::Phase> mainwin_phase(std::in_place, "Construct MainWindow");
 		MainWindow *mainWin = new MainWindow();
+		mainwin_phase.reset();
 		mainWin->setObjectName("AMLMMainWindow#");
 		// Tell the app singleton about the main window singleton.
 		// Note that there's a lot of code between the two creations.
 		amlmApp->MAIN_ONLY_setMainWindow(mainWin);
+		DeferredInit::instance()->runAfterFirstPaint(mainWin);
 		mainWin->show();
 	}
 
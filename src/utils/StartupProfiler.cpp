@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file StartupProfiler.cpp
+ * Implementation of StartupProfiler.
+ */
+
+#include "StartupProfiler.h"
+
+// Std C++
+#include <atomic>
+#include <mutex>
+
+// Qt
+#include <QThread>
+
+// Ours
+#include <utils/DebugHelpers.h>
+#include <utils/Trace.h>
+
+
+namespace
+{
+	struct ProfilerState
+	{
+		std::mutex m_mutex;
+		std::chrono::steady_clock::time_point m_origin {std::chrono::steady_clock::now()};
+		std::vector<StartupProfiler::Event> m_events;
+		bool m_interactive {false};
+		std::atomic<bool> m_enabled {qEnvironmentVariableIsSet("AMLM_PROFILE_STARTUP")};
+	};
+
+	ProfilerState& state()
+	{
+		static ProfilerState the_state;
+		return the_state;
+	}
+
+	std::string current_thread_name()
+	{
+		QString name = QThread::currentThread()->objectName();
+		if(name.isEmpty())
+		{
+			return std::to_string(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+		}
+		return name.toStdString();
+	}
+
+	double to_ms(std::chrono::steady_clock::duration d)
+	{
+		return std::chrono::duration<double, std::milli>(d).count();
+	}
+
+	void log_event(const StartupProfiler::Event& event)
+	{
+		qIn().noquote() << QString("STARTUP: %1 ms %2 ms [%3] %4")
+			.arg(to_ms(event.m_start), 9, 'f', 1)
+			.arg(to_ms(event.m_duration), 9, 'f', 1)
+			.arg(QString::fromStdString(event.m_thread_name), 15)
+			.arg(QString::fromStdString(event.m_name));
+	}
+}
+
+void StartupProfiler::start()
+{
+	auto& s = state();
+	std::scoped_lock lock(s.m_mutex);
+	s.m_origin = std::chrono::steady_clock::now();
+	s.m_events.clear();
+	s.m_interactive = false;
+}
+
+void StartupProfiler::enable()
+{
+	state().m_enabled = true;
+}
+
+bool StartupProfiler::isEnabled()
+{
+	return state().m_enabled;
+}
+
+StartupProfiler::Phase::Phase(std::string name) : m_name(std::move(name)), m_start(std::chrono::steady_clock::now())
+{
+}
+
+StartupProfiler::Phase::~Phase()
+{
+	record(std::move(m_name), m_start, std::chrono::steady_clock::now());
+}
+
+void StartupProfiler::mark(std::string name)
+{
+	const auto now = std::chrono::steady_clock::now();
+	record(std::move(name), now, now);
+}
+
+void StartupProfiler::interactive()
+{
+	const auto now = std::chrono::steady_clock::now();
+	auto& s = state();
+	std::scoped_lock lock(s.m_mutex);
+
+	if(s.m_interactive)
+	{
+		return;
+	}
+	s.m_interactive = true;
+
+	const auto time_to_interactive = now - s.m_origin;
+	s.m_events.push_back({"Interactive", current_thread_name(), time_to_interactive, {}});
+
+	if(!isEnabled())
+	{
+		return;
+	}
+
+	qIn() << "STARTUP TIMELINE:    start    duration  thread           phase";
+	for(const auto& event : s.m_events)
+	{
+		log_event(event);
+	}
+	if(time_to_interactive > c_interactive_target)
+	{
+		qWr() << "STARTUP: Time to interactive" << to_ms(time_to_interactive) << "ms is over the target of" << c_interactive_target.count() << "ms";
+	}
+	else
+	{
+		qIn() << "STARTUP: Time to interactive" << to_ms(time_to_interactive) << "ms";
+	}
+}
+
+std::vector<StartupProfiler::Event> StartupProfiler::events()
+{
+	auto& s = state();
+	std::scoped_lock lock(s.m_mutex);
+	return s.m_events;
+}
+
+void StartupProfiler::record(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	if(Trace::isEnabled())
+	{
+		Trace::complete(Trace::intern(name), start, end);
+	}
+
+	auto& s = state();
+	std::scoped_lock lock(s.m_mutex);
+
+	s.m_events.push_back({std::move(name), current_thread_name(), start - s.m_origin, end - start});
+
+	// After interactive(), the timeline's already been logged, so log the stragglers as they come in.
+	if(s.m_interactive && isEnabled())
+	{
+		log_event(s.m_events.back());
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file StartupProfiler.h
+ * Interface of StartupProfiler, the startup timeline.
+ */
+#ifndef SRC_UTILS_STARTUPPROFILER_H_
+#define SRC_UTILS_STARTUPPROFILER_H_
+
+// Std C++
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Ours
+#include <future/guideline_helpers.h>
+
+
+/**
+ * Timeline of the app's startup, from main() to the main window being usable.
+ *
+ * Recording the handful of startup phases is cheap enough that it's always done.  The timeline is only logged if
+ * it's enabled, by the AMLM_PROFILE_STARTUP env var being set or the --profile-startup command line option.
+ *
+ * All static, threadsafe.
+ */
+class StartupProfiler
+{
+public:
+	/// Target time from start() to interactive().  If it takes longer it's logged as a warning.
+	static constexpr std::chrono::milliseconds c_interactive_target {1000};
+
+	/// Call first thing in main().  Everything is timed relative to this.
+	static void start();
+
+	/// Log the timeline when interactive() is called.
+	static void enable();
+	static bool isEnabled();
+
+	/**
+	 * Scoped timer for one startup phase.
+	 */
+	class Phase
+	{
+	public:
+		M_GH_DELETE_COPY_AND_MOVE(Phase)
+
+		explicit Phase(std::string name);
+		~Phase();
+
+	private:
+		std::string m_name;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	/// Record a point in time rather than a phase.
+	static void mark(std::string name);
+
+	/**
+	 * The main window is up, painted and responding to input.  Logs the timeline if enabled.
+	 * Phases recorded after this, e.g. deferred initialization, are logged as they finish.
+	 */
+	static void interactive();
+
+	struct Event
+	{
+		std::string m_name;
+		std::string m_thread_name;
+		/// From start().
+		std::chrono::steady_clock::duration m_start;
+		/// Zero for mark()s.
+		std::chrono::steady_clock::duration m_duration;
+	};
+
+	/// Everything recorded so far, in the order the phases ended.
+	static std::vector<Event> events();
+
+private:
+	static void record(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+};
+
+#endif /* SRC_UTILS_STARTUPPROFILER_H_ */
@@ -28,6 +28,7 @@
 
 // Ours
 #include <utils/DebugHelpers.h>
+#include <utils/Trace.h>
 
 #define AMLMCOUT qDb()
 
@@ -56,6 +57,13 @@ void Stopwatch::start(const std::string& being_timed_msg)
 	m_being_timed_msg = being_timed_msg;
 	m_start = std::chrono::steady_clock::now();
 	AMLMCOUT << "START: " << m_being_timed_msg; // << std::endl;
+
+	if(Trace::isEnabled())
+	{
+		m_trace_name = Trace::intern(m_being_timed_msg);
+		m_trace_id = Trace::newAsyncId();
+		Trace::asyncBegin(m_trace_name, m_trace_id, m_start);
+	}
 }
 
 void Stopwatch::lap(const std::string& lap_marker_str)
@@ -65,6 +73,15 @@ void Stopwatch::lap(const std::string& lap_marker_str)
 	lap_marker lm;
 	lm.m_lap_time = std::chrono::steady_clock::now();
 	lm.m_lap_discription = lap_marker_str;
+
+	if(m_trace_name != nullptr)
+	{
+		// From the last lap to this one, nested in the whole timing.
+		const char* lap_name = Trace::intern(lap_marker_str);
+		Trace::asyncBegin(lap_name, m_trace_id, m_lap_markers.empty() ? m_start : m_lap_markers.back().m_lap_time);
+		Trace::asyncEnd(lap_name, m_trace_id, lm.m_lap_time);
+	}
+
 	m_lap_markers.push_back(lm);
 
 	std::chrono::duration<double> elapsed = lm.m_lap_time - m_start;
@@ -77,6 +94,7 @@ void Stopwatch::stop()
 	std::scoped_lock sl(m_mutex);
 
 	m_end = std::chrono::steady_clock::now();
+	TSI_end_trace_span(m_end);
 }
 
 void Stopwatch::reset()
@@ -119,9 +137,19 @@ void Stopwatch::print_results()
 
 void Stopwatch::TSI_reset()
 {
+	TSI_end_trace_span(std::chrono::steady_clock::now());
+
 	m_start = decltype(m_start)::min();
 	m_end = decltype(m_end)::max();
 	m_lap_markers.clear();
 	m_being_timed_msg.clear();
 }
 
+void Stopwatch::TSI_end_trace_span(std::chrono::steady_clock::time_point at)
+{
+	if(m_trace_name != nullptr)
+	{
+		Trace::asyncEnd(m_trace_name, m_trace_id, at);
+		m_trace_name = nullptr;
+	}
+}
@@ -25,12 +25,15 @@
 
 // Std C++
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <mutex>
 
 /**
  * Threadsafe, scoped Elapsed time timer, mostly for debug purposes.
+ *
+ * If Trace is enabled, each timing is also an async span in the trace, with a span per lap nested in it.
  */
 class Stopwatch
 {
@@ -53,6 +56,9 @@ private:
 	/// Threadsafe Interface pattern, internal reset.
 	void TSI_reset();
 
+	/// End the trace span, if there's one open.
+	void TSI_end_trace_span(std::chrono::steady_clock::time_point at);
+
 
 	struct lap_marker
 	{
@@ -66,6 +72,10 @@ private:
 	std::chrono::steady_clock::time_point m_end;
 	std::string m_being_timed_msg;
 	std::vector<lap_marker> m_lap_markers;
+
+	/// Trace::intern()ed m_being_timed_msg while the span is open, else nullptr.
+	const char* m_trace_name {nullptr};
+	std::uint64_t m_trace_id {0};
 };
 
 #endif /* SRC_UTILS_STOPWATCH_H_ */
@@ -0,0 +1,388 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Trace.cpp
+ * Implementation of Trace.
+ */
+
+#include "Trace.h"
+
+// Std C++
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+// Qt
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QThread>
+
+// Ours
+#include <utils/DebugHelpers.h>
+
+
+namespace Trace_detail
+{
+	std::atomic_bool g_enabled {false};
+}
+
+namespace
+{
+	using Trace_detail::Arg;
+
+	struct Event
+	{
+		const char* m_name;
+		std::int64_t m_ts_ns;
+		/// Complete events only.
+		std::int64_t m_dur_ns;
+		/// Async events only.
+		std::uint64_t m_id;
+		/// The Chrome trace event phase: 'X' complete, 'i' instant, 'C' counter, 'b'/'e' async begin/end.
+		char m_phase;
+		int m_num_args;
+		std::array<Arg, Trace::c_max_span_args> m_args;
+	};
+
+	/**
+	 * One thread's events.  The mutex is only ever contended by writeChromeTrace() and clear().
+	 * Held by the registry as well as the thread, so it outlives the thread.
+	 */
+	struct ThreadBuffer
+	{
+		std::mutex m_mutex;
+		int m_tid {0};
+		QString m_thread_name;
+		std::vector<Event> m_events;
+		std::size_t m_num_dropped {0};
+	};
+
+	struct Registry
+	{
+		std::mutex m_mutex;
+		std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+		int m_next_tid {1};
+		std::unordered_set<std::string> m_interned;
+		QString m_exit_trace_path;
+		std::atomic<std::uint64_t> m_next_async_id {1};
+	};
+
+	Registry& registry()
+	{
+		static Registry the_registry;
+		return the_registry;
+	}
+
+	thread_local std::shared_ptr<ThreadBuffer> t_buffer;
+
+	ThreadBuffer& this_thread_buffer()
+	{
+		if(!t_buffer)
+		{
+			auto buffer = std::make_shared<ThreadBuffer>();
+			buffer->m_thread_name = QThread::currentThread()->objectName();
+
+			auto& r = registry();
+			std::scoped_lock lock(r.m_mutex);
+			buffer->m_tid = r.m_next_tid++;
+			if(buffer->m_thread_name.isEmpty())
+			{
+				buffer->m_thread_name = QString("Thread %1").arg(buffer->m_tid);
+			}
+			r.m_buffers.push_back(buffer);
+			t_buffer = std::move(buffer);
+		}
+		return *t_buffer;
+	}
+
+	void record(const Event& event)
+	{
+		ThreadBuffer& buffer = this_thread_buffer();
+		std::scoped_lock lock(buffer.m_mutex);
+		if(buffer.m_events.size() >= Trace::c_max_events_per_thread)
+		{
+			buffer.m_num_dropped++;
+			return;
+		}
+		buffer.m_events.push_back(event);
+	}
+
+	Event make_event(char phase, const char* name, std::int64_t ts_ns)
+	{
+		Event event;
+		event.m_name = name;
+		event.m_ts_ns = ts_ns;
+		event.m_dur_ns = 0;
+		event.m_id = 0;
+		event.m_phase = phase;
+		event.m_num_args = 0;
+		return event;
+	}
+
+	void append_json_string(QByteArray& out, const char* str)
+	{
+		out += '"';
+		for(const char* c = str; *c != '\0'; ++c)
+		{
+			switch(*c)
+			{
+			case '"':
+				out += "\\\"";
+				break;
+			case '\\':
+				out += "\\\\";
+				break;
+			case '\n':
+				out += "\\n";
+				break;
+			case '\t':
+				out += "\\t";
+				break;
+			default:
+				if(static_cast<unsigned char>(*c) < 0x20)
+				{
+					out += QByteArray("\\u00") + QByteArray::number(static_cast<unsigned char>(*c), 16).rightJustified(2, '0');
+				}
+				else
+				{
+					out += *c;
+				}
+				break;
+			}
+		}
+		out += '"';
+	}
+
+	/// Chrome traces are in microseconds.
+	QByteArray us(std::int64_t ns)
+	{
+		return QByteArray::number(static_cast<double>(ns) / 1000.0, 'f', 3);
+	}
+}
+
+void Trace::enable()
+{
+	Trace_detail::g_enabled = true;
+}
+
+void Trace::disable()
+{
+	Trace_detail::g_enabled = false;
+}
+
+void Trace::clear()
+{
+	auto& r = registry();
+	std::scoped_lock lock(r.m_mutex);
+	for(const auto& buffer : r.m_buffers)
+	{
+		std::scoped_lock buffer_lock(buffer->m_mutex);
+		buffer->m_events.clear();
+		buffer->m_num_dropped = 0;
+	}
+}
+
+void Trace::Span::end()
+{
+	Event event = make_event('X', m_name, Trace_detail::to_ns(m_start));
+	event.m_dur_ns = Trace_detail::to_ns(std::chrono::steady_clock::now()) - event.m_ts_ns;
+	event.m_num_args = m_num_args;
+	std::copy_n(m_args.cbegin(), m_num_args, event.m_args.begin());
+	record(event);
+}
+
+void Trace::complete(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	if(!isEnabled())
+	{
+		return;
+	}
+	Event event = make_event('X', name, Trace_detail::to_ns(start));
+	event.m_dur_ns = Trace_detail::to_ns(end) - event.m_ts_ns;
+	record(event);
+}
+
+void Trace::instant(const char* name)
+{
+	if(!isEnabled())
+	{
+		return;
+	}
+	record(make_event('i', name, Trace_detail::to_ns(std::chrono::steady_clock::now())));
+}
+
+void Trace::counter(const char* name, std::int64_t value)
+{
+	if(!isEnabled())
+	{
+		return;
+	}
+	Event event = make_event('C', name, Trace_detail::to_ns(std::chrono::steady_clock::now()));
+	event.m_num_args = 1;
+	event.m_args[0] = {"value", value};
+	record(event);
+}
+
+std::uint64_t Trace::newAsyncId()
+{
+	return registry().m_next_async_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Trace::asyncBegin(const char* name, std::uint64_t id, std::chrono::steady_clock::time_point at)
+{
+	if(!isEnabled())
+	{
+		return;
+	}
+	Event event = make_event('b', name, Trace_detail::to_ns(at));
+	event.m_id = id;
+	record(event);
+}
+
+void Trace::asyncEnd(const char* name, std::uint64_t id, std::chrono::steady_clock::time_point at)
+{
+	if(!isEnabled())
+	{
+		return;
+	}
+	Event event = make_event('e', name, Trace_detail::to_ns(at));
+	event.m_id = id;
+	record(event);
+}
+
+const char* Trace::intern(const std::string& str)
+{
+	auto& r = registry();
+	std::scoped_lock lock(r.m_mutex);
+	// Node-based, so the strings never move.
+	return r.m_interned.insert(str).first->c_str();
+}
+
+bool Trace::writeChromeTrace(const QString& file_path)
+{
+	auto& r = registry();
+	const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+	QByteArray out;
+	out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"args\":{\"name\":";
+	append_json_string(out, QCoreApplication::applicationName().toUtf8().constData());
+	out += "}}";
+
+	std::size_t num_events = 0;
+	std::size_t num_dropped = 0;
+	{
+		std::scoped_lock lock(r.m_mutex);
+
+		// Time zero is the earliest event.
+		std::int64_t origin_ns = std::numeric_limits<std::int64_t>::max();
+		for(const auto& buffer : r.m_buffers)
+		{
+			std::scoped_lock buffer_lock(buffer->m_mutex);
+			for(const Event& event : buffer->m_events)
+			{
+				origin_ns = std::min(origin_ns, event.m_ts_ns);
+			}
+		}
+
+		for(const auto& buffer : r.m_buffers)
+		{
+			std::scoped_lock buffer_lock(buffer->m_mutex);
+			const QByteArray tid = QByteArray::number(buffer->m_tid);
+
+			out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":";
+			append_json_string(out, buffer->m_thread_name.toUtf8().constData());
+			out += "}}";
+
+			for(const Event& event : buffer->m_events)
+			{
+				out += ",\n{\"name\":";
+				append_json_string(out, event.m_name);
+				out += ",\"cat\":\"amlm\",\"ph\":\"";
+				out += event.m_phase;
+				out += "\",\"ts\":" + us(event.m_ts_ns - origin_ns) + ",\"pid\":" + pid + ",\"tid\":" + tid;
+				switch(event.m_phase)
+				{
+				case 'X':
+					out += ",\"dur\":" + us(event.m_dur_ns);
+					break;
+				case 'i':
+					out += ",\"s\":\"t\"";
+					break;
+				case 'b':
+				case 'e':
+					out += ",\"id\":\"0x" + QByteArray::number(static_cast<qulonglong>(event.m_id), 16) + '"';
+					break;
+				default:
+					break;
+				}
+				if(event.m_num_args > 0)
+				{
+					out += ",\"args\":{";
+					for(int i = 0; i < event.m_num_args; ++i)
+					{
+						if(i > 0)
+						{
+							out += ',';
+						}
+						append_json_string(out, event.m_args[i].m_name);
+						out += ':' + QByteArray::number(static_cast<qlonglong>(event.m_args[i].m_value));
+					}
+					out += '}';
+				}
+				out += '}';
+			}
+			num_events += buffer->m_events.size();
+			num_dropped += buffer->m_num_dropped;
+		}
+	}
+	out += "\n]}\n";
+
+	QSaveFile file(file_path);
+	if(!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit())
+	{
+		qWr() << "Couldn't write trace to" << file_path << ":" << file.errorString();
+		return false;
+	}
+
+	qIn() << "Wrote" << num_events << "trace events to" << file_path;
+	if(num_dropped > 0)
+	{
+		qWr() << "Dropped" << num_dropped << "trace events, over" << c_max_events_per_thread << "on a thread";
+	}
+	return true;
+}
+
+QString Trace::exitTracePath()
+{
+	auto& r = registry();
+	std::scoped_lock lock(r.m_mutex);
+	return r.m_exit_trace_path;
+}
+
+void Trace::setExitTracePath(const QString& file_path)
+{
+	auto& r = registry();
+	std::scoped_lock lock(r.m_mutex);
+	r.m_exit_trace_path = file_path;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Trace.h
+ * Interface of Trace, a timeline of what ran on which thread, exportable as Chrome trace event JSON.
+ */
+#ifndef SRC_UTILS_TRACE_H_
+#define SRC_UTILS_TRACE_H_
+
+// Std C++
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Qt
+#include <QString>
+
+// Ours
+#include <future/guideline_helpers.h>
+
+
+namespace Trace_detail
+{
+	/// Only read through Trace::isEnabled().
+	extern std::atomic_bool g_enabled;
+
+	inline std::int64_t to_ns(std::chrono::steady_clock::time_point tp)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+	}
+
+	struct Arg
+	{
+		const char* m_name;
+		std::int64_t m_value;
+	};
+}
+
+/**
+ * Timeline tracing: which spans of work ran on which thread when, how they nest, with a few counters on each.
+ *
+ * Everything's recorded into a buffer per thread, so recording doesn't contend with the other threads, and
+ * writeChromeTrace() writes it all out as Chrome trace event JSON, for chrome://tracing or ui.perfetto.dev.
+ * Stopwatch and StartupProfiler record into it as well, the Stopwatches as async spans with their laps nested in them.
+ *
+ * Off by default.  Turned on by enable(), the AMLM_TRACE environment variable or the --trace command line option.
+ * When it's off, a Span costs one relaxed atomic load.
+ *
+ * Names are const char*s which have to live as long as the trace, i.e. string literals.  intern() anything else.
+ *
+ * All static, threadsafe.
+ */
+class Trace
+{
+public:
+	static bool isEnabled() { return Trace_detail::g_enabled.load(std::memory_order_relaxed); }
+	static void enable();
+	static void disable();
+	/// Drop everything recorded so far.
+	static void clear();
+
+	/// Counters per Span, any more are dropped.
+	static constexpr int c_max_span_args = 4;
+	/// Events per thread, any more are dropped and counted.
+	static constexpr std::size_t c_max_events_per_thread = 1 << 20;
+
+	/**
+	 * Scoped span of work on this thread.  Spans in spans nest.
+	 */
+	class Span
+	{
+	public:
+		M_GH_DELETE_COPY_AND_MOVE(Span)
+
+		explicit Span(const char* name) : m_name(isEnabled() ? name : nullptr)
+		{
+			if(m_name != nullptr)
+			{
+				m_start = std::chrono::steady_clock::now();
+			}
+		}
+		~Span()
+		{
+			if(m_name != nullptr)
+			{
+				end();
+			}
+		}
+
+		/// Attach a counter to this span, e.g. the number of files it handled.
+		void counter(const char* name, std::int64_t value)
+		{
+			if(m_name != nullptr && m_num_args < c_max_span_args)
+			{
+				m_args[m_num_args++] = {name, value};
+			}
+		}
+
+	private:
+		void end();
+
+		const char* m_name;
+		std::chrono::steady_clock::time_point m_start;
+		int m_num_args {0};
+		std::array<Trace_detail::Arg, c_max_span_args> m_args;
+	};
+
+	/// A span from @a start to @a end on this thread, for one which has already been timed.
+	static void complete(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+	/// A point in time on this thread.
+	static void instant(const char* name);
+
+	/// A value on its own track, e.g. a queue depth.
+	static void counter(const char* name, std::int64_t value);
+
+	/// @name Async spans, for ones which can begin on one thread and end on another.  Matched by @a name and @a id.
+	/// @{
+	static std::uint64_t newAsyncId();
+	static void asyncBegin(const char* name, std::uint64_t id, std::chrono::steady_clock::time_point at);
+	static void asyncEnd(const char* name, std::uint64_t id, std::chrono::steady_clock::time_point at);
+	/// @}
+
+	/// A copy of @a str which lives as long as the process, for names which aren't literals.
+	static const char* intern(const std::string& str);
+
+	/// Write everything recorded so far to @a file_path as Chrome trace event JSON.
+	static bool writeChromeTrace(const QString& file_path);
+
+	/// Where the trace is written at exit, empty for nowhere.
+	static QString exitTracePath();
+	static void setExitTracePath(const QString& file_path);
+};
+
+#endif /* SRC_UTILS_TRACE_H_ */
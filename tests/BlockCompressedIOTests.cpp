@@ -0,0 +1,311 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#include "BlockCompressedIOTests.h"
+
+// Std C++
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QBuffer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QUrl>
+
+// Ours
+#include <logic/serialization/BlockCompressedIO.h>
+#include <logic/serialization/ISerializable.h>
+#include <logic/serialization/XmlSerializer.h>
+
+/// Small blocks, so the tests have a few of them without needing megabytes of data.
+static constexpr qsizetype c_test_block_size = 1000;
+
+namespace
+{
+	/// For load_split() tests which only care about the split elements.
+	class IgnoresSkeleton : public ISerializable
+	{
+	public:
+		QVariant toVariant() const override { return {}; }
+		void fromVariant(const QVariant&) override {}
+		void fromXmlStream(XmlStreamReadVisitor&) override {}
+	};
+
+	/// A document with two runs of @a num_items split elements each, which are long enough that many straddle blocks.
+	QByteArray split_test_document(int num_items)
+	{
+		QByteArray retval = "<?xml version=\"1.0\"?>\n<root><list>\n";
+		for(int run = 0; run < 2; ++run)
+		{
+			for(int i = 0; i < num_items; ++i)
+			{
+				retval += "<item n=\"" + QByteArray::number(i) + "\">" + QByteArray(37 + i % 50, 'a' + run) + "</item>\n";
+			}
+			// Not whitespace, so the next item starts a new run.
+			retval += "<separator/>\n";
+		}
+		retval += "</list></root>\n";
+		return retval;
+	}
+
+	struct SplitResults
+	{
+		std::vector<std::size_t> m_run_sizes;
+		std::map<std::pair<std::size_t, std::size_t>, QByteArray> m_items;
+	};
+
+	bool load_split_file(const QString& file_path, SplitResults* results)
+	{
+		IgnoresSkeleton skeleton;
+		std::mutex items_mutex;
+		XmlSerializer xmlser;
+		return xmlser.load_split(skeleton, QUrl::fromLocalFile(file_path), "item",
+				[&](const std::vector<std::size_t>& run_sizes){ results->m_run_sizes = run_sizes; },
+				[&](std::size_t run, std::size_t index, QByteArrayView item_xml){
+					std::scoped_lock lock(items_mutex);
+					results->m_items[{run, index}] = item_xml.toByteArray();
+				});
+	}
+
+	void write_file(const QString& file_path, const QByteArray& contents)
+	{
+		QFile file(file_path);
+		ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+		ASSERT_EQ(file.write(contents), contents.size());
+	}
+}
+
+QByteArray BlockCompressedIOTests::compress(const QByteArray& uncompressed, qsizetype block_size) const
+{
+	QBuffer sink;
+	EXPECT_TRUE(sink.open(QIODevice::WriteOnly));
+	BlockCompressedWriter writer(&sink, -1, block_size);
+	const QString no_error = writer.errorString();
+	EXPECT_TRUE(writer.open(QIODevice::WriteOnly));
+	// Write it in uneven pieces so that writes straddle block boundaries.
+	for(qsizetype pos = 0; pos < uncompressed.size(); pos += 333)
+	{
+		const QByteArray piece = uncompressed.mid(pos, 333);
+		EXPECT_EQ(writer.write(piece), piece.size());
+	}
+	writer.close();
+	EXPECT_EQ(writer.errorString(), no_error);
+	return sink.data();
+}
+
+bool BlockCompressedIOTests::read_with_reader(const QByteArray& compressed, QByteArray* out) const
+{
+	QBuffer source;
+	source.setData(compressed);
+	EXPECT_TRUE(source.open(QIODevice::ReadOnly));
+	BlockCompressedReader reader(&source);
+	const QString no_error = reader.errorString();
+	if(!reader.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+	*out = reader.readAll();
+	// The reader only hits the end marker cleanly if it didn't have to set an error.
+	return reader.errorString() == no_error;
+}
+
+QByteArray BlockCompressedIOTests::test_data(qsizetype size) const
+{
+	QByteArray retval;
+	retval.reserve(size);
+	quint32 x = 12345;
+	while(retval.size() < size)
+	{
+		// A little LCG noise in among the repetition.
+		x = x * 1103515245 + 12345;
+		retval.append(QByteArrayLiteral("<entry url=\"file:///music/"));
+		retval.append(QByteArray::number(x >> 16));
+		retval.append(QByteArrayLiteral(".flac\"/>\n"));
+	}
+	retval.truncate(size);
+	return retval;
+}
+
+TEST_F(BlockCompressedIOTests, RoundTrip)
+{
+	for(const qsizetype size : {qsizetype(0), qsizetype(1), c_test_block_size - 1, c_test_block_size,
+			c_test_block_size + 1, 10 * c_test_block_size + 7})
+	{
+		SCOPED_TRACE(size);
+		const QByteArray uncompressed = test_data(size);
+		const QByteArray compressed = compress(uncompressed, c_test_block_size);
+		ASSERT_TRUE(BlockCompressedFormat::detect(compressed));
+
+		QByteArray decompressed;
+		ASSERT_TRUE(BlockCompressedFormat::decompress_all(compressed, &decompressed));
+		EXPECT_EQ(decompressed, uncompressed);
+
+		QByteArray streamed;
+		ASSERT_TRUE(read_with_reader(compressed, &streamed));
+		EXPECT_EQ(streamed, uncompressed);
+	}
+}
+
+TEST_F(BlockCompressedIOTests, BadMagicIsRejected)
+{
+	QByteArray compressed = compress(test_data(100), c_test_block_size);
+	compressed[0] = 'X';
+	EXPECT_FALSE(BlockCompressedFormat::detect(compressed));
+
+	QByteArray out;
+	EXPECT_FALSE(BlockCompressedFormat::decompress_all(compressed, &out));
+	EXPECT_FALSE(read_with_reader(compressed, &out));
+}
+
+TEST_F(BlockCompressedIOTests, TruncatedDataFails)
+{
+	const QByteArray compressed = compress(test_data(5 * c_test_block_size), c_test_block_size);
+
+	// Cut it off everywhere from just after the magic to just before the last byte of the end marker.
+	for(qsizetype size = BlockCompressedFormat::c_magic.size(); size < compressed.size(); ++size)
+	{
+		SCOPED_TRACE(size);
+		QByteArray out;
+		EXPECT_FALSE(BlockCompressedFormat::decompress_all(compressed.left(size), &out));
+		EXPECT_FALSE(read_with_reader(compressed.left(size), &out));
+	}
+}
+
+TEST_F(BlockCompressedIOTests, HugeUncompressedSizeIsRejected)
+{
+	QByteArray compressed = compress(test_data(3 * c_test_block_size), c_test_block_size);
+
+	// Claim the first block is 4 GiB - 1, and that its qCompress() output says so too.  Both readers have to refuse
+	// this off the header alone, not try to allocate it.
+	const qsizetype first_header_pos = BlockCompressedFormat::c_magic.size();
+	const qsizetype first_block_pos = first_header_pos + BlockCompressedFormat::c_block_header_size;
+	qToBigEndian<quint32>(0xFFFFFFFF, compressed.data() + first_header_pos);
+	qToBigEndian<quint32>(0xFFFFFFFF, compressed.data() + first_block_pos);
+
+	QByteArray out;
+	EXPECT_FALSE(BlockCompressedFormat::decompress_all(compressed, &out));
+	EXPECT_TRUE(out.isEmpty());
+	EXPECT_FALSE(read_with_reader(compressed, &out));
+}
+
+TEST_F(BlockCompressedIOTests, HugeCompressedSizeIsRejected)
+{
+	QByteArray compressed = compress(test_data(3 * c_test_block_size), c_test_block_size);
+
+	const qsizetype first_header_pos = BlockCompressedFormat::c_magic.size();
+	qToBigEndian<quint32>(0xFFFFFFF0, compressed.data() + first_header_pos + 4);
+
+	QByteArray out;
+	EXPECT_FALSE(BlockCompressedFormat::decompress_all(compressed, &out));
+	EXPECT_FALSE(read_with_reader(compressed, &out));
+}
+
+TEST_F(BlockCompressedIOTests, MismatchedSizesAreRejected)
+{
+	QByteArray compressed = compress(test_data(3 * c_test_block_size), c_test_block_size);
+
+	// A sane-looking header which disagrees with the block's own size prefix.
+	const qsizetype first_header_pos = BlockCompressedFormat::c_magic.size();
+	qToBigEndian<quint32>(c_test_block_size / 2, compressed.data() + first_header_pos);
+
+	QByteArray out;
+	EXPECT_FALSE(BlockCompressedFormat::decompress_all(compressed, &out));
+	EXPECT_FALSE(read_with_reader(compressed, &out));
+}
+
+TEST_F(BlockCompressedIOTests, CorruptBlockFails)
+{
+	const QByteArray compressed = compress(test_data(3 * c_test_block_size), c_test_block_size);
+
+	// Flip a byte in the zlib stream of the first block, past its size prefix and zlib header.
+	QByteArray corrupt = compressed;
+	const qsizetype first_block_pos = BlockCompressedFormat::c_magic.size() + BlockCompressedFormat::c_block_header_size;
+	corrupt[first_block_pos + 10] = char(corrupt[first_block_pos + 10] ^ 0x55);
+
+	QByteArray out;
+	EXPECT_FALSE(BlockCompressedFormat::decompress_all(corrupt, &out));
+	EXPECT_TRUE(out.isEmpty());
+	EXPECT_FALSE(read_with_reader(corrupt, &out));
+}
+
+TEST_F(BlockCompressedIOTests, BlocksDecompressOneAtATime)
+{
+	const QByteArray uncompressed = test_data(10 * c_test_block_size + 7);
+	const QByteArray compressed = compress(uncompressed, c_test_block_size);
+
+	std::vector<BlockCompressedFormat::Block> blocks;
+	ASSERT_TRUE(BlockCompressedFormat::index_blocks(compressed, &blocks));
+	ASSERT_EQ(blocks.size(), 11u);
+
+	QByteArray decompressed;
+	for(const auto& block : blocks)
+	{
+		EXPECT_EQ(block.m_uncompressed_pos, decompressed.size());
+		ASSERT_TRUE(BlockCompressedFormat::decompress_block(compressed, block, &decompressed));
+	}
+	EXPECT_EQ(decompressed, uncompressed);
+
+	EXPECT_FALSE(BlockCompressedFormat::index_blocks(compressed.left(compressed.size() - 1), &blocks));
+	EXPECT_TRUE(blocks.empty());
+}
+
+TEST_F(BlockCompressedIOTests, LoadSplitOfCompressedFileMatchesUncompressed)
+{
+	QTemporaryDir temp_dir;
+	ASSERT_TRUE(temp_dir.isValid());
+	const QByteArray document = split_test_document(300);
+	write_file(temp_dir.filePath("plain.xml"), document);
+	// Blocks much smaller than the elements are long, so lots of them straddle blocks.
+	write_file(temp_dir.filePath("compressed.xml"), compress(document, 64));
+
+	SplitResults plain;
+	ASSERT_TRUE(load_split_file(temp_dir.filePath("plain.xml"), &plain));
+	EXPECT_THAT(plain.m_run_sizes, ::testing::ElementsAre(300u, 300u));
+	ASSERT_EQ(plain.m_items.size(), 600u);
+	EXPECT_EQ(plain.m_items[{1, 299}], "<item n=\"299\">" + QByteArray(37 + 299 % 50, 'b') + "</item>");
+
+	SplitResults compressed;
+	ASSERT_TRUE(load_split_file(temp_dir.filePath("compressed.xml"), &compressed));
+	EXPECT_EQ(compressed.m_run_sizes, plain.m_run_sizes);
+	EXPECT_EQ(compressed.m_items, plain.m_items);
+}
+
+TEST_F(BlockCompressedIOTests, LoadSplitOfCorruptFileFails)
+{
+	QTemporaryDir temp_dir;
+	ASSERT_TRUE(temp_dir.isValid());
+	QByteArray compressed = compress(split_test_document(100), c_test_block_size);
+
+	// Corrupt the zlib stream of a block in the middle, which the headers can't show.
+	std::vector<BlockCompressedFormat::Block> blocks;
+	ASSERT_TRUE(BlockCompressedFormat::index_blocks(compressed, &blocks));
+	ASSERT_GT(blocks.size(), 2u);
+	const qsizetype corrupt_pos = blocks[blocks.size() / 2].m_compressed_pos + 10;
+	compressed[corrupt_pos] = char(compressed[corrupt_pos] ^ 0x55);
+	write_file(temp_dir.filePath("corrupt.xml"), compressed);
+
+	SplitResults results;
+	EXPECT_FALSE(load_split_file(temp_dir.filePath("corrupt.xml"), &results));
+}
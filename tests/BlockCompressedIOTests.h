@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLOCKCOMPRESSEDIOTESTS_H
+#define BLOCKCOMPRESSEDIOTESTS_H
+
+/// @file
+
+// Qt
+#include <QByteArray>
+
+// Google Test
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+class BlockCompressedIOTests : public ::testing::Test
+{
+	public:
+
+ 	protected:
+
+	/// Block-compress @a uncompressed with BlockCompressedWriter, in blocks of @a block_size.
+	QByteArray compress(const QByteArray& uncompressed, qsizetype block_size) const;
+
+	/// Read all of @a compressed back through a BlockCompressedReader.  Returns false if the reader reported an error.
+	bool read_with_reader(const QByteArray& compressed, QByteArray* out) const;
+
+	/// Some uncompressed data which compresses, but not to nothing.
+	QByteArray test_data(qsizetype size) const;
+};
+
+#endif //BLOCKCOMPRESSEDIOTESTS_H
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#include "CollectionStoreTests.h"
+
+// Std C++
+#include <vector>
+
+// Qt
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+
+// Ours
+#include <logic/LibraryEntry.h>
+#include <logic/models/ScanResultsTreeModel.h>
+#include <logic/models/SRTMItemLibEntry.h>
+
+/// A LibraryEntry which is populated without reading its file.
+class PopulatedEntry : public LibraryEntry
+{
+public:
+	PopulatedEntry(const QUrl& url, int track_number, qint64 file_size, const QDateTime& file_mtime,
+				   qint64 length_frames = 0) : LibraryEntry(url)
+	{
+		m_is_populated = true;
+		m_track_number = track_number;
+		m_length_frames = length_frames;
+		m_populated_file_size = file_size;
+		m_populated_file_mtime = file_mtime;
+	}
+};
+
+void CollectionStoreTests::SetUp()
+{
+	ASSERT_TRUE(m_temp_dir.isValid());
+}
+
+QUrl CollectionStoreTests::write_file(const QString& name, const QByteArray& contents) const
+{
+	const QString file_path = m_temp_dir.filePath(name);
+	QFile file(file_path);
+	EXPECT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+	EXPECT_EQ(file.write(contents), contents.size());
+	return QUrl::fromLocalFile(file_path);
+}
+
+DirScanResult CollectionStoreTests::scan(const QUrl& url) const
+{
+	return DirScanResult(url, QFileInfo(url.toLocalFile()));
+}
+
+std::shared_ptr<LibraryEntry> CollectionStoreTests::read_entry(const QUrl& url, int track_number, qint64 length_frames) const
+{
+	const QFileInfo file_info(url.toLocalFile());
+	return std::make_shared<PopulatedEntry>(url, track_number, file_info.size(), file_info.lastModified(), length_frames);
+}
+
+QStringList CollectionStoreTests::flush(CollectionStore& store) const
+{
+	QSignalSpy changed_spy(&store, &CollectionStore::SIGNAL_changed);
+	store.flushChanges();
+	QStringList retval;
+	for(const auto& args : changed_spy)
+	{
+		retval << args.at(0).toStringList();
+	}
+	return retval;
+}
+
+TEST_F(CollectionStoreTests, LibrariesShareEntries)
+{
+	CollectionStore store;
+	const QUrl url = write_file("a.flac", "a");
+
+	auto first = store.intern(read_entry(url), CollectionStore::InternMode::PreferExisting);
+	auto second = store.intern(read_entry(url), CollectionStore::InternMode::PreferExisting);
+	EXPECT_EQ(second, first);
+
+	// A different track of the same file isn't the same entry.
+	auto other_track = read_entry(url, 2);
+	EXPECT_EQ(store.intern(other_track, CollectionStore::InternMode::PreferExisting), other_track);
+
+	EXPECT_THAT(flush(store), ::testing::ElementsAre(CollectionStore::fileKey(url)));
+	ASSERT_TRUE(store.file(CollectionStore::fileKey(url)));
+	EXPECT_EQ(store.file(CollectionStore::fileKey(url))->m_entries.size(), 2u);
+}
+
+TEST_F(CollectionStoreTests, ReplacementsAreReported)
+{
+	CollectionStore store;
+	const QUrl url = write_file("a.flac", "a");
+
+	// One library has the entry, another one replaces it.
+	auto old_entry = store.intern(read_entry(url), CollectionStore::InternMode::PreferExisting);
+	flush(store);
+	auto new_entry = store.intern(read_entry(url), CollectionStore::InternMode::Replace);
+
+	CollectionStore::Replacements replacements;
+	connect(&store, &CollectionStore::SIGNAL_entriesReplaced, &store, [&](const CollectionStore::Replacements& r){
+		replacements = r;
+	});
+	EXPECT_THAT(flush(store), ::testing::ElementsAre(CollectionStore::fileKey(url)));
+
+	ASSERT_EQ(replacements.size(), 1u);
+	EXPECT_EQ(replacements[0].first, old_entry);
+	EXPECT_EQ(replacements[0].second, new_entry);
+
+	// And anybody loading it now gets the new one.
+	EXPECT_EQ(store.intern(read_entry(url), CollectionStore::InternMode::PreferExisting), new_entry);
+}
+
+TEST_F(CollectionStoreTests, OnlyUnchangedFilesAreReused)
+{
+	CollectionStore store;
+	const QUrl url = write_file("a.flac", "a");
+	store.addScanResult(scan(url));
+
+	auto entry = store.intern(read_entry(url), CollectionStore::InternMode::PreferExisting);
+	EXPECT_TRUE(store.isCurrent(*entry));
+	EXPECT_THAT(store.populatedEntries(url), ::testing::ElementsAre(entry));
+
+	// The file changes, and the next scan sees that.
+	write_file("a.flac", "changed");
+	QFile file(url.toLocalFile());
+	ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+	ASSERT_TRUE(file.setFileTime(QFileInfo(file).lastModified().addSecs(10), QFileDevice::FileModificationTime));
+	file.close();
+	store.addScanResult(scan(url));
+
+	EXPECT_FALSE(store.isCurrent(*entry));
+	EXPECT_TRUE(store.populatedEntries(url).empty());
+}
+
+TEST_F(CollectionStoreTests, EntriesFromASavedLibraryAreNotCurrent)
+{
+	CollectionStore store;
+	const QUrl url = write_file("a.flac", "a");
+	store.addScanResult(scan(url));
+
+	// It doesn't know what the file looked like when it was read.
+	auto entry = store.intern(std::make_shared<PopulatedEntry>(url, 0, -1, QDateTime()),
+							  CollectionStore::InternMode::PreferExisting);
+	EXPECT_FALSE(store.isCurrent(*entry));
+	EXPECT_TRUE(store.populatedEntries(url).empty());
+}
+
+TEST_F(CollectionStoreTests, UnchangedRescanIsNotSignaled)
+{
+	CollectionStore store;
+	const QUrl url = write_file("a.flac", "a");
+	store.addScanResult(scan(url));
+	auto entry = store.intern(read_entry(url), CollectionStore::InternMode::PreferExisting);
+	EXPECT_THAT(flush(store), ::testing::ElementsAre(CollectionStore::fileKey(url)));
+
+	// Rescanned, nothing's changed.
+	store.addScanResult(scan(url));
+	EXPECT_TRUE(flush(store).isEmpty());
+	EXPECT_TRUE(store.isCurrent(*entry));
+}
+
+TEST_F(CollectionStoreTests, RereadWithSameContentKeepsTheEntry)
+{
+	CollectionStore store;
+	const QUrl url = write_file("a.flac", "a");
+	store.addScanResult(scan(url));
+
+	// From a saved library, so not current until it's been re-read.
+	auto entry = store.intern(std::make_shared<PopulatedEntry>(url, 0, -1, QDateTime()),
+							  CollectionStore::InternMode::PreferExisting);
+	flush(store);
+	ASSERT_FALSE(store.isCurrent(*entry));
+
+	store.refreshPopulatedFrom(*entry, *read_entry(url));
+	EXPECT_TRUE(store.isCurrent(*entry));
+	EXPECT_THAT(store.populatedEntries(url), ::testing::ElementsAre(entry));
+	EXPECT_TRUE(flush(store).isEmpty());
+}
+
+TEST_F(CollectionStoreTests, ReleasedFilesArePruned)
+{
+	CollectionStore store;
+	const QUrl kept_url = write_file("kept.flac", "k");
+	const QUrl dropped_url = write_file("dropped.flac", "d");
+	const QUrl scanned_url = write_file("scanned.flac", "s");
+
+	auto kept = store.intern(read_entry(kept_url), CollectionStore::InternMode::PreferExisting);
+	auto dropped = store.intern(read_entry(dropped_url), CollectionStore::InternMode::PreferExisting);
+	// Scanned, but the model hasn't added it yet.
+	store.addScanResult(scan(scanned_url));
+	flush(store);
+	EXPECT_EQ(store.numFileRecords(), 3);
+
+	dropped.reset();
+	store.entriesReleased();
+	EXPECT_THAT(flush(store), ::testing::ElementsAre(CollectionStore::fileKey(dropped_url)));
+
+	EXPECT_EQ(store.numFileRecords(), 2);
+	EXPECT_FALSE(store.file(CollectionStore::fileKey(dropped_url)));
+	EXPECT_TRUE(store.file(CollectionStore::fileKey(kept_url)));
+}
+
+TEST_F(CollectionStoreTests, TreeModelFollowsChanges)
+{
+	CollectionStore store;
+	auto model = ScanResultsTreeModel::create({});
+	QSignalSpy reset_spy(model.get(), &QAbstractItemModel::modelReset);
+	QSignalSpy inserted_spy(model.get(), &QAbstractItemModel::rowsInserted);
+	QSignalSpy removed_spy(model.get(), &QAbstractItemModel::rowsRemoved);
+
+	const QUrl b_url = write_file("b.flac", "b");
+	const QUrl a_url = write_file("a.flac", "a");
+	auto b_entry = store.intern(read_entry(b_url), CollectionStore::InternMode::PreferExisting);
+	auto a_entry = store.intern(read_entry(a_url), CollectionStore::InternMode::PreferExisting);
+	model->applyCollectionStoreChanges(store, flush(store));
+
+	// One row per file in key order, each with its track.
+	ASSERT_EQ(model->rowCount(), 2);
+	EXPECT_EQ(model->getItem(model->index(0, 0))->childCount(), 1);
+	auto first_file = std::dynamic_pointer_cast<ScanResultsTreeModelItem>(model->getItem(model->index(0, 0)));
+	ASSERT_TRUE(first_file);
+	EXPECT_EQ(QUrl(first_file->getDsr().getMediaExtUrl()), a_url);
+
+	// Replacing a's entry with one that reads the same just swaps it in, no rows come or go.
+	inserted_spy.clear();
+	auto same_a_entry = store.intern(read_entry(a_url), CollectionStore::InternMode::Replace);
+	model->applyCollectionStoreChanges(store, flush(store));
+	EXPECT_EQ(inserted_spy.size(), 0);
+	EXPECT_EQ(removed_spy.size(), 0);
+	auto a_track = std::dynamic_pointer_cast<SRTMItem_LibEntry>(first_file->child(0));
+	ASSERT_TRUE(a_track);
+	EXPECT_EQ(a_track->getLibraryEntry(), same_a_entry);
+
+	// Replacing it with a different one only touches a's track row.
+	auto new_a_entry = store.intern(read_entry(a_url, 0, 588), CollectionStore::InternMode::Replace);
+	model->applyCollectionStoreChanges(store, flush(store));
+	ASSERT_EQ(model->rowCount(), 2);
+	ASSERT_EQ(inserted_spy.size(), 1);
+	EXPECT_EQ(qvariant_cast<QModelIndex>(inserted_spy[0][0]), model->index(0, 0));
+
+	// Dropping b removes its row.
+	b_entry.reset();
+	store.entriesReleased();
+	model->applyCollectionStoreChanges(store, flush(store));
+	EXPECT_EQ(model->rowCount(), 1);
+	EXPECT_EQ(model->getItem(model->index(0, 0)), std::static_pointer_cast<AbstractTreeModelItem>(first_file));
+
+	EXPECT_EQ(reset_spy.size(), 0);
+}
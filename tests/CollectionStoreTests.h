@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COLLECTIONSTORETESTS_H
+#define COLLECTIONSTORETESTS_H
+
+/// @file
+
+// Std C++
+#include <memory>
+
+// Qt
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QUrl>
+
+// Google Test
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+// Ours
+#include <logic/CollectionStore.h>
+class LibraryEntry;
+
+class CollectionStoreTests : public ::testing::Test
+{
+	public:
+
+ 	protected:
+
+	void SetUp() override;
+
+	/// Create a file named @a name in the temp dir with contents @a contents, and return its URL.
+	QUrl write_file(const QString& name, const QByteArray& contents) const;
+
+	/// What a directory scan would report for the file at @a url as it is now.
+	DirScanResult scan(const QUrl& url) const;
+
+	/**
+	 * A populated entry for track @a track_number of the file at @a url, as if it had just been read from the file.
+	 * Give it a different @a length_frames for an entry with different content.
+	 */
+	std::shared_ptr<LibraryEntry> read_entry(const QUrl& url, int track_number = 0, qint64 length_frames = 0) const;
+
+	/// Flush @a store and return the file keys its SIGNAL_changed() reported.
+	QStringList flush(CollectionStore& store) const;
+
+	// Objects declared here can be used by all tests in this Fixture.
+
+	QTemporaryDir m_temp_dir;
+};
+
+#endif //COLLECTIONSTORETESTS_H
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#include "DirSummaryCacheTests.h"
+
+// Std C++
+#include <chrono>
+#include <memory>
+
+// Qt
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPromise>
+#include <QStandardPaths>
+
+// Ours
+#include <concurrency/BoundedChannel.h>
+#include <concurrency/CancellationToken.h>
+#include <concurrency/ProgressCounter.h>
+#include <logic/jobs/DirectoryScanJob.h>
+
+void DirSummaryCacheTests::SetUp()
+{
+	// Keep the summaries out of the real cache directory.
+	QStandardPaths::setTestModeEnabled(true);
+
+	ASSERT_TRUE(m_temp_dir.isValid());
+	m_root_path = m_temp_dir.filePath("music");
+	ASSERT_TRUE(QDir().mkpath(m_root_path));
+	m_root_url = QUrl::fromLocalFile(m_root_path);
+	m_aged_mtime = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+}
+
+void DirSummaryCacheTests::TearDown()
+{
+	QFile::remove(DirSummaryCache::cacheFileFor(m_root_url));
+	QStandardPaths::setTestModeEnabled(false);
+}
+
+void DirSummaryCacheTests::write_file(const QString& relative_path, const QByteArray& contents) const
+{
+	const QString file_path = m_root_path + u'/' + relative_path;
+	ASSERT_TRUE(QDir().mkpath(QFileInfo(file_path).absolutePath()));
+	QFile file(file_path);
+	ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+	ASSERT_EQ(file.write(contents), contents.size());
+}
+
+void DirSummaryCacheTests::age_tree() const
+{
+	namespace fs = std::filesystem;
+	const fs::path root(m_root_path.toStdString());
+	for(const auto& dir_entry : fs::recursive_directory_iterator(root))
+	{
+		fs::last_write_time(dir_entry.path(), m_aged_mtime);
+	}
+	fs::last_write_time(root, m_aged_mtime);
+}
+
+std::map<QString, DirScanResult> DirSummaryCacheTests::scan(DirSummaryCache::Mode mode) const
+{
+	QPromise<Unit> promise;
+	promise.start();
+	auto out_channel = std::make_shared<BoundedChannel<DirScanResult>>(1024);
+	DirScanIncrementalFunction(promise, out_channel, std::make_shared<ProgressCounter>(), CancellationToken(),
+							   m_root_url, {QStringLiteral("*.flac")}, mode);
+	promise.finish();
+	EXPECT_FALSE(out_channel->isCanceled());
+
+	std::map<QString, DirScanResult> retval;
+	const QDir root_dir(m_root_path);
+	for(const DirScanResult& dsr : out_channel->try_pop_batch(out_channel->size()))
+	{
+		retval.emplace(root_dir.relativeFilePath(QUrl(dsr.getMediaExtUrl()).toLocalFile()), dsr);
+	}
+	EXPECT_TRUE(out_channel->isDrained());
+	return retval;
+}
+
+TEST_F(DirSummaryCacheTests, SaveAndLoad)
+{
+	DirSummary summary;
+	summary.m_mtime_ns = 1234;
+	summary.m_inode = 5678;
+	summary.m_num_entries = 3;
+	summary.m_children_hash = dir_summary_hash_child(0, "a.flac", 10, 20);
+	summary.m_files = QStringList{"a.flac", "b.flac"};
+	summary.m_files_with_sidecar_cuesheet = QStringList{"b.flac"};
+	summary.m_subdirs = QStringList{"sub"};
+	summary.m_scanned_at_ns = 9999;
+
+	DirSummaryCache cache(m_root_url);
+	cache.record(m_root_path, summary);
+	cache.commitRecorded();
+	ASSERT_TRUE(cache.save());
+
+	DirSummaryCache loaded(m_root_url);
+	ASSERT_TRUE(loaded.load());
+	ASSERT_EQ(loaded.size(), 1);
+	const DirSummary* loaded_summary = loaded.find(m_root_path);
+	ASSERT_NE(loaded_summary, nullptr);
+	EXPECT_EQ(loaded_summary->m_mtime_ns, summary.m_mtime_ns);
+	EXPECT_EQ(loaded_summary->m_inode, summary.m_inode);
+	EXPECT_EQ(loaded_summary->m_num_entries, summary.m_num_entries);
+	EXPECT_EQ(loaded_summary->m_children_hash, summary.m_children_hash);
+	EXPECT_EQ(loaded_summary->m_files, summary.m_files);
+	EXPECT_EQ(loaded_summary->m_files_with_sidecar_cuesheet, summary.m_files_with_sidecar_cuesheet);
+	EXPECT_EQ(loaded_summary->m_subdirs, summary.m_subdirs);
+	EXPECT_EQ(loaded_summary->m_scanned_at_ns, summary.m_scanned_at_ns);
+
+	// Another root's summaries are somewhere else.
+	EXPECT_FALSE(DirSummaryCache(QUrl::fromLocalFile(m_temp_dir.path())).load());
+}
+
+TEST_F(DirSummaryCacheTests, CorruptFileIsAnEmptyCache)
+{
+	const QString cache_file = DirSummaryCache::cacheFileFor(m_root_url);
+	ASSERT_TRUE(QDir().mkpath(QFileInfo(cache_file).absolutePath()));
+	QFile file(cache_file);
+	ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+	file.write("not a summary file");
+	file.close();
+
+	DirSummaryCache cache(m_root_url);
+	EXPECT_FALSE(cache.load());
+	EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(DirSummaryCacheTests, CommitDropsDirectoriesNotSeen)
+{
+	DirSummaryCache cache(m_root_url);
+	cache.record("/a", DirSummary());
+	cache.record("/b", DirSummary());
+	cache.commitRecorded();
+	ASSERT_EQ(cache.size(), 2);
+
+	// The next scan only sees /a.
+	cache.record("/a", DirSummary());
+	EXPECT_EQ(cache.size(), 2);
+	cache.commitRecorded();
+	EXPECT_EQ(cache.size(), 1);
+	EXPECT_NE(cache.find("/a"), nullptr);
+	EXPECT_EQ(cache.find("/b"), nullptr);
+}
+
+TEST_F(DirSummaryCacheTests, IsUnchanged)
+{
+	constexpr qint64 c_mtime_ns = 1'000'000'000'000;
+	DirSummary summary;
+	summary.m_mtime_ns = c_mtime_ns;
+	summary.m_inode = 42;
+	summary.m_scanned_at_ns = c_mtime_ns + DirSummaryCache::c_racy_window_ns + 1;
+
+	EXPECT_TRUE(DirSummaryCache::isUnchanged(summary, {c_mtime_ns, 42}));
+	EXPECT_FALSE(DirSummaryCache::isUnchanged(summary, {c_mtime_ns + 1, 42}));
+	EXPECT_FALSE(DirSummaryCache::isUnchanged(summary, {c_mtime_ns, 43}));
+
+	// Listed too soon after it was modified to be sure the listing caught everything.
+	summary.m_scanned_at_ns = c_mtime_ns + DirSummaryCache::c_racy_window_ns;
+	EXPECT_FALSE(DirSummaryCache::isUnchanged(summary, {c_mtime_ns, 42}));
+}
+
+TEST_F(DirSummaryCacheTests, IncrementalScanReportsFullResultsForUnchangedDirs)
+{
+	write_file("a/1.flac", "one");
+	write_file("a/1.cue", "cue");
+	write_file("a/2.flac", "two");
+	write_file("a/notes.txt", "not media");
+	write_file("b/c/3.flac", "three");
+	age_tree();
+
+	const auto first = scan(DirSummaryCache::Mode::TrustDirMtime);
+	ASSERT_EQ(first.size(), 3u);
+	EXPECT_TRUE(DirSummaryCache(m_root_url).load());
+
+	// Nothing's changed, so this one takes everything from the summaries, and has to come up with the same results.
+	const auto second = scan(DirSummaryCache::Mode::TrustDirMtime);
+	ASSERT_EQ(second.size(), first.size());
+	for(const auto& [path, dsr] : first)
+	{
+		SCOPED_TRACE(path.toStdString());
+		ASSERT_TRUE(second.contains(path));
+		const DirScanResult& second_dsr = second.at(path);
+		EXPECT_EQ(second_dsr.getDirProps(), dsr.getDirProps());
+		EXPECT_EQ(QUrl(second_dsr.getSidecarCuesheetExtUrl()), QUrl(dsr.getSidecarCuesheetExtUrl()));
+		EXPECT_EQ(second_dsr.getMediaExtUrl().m_file_size_bytes, dsr.getMediaExtUrl().m_file_size_bytes);
+		EXPECT_EQ(second_dsr.getMediaExtUrl().m_last_modified_timestamp, dsr.getMediaExtUrl().m_last_modified_timestamp);
+	}
+	EXPECT_TRUE(second.at("a/1.flac").getDirProps().testFlag(DirScanResult::HasSidecarCueSheet));
+	EXPECT_FALSE(second.at("a/2.flac").getDirProps().testFlag(DirScanResult::HasSidecarCueSheet));
+}
+
+TEST_F(DirSummaryCacheTests, IncrementalScanSeesFilesModifiedInPlace)
+{
+	write_file("a/1.flac", "one");
+	age_tree();
+	scan(DirSummaryCache::Mode::TrustDirMtime);
+
+	// Rewriting a file doesn't change its directory's mtime, but the result still has to have the file's new size.
+	write_file("a/1.flac", "one, retagged");
+	const auto results = scan(DirSummaryCache::Mode::TrustDirMtime);
+	ASSERT_TRUE(results.contains("a/1.flac"));
+	EXPECT_EQ(results.at("a/1.flac").getMediaExtUrl().m_file_size_bytes, QByteArray("one, retagged").size());
+}
+
+TEST_F(DirSummaryCacheTests, TrustDirMtimeSkipsUnchangedDirsButVerifyDoesNot)
+{
+	write_file("a/1.flac", "one");
+	age_tree();
+	scan(DirSummaryCache::Mode::TrustDirMtime);
+
+	// Sneak a file in and put the directory's mtime back, so we can tell whether it was listed.
+	write_file("a/2.flac", "two");
+	age_tree();
+
+	EXPECT_EQ(scan(DirSummaryCache::Mode::TrustDirMtime).size(), 1u);
+	EXPECT_EQ(scan(DirSummaryCache::Mode::Verify).size(), 2u);
+	EXPECT_EQ(scan(DirSummaryCache::Mode::Off).size(), 2u);
+}
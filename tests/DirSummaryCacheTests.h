@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIRSUMMARYCACHETESTS_H
+#define DIRSUMMARYCACHETESTS_H
+
+/// @file
+
+// Std C++
+#include <filesystem>
+#include <map>
+
+// Qt
+#include <QByteArray>
+#include <QString>
+#include <QTemporaryDir>
+#include <QUrl>
+
+// Google Test
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+// Ours
+#include <logic/DirScanResult.h>
+#include <logic/DirSummaryCache.h>
+
+class DirSummaryCacheTests : public ::testing::Test
+{
+	public:
+
+ 	protected:
+
+	void SetUp() override;
+	void TearDown() override;
+
+	/// Create the file @a relative_path under the scan root, and any directories it needs.
+	void write_file(const QString& relative_path, const QByteArray& contents) const;
+
+	/// Set the mtime of everything under the scan root, including the root, to m_aged_mtime.  Directories touched
+	/// just before a scan are inside the racy window and never trusted.
+	void age_tree() const;
+
+	/// Run DirScanIncrementalFunction() over the scan root and return what it found, by path relative to the root.
+	std::map<QString, DirScanResult> scan(DirSummaryCache::Mode mode) const;
+
+	// Objects declared here can be used by all tests in this Fixture.
+
+	QTemporaryDir m_temp_dir;
+	QString m_root_path;
+	QUrl m_root_url;
+	/// An hour before the test started.  The same every time, so age_tree() can put a directory's mtime back.
+	std::filesystem::file_time_type m_aged_mtime;
+};
+
+#endif //DIRSUMMARYCACHETESTS_H
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#include "LibraryJournalTests.h"
+
+// Std C++
+#include <memory>
+#include <utility>
+
+// Qt
+#include <QFile>
+#include <QtEndian>
+#include <QUrl>
+
+// Ours
+#include <logic/LibraryEntry.h>
+#include <logic/LibraryJournal.h>
+#include <logic/models/LibraryModel.h>
+
+// The libraries in these tests all have the default, empty, root URL.  That's fine, it's only the key the journal
+// matches records to libraries with.
+
+/// Frame kind, payload size and checksum.
+static constexpr qsizetype c_frame_header_size = 1 + 4 + 2;
+
+struct Frame
+{
+	quint8 m_kind {0};
+	QByteArray m_payload;
+	/// Offset of the next frame.
+	qsizetype m_end {0};
+};
+
+/// Split journal file contents @a bytes into frames, checking each one's size and checksum.
+static std::vector<Frame> split_frames(const QByteArray& bytes)
+{
+	std::vector<Frame> retval;
+	qsizetype pos = 0;
+	while(pos < bytes.size())
+	{
+		EXPECT_LE(pos + c_frame_header_size, bytes.size());
+		const auto size = qFromBigEndian<quint32>(bytes.constData() + pos + 1);
+		const auto checksum = qFromBigEndian<quint16>(bytes.constData() + pos + 5);
+		const qsizetype payload_pos = pos + c_frame_header_size;
+		EXPECT_LE(payload_pos + qsizetype(size), bytes.size());
+		if(payload_pos + qsizetype(size) > bytes.size())
+		{
+			break;
+		}
+
+		Frame frame {static_cast<quint8>(bytes[pos]), bytes.sliced(payload_pos, size), payload_pos + size};
+		EXPECT_EQ(checksum, qChecksum(frame.m_payload)) << "Frame at offset" << pos;
+		pos = frame.m_end;
+		retval.push_back(std::move(frame));
+	}
+	return retval;
+}
+
+static std::vector<std::shared_ptr<LibraryEntry>> make_entries(const QStringList& filenames)
+{
+	std::vector<std::shared_ptr<LibraryEntry>> retval;
+	for(const auto& filename : filenames)
+	{
+		retval.push_back(LibraryEntry::fromUrl(QUrl::fromLocalFile("/music/" + filename)));
+	}
+	return retval;
+}
+
+void LibraryJournalTests::SetUp()
+{
+	ASSERT_TRUE(m_temp_dir.isValid());
+	m_journal_path = m_temp_dir.filePath("AMLMDatabaseSerDes.journal");
+}
+
+void LibraryJournalTests::write_journal(const std::vector<QStringList>& batches)
+{
+	LibraryModel model;
+	LibraryJournal journal(m_journal_path);
+	journal.open(0);
+	journal.attach(&model);
+
+	for(const auto& batch : batches)
+	{
+		model.appendRows(make_entries(batch));
+	}
+
+	journal.flush();
+}
+
+QStringList LibraryJournalTests::replay_journal(quint64 snapshot_seq, const QStringList& initial_filenames)
+{
+	LibraryModel model;
+	if(!initial_filenames.isEmpty())
+	{
+		model.appendRows(make_entries(initial_filenames));
+	}
+
+	LibraryJournal journal(m_journal_path);
+	journal.open(snapshot_seq);
+	journal.replay(&model);
+	journal.flush();
+
+	QStringList retval;
+	for(int row = 0; row < model.rowCount(); ++row)
+	{
+		retval << model.getItem(model.index(row, 0))->getFilename();
+	}
+	return retval;
+}
+
+QByteArray LibraryJournalTests::read_file(const QString& file_path) const
+{
+	QFile file(file_path);
+	EXPECT_TRUE(file.open(QIODevice::ReadOnly)) << file_path.toStdString();
+	return file.readAll();
+}
+
+void LibraryJournalTests::write_file(const QString& file_path, const QByteArray& bytes) const
+{
+	QFile file(file_path);
+	ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate)) << file_path.toStdString();
+	ASSERT_EQ(file.write(bytes), bytes.size());
+}
+
+TEST_F(LibraryJournalTests, FrameFormat)
+{
+	write_journal({{"a.flac", "b.flac"}, {"c.flac"}});
+
+	// A header frame, then one record frame per insert.
+	auto frames = split_frames(read_file(m_journal_path));
+	ASSERT_EQ(frames.size(), 3);
+	EXPECT_EQ(frames[0].m_kind, quint8('J'));
+	EXPECT_TRUE(frames[0].m_payload.startsWith("AMLMJRNL"));
+	EXPECT_EQ(frames[1].m_kind, quint8('R'));
+	EXPECT_EQ(frames[2].m_kind, quint8('R'));
+
+	EXPECT_EQ(replay_journal(), QStringList({"a.flac", "b.flac", "c.flac"}));
+}
+
+TEST_F(LibraryJournalTests, TornTailIsTruncated)
+{
+	write_journal({{"a.flac"}, {"b.flac"}});
+	const QByteArray bytes = read_file(m_journal_path);
+	auto frames = split_frames(bytes);
+	ASSERT_EQ(frames.size(), 3);
+
+	// A crash in the middle of writing the last frame.
+	write_file(m_journal_path, bytes.first(frames[2].m_end - 3));
+	EXPECT_EQ(replay_journal(), QStringList({"a.flac"}));
+
+	// Opening the journal cut off the partial frame, so what's appended next is readable.
+	EXPECT_EQ(read_file(m_journal_path).size(), frames[1].m_end);
+	write_journal({{"c.flac"}});
+	EXPECT_EQ(replay_journal(), QStringList({"a.flac", "c.flac"}));
+}
+
+TEST_F(LibraryJournalTests, CorruptFrameEndsTheJournal)
+{
+	write_journal({{"a.flac"}, {"b.flac"}, {"c.flac"}});
+	QByteArray bytes = read_file(m_journal_path);
+	auto frames = split_frames(bytes);
+	ASSERT_EQ(frames.size(), 4);
+
+	// Flip a bit in the second record's payload, that and everything after it is gone.
+	bytes[frames[2].m_end - 1] = static_cast<char>(bytes[frames[2].m_end - 1] ^ 0x01);
+	write_file(m_journal_path, bytes);
+	EXPECT_EQ(replay_journal(), QStringList({"a.flac"}));
+	EXPECT_EQ(read_file(m_journal_path).size(), frames[1].m_end);
+}
+
+TEST_F(LibraryJournalTests, DuplicateRecordsReplayOnce)
+{
+	write_journal({{"a.flac"}, {"b.flac"}});
+	const QByteArray bytes = read_file(m_journal_path);
+
+	// What a compaction which finds an unfinished one's moved-aside journal can leave behind: that journal with
+	// another one appended to it, header and all, and records which are in both.
+	write_file(m_journal_path + ".compacting", bytes + bytes);
+
+	EXPECT_EQ(replay_journal(), QStringList({"a.flac", "b.flac"}));
+}
+
+TEST_F(LibraryJournalTests, RecordsInTheSnapshotAreSkipped)
+{
+	// Records 1 and 2.
+	write_journal({{"a.flac"}, {"b.flac"}});
+
+	// A snapshot current up to seq 2 already has a.flac.
+	EXPECT_EQ(replay_journal(2, {"a.flac"}), QStringList({"a.flac", "b.flac"}));
+	// And a later session's records carry on from there.
+	write_journal({{"c.flac"}});
+	EXPECT_EQ(replay_journal(3, {"a.flac", "b.flac"}), QStringList({"a.flac", "b.flac", "c.flac"}));
+}
+
+TEST_F(LibraryJournalTests, NothingRecordedWhilePaused)
+{
+	{
+		LibraryModel model;
+		LibraryJournal journal(m_journal_path);
+		journal.open(0);
+		journal.attach(&model);
+
+		// Like the entries of a library being loaded from the snapshot.
+		{
+			LibraryJournal::ScopedPause pause(journal);
+			model.appendRows(make_entries({"a.flac"}));
+		}
+		model.appendRows(make_entries({"b.flac"}));
+
+		journal.flush();
+	}
+
+	EXPECT_EQ(replay_journal(0, {"a.flac"}), QStringList({"a.flac", "b.flac"}));
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRARYJOURNALTESTS_H
+#define LIBRARYJOURNALTESTS_H
+
+/// @file
+
+// Std C++
+#include <vector>
+
+// Qt
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+
+// Google Test
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+class LibraryJournalTests : public ::testing::Test
+{
+	public:
+
+ 	protected:
+
+	void SetUp() override;
+
+	/// Journal a session in which each of @a batches of filenames is appended to a library as one insert.
+	void write_journal(const std::vector<QStringList>& batches);
+
+	/**
+	 * Start a session with a library holding @a initial_filenames and a snapshot current up to @a snapshot_seq,
+	 * replay the journal into it, and return the filenames it ends up with.
+	 */
+	QStringList replay_journal(quint64 snapshot_seq = 0, const QStringList& initial_filenames = {});
+
+	QByteArray read_file(const QString& file_path) const;
+	void write_file(const QString& file_path, const QByteArray& bytes) const;
+
+	// Objects declared here can be used by all tests in this Fixture.
+
+	QTemporaryDir m_temp_dir;
+	QString m_journal_path;
+};
+
+#endif //LIBRARYJOURNALTESTS_H
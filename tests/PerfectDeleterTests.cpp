@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// PerfectDeleter's shutdown.  Each test has its own PerfectDeleter and cancellation root, the app's are never
+/// canceled here, that would stop everything else in the process.
+
+#include "PerfectDeleterTests.h"
+
+// Std C++
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+// Qt
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QPromise>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+#include <QUrl>
+
+// Ours
+#include <concurrency/AMLMExecutor.h>
+#include <concurrency/BoundedChannel.h>
+#include <concurrency/CancellationToken.h>
+#include <concurrency/ProgressCounter.h>
+#include <logic/DirScanResult.h>
+#include <logic/DirSummaryCache.h>
+#include <logic/PerfectDeleter.h>
+#include <logic/jobs/DirectoryScanJob.h>
+
+namespace
+{
+	constexpr std::chrono::milliseconds c_budget {3000};
+	/// Long enough for a thread which is going to get somewhere to get there.
+	constexpr int c_settle_ms = 200;
+	constexpr int c_timeout_ms = 5000;
+}
+
+/// A dir scan stuck on a full channel, as when its consumer's waiting on the GUI thread, stops as soon as shutdown
+/// cancels it.
+TEST_F(PerfectDeleterTests, ShutdownCancelsRunningScanWithinBudget)
+{
+	QTemporaryDir temp_dir;
+	ASSERT_TRUE(temp_dir.isValid());
+	for(const char* name : {"1.flac", "2.flac", "3.flac"})
+	{
+		QFile file(temp_dir.filePath(name));
+		ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+		file.write("not really flac");
+	}
+
+	// Set up like LibraryRescanner::startAsyncDirectoryTraversal() does, but with nothing consuming the results.
+	CancellationSource root;
+	CancellationSource scan_cancel_source(root.token());
+	const CancellationToken scan_cancel_token = scan_cancel_source.token();
+	auto dirscan_channel = std::make_shared<BoundedChannel<DirScanResult>>(1);
+	scan_cancel_token.onCancel([dirscan_channel](){ dirscan_channel->cancel(); });
+
+	QFuture<Unit> scan_future = AMLMExecutor::io().run(DirScanIncrementalFunction, dirscan_channel,
+													   std::make_shared<ProgressCounter>(), scan_cancel_token,
+													   QUrl::fromLocalFile(temp_dir.path()),
+													   QStringList{QStringLiteral("*.flac")}, DirSummaryCache::Mode::Off);
+	scan_cancel_token.bind(scan_future);
+
+	PerfectDeleter deleter(nullptr);
+	deleter.addQFuture(QFuture<void>(scan_future));
+
+	// Wait for it to fill the channel and block on the next file.
+	ASSERT_TRUE(QTest::qWaitFor([&](){ return dirscan_channel->size() == 1; }, c_timeout_ms));
+	QTest::qWait(c_settle_ms);
+	ASSERT_FALSE(scan_future.isFinished());
+
+	QElapsedTimer shutdown_timer;
+	shutdown_timer.start();
+	EXPECT_TRUE(deleter.cancel_and_wait_for_all(root, c_budget));
+	EXPECT_LT(shutdown_timer.elapsed(), c_budget.count());
+
+	EXPECT_TRUE(scan_future.isFinished());
+	EXPECT_TRUE(scan_future.isCanceled());
+	EXPECT_TRUE(scan_cancel_source.isCanceled());
+	EXPECT_TRUE(dirscan_channel->isCanceled());
+}
+
+/// Work which ignores the cancel is given up on when the budget runs out, and once it's abandoned nothing waits for it.
+TEST_F(PerfectDeleterTests, UncooperativeWorkIsAbandoned)
+{
+	constexpr std::chrono::milliseconds c_short_budget {200};
+
+	auto release = std::make_shared<std::atomic_bool>(false);
+	QFuture<void> stuck = AMLMExecutor::io().run([release](QPromise<void>&){
+		while(!release->load())
+		{
+			QThread::msleep(5);
+		}
+	});
+
+	QElapsedTimer shutdown_timer;
+	{
+		CancellationSource root;
+		PerfectDeleter deleter(nullptr);
+		deleter.addQFuture(stuck);
+
+		shutdown_timer.start();
+		EXPECT_FALSE(deleter.cancel_and_wait_for_all(root, c_short_budget));
+		EXPECT_GE(shutdown_timer.elapsed(), c_short_budget.count());
+
+		deleter.abandon_still_running();
+		// The deleter's destroyed here, and mustn't wait.
+	}
+	EXPECT_LT(shutdown_timer.elapsed(), c_budget.count());
+	EXPECT_FALSE(stuck.isFinished());
+
+	*release = true;
+	stuck.waitForFinished();
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Trace::writeChromeTrace() output, read back with QJsonDocument.  Trace is process-wide and other threads may be
+/// recording into it at the same time, so the tests only look at events with their own names.
+
+#include "TraceTests.h"
+
+// Std C++
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Qt
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QTemporaryDir>
+
+// Ours
+#include <utils/Trace.h>
+
+namespace
+{
+	/// The "traceEvents" of the trace written to @a file_path, empty if it isn't valid JSON.
+	QJsonArray read_trace_events(const QString& file_path)
+	{
+		QFile file(file_path);
+		if(!file.open(QIODevice::ReadOnly))
+		{
+			ADD_FAILURE() << "Couldn't open " << file_path.toStdString();
+			return {};
+		}
+		QJsonParseError error;
+		const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+		if(error.error != QJsonParseError::NoError)
+		{
+			ADD_FAILURE() << "Not valid JSON: " << error.errorString().toStdString() << " at offset " << error.offset;
+			return {};
+		}
+		EXPECT_TRUE(doc.isObject());
+		EXPECT_TRUE(doc.object().value("traceEvents").isArray());
+		return doc.object().value("traceEvents").toArray();
+	}
+
+	std::vector<QJsonObject> events_named(const QJsonArray& events, const QString& name)
+	{
+		std::vector<QJsonObject> retval;
+		for(const auto& event : events)
+		{
+			if(event.toObject().value("name").toString() == name)
+			{
+				retval.push_back(event.toObject());
+			}
+		}
+		return retval;
+	}
+
+	/// ts and dur are written in microseconds to three places, so sums of them can be off by a rounding.
+	constexpr double c_rounding_us = 0.002;
+}
+
+void TraceTests::SetUp()
+{
+	Trace::clear();
+	Trace::enable();
+}
+
+void TraceTests::TearDown()
+{
+	Trace::disable();
+	Trace::clear();
+}
+
+TEST_F(TraceTests, SpansNestWithTheirCounters)
+{
+	{
+		Trace::Span outer("TraceTests outer");
+		{
+			Trace::Span inner("TraceTests inner");
+			inner.counter("files", 3);
+			inner.counter("dirs", 1);
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+
+	QTemporaryDir temp_dir;
+	ASSERT_TRUE(temp_dir.isValid());
+	const QString trace_path = temp_dir.filePath("trace.json");
+	ASSERT_TRUE(Trace::writeChromeTrace(trace_path));
+	const QJsonArray events = read_trace_events(trace_path);
+
+	const auto outers = events_named(events, "TraceTests outer");
+	const auto inners = events_named(events, "TraceTests inner");
+	ASSERT_EQ(outers.size(), 1U);
+	ASSERT_EQ(inners.size(), 1U);
+	const QJsonObject& outer = outers.front();
+	const QJsonObject& inner = inners.front();
+
+	EXPECT_EQ(outer.value("ph").toString(), "X");
+	EXPECT_EQ(inner.value("ph").toString(), "X");
+	EXPECT_EQ(outer.value("tid").toInt(), inner.value("tid").toInt());
+	EXPECT_TRUE(outer.value("ts").isDouble());
+	EXPECT_GE(inner.value("dur").toDouble(), 2000.0);
+
+	// The inner span's entirely inside the outer one.
+	const double outer_ts = outer.value("ts").toDouble();
+	const double inner_ts = inner.value("ts").toDouble();
+	EXPECT_GE(inner_ts, outer_ts);
+	EXPECT_LE(inner_ts + inner.value("dur").toDouble(),
+			  outer_ts + outer.value("dur").toDouble() + c_rounding_us);
+
+	EXPECT_FALSE(outer.contains("args"));
+	const QJsonObject args = inner.value("args").toObject();
+	EXPECT_EQ(args.size(), 2);
+	EXPECT_EQ(args.value("files").toInteger(), 3);
+	EXPECT_EQ(args.value("dirs").toInteger(), 1);
+
+	// Every thread which recorded anything is named.
+	bool found_thread_name = false;
+	for(const auto& event : events_named(events, "thread_name"))
+	{
+		EXPECT_EQ(event.value("ph").toString(), "M");
+		found_thread_name = found_thread_name || event.value("tid").toInt() == outer.value("tid").toInt();
+	}
+	EXPECT_TRUE(found_thread_name);
+}
+
+TEST_F(TraceTests, CountersAndAsyncSpansAcrossThreads)
+{
+	Trace::counter("TraceTests depth", 7);
+	Trace::counter("TraceTests depth", -2);
+
+	const std::uint64_t id = Trace::newAsyncId();
+	const auto begin = std::chrono::steady_clock::now();
+	Trace::asyncBegin("TraceTests async", id, begin);
+	std::thread other_thread([id, begin](){
+		Trace::asyncEnd("TraceTests async", id, begin + std::chrono::milliseconds(5));
+	});
+	other_thread.join();
+
+	QTemporaryDir temp_dir;
+	ASSERT_TRUE(temp_dir.isValid());
+	const QString trace_path = temp_dir.filePath("trace.json");
+	ASSERT_TRUE(Trace::writeChromeTrace(trace_path));
+	const QJsonArray events = read_trace_events(trace_path);
+
+	const auto counters = events_named(events, "TraceTests depth");
+	ASSERT_EQ(counters.size(), 2U);
+	EXPECT_EQ(counters[0].value("ph").toString(), "C");
+	EXPECT_EQ(counters[0].value("args").toObject().value("value").toInteger(), 7);
+	EXPECT_EQ(counters[1].value("args").toObject().value("value").toInteger(), -2);
+	EXPECT_LE(counters[0].value("ts").toDouble(), counters[1].value("ts").toDouble());
+
+	const auto asyncs = events_named(events, "TraceTests async");
+	ASSERT_EQ(asyncs.size(), 2U);
+	// Events are written a thread at a time, so the two can come in either order.
+	const QJsonObject& async_begin = asyncs[0].value("ph").toString() == "b" ? asyncs[0] : asyncs[1];
+	const QJsonObject& async_end = asyncs[0].value("ph").toString() == "b" ? asyncs[1] : asyncs[0];
+	EXPECT_EQ(async_begin.value("ph").toString(), "b");
+	EXPECT_EQ(async_end.value("ph").toString(), "e");
+	EXPECT_EQ(async_begin.value("id").toString(), QString("0x%1").arg(static_cast<qulonglong>(id), 0, 16));
+	EXPECT_EQ(async_begin.value("id").toString(), async_end.value("id").toString());
+	EXPECT_NE(async_begin.value("tid").toInt(), async_end.value("tid").toInt());
+	EXPECT_NEAR(async_end.value("ts").toDouble() - async_begin.value("ts").toDouble(), 5000.0, c_rounding_us);
+}
+
+TEST_F(TraceTests, NamesAreEscaped)
+{
+	const char* name = Trace::intern("TraceTests \"quoted\\path\"\tand\na control \x01");
+	Trace::instant(name);
+
+	QTemporaryDir temp_dir;
+	ASSERT_TRUE(temp_dir.isValid());
+	const QString trace_path = temp_dir.filePath("trace.json");
+	ASSERT_TRUE(Trace::writeChromeTrace(trace_path));
+	const QJsonArray events = read_trace_events(trace_path);
+
+	const auto instants = events_named(events, QString::fromUtf8(name));
+	ASSERT_EQ(instants.size(), 1U);
+	EXPECT_EQ(instants.front().value("ph").toString(), "i");
+	EXPECT_EQ(instants.front().value("s").toString(), "t");
+}
+
+TEST_F(TraceTests, NothingRecordedWhileDisabled)
+{
+	Trace::disable();
+	{
+		Trace::Span span("TraceTests disabled span");
+		span.counter("files", 1);
+	}
+	Trace::counter("TraceTests disabled counter", 1);
+
+	QTemporaryDir temp_dir;
+	ASSERT_TRUE(temp_dir.isValid());
+	const QString trace_path = temp_dir.filePath("trace.json");
+	ASSERT_TRUE(Trace::writeChromeTrace(trace_path));
+	const QJsonArray events = read_trace_events(trace_path);
+
+	EXPECT_TRUE(events_named(events, "TraceTests disabled span").empty());
+	EXPECT_TRUE(events_named(events, "TraceTests disabled counter").empty());
+	// It's still a valid trace, just one with only the metadata in it.
+	EXPECT_FALSE(events_named(events, "process_name").empty());
+}
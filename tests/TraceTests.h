@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026 Gary R. Van Sickle (grvs@users.sourceforge.net).
+ *
+ * This file is part of AwesomeMediaLibraryManager.
+ *
+ * AwesomeMediaLibraryManager is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AwesomeMediaLibraryManager is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AwesomeMediaLibraryManager.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACETESTS_H
+#define TRACETESTS_H
+
+/// @file
+
+// Google Test
+#include <gtest/gtest.h>
+
+class TraceTests : public ::testing::Test
+{
+	public:
+
+ 	protected:
+
+	void SetUp() override;
+	void TearDown() override;
+
+	// Objects declared here can be used by all tests in this Fixture.
+
+};
+
+#endif //TRACETESTS_H
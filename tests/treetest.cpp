@@ -252,3 +252,148 @@ TEST(BasicTreeTests, Deregistration)
 }
 
 
+
+/// Returns the column 0 text of the children of @a parent, in row order.
+static QStringList child_texts(const std::shared_ptr<AbstractTreeModel>& model, const std::shared_ptr<AbstractTreeModelItem>& parent)
+{
+	QStringList retval;
+	auto parent_index = (parent == model->getRootItem()) ? QModelIndex() : model->getIndexFromItem(parent);
+	for(int row = 0; row < model->rowCount(parent_index); ++row)
+	{
+		retval << model->data(model->index(row, 0, parent_index), Qt::DisplayRole).toString();
+	}
+	return retval;
+}
+
+/// Appends new items with @a texts to @a parent one row at a time, the way a loader would.
+static void append_items(const std::shared_ptr<AbstractTreeModel>& model, const std::shared_ptr<AbstractTreeModelItem>& parent,
+						 const QStringList& texts)
+{
+	for(const auto& text : texts)
+	{
+		std::shared_ptr<AbstractTreeModelItem> item = AbstractTreeModelItem::create({text}, model);
+		ASSERT_TRUE(model->insertItemRows(parent->getId(), parent->childCount(), {&item, 1}));
+	}
+}
+
+TEST(TreeModelCommandLogTests, NothingRecordedOutsideAStep)
+{
+	auto model = AbstractTreeModel::create({ColumnSpec(SectionID::Filename, "Column0")});
+	auto root = model->getRootItem();
+
+	append_items(model, root, {"a", "b"});
+
+	EXPECT_FALSE(model->commandLog().canUndo());
+	EXPECT_EQ(model->commandLog().num_commands(), 0);
+	EXPECT_EQ(model->commandLog().num_stored_items(), 0);
+}
+
+TEST(TreeModelCommandLogTests, AdjacentInsertsMergeIntoOneCommand)
+{
+	auto model = AbstractTreeModel::create({ColumnSpec(SectionID::Filename, "Column0")});
+	auto root = model->getRootItem();
+
+	{
+		TreeModelCommandLog::ScopedStep step(model->commandLog(), "Add items");
+		append_items(model, root, {"a", "b", "c", "d"});
+	}
+
+	EXPECT_EQ(model->commandLog().num_commands(), 1);
+	EXPECT_EQ(model->commandLog().num_stored_items(), 4);
+	EXPECT_EQ(model->commandLog().undoText(), "Add items");
+
+	ASSERT_TRUE(model->undo());
+	EXPECT_EQ(model->rowCount(), 0);
+	EXPECT_TRUE(model->checkConsistency());
+	EXPECT_FALSE(model->commandLog().canUndo());
+
+	ASSERT_TRUE(model->redo());
+	EXPECT_EQ(child_texts(model, root), QStringList({"a", "b", "c", "d"}));
+	EXPECT_TRUE(model->checkConsistency());
+}
+
+TEST(TreeModelCommandLogTests, RemovesAtTheSameRowMergeIntoOneCommand)
+{
+	auto model = AbstractTreeModel::create({ColumnSpec(SectionID::Filename, "Column0")});
+	auto root = model->getRootItem();
+	append_items(model, root, {"a", "b", "c", "d", "e"});
+
+	{
+		TreeModelCommandLog::ScopedStep step(model->commandLog(), "Delete items");
+		// Each removal slides the next row up into row 1.
+		ASSERT_TRUE(model->removeItemRows(root->getId(), 1, 1));
+		ASSERT_TRUE(model->removeItemRows(root->getId(), 1, 1));
+		ASSERT_TRUE(model->removeItemRows(root->getId(), 1, 1));
+	}
+	EXPECT_EQ(child_texts(model, root), QStringList({"a", "e"}));
+	EXPECT_EQ(model->commandLog().num_commands(), 1);
+
+	ASSERT_TRUE(model->undo());
+	EXPECT_EQ(child_texts(model, root), QStringList({"a", "b", "c", "d", "e"}));
+	EXPECT_TRUE(model->checkConsistency());
+
+	ASSERT_TRUE(model->redo());
+	EXPECT_EQ(child_texts(model, root), QStringList({"a", "e"}));
+	EXPECT_TRUE(model->checkConsistency());
+}
+
+TEST(TreeModelCommandLogTests, NestedStepsAndEmptySteps)
+{
+	auto model = AbstractTreeModel::create({ColumnSpec(SectionID::Filename, "Column0")});
+	auto root = model->getRootItem();
+	append_items(model, root, {"a", "b", "c", "d"});
+
+	{
+		// An empty step leaves nothing to undo.
+		TreeModelCommandLog::ScopedStep step(model->commandLog(), "Nothing");
+	}
+	EXPECT_FALSE(model->commandLog().canUndo());
+
+	{
+		// Two multi-row deletes from a user action, each of which opens its own step inside the outer one.
+		TreeModelCommandLog::ScopedStep step(model->commandLog(), "Delete selection");
+		ASSERT_TRUE(model->removeRows(2, 2));
+		EXPECT_FALSE(model->commandLog().canUndo());
+		ASSERT_TRUE(model->removeRows(0, 1));
+	}
+	EXPECT_EQ(child_texts(model, root), QStringList({"b"}));
+	EXPECT_EQ(model->commandLog().undoText(), "Delete selection");
+
+	// One undo restores both ranges.
+	ASSERT_TRUE(model->undo());
+	EXPECT_EQ(child_texts(model, root), QStringList({"a", "b", "c", "d"}));
+	EXPECT_FALSE(model->commandLog().canUndo());
+	EXPECT_TRUE(model->checkConsistency());
+}
+
+TEST(TreeModelCommandLogTests, MoveRowsUndoRedo)
+{
+	auto model = AbstractTreeModel::create({ColumnSpec(SectionID::Filename, "Column0")});
+	auto root = model->getRootItem();
+	append_items(model, root, {"a", "b", "c", "d"});
+	auto parent_b = root->child(1);
+	append_items(model, parent_b, {"b1"});
+
+	// Qt's destination row counts the rows being moved.
+	ASSERT_TRUE(model->moveRows(QModelIndex(), 0, 2, QModelIndex(), 4));
+	EXPECT_EQ(child_texts(model, root), QStringList({"c", "d", "a", "b"}));
+	EXPECT_EQ(child_texts(model, parent_b), QStringList({"b1"}));
+	EXPECT_EQ(model->commandLog().undoText(), "Move items");
+
+	// Can't move an item under itself.
+	EXPECT_FALSE(model->moveRows(QModelIndex(), 3, 1, model->getIndexFromItem(parent_b), 0));
+
+	ASSERT_TRUE(model->undo());
+	EXPECT_EQ(child_texts(model, root), QStringList({"a", "b", "c", "d"}));
+	EXPECT_TRUE(model->checkConsistency());
+
+	ASSERT_TRUE(model->redo());
+	EXPECT_EQ(child_texts(model, root), QStringList({"c", "d", "a", "b"}));
+	EXPECT_TRUE(model->checkConsistency());
+
+	// A new step discards the undone ones.
+	ASSERT_TRUE(model->undo());
+	ASSERT_TRUE(model->removeRows(3, 1));
+	EXPECT_FALSE(model->commandLog().canRedo());
+	EXPECT_EQ(child_texts(model, root), QStringList({"a", "b", "c"}));
+}